@@ -0,0 +1,1141 @@
+/*
+ * This file is part of Hubbub.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include <libxml/HTMLtree.h>
+#include <libxml/dict.h>
+#include <libxml/tree.h>
+#include <libxml/valid.h>
+
+#include <hubbub/parser.h>
+#include <hubbub/tree.h>
+
+#include "hubbub_libxml.h"
+
+#define UNUSED(x) ((x)=(x))
+
+/**
+ * Source of encoding information
+ */
+typedef enum encoding_source {
+	ENCODING_SOURCE_HEADER,
+	ENCODING_SOURCE_DETECTED,
+	ENCODING_SOURCE_META
+} encoding_source;
+
+#define NUM_NAMESPACES (6)
+
+/**
+ * Hubbub parser building a libxml2 document
+ */
+struct hubbub_libxml {
+	hubbub_parser *parser;			/**< Underlying parser */
+
+	htmlDocPtr document;			/**< Document being built */
+	xmlDictPtr dict;			/**< The document's dictionary */
+
+	const char *encoding;			/**< The charset of the input */
+	encoding_source enc_source;		/**< The encoding source */
+	bool fix_enc;				/**< Whether to fix encodings */
+
+	xmlNsPtr namespaces[NUM_NAMESPACES];	/**< XML namespaces, by
+						 * hubbub_ns - 1 */
+	bool have_namespaces;			/**< Whether namespaces exist */
+
+	hubbub_tree_handler tree_handler;	/**< Hubbub tree callbacks */
+
+	hubbub_allocator_fn alloc;		/**< Memory (de)allocation */
+	void *pw;				/**< Client data */
+};
+
+/**
+ * Mapping of namespace prefixes to URIs, indexed by hubbub_ns.
+ */
+static const struct {
+	const char *prefix;
+	const char *url;
+} namespaces[] = {
+	{ NULL, NULL },
+	{ NULL, "http://www.w3.org/1999/xhtml" },
+	{ "math", "http://www.w3.org/1998/Math/MathML" },
+	{ "svg", "http://www.w3.org/2000/svg" },
+	{ "xlink", "http://www.w3.org/1999/xlink" },
+	{ "xml", "http://www.w3.org/XML/1998/namespace" },
+	{ "xmlns", "http://www.w3.org/2000/xmlns/" }
+};
+
+static hubbub_error binding_start(hubbub_libxml *b);
+static void binding_stop(hubbub_libxml *b);
+static void create_namespaces(hubbub_libxml *b, xmlNode *root);
+static inline xmlNsPtr get_namespace(hubbub_libxml *b, hubbub_ns ns);
+static inline const xmlChar *intern(hubbub_libxml *b,
+		const hubbub_string *str);
+static inline xmlChar *copy_string(const hubbub_string *str);
+static hubbub_error add_attribute(hubbub_libxml *b, xmlNode *node,
+		const xmlChar *name, xmlNsPtr ns,
+		const xmlChar *value, int len);
+static void link_node(xmlNode *parent, xmlNode *child, xmlNode *ref);
+static hubbub_error create_comment(void *ctx, const hubbub_string *data,
+		void **result);
+static hubbub_error create_doctype(void *ctx, const hubbub_doctype *doctype,
+		void **result);
+static hubbub_error create_element(void *ctx, const hubbub_tag *tag,
+		void **result);
+static hubbub_error create_text(void *ctx, const hubbub_string *data,
+		void **result);
+static hubbub_error ref_node(void *ctx, void *node);
+static hubbub_error unref_node(void *ctx, void *node);
+static hubbub_error append_child(void *ctx, void *parent, void *child,
+		void **result);
+static hubbub_error insert_before(void *ctx, void *parent, void *child,
+		void *ref_child, void **result);
+static hubbub_error remove_child(void *ctx, void *parent, void *child,
+		void **result);
+static hubbub_error clone_node(void *ctx, void *node, bool deep, void **result);
+static hubbub_error reparent_children(void *ctx, void *node, void *new_parent);
+static hubbub_error get_parent(void *ctx, void *node, bool element_only,
+		void **result);
+static hubbub_error has_children(void *ctx, void *node, bool *result);
+static hubbub_error form_associate(void *ctx, void *form, void *node);
+static hubbub_error add_attributes(void *ctx, void *node,
+		const hubbub_attribute *attributes, uint32_t n_attributes);
+static hubbub_error set_quirks_mode(void *ctx, hubbub_quirks_mode mode);
+static hubbub_error change_encoding(void *ctx, const char *charset);
+static hubbub_error complete_script(void *ctx, void *script);
+
+/* Prototype tree handler struct */
+static const hubbub_tree_handler tree_handler = {
+	create_comment,
+	create_doctype,
+	create_element,
+	create_text,
+	ref_node,
+	unref_node,
+	append_child,
+	insert_before,
+	remove_child,
+	clone_node,
+	reparent_children,
+	get_parent,
+	has_children,
+	form_associate,
+	add_attributes,
+	set_quirks_mode,
+	change_encoding,
+	complete_script,
+	NULL
+};
+
+/**
+ * Create a parser building a libxml2 document
+ *
+ * \param enc      Source document encoding, or NULL to autodetect
+ * \param fix_enc  Permit fixing up of encoding if it's frequently misused
+ * \param alloc    Memory (de)allocation function
+ * \param pw       Pointer to client-specific private data (may be NULL)
+ * \param binding  Pointer to location to receive binding instance
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_BADPARM on bad parameters,
+ *         HUBBUB_NOMEM on memory exhaustion,
+ *         HUBBUB_BADENCODING if ::enc is unsupported
+ *
+ * Names in the document are interned in the document's dictionary.
+ * Libxml2 itself allocates the document with its own allocator; ::alloc
+ * is used for the parser and the binding.
+ */
+hubbub_error hubbub_libxml_create(const char *enc, bool fix_enc,
+		hubbub_allocator_fn alloc, void *pw, hubbub_libxml **binding)
+{
+	hubbub_libxml *b;
+	hubbub_error error;
+
+	if (alloc == NULL || binding == NULL)
+		return HUBBUB_BADPARM;
+
+	b = alloc(NULL, sizeof(hubbub_libxml), pw);
+	if (b == NULL)
+		return HUBBUB_NOMEM;
+
+	b->parser = NULL;
+	b->document = NULL;
+	b->dict = NULL;
+	b->encoding = enc;
+	b->enc_source = ENCODING_SOURCE_HEADER;
+	b->fix_enc = fix_enc;
+	b->tree_handler = tree_handler;
+	b->tree_handler.ctx = b;
+	b->alloc = alloc;
+	b->pw = pw;
+
+	error = binding_start(b);
+	if (error != HUBBUB_OK) {
+		alloc(b, 0, pw);
+		return error;
+	}
+
+	*binding = b;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Destroy a parser building a libxml2 document
+ *
+ * \param binding  The binding to destroy
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * The document is destroyed too, unless it has been extracted.
+ */
+hubbub_error hubbub_libxml_destroy(hubbub_libxml *binding)
+{
+	if (binding == NULL)
+		return HUBBUB_BADPARM;
+
+	binding_stop(binding);
+
+	binding->alloc(binding, 0, binding->pw);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Pass a chunk of data to the parser
+ *
+ * \param binding  The binding to use
+ * \param data     Data to parse (encoded in the input charset)
+ * \param len      Length, in bytes, of data
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_ENCODINGCHANGE if the document turned out to be in a
+ *                               different charset,
+ *         appropriate error otherwise.
+ *
+ * On HUBBUB_ENCODINGCHANGE, the binding has discarded its document and
+ * started again in the new charset.  The client must pass the data again,
+ * from the start of the document.
+ */
+hubbub_error hubbub_libxml_parse_chunk(hubbub_libxml *binding,
+		const uint8_t *data, size_t len)
+{
+	hubbub_error error;
+
+	if (binding == NULL || binding->parser == NULL)
+		return HUBBUB_BADPARM;
+
+	error = hubbub_parser_parse_chunk(binding->parser, data, len);
+	if (error == HUBBUB_ENCODINGCHANGE) {
+		binding_stop(binding);
+
+		error = binding_start(binding);
+		if (error != HUBBUB_OK)
+			return error;
+
+		return HUBBUB_ENCODINGCHANGE;
+	}
+
+	return error;
+}
+
+/**
+ * Inform the parser that the last chunk of data has been parsed
+ *
+ * \param binding  The binding to inform
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error hubbub_libxml_completed(hubbub_libxml *binding)
+{
+	if (binding == NULL || binding->parser == NULL)
+		return HUBBUB_BADPARM;
+
+	return hubbub_parser_completed(binding->parser);
+}
+
+/**
+ * Take ownership of the document
+ *
+ * \param binding  The binding to extract the document from
+ * \return The document, or NULL if there is none
+ *
+ * The underlying parser is destroyed, so no more data may be parsed.
+ * The client must free the document with xmlFreeDoc().
+ */
+htmlDocPtr hubbub_libxml_extract_document(hubbub_libxml *binding)
+{
+	htmlDocPtr document;
+
+	if (binding == NULL)
+		return NULL;
+
+	/* Destroying the parser releases its references to nodes */
+	if (binding->parser != NULL) {
+		hubbub_parser_destroy(binding->parser);
+		binding->parser = NULL;
+	}
+
+	document = binding->document;
+	binding->document = NULL;
+	binding->dict = NULL;
+
+	if (document != NULL)
+		document->_private = NULL;
+
+	return document;
+}
+
+/**
+ * Retrieve the underlying parser
+ *
+ * \param binding  The binding to query
+ * \return The parser, or NULL once the document has been extracted
+ *
+ * The parser may be used to set options, but must not be destroyed, nor
+ * have its tree handler or document node changed.
+ */
+hubbub_parser *hubbub_libxml_get_parser(hubbub_libxml *binding)
+{
+	if (binding == NULL)
+		return NULL;
+
+	return binding->parser;
+}
+
+/******************************************************************************
+ * Helper functions                                                           *
+ ******************************************************************************/
+
+/**
+ * Create a parser and an empty document
+ *
+ * \param b  The binding
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error binding_start(hubbub_libxml *b)
+{
+	hubbub_parser_optparams params;
+	hubbub_error error;
+	uint32_t i;
+
+	error = hubbub_parser_create(b->encoding, b->fix_enc,
+			b->alloc, b->pw, &b->parser);
+	if (error != HUBBUB_OK) {
+		b->parser = NULL;
+		return error;
+	}
+
+	b->document = htmlNewDocNoDtD(NULL, NULL);
+	if (b->document == NULL) {
+		binding_stop(b);
+		return HUBBUB_NOMEM;
+	}
+
+	/* Names are interned in the document's dictionary, which is freed
+	 * with the document */
+	b->dict = xmlDictCreate();
+	if (b->dict == NULL) {
+		binding_stop(b);
+		return HUBBUB_NOMEM;
+	}
+	b->document->dict = b->dict;
+
+	for (i = 0; i < NUM_NAMESPACES; i++)
+		b->namespaces[i] = NULL;
+	b->have_namespaces = false;
+
+	params.tree_handler = &b->tree_handler;
+	error = hubbub_parser_setopt(b->parser, HUBBUB_PARSER_TREE_HANDLER,
+			&params);
+	if (error != HUBBUB_OK) {
+		binding_stop(b);
+		return error;
+	}
+
+	/* The treebuilder releases this reference when it is destroyed */
+	b->document->_private = (void *) 1;
+	params.document_node = b->document;
+	error = hubbub_parser_setopt(b->parser, HUBBUB_PARSER_DOCUMENT_NODE,
+			&params);
+	if (error != HUBBUB_OK) {
+		binding_stop(b);
+		return error;
+	}
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Destroy the parser and document, if any
+ *
+ * \param b  The binding
+ */
+void binding_stop(hubbub_libxml *b)
+{
+	if (b->parser != NULL) {
+		hubbub_parser_destroy(b->parser);
+		b->parser = NULL;
+	}
+
+	if (b->document != NULL) {
+		xmlFreeDoc(b->document);
+		b->document = NULL;
+		b->dict = NULL;
+	}
+}
+
+/**
+ * Declare the document's namespaces on its first element
+ *
+ * \param b     The binding
+ * \param root  The first element created
+ */
+void create_namespaces(hubbub_libxml *b, xmlNode *root)
+{
+	uint32_t i;
+
+	/* Index 0 is the NULL namespace, so skip over it */
+	for (i = 1; i < sizeof(namespaces) / sizeof(namespaces[0]); i++) {
+		const xmlChar *prefix = BAD_CAST namespaces[i].prefix;
+
+		/* Libxml2 refuses to declare the "xml" prefix, which every
+		 * document has implicitly */
+		if (prefix != NULL && xmlStrEqual(prefix, BAD_CAST "xml")) {
+			b->namespaces[i - 1] = xmlSearchNs(b->document,
+					root, prefix);
+		} else {
+			b->namespaces[i - 1] = xmlNewNs(root,
+					BAD_CAST namespaces[i].url, prefix);
+		}
+	}
+
+	b->have_namespaces = true;
+}
+
+/**
+ * Find the libxml2 namespace for a hubbub namespace
+ *
+ * \param b   The binding
+ * \param ns  The namespace
+ * \return The libxml2 namespace, or NULL for none
+ */
+xmlNsPtr get_namespace(hubbub_libxml *b, hubbub_ns ns)
+{
+	if (ns == HUBBUB_NS_NULL || ns > NUM_NAMESPACES)
+		return NULL;
+
+	return b->namespaces[ns - 1];
+}
+
+/**
+ * Intern a string in the document's dictionary
+ *
+ * \param b    The binding
+ * \param str  The string to intern
+ * \return The interned string, or NULL on memory exhaustion
+ */
+const xmlChar *intern(hubbub_libxml *b, const hubbub_string *str)
+{
+	if (str->len == 0)
+		return xmlDictLookup(b->dict, BAD_CAST "", 0);
+
+	return xmlDictLookup(b->dict, str->ptr, (int) str->len);
+}
+
+/**
+ * Copy a hubbub string to a libxml2 string
+ *
+ * \param str  The string to copy
+ * \return The copy, or NULL on memory exhaustion
+ */
+xmlChar *copy_string(const hubbub_string *str)
+{
+	if (str->len == 0)
+		return xmlStrdup(BAD_CAST "");
+
+	return xmlStrndup(str->ptr, (int) str->len);
+}
+
+/**
+ * Add an attribute to an element
+ *
+ * \param b      The binding
+ * \param node   The element
+ * \param name   The attribute's name, interned in the document's dictionary
+ * \param ns     The attribute's namespace, or NULL for none
+ * \param value  The attribute's value
+ * \param len    Length, in bytes, of value
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * The value is copied once, straight into the attribute's text node.
+ */
+hubbub_error add_attribute(hubbub_libxml *b, xmlNode *node,
+		const xmlChar *name, xmlNsPtr ns,
+		const xmlChar *value, int len)
+{
+	xmlAttrPtr attr;
+	xmlNodePtr text;
+
+	attr = xmlNewNsPropEatName(node, ns, (xmlChar *) name, NULL);
+	if (attr == NULL)
+		return HUBBUB_NOMEM;
+
+	/* An attribute with no children has an empty value */
+	if (len == 0)
+		return HUBBUB_OK;
+
+	text = xmlNewDocTextLen(b->document, value, len);
+	if (text == NULL)
+		return HUBBUB_NOMEM;
+
+	text->parent = (xmlNodePtr) attr;
+	attr->children = attr->last = text;
+
+	if (xmlIsID(b->document, node, attr))
+		xmlAddID(NULL, b->document, text->content, attr);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Link a node into a parent's child list
+ *
+ * \param parent  The new parent
+ * \param child   The node to link, which is unlinked first if necessary
+ * \param ref     The child to insert before, or NULL to append
+ *
+ * Unlike xmlAddChild() and friends, this never merges or frees text
+ * nodes, which would invalidate the treebuilder's references.
+ */
+void link_node(xmlNode *parent, xmlNode *child, xmlNode *ref)
+{
+	if (child->parent != NULL)
+		xmlUnlinkNode(child);
+
+	child->parent = parent;
+	child->next = ref;
+
+	if (ref == NULL) {
+		child->prev = parent->last;
+		parent->last = child;
+	} else {
+		child->prev = ref->prev;
+		ref->prev = child;
+	}
+
+	if (child->prev == NULL)
+		parent->children = child;
+	else
+		child->prev->next = child;
+}
+
+/******************************************************************************
+ * Tree callbacks for hubbub                                                  *
+ ******************************************************************************/
+
+/**
+ * Create a comment node
+ *
+ * \param ctx     The binding
+ * \param data    The comment body
+ * \param result  Location to receive manufactured node
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Postcondition: if successful, result's reference count must be 1.
+ */
+hubbub_error create_comment(void *ctx, const hubbub_string *data, void **result)
+{
+	hubbub_libxml *b = (hubbub_libxml *) ctx;
+	xmlNodePtr n;
+
+	n = xmlNewDocComment(b->document, NULL);
+	if (n == NULL)
+		return HUBBUB_NOMEM;
+
+	n->content = copy_string(data);
+	if (n->content == NULL) {
+		xmlFreeNode(n);
+		return HUBBUB_NOMEM;
+	}
+
+	n->_private = (void *) 1;
+
+	*result = n;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Create a doctype node
+ *
+ * \param ctx      The binding
+ * \param doctype  Data for doctype node (name, public ID and system ID)
+ * \param result   Location to receive manufactured node
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Postcondition: if successful, result's reference count must be 1.
+ */
+hubbub_error create_doctype(void *ctx, const hubbub_doctype *doctype,
+		void **result)
+{
+	hubbub_libxml *b = (hubbub_libxml *) ctx;
+	xmlChar *name, *public = NULL, *system = NULL;
+	xmlDtdPtr n;
+
+	name = copy_string(&doctype->name);
+	if (name == NULL)
+		goto fail;
+
+	if (doctype->public_missing == false) {
+		public = copy_string(&doctype->public_id);
+		if (public == NULL)
+			goto fail;
+	}
+
+	if (doctype->system_missing == false) {
+		system = copy_string(&doctype->system_id);
+		if (system == NULL)
+			goto fail;
+	}
+
+	n = xmlNewDtd(b->document, name, public, system);
+	if (n == NULL)
+		goto fail;
+
+	n->_private = (void *) 1;
+
+	*result = n;
+
+	xmlFree(name);
+	xmlFree(public);
+	xmlFree(system);
+
+	return HUBBUB_OK;
+
+fail:
+	xmlFree(name);
+	xmlFree(public);
+	xmlFree(system);
+
+	return HUBBUB_NOMEM;
+}
+
+/**
+ * Create an element node
+ *
+ * \param ctx     The binding
+ * \param tag     Data for node
+ * \param result  Location to receive manufactured node
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Postcondition: if successful, result's reference count must be 1.
+ */
+hubbub_error create_element(void *ctx, const hubbub_tag *tag, void **result)
+{
+	hubbub_libxml *b = (hubbub_libxml *) ctx;
+	const xmlChar *name;
+	xmlNodePtr n;
+	uint32_t i;
+
+	name = intern(b, &tag->name);
+	if (name == NULL)
+		return HUBBUB_NOMEM;
+
+	n = xmlNewDocNodeEatName(b->document, NULL, (xmlChar *) name, NULL);
+	if (n == NULL)
+		return HUBBUB_NOMEM;
+
+	if (b->have_namespaces == false)
+		create_namespaces(b, n);
+
+	n->ns = get_namespace(b, tag->ns);
+
+	for (i = 0; i < tag->n_attributes; i++) {
+		const hubbub_attribute *attr = &tag->attributes[i];
+		const xmlChar *aname = intern(b, &attr->name);
+
+		if (aname == NULL || add_attribute(b, n, aname,
+				get_namespace(b, attr->ns), attr->value.ptr,
+				(int) attr->value.len) != HUBBUB_OK) {
+			xmlFreeNode(n);
+			return HUBBUB_NOMEM;
+		}
+	}
+
+	n->_private = (void *) 1;
+
+	*result = n;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Create a text node
+ *
+ * \param ctx     The binding
+ * \param data    Node data
+ * \param result  Location to receive manufactured node
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Postcondition: if successful, result's reference count must be 1.
+ */
+hubbub_error create_text(void *ctx, const hubbub_string *data, void **result)
+{
+	hubbub_libxml *b = (hubbub_libxml *) ctx;
+	xmlNodePtr n;
+
+	n = xmlNewDocTextLen(b->document, data->ptr, (int) data->len);
+	if (n == NULL)
+		return HUBBUB_NOMEM;
+
+	n->_private = (void *) 1;
+
+	*result = n;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Increase a node's reference count
+ *
+ * \param ctx   The binding
+ * \param node  Node to reference
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * The count is kept in _private, which xmlDoc and xmlNode share.
+ */
+hubbub_error ref_node(void *ctx, void *node)
+{
+	xmlNode *n = (xmlNode *) node;
+	uintptr_t count = (uintptr_t) n->_private;
+
+	UNUSED(ctx);
+
+	n->_private = (void *) ++count;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Decrease a node's reference count
+ *
+ * \param ctx   The binding
+ * \param node  The node to unreference
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Postcondition: If the node's reference count becomes zero, and it has no
+ * parent, and it is not the document node, then it is destroyed.
+ */
+hubbub_error unref_node(void *ctx, void *node)
+{
+	hubbub_libxml *b = (hubbub_libxml *) ctx;
+	xmlNode *n = (xmlNode *) node;
+	uintptr_t count = (uintptr_t) n->_private;
+
+	/* Trap any attempt to unref a non-referenced node */
+	assert(count != 0 && "Node has refcount of zero");
+
+	n->_private = (void *) --count;
+
+	/* Never destroy document node */
+	if (count == 0 && n->parent == NULL && node != b->document)
+		xmlFreeNode(n);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Append a node to the end of another's child list
+ *
+ * \param ctx     The binding
+ * \param parent  The node to append to
+ * \param child   The node to append
+ * \param result  Location to receive appended node
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Postcondition: if successful, result's reference count is increased by 1
+ *
+ * Important: *result may not == child (e.g. if text nodes got coalesced)
+ */
+hubbub_error append_child(void *ctx, void *parent, void *child, void **result)
+{
+	xmlNode *chld = (xmlNode *) child;
+	xmlNode *p = (xmlNode *) parent;
+
+	/* A new text node following a text node extends it in place */
+	if (chld->type == XML_TEXT_NODE && chld->parent == NULL &&
+			p->last != NULL && p->last->type == XML_TEXT_NODE) {
+		if (xmlTextConcat(p->last, chld->content,
+				xmlStrlen(chld->content)) != 0)
+			return HUBBUB_NOMEM;
+
+		*result = p->last;
+	} else {
+		link_node(p, chld, NULL);
+
+		*result = chld;
+	}
+
+	return ref_node(ctx, *result);
+}
+
+/**
+ * Insert a node into another's child list
+ *
+ * \param ctx        The binding
+ * \param parent     The node to insert into
+ * \param child      The node to insert
+ * \param ref_child  The node to insert before
+ * \param result     Location to receive inserted node
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Postcondition: if successful, result's reference count is increased by 1
+ *
+ * Important: *result may not == child (e.g. if text nodes got coalesced)
+ */
+hubbub_error insert_before(void *ctx, void *parent, void *child,
+		void *ref_child, void **result)
+{
+	xmlNode *chld = (xmlNode *) child;
+	xmlNode *ref = (xmlNode *) ref_child;
+
+	if (chld->type == XML_TEXT_NODE && chld->parent == NULL &&
+			ref->prev != NULL && ref->prev->type == XML_TEXT_NODE) {
+		/* Extend the preceding text node */
+		if (xmlTextConcat(ref->prev, chld->content,
+				xmlStrlen(chld->content)) != 0)
+			return HUBBUB_NOMEM;
+
+		*result = ref->prev;
+	} else if (chld->type == XML_TEXT_NODE && chld->parent == NULL &&
+			ref->type == XML_TEXT_NODE) {
+		/* Prepend to the following text node */
+		xmlChar *content = xmlStrncatNew(chld->content,
+				ref->content, -1);
+		if (content == NULL)
+			return HUBBUB_NOMEM;
+
+		xmlNodeSetContent(ref, content);
+		xmlFree(content);
+
+		*result = ref;
+	} else {
+		link_node((xmlNode *) parent, chld, ref);
+
+		*result = chld;
+	}
+
+	return ref_node(ctx, *result);
+}
+
+/**
+ * Remove a node from another's child list
+ *
+ * \param ctx     The binding
+ * \param parent  The node to remove from
+ * \param child   The node to remove
+ * \param result  Location to receive removed node
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Postcondition: if successful, result's reference count is increased by 1
+ */
+hubbub_error remove_child(void *ctx, void *parent, void *child, void **result)
+{
+	UNUSED(parent);
+
+	xmlUnlinkNode((xmlNode *) child);
+
+	*result = child;
+
+	return ref_node(ctx, *result);
+}
+
+/**
+ * Clone a node
+ *
+ * \param ctx     The binding
+ * \param node    The node to clone
+ * \param deep    True to clone entire subtree, false to clone only the node
+ * \param result  Location to receive clone
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Postcondition: if successful, result's reference count must be 1.
+ */
+hubbub_error clone_node(void *ctx, void *node, bool deep, void **result)
+{
+	hubbub_libxml *b = (hubbub_libxml *) ctx;
+	xmlNode *n = (xmlNode *) node;
+	xmlNode *copy;
+
+	if (n->type == XML_ELEMENT_NODE && deep == false) {
+		/* The treebuilder clones formatting elements often.  Reuse
+		 * their interned names and cached namespaces, rather than
+		 * have xmlDocCopyNode() redeclare the namespaces on the
+		 * detached copy */
+		xmlAttr *a;
+
+		copy = xmlNewDocNodeEatName(b->document, n->ns,
+				(xmlChar *) n->name, NULL);
+		if (copy == NULL)
+			return HUBBUB_NOMEM;
+
+		for (a = n->properties; a != NULL; a = a->next) {
+			const xmlChar *value = NULL;
+
+			if (a->children != NULL)
+				value = a->children->content;
+
+			if (add_attribute(b, copy, a->name, a->ns, value,
+					xmlStrlen(value)) != HUBBUB_OK) {
+				xmlFreeNode(copy);
+				return HUBBUB_NOMEM;
+			}
+		}
+	} else {
+		xmlNode *d;
+
+		copy = xmlDocCopyNode(n, b->document, deep ? 1 : 2);
+		if (copy == NULL)
+			return HUBBUB_NOMEM;
+
+		/* Descendants are unreferenced */
+		for (d = copy->children; d != NULL; ) {
+			d->_private = NULL;
+
+			if (d->type != XML_ENTITY_REF_NODE &&
+					d->children != NULL) {
+				d = d->children;
+				continue;
+			}
+
+			while (d != copy && d->next == NULL)
+				d = d->parent;
+
+			d = (d == copy) ? NULL : d->next;
+		}
+	}
+
+	copy->_private = (void *) 1;
+
+	*result = copy;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Move all the children of one node to another
+ *
+ * \param ctx         The binding
+ * \param node        The initial parent node
+ * \param new_parent  The new parent node
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error reparent_children(void *ctx, void *node, void *new_parent)
+{
+	xmlNode *n = (xmlNode *) node;
+	xmlNode *p = (xmlNode *) new_parent;
+	xmlNode *child;
+
+	UNUSED(ctx);
+
+	if (n->children == NULL)
+		return HUBBUB_OK;
+
+	/* Splice the whole child list across */
+	for (child = n->children; child != NULL; child = child->next)
+		child->parent = p;
+
+	if (p->last == NULL) {
+		p->children = n->children;
+	} else {
+		p->last->next = n->children;
+		n->children->prev = p->last;
+	}
+	p->last = n->last;
+
+	n->children = n->last = NULL;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Retrieve the parent of a node
+ *
+ * \param ctx           The binding
+ * \param node          Node to retrieve the parent of
+ * \param element_only  True if the parent must be an element, false otherwise
+ * \param result        Location to receive parent node
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Postcondition: if there is a parent, then result's reference count must be
+ * increased.
+ */
+hubbub_error get_parent(void *ctx, void *node, bool element_only,
+		void **result)
+{
+	xmlNode *parent = ((xmlNode *) node)->parent;
+
+	if (parent != NULL && element_only &&
+			parent->type != XML_ELEMENT_NODE)
+		parent = NULL;
+
+	*result = parent;
+
+	if (parent != NULL)
+		return ref_node(ctx, parent);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Determine if a node has children
+ *
+ * \param ctx     The binding
+ * \param node    The node to inspect
+ * \param result  Location to receive result
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error has_children(void *ctx, void *node, bool *result)
+{
+	UNUSED(ctx);
+
+	*result = ((xmlNode *) node)->children != NULL;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Associate a form with a node
+ *
+ * \param ctx   The binding
+ * \param form  The form to associate with
+ * \param node  The node to associate
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Libxml2 has no notion of form ownership, so this does nothing.
+ */
+hubbub_error form_associate(void *ctx, void *form, void *node)
+{
+	UNUSED(ctx);
+	UNUSED(form);
+	UNUSED(node);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Add attributes to a node
+ *
+ * \param ctx           The binding
+ * \param node          The node to add to
+ * \param attributes    Array of attributes to add
+ * \param n_attributes  Number of entries in array
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Attributes the node already has are left alone.
+ */
+hubbub_error add_attributes(void *ctx, void *node,
+		const hubbub_attribute *attributes, uint32_t n_attributes)
+{
+	hubbub_libxml *b = (hubbub_libxml *) ctx;
+	xmlNode *n = (xmlNode *) node;
+	uint32_t i;
+
+	for (i = 0; i < n_attributes; i++) {
+		const hubbub_attribute *attr = &attributes[i];
+		xmlNsPtr ns = get_namespace(b, attr->ns);
+		const xmlChar *name;
+		xmlAttr *a;
+
+		name = intern(b, &attr->name);
+		if (name == NULL)
+			return HUBBUB_NOMEM;
+
+		/* Interned names compare by pointer */
+		for (a = n->properties; a != NULL; a = a->next) {
+			if (a->name == name && a->ns == ns)
+				break;
+		}
+
+		if (a != NULL)
+			continue;
+
+		if (add_attribute(b, n, name, ns, attr->value.ptr,
+				(int) attr->value.len) != HUBBUB_OK)
+			return HUBBUB_NOMEM;
+	}
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Notification of the quirks mode of a document
+ *
+ * \param ctx   The binding
+ * \param mode  The quirks mode
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error set_quirks_mode(void *ctx, hubbub_quirks_mode mode)
+{
+	UNUSED(ctx);
+	UNUSED(mode);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Notification that a potential encoding change is required
+ *
+ * \param ctx      The binding
+ * \param charset  The new charset for the source data
+ * \return HUBBUB_OK to continue using the current input handler,
+ *         HUBBUB_ENCODINGCHANGE to stop processing immediately and
+ *                               return control to the client,
+ *         appropriate error otherwise.
+ */
+hubbub_error change_encoding(void *ctx, const char *charset)
+{
+	hubbub_libxml *b = (hubbub_libxml *) ctx;
+	hubbub_charset_source source;
+	const char *name;
+
+	/* If we have an encoding here, it means we are *certain* */
+	if (b->encoding != NULL)
+		return HUBBUB_OK;
+
+	/* Find the confidence otherwise (can only be from a BOM) */
+	name = hubbub_parser_read_charset(b->parser, &source);
+
+	if (source == HUBBUB_CHARSET_CONFIDENT) {
+		b->enc_source = ENCODING_SOURCE_DETECTED;
+		b->encoding = charset;
+		return HUBBUB_OK;
+	}
+
+	/* The encoding is set either way: for reprocessing in a different
+	 * charset, or to confirm that the charset is in fact correct */
+	b->encoding = charset;
+	b->enc_source = ENCODING_SOURCE_META;
+
+	/* Equal encodings will have the same string pointers */
+	return (charset == name) ? HUBBUB_OK : HUBBUB_ENCODINGCHANGE;
+}
+
+/**
+ * Notification that a script has been completed
+ *
+ * \param ctx     The binding
+ * \param script  The script element
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Scripts are not run, so this does nothing.
+ */
+hubbub_error complete_script(void *ctx, void *script)
+{
+	UNUSED(ctx);
+	UNUSED(script);
+
+	return HUBBUB_OK;
+}
+
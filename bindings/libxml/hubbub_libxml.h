@@ -0,0 +1,52 @@
+/*
+ * This file is part of Hubbub.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ */
+
+#ifndef hubbub_libxml_h_
+#define hubbub_libxml_h_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include <libxml/HTMLtree.h>
+
+#include <hubbub/errors.h>
+#include <hubbub/functypes.h>
+#include <hubbub/parser.h>
+
+/**
+ * Hubbub parser building a libxml2 document
+ */
+typedef struct hubbub_libxml hubbub_libxml;
+
+/* Create a parser building a libxml2 document */
+hubbub_error hubbub_libxml_create(const char *enc, bool fix_enc,
+		hubbub_allocator_fn alloc, void *pw, hubbub_libxml **binding);
+/* Destroy a parser, and its document unless extracted */
+hubbub_error hubbub_libxml_destroy(hubbub_libxml *binding);
+
+/* Pass a chunk of data to the parser */
+hubbub_error hubbub_libxml_parse_chunk(hubbub_libxml *binding,
+		const uint8_t *data, size_t len);
+/* Inform the parser that the last chunk of data has been parsed */
+hubbub_error hubbub_libxml_completed(hubbub_libxml *binding);
+
+/* Take ownership of the document */
+htmlDocPtr hubbub_libxml_extract_document(hubbub_libxml *binding);
+
+/* Retrieve the underlying parser */
+hubbub_parser *hubbub_libxml_get_parser(hubbub_libxml *binding);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,502 @@
+/*
+ * This file is part of Hubbub.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 The NetSurf Browser Project
+ */
+
+#ifndef hubbub_coroutine_hpp_
+#define hubbub_coroutine_hpp_
+
+/**
+ * \file
+ * C++20 coroutine front end
+ *
+ * hubbub::token_stream<Source> turns the parser into an awaitable
+ * generator of tokens, fed by an asynchronous byte source:
+ *
+ *   hubbub::token_stream<my_source> tokens;
+ *   if (tokens.create(source, "UTF-8") != HUBBUB_OK) ...
+ *
+ *   while (const hubbub::token_view *token = co_await tokens.next()) {
+ *       ...
+ *   }
+ *
+ *   if (tokens.error() != HUBBUB_OK) ...
+ *
+ * Source must provide read(), whose result, when awaited, converts to
+ * std::span<const uint8_t>: the next chunk of the document, or an empty
+ * span at the end of input.  The chunk need only remain valid until the
+ * stream next awaits read().
+ *
+ * The stream reads only when the tokeniser has run out of data, and
+ * hands tokens over from within the tokeniser's callback, so nothing is
+ * buffered or copied on the way.  A token's views are valid until the
+ * consumer next suspends, which is normally at its next co_await of
+ * next().
+ *
+ * A consumer may also suspend on other work between tokens.  The
+ * tokeniser is then paused (see HUBBUB_PARSER_PAUSE) until the consumer
+ * asks for the next token.  Character tokens cannot always be held back
+ * immediately, so any the tokeniser emits before it stops are copied and
+ * delivered in order once the consumer returns.
+ *
+ * Exceptions thrown by the source are rethrown from next().
+ */
+
+#if __cplusplus < 202002L
+#error "hubbub/coroutine.hpp requires C++20"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <hubbub/token.hpp>
+
+namespace hubbub {
+
+template <typename Source>
+class token_stream {
+	class pump;
+
+public:
+	token_stream()
+		: source_(nullptr), parser_(nullptr), arena_(nullptr),
+		  error_(HUBBUB_OK), delivered_(0), queued_(false),
+		  parked_(true), paused_(false), eof_(false), done_(false),
+		  in_callback_(false)
+	{
+	}
+
+	~token_stream()
+	{
+		destroy();
+	}
+
+	/**
+	 * Create the underlying parser and attach it to a source
+	 *
+	 * \param source   Byte source; must outlive the stream
+	 * \param enc      Source document encoding, or NULL to autodetect
+	 * \param fix_enc  Permit fixing up of encoding if it's frequently
+	 *                 misused
+	 * \param alloc    Memory (de)allocation function
+	 * \param pw       Pointer to client-specific private data
+	 * \return HUBBUB_OK on success, appropriate error otherwise.
+	 */
+	hubbub_error create(Source &source, const char *enc = NULL,
+			bool fix_enc = false,
+			hubbub_allocator_fn alloc = allocator, void *pw = NULL)
+	{
+		hubbub_parser_optparams params;
+		hubbub_error error;
+
+		destroy();
+
+		error = token_arena::create(alloc, pw, &arena_);
+		if (error != HUBBUB_OK)
+			return error;
+
+		error = hubbub_parser_create(enc, fix_enc, alloc, pw,
+				&parser_);
+		if (error != HUBBUB_OK) {
+			parser_ = nullptr;
+			destroy();
+			return error;
+		}
+
+		params.token_handler.handler = handle_token;
+		params.token_handler.pw = this;
+		error = hubbub_parser_setopt(parser_,
+				HUBBUB_PARSER_TOKEN_HANDLER, &params);
+		if (error != HUBBUB_OK) {
+			destroy();
+			return error;
+		}
+
+		source_ = &source;
+		pump_ = run().handle();
+
+		return HUBBUB_OK;
+	}
+
+	/**
+	 * Destroy the underlying parser, if any
+	 *
+	 * Must not be called while the stream is running, i.e. from the
+	 * consumer while it holds a token.
+	 */
+	void destroy()
+	{
+		if (pump_) {
+			pump_.destroy();
+			pump_ = nullptr;
+		}
+
+		if (parser_ != nullptr) {
+			hubbub_parser_destroy(parser_);
+			parser_ = nullptr;
+		}
+
+		if (arena_ != nullptr) {
+			token_arena::destroy(arena_);
+			arena_ = nullptr;
+		}
+
+		source_ = nullptr;
+		waiting_ = nullptr;
+		exception_ = nullptr;
+		current_.reset();
+		queue_.clear();
+		error_ = HUBBUB_OK;
+		delivered_ = 0;
+		queued_ = false;
+		parked_ = true;
+		paused_ = false;
+		eof_ = false;
+		done_ = false;
+		in_callback_ = false;
+	}
+
+	/**
+	 * Await the next token
+	 *
+	 * The awaited result is the next token, or NULL once the input is
+	 * exhausted or parsing has failed (see error()).
+	 */
+	auto next()
+	{
+		struct awaiter {
+			token_stream *stream;
+
+			bool await_ready()
+			{
+				return stream->take_ready();
+			}
+
+			std::coroutine_handle<> await_suspend(
+					std::coroutine_handle<> consumer)
+			{
+				return stream->wait(consumer);
+			}
+
+			const token_view *await_resume()
+			{
+				return stream->result();
+			}
+		};
+
+		return awaiter{this};
+	}
+
+	/**
+	 * Retrieve the reason the stream ended early
+	 *
+	 * \return HUBBUB_OK if the stream has not failed, or the error
+	 *         which ended it
+	 */
+	hubbub_error error() const
+	{
+		return error_;
+	}
+
+	/** The underlying parser, for the rest of the C API */
+	hubbub_parser *get() const
+	{
+		return parser_;
+	}
+
+private:
+	token_stream(const token_stream &);
+	token_stream &operator=(const token_stream &);
+
+	/**
+	 * Coroutine driving the parser
+	 *
+	 * It starts suspended, and is resumed by a consumer waiting for a
+	 * token or by the source once data is available.
+	 */
+	class pump {
+	public:
+		struct promise_type {
+			explicit promise_type(token_stream &stream)
+				: stream(&stream)
+			{
+			}
+
+			pump get_return_object()
+			{
+				return pump(std::coroutine_handle<
+						promise_type>::from_promise(
+						*this));
+			}
+
+			std::suspend_always initial_suspend() noexcept
+			{
+				return {};
+			}
+
+			auto final_suspend() noexcept
+			{
+				struct final_awaiter {
+					bool await_ready() noexcept
+					{
+						return false;
+					}
+
+					std::coroutine_handle<> await_suspend(
+						std::coroutine_handle<
+							promise_type> h)
+							noexcept
+					{
+						return h.promise().stream->
+								finish();
+					}
+
+					void await_resume() noexcept
+					{
+					}
+				};
+
+				return final_awaiter{};
+			}
+
+			void return_void()
+			{
+			}
+
+			void unhandled_exception()
+			{
+				stream->exception_ = std::current_exception();
+			}
+
+			token_stream *stream;
+		};
+
+		pump() = default;
+		explicit pump(std::coroutine_handle<promise_type> h)
+			: h_(h)
+		{
+		}
+
+		std::coroutine_handle<> handle() const { return h_; }
+
+	private:
+		std::coroutine_handle<promise_type> h_;
+	};
+
+	/**
+	 * Awaitable suspending the pump until the consumer wants a token
+	 */
+	struct park {
+		token_stream *stream;
+
+		bool await_ready()
+		{
+			return false;
+		}
+
+		void await_suspend(std::coroutine_handle<>)
+		{
+			stream->parked_ = true;
+		}
+
+		void await_resume()
+		{
+		}
+	};
+
+	/**
+	 * Body of the pump
+	 */
+	pump run()
+	{
+		for (;;) {
+			hubbub_error error;
+
+			if (paused_) {
+				hubbub_parser_optparams params;
+
+				paused_ = false;
+				params.pause_parse = false;
+				error = hubbub_parser_setopt(parser_,
+						HUBBUB_PARSER_PAUSE, &params);
+			} else {
+				std::span<const uint8_t> data =
+						co_await source_->read();
+
+				if (data.empty()) {
+					eof_ = true;
+					error = hubbub_parser_completed(
+							parser_);
+				} else {
+					error = hubbub_parser_parse_chunk(
+							parser_, data.data(),
+							data.size());
+				}
+			}
+
+			if (error == HUBBUB_PAUSED) {
+				/* The consumer was busy elsewhere.  It may
+				 * have asked for more while we awaited the
+				 * source, in which case carry on at once */
+				paused_ = true;
+				if (!waiting_)
+					co_await park{this};
+				continue;
+			}
+
+			if (error != HUBBUB_OK) {
+				error_ = error;
+				co_return;
+			}
+
+			/* The tokeniser has consumed all its input */
+			if (eof_)
+				co_return;
+		}
+	}
+
+	/**
+	 * Tokeniser callback: hand the token to the consumer, if waiting
+	 */
+	static hubbub_error handle_token(const hubbub_token *token, void *pw)
+	{
+		token_stream *self = static_cast<token_stream *>(pw);
+
+		if (self->waiting_) {
+			std::coroutine_handle<> consumer = self->waiting_;
+
+			self->waiting_ = nullptr;
+			self->current_.emplace(*token);
+
+			self->in_callback_ = true;
+			consumer.resume();
+			self->in_callback_ = false;
+
+			/* If the consumer suspended anywhere but in next(),
+			 * hold the tokeniser until it asks again */
+			return self->waiting_ ? HUBBUB_OK : HUBBUB_PAUSED;
+		} else {
+			hubbub_token copy = *token;
+			hubbub_error error = self->arena_->copy(copy);
+			if (error != HUBBUB_OK)
+				return error;
+
+			self->queue_.push_back(copy);
+
+			return HUBBUB_PAUSED;
+		}
+	}
+
+	/**
+	 * Start waiting for a token, taking a queued one if available
+	 *
+	 * \return true if the token is available without suspending
+	 */
+	bool take_ready()
+	{
+		current_.reset();
+
+		if (queued_) {
+			queued_ = false;
+			if (++delivered_ == queue_.size()) {
+				queue_.clear();
+				delivered_ = 0;
+				arena_->reset();
+			}
+		}
+
+		if (delivered_ < queue_.size()) {
+			current_.emplace(queue_[delivered_]);
+			queued_ = true;
+			return true;
+		}
+
+		return done_;
+	}
+
+	/**
+	 * Suspend the consumer until a token is available
+	 *
+	 * \param consumer  Consumer awaiting next()
+	 * \return Coroutine to resume in its place
+	 */
+	std::coroutine_handle<> wait(std::coroutine_handle<> consumer)
+	{
+		waiting_ = consumer;
+
+		/* Called from within handle_token(): return to it */
+		if (in_callback_)
+			return std::noop_coroutine();
+
+		/* Otherwise run the pump, unless it awaits the source */
+		if (parked_) {
+			parked_ = false;
+			return pump_;
+		}
+
+		return std::noop_coroutine();
+	}
+
+	/**
+	 * Result of next()
+	 */
+	const token_view *result()
+	{
+		if (exception_) {
+			std::exception_ptr e = exception_;
+			exception_ = nullptr;
+			std::rethrow_exception(e);
+		}
+
+		return current_ ? &*current_ : nullptr;
+	}
+
+	/**
+	 * Complete the stream, releasing any waiting consumer
+	 *
+	 * \return Coroutine to resume in place of the pump
+	 */
+	std::coroutine_handle<> finish()
+	{
+		done_ = true;
+
+		if (waiting_) {
+			std::coroutine_handle<> consumer = waiting_;
+
+			waiting_ = nullptr;
+			current_.reset();
+
+			return consumer;
+		}
+
+		return std::noop_coroutine();
+	}
+
+	Source *source_;			/**< Byte source */
+	hubbub_parser *parser_;			/**< Underlying parser */
+	token_arena *arena_;			/**< Storage for queued tokens */
+	std::coroutine_handle<> pump_;		/**< Parser driver */
+	std::coroutine_handle<> waiting_;	/**< Consumer awaiting next() */
+	std::exception_ptr exception_;		/**< Exception from the pump */
+	std::optional<token_view> current_;	/**< Token for the consumer */
+	std::vector<hubbub_token> queue_;	/**< Tokens emitted while the
+						 * consumer was busy */
+	hubbub_error error_;			/**< Reason for ending early */
+	size_t delivered_;			/**< Queued tokens handed out */
+	bool queued_;		/**< Whether current_ is from queue_ */
+	bool parked_;		/**< Whether the pump awaits the consumer */
+	bool paused_;		/**< Whether the tokeniser is paused */
+	bool eof_;		/**< Whether the source is exhausted */
+	bool done_;		/**< Whether the pump has finished */
+	bool in_callback_;	/**< Whether the consumer runs in
+				 * handle_token() */
+};
+
+}
+
+#endif
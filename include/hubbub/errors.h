@@ -20,6 +20,7 @@ typedef enum hubbub_error {
 	HUBBUB_REPROCESS	= 1,
 	HUBBUB_ENCODINGCHANGE	= 2,
 	HUBBUB_PAUSED		= 3, /**< tokenisation is paused */
+	HUBBUB_STOPPED		= 4, /**< stop condition has been met */
 
 	HUBBUB_NOMEM            = 5,
 	HUBBUB_BADPARM          = 6,
@@ -52,6 +52,28 @@ typedef hubbub_error (*hubbub_token_handler)(
 typedef void (*hubbub_error_handler)(uint32_t line, uint32_t col,
 		const char *message, void *pw);
 
+/**
+ * Type of node mapping function, used when cloning a parser
+ *
+ * \param node   Node referenced by the parser being cloned
+ * \param pw     Pointer to client data
+ * \param clone  Pointer to location to receive the counterpart of ::node in
+ *               the clone's tree, which must be referenced on its behalf
+ * \return HUBBUB_OK on success, appropriate error otherwise.
+ */
+typedef hubbub_error (*hubbub_clone_handler)(void *node, void *pw,
+		void **clone);
+
+/**
+ * Type of visible text handling function
+ *
+ * \param text  Run of visible text, valid only for the duration of the call
+ * \param pw    Pointer to client data
+ * \return HUBBUB_OK on success, appropriate error otherwise.
+ */
+typedef hubbub_error (*hubbub_text_handler)(const hubbub_string *text,
+		void *pw);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,452 @@
+/*
+ * This file is part of Hubbub.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 The NetSurf Browser Project
+ */
+
+#ifndef hubbub_hubbub_hpp_
+#define hubbub_hubbub_hpp_
+
+/**
+ * \file
+ * Header-only C++ front end
+ *
+ * A tree is any class providing the tree handler operations as member
+ * functions over its own node pointer type, e.g.
+ *
+ *   struct my_tree : hubbub::tree_base<my_node *> {
+ *       hubbub_error create_element(const hubbub_tag &tag,
+ *               my_node *&result);
+ *       ...
+ *   };
+ *
+ *   hubbub::parser<my_tree> parser;
+ *   if (parser.create(tree, document, "UTF-8") != HUBBUB_OK) ...
+ *
+ * hubbub::parser<Tree> fills in a hubbub_tree_handler whose entries are
+ * instantiated for Tree, and converts the tree builder's void * arguments
+ * to Tree's node type. This saves writing that glue by hand; it does not
+ * make tree building faster. The tree builder is C, and still makes one
+ * indirect call through the handler for each tree operation, just as it
+ * does for C clients.
+ *
+ * Errors are reported as hubbub_error, as in the C API; nothing in this
+ * file throws.
+ */
+
+#include <cstdlib>
+#if __cplusplus >= 202002L
+#include <concepts>
+#endif
+
+#include <hubbub/hubbub.h>
+#include <hubbub/parser.h>
+#include <hubbub/tree.h>
+
+namespace hubbub {
+
+/**
+ * Defaults for the optional tree operations
+ *
+ * Trees without reference counting, forms, quirks handling or scripts
+ * may derive from this rather than implement those operations.
+ */
+template <typename Node>
+class tree_base {
+public:
+	typedef Node node_type;
+
+	hubbub_error ref_node(Node node)
+	{
+		(void) node;
+		return HUBBUB_OK;
+	}
+
+	hubbub_error unref_node(Node node)
+	{
+		(void) node;
+		return HUBBUB_OK;
+	}
+
+	hubbub_error form_associate(Node form, Node node)
+	{
+		(void) form;
+		(void) node;
+		return HUBBUB_OK;
+	}
+
+	hubbub_error set_quirks_mode(hubbub_quirks_mode mode)
+	{
+		(void) mode;
+		return HUBBUB_OK;
+	}
+
+	hubbub_error encoding_change(const char *encname)
+	{
+		(void) encname;
+		return HUBBUB_OK;
+	}
+
+	hubbub_error complete_script(Node script)
+	{
+		(void) script;
+		return HUBBUB_OK;
+	}
+};
+
+#if __cplusplus >= 202002L
+/**
+ * Requirements on a tree policy
+ */
+template <typename Tree>
+concept tree_policy = requires(Tree &t, typename Tree::node_type n,
+		typename Tree::node_type &r, bool &b,
+		const hubbub_string &s, const hubbub_doctype &d,
+		const hubbub_tag &tag, const hubbub_attribute *a) {
+	{ t.create_comment(s, r) } -> std::same_as<hubbub_error>;
+	{ t.create_doctype(d, r) } -> std::same_as<hubbub_error>;
+	{ t.create_element(tag, r) } -> std::same_as<hubbub_error>;
+	{ t.create_text(s, r) } -> std::same_as<hubbub_error>;
+	{ t.ref_node(n) } -> std::same_as<hubbub_error>;
+	{ t.unref_node(n) } -> std::same_as<hubbub_error>;
+	{ t.append_child(n, n, r) } -> std::same_as<hubbub_error>;
+	{ t.insert_before(n, n, n, r) } -> std::same_as<hubbub_error>;
+	{ t.remove_child(n, n, r) } -> std::same_as<hubbub_error>;
+	{ t.clone_node(n, true, r) } -> std::same_as<hubbub_error>;
+	{ t.reparent_children(n, n) } -> std::same_as<hubbub_error>;
+	{ t.get_parent(n, true, r) } -> std::same_as<hubbub_error>;
+	{ t.has_children(n, b) } -> std::same_as<hubbub_error>;
+	{ t.form_associate(n, n) } -> std::same_as<hubbub_error>;
+	{ t.add_attributes(n, a, 0u) } -> std::same_as<hubbub_error>;
+	{ t.set_quirks_mode(HUBBUB_QUIRKS_MODE_NONE) } ->
+			std::same_as<hubbub_error>;
+	{ t.encoding_change("") } -> std::same_as<hubbub_error>;
+	{ t.complete_script(n) } -> std::same_as<hubbub_error>;
+};
+#define HUBBUB_TREE_POLICY tree_policy
+#else
+#define HUBBUB_TREE_POLICY typename
+#endif
+
+/**
+ * Tree handler entries for a given tree policy
+ *
+ * Each entry recovers the tree and its nodes from the C handler's
+ * untyped arguments and calls the corresponding member function.
+ */
+template <typename Tree>
+struct tree_handler {
+	typedef typename Tree::node_type node;
+
+	static Tree *tree(void *ctx)
+	{
+		return static_cast<Tree *>(ctx);
+	}
+
+	static node cast(void *n)
+	{
+		return static_cast<node>(n);
+	}
+
+	static hubbub_error create_comment(void *ctx,
+			const hubbub_string *data, void **result)
+	{
+		node r = node();
+		hubbub_error err = tree(ctx)->create_comment(*data, r);
+		*result = r;
+		return err;
+	}
+
+	static hubbub_error create_doctype(void *ctx,
+			const hubbub_doctype *doctype, void **result)
+	{
+		node r = node();
+		hubbub_error err = tree(ctx)->create_doctype(*doctype, r);
+		*result = r;
+		return err;
+	}
+
+	static hubbub_error create_element(void *ctx,
+			const hubbub_tag *tag, void **result)
+	{
+		node r = node();
+		hubbub_error err = tree(ctx)->create_element(*tag, r);
+		*result = r;
+		return err;
+	}
+
+	static hubbub_error create_text(void *ctx,
+			const hubbub_string *data, void **result)
+	{
+		node r = node();
+		hubbub_error err = tree(ctx)->create_text(*data, r);
+		*result = r;
+		return err;
+	}
+
+	static hubbub_error ref_node(void *ctx, void *n)
+	{
+		return tree(ctx)->ref_node(cast(n));
+	}
+
+	static hubbub_error unref_node(void *ctx, void *n)
+	{
+		return tree(ctx)->unref_node(cast(n));
+	}
+
+	static hubbub_error append_child(void *ctx, void *parent,
+			void *child, void **result)
+	{
+		node r = node();
+		hubbub_error err = tree(ctx)->append_child(cast(parent),
+				cast(child), r);
+		*result = r;
+		return err;
+	}
+
+	static hubbub_error insert_before(void *ctx, void *parent,
+			void *child, void *ref_child, void **result)
+	{
+		node r = node();
+		hubbub_error err = tree(ctx)->insert_before(cast(parent),
+				cast(child), cast(ref_child), r);
+		*result = r;
+		return err;
+	}
+
+	static hubbub_error remove_child(void *ctx, void *parent,
+			void *child, void **result)
+	{
+		node r = node();
+		hubbub_error err = tree(ctx)->remove_child(cast(parent),
+				cast(child), r);
+		*result = r;
+		return err;
+	}
+
+	static hubbub_error clone_node(void *ctx, void *n, bool deep,
+			void **result)
+	{
+		node r = node();
+		hubbub_error err = tree(ctx)->clone_node(cast(n), deep, r);
+		*result = r;
+		return err;
+	}
+
+	static hubbub_error reparent_children(void *ctx, void *n,
+			void *new_parent)
+	{
+		return tree(ctx)->reparent_children(cast(n),
+				cast(new_parent));
+	}
+
+	static hubbub_error get_parent(void *ctx, void *n,
+			bool element_only, void **result)
+	{
+		node r = node();
+		hubbub_error err = tree(ctx)->get_parent(cast(n),
+				element_only, r);
+		*result = r;
+		return err;
+	}
+
+	static hubbub_error has_children(void *ctx, void *n, bool *result)
+	{
+		return tree(ctx)->has_children(cast(n), *result);
+	}
+
+	static hubbub_error form_associate(void *ctx, void *form, void *n)
+	{
+		return tree(ctx)->form_associate(cast(form), cast(n));
+	}
+
+	static hubbub_error add_attributes(void *ctx, void *n,
+			const hubbub_attribute *attributes,
+			uint32_t n_attributes)
+	{
+		return tree(ctx)->add_attributes(cast(n), attributes,
+				n_attributes);
+	}
+
+	static hubbub_error set_quirks_mode(void *ctx,
+			hubbub_quirks_mode mode)
+	{
+		return tree(ctx)->set_quirks_mode(mode);
+	}
+
+	static hubbub_error encoding_change(void *ctx, const char *encname)
+	{
+		return tree(ctx)->encoding_change(encname);
+	}
+
+	static hubbub_error complete_script(void *ctx, void *script)
+	{
+		return tree(ctx)->complete_script(cast(script));
+	}
+
+	/**
+	 * Fill in a C tree handler for the given tree
+	 *
+	 * \param t        Tree to direct callbacks to
+	 * \param handler  Handler to fill in
+	 */
+	static void bind(Tree &t, hubbub_tree_handler &handler)
+	{
+		handler.create_comment = create_comment;
+		handler.create_doctype = create_doctype;
+		handler.create_element = create_element;
+		handler.create_text = create_text;
+		handler.ref_node = ref_node;
+		handler.unref_node = unref_node;
+		handler.append_child = append_child;
+		handler.insert_before = insert_before;
+		handler.remove_child = remove_child;
+		handler.clone_node = clone_node;
+		handler.reparent_children = reparent_children;
+		handler.get_parent = get_parent;
+		handler.has_children = has_children;
+		handler.form_associate = form_associate;
+		handler.add_attributes = add_attributes;
+		handler.set_quirks_mode = set_quirks_mode;
+		handler.encoding_change = encoding_change;
+		handler.complete_script = complete_script;
+		handler.ctx = &t;
+	}
+};
+
+/**
+ * Default allocator, on top of the C library
+ */
+inline void *allocator(void *ptr, size_t size, void *pw)
+{
+	(void) pw;
+
+	if (size == 0) {
+		std::free(ptr);
+		return NULL;
+	}
+
+	return std::realloc(ptr, size);
+}
+
+/**
+ * Parser building a tree through the policy class Tree
+ *
+ * The parser refers to its tree handler by address, so instances can
+ * be neither copied nor moved.
+ */
+template <HUBBUB_TREE_POLICY Tree>
+class parser {
+public:
+	typedef typename Tree::node_type node_type;
+
+	parser() : parser_(NULL)
+	{
+	}
+
+	~parser()
+	{
+		destroy();
+	}
+
+	/**
+	 * Create the underlying parser and attach it to a tree
+	 *
+	 * \param tree      Tree to build into; must outlive the parser
+	 * \param document  Document node of tree
+	 * \param enc       Source document encoding, or NULL to autodetect
+	 * \param fix_enc   Permit fixing up of encoding if it's frequently misused
+	 * \param alloc     Memory (de)allocation function
+	 * \param pw        Pointer to client-specific private data
+	 * \return HUBBUB_OK on success, appropriate error otherwise.
+	 *
+	 * Any parser previously created by this object is destroyed first.
+	 */
+	hubbub_error create(Tree &tree, node_type document,
+			const char *enc = NULL, bool fix_enc = false,
+			hubbub_allocator_fn alloc = allocator, void *pw = NULL)
+	{
+		hubbub_parser_optparams params;
+		hubbub_error error;
+
+		destroy();
+
+		error = hubbub_parser_create(enc, fix_enc, alloc, pw,
+				&parser_);
+		if (error != HUBBUB_OK)
+			return error;
+
+		tree_handler<Tree>::bind(tree, handler_);
+
+		params.tree_handler = &handler_;
+		error = hubbub_parser_setopt(parser_,
+				HUBBUB_PARSER_TREE_HANDLER, &params);
+		if (error == HUBBUB_OK) {
+			params.document_node = document;
+			error = hubbub_parser_setopt(parser_,
+					HUBBUB_PARSER_DOCUMENT_NODE, &params);
+		}
+
+		if (error != HUBBUB_OK)
+			destroy();
+
+		return error;
+	}
+
+	/**
+	 * Destroy the underlying parser, if any
+	 */
+	void destroy()
+	{
+		if (parser_ != NULL) {
+			hubbub_parser_destroy(parser_);
+			parser_ = NULL;
+		}
+	}
+
+	hubbub_error setopt(hubbub_parser_opttype type,
+			hubbub_parser_optparams &params)
+	{
+		return hubbub_parser_setopt(parser_, type, &params);
+	}
+
+	hubbub_error parse_chunk(const uint8_t *data, size_t len)
+	{
+		return hubbub_parser_parse_chunk(parser_, data, len);
+	}
+
+	hubbub_error insert_chunk(const uint8_t *data, size_t len)
+	{
+		return hubbub_parser_insert_chunk(parser_, data, len);
+	}
+
+	hubbub_error completed()
+	{
+		return hubbub_parser_completed(parser_);
+	}
+
+	const char *read_charset(hubbub_charset_source &source)
+	{
+		return hubbub_parser_read_charset(parser_, &source);
+	}
+
+	/** The underlying parser, for the rest of the C API */
+	hubbub_parser *get() const
+	{
+		return parser_;
+	}
+
+private:
+	parser(const parser &);
+	parser &operator=(const parser &);
+
+	hubbub_parser *parser_;		/**< Underlying parser */
+	hubbub_tree_handler handler_;	/**< Callbacks into the tree */
+};
+
+#undef HUBBUB_TREE_POLICY
+
+}
+
+#endif
@@ -23,6 +23,9 @@ extern "C"
 
 typedef struct hubbub_parser hubbub_parser;
 
+/* See <sys/uio.h> */
+struct iovec;
+
 /**
  * Hubbub parser option types
  */
@@ -33,7 +36,14 @@ typedef enum hubbub_parser_opttype {
 	HUBBUB_PARSER_TREE_HANDLER,
 	HUBBUB_PARSER_DOCUMENT_NODE,
 	HUBBUB_PARSER_ENABLE_SCRIPTING,
-	HUBBUB_PARSER_PAUSE
+	HUBBUB_PARSER_PAUSE,
+	HUBBUB_PARSER_STOP,
+	HUBBUB_PARSER_ATTRIBUTE_FILTER,
+	HUBBUB_PARSER_TEXT_HANDLER,
+	HUBBUB_PARSER_IGNORE_WHITESPACE,
+	HUBBUB_PARSER_RECORD_TOKENS,
+	HUBBUB_PARSER_INTERN_VALUES,
+	HUBBUB_PARSER_STREAMING
 } hubbub_parser_opttype;
 
 /**
@@ -61,11 +71,68 @@ typedef union hubbub_parser_optparams {
 	bool enable_scripting;		/**< Whether to enable scripting */
 
 	bool pause_parse;		/**< Pause parsing */
+
+	struct {
+		hubbub_stop_condition condition;
+		const char *name;	/**< HTML element, for AFTER_ELEMENT */
+		uint32_t count;		/**< Tags, for STOP_AFTER_START_TAGS */
+	} stop;				/**< Stop parsing early: once the
+					 * condition is met, parsing calls
+					 * return HUBBUB_STOPPED */
+
+	struct {
+		const char **names;	/**< Attributes to keep, or NULL */
+		const char **tags;	/**< Tags to keep them on, or NULL */
+	} attribute_filter;		/**< NULL-terminated lists of lower
+					 * case names. Other attributes are
+					 * never seen by the token handler.
+					 * Only available once a token or
+					 * text handler is set, as the tree
+					 * builder needs attributes to build
+					 * the tree. A text handler sees no
+					 * attributes; the filter applies
+					 * again once a token handler
+					 * replaces it */
+
+	struct {
+		hubbub_text_handler handler;
+		void *pw;
+	} text_handler;			/**< Visible text callback. Setting
+					 * this replaces tree construction:
+					 * no tree callbacks are made */
+
+	bool ignore_whitespace;		/**< Don't create text nodes for
+					 * whitespace that cannot be
+					 * rendered, e.g. between blocks */
+
+	bool record_tokens;		/**< Record the tokens emitted from
+					 * now on, in a compact form which
+					 * can be cached and replayed. See
+					 * hubbub_parser_read_recording() */
+
+	bool intern_values;		/**< Intern short attribute values:
+					 * equal values are given the same
+					 * nonzero value_id, and point at
+					 * one copy which remains valid
+					 * until the parser is destroyed */
+
+	bool streaming;			/**< Discard input as soon as it
+					 * has been tokenised, so that
+					 * memory use doesn't grow with
+					 * the length of the input. See
+					 * hubbub_parser_read_offset() */
 } hubbub_parser_optparams;
 
 /* Create a hubbub parser */
 hubbub_error hubbub_parser_create(const char *enc, bool fix_enc,
 		hubbub_allocator_fn alloc, void *pw, hubbub_parser **parser);
+/* Create a hubbub parser for a fragment, given its context element */
+hubbub_error hubbub_parser_create_fragment(hubbub_ns context_ns,
+		const char *context_name, const char *enc, bool fix_enc,
+		hubbub_allocator_fn alloc, void *pw, hubbub_parser **parser);
+/* Clone a hubbub parser, mapping referenced nodes through handler */
+hubbub_error hubbub_parser_clone(hubbub_parser *parser,
+		hubbub_clone_handler handler, void *pw, hubbub_parser **clone);
 /* Destroy a hubbub parser */
 hubbub_error hubbub_parser_destroy(hubbub_parser *parser);
 
@@ -78,6 +145,10 @@ hubbub_error hubbub_parser_setopt(hubbub_parser *parser,
 /* This data is encoded in the input charset */
 hubbub_error hubbub_parser_parse_chunk(hubbub_parser *parser,
 		const uint8_t *data, size_t len);
+/* Pass a chain of buffers to a hubbub parser for parsing */
+/* This data is encoded in the input charset */
+hubbub_error hubbub_parser_parse_iov(hubbub_parser *parser,
+		const struct iovec *iov, int cnt);
 
 /**
  * Insert a chunk of data into a hubbub parser input stream
@@ -98,10 +169,21 @@ hubbub_error hubbub_parser_insert_chunk(hubbub_parser *parser,
 /* Inform the parser that the last chunk of data has been parsed */
 hubbub_error hubbub_parser_completed(hubbub_parser *parser);
 
+/* Read the tokens recorded so far */
+hubbub_error hubbub_parser_read_recording(hubbub_parser *parser,
+		const uint8_t **data, size_t *len);
+/* Replay recorded tokens, instead of parsing a document */
+hubbub_error hubbub_parser_replay(hubbub_parser *parser,
+		const uint8_t *data, size_t len);
+
 /* Read the document charset */
 const char *hubbub_parser_read_charset(hubbub_parser *parser,
 		hubbub_charset_source *source);
 
+/* Read the amount of input consumed */
+hubbub_error hubbub_parser_read_offset(hubbub_parser *parser,
+		uint64_t *offset);
+
 #ifdef __cplusplus
 }
 #endif
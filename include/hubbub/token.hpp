@@ -0,0 +1,662 @@
+/*
+ * This file is part of Hubbub.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 The NetSurf Browser Project
+ */
+
+#ifndef hubbub_token_hpp_
+#define hubbub_token_hpp_
+
+/**
+ * \file
+ * C++ views of tokens
+ *
+ * The views wrap the tokeniser's pointer/length pairs without copying:
+ * names and values are std::string_view, attributes are a random access
+ * range of attribute_view (or, from C++20, a std::span of
+ * hubbub_attribute).
+ *
+ * Lifetimes: the data behind a view is the tokeniser's, and is only
+ * valid for the duration of the callback which received it.  A
+ * token_parser created in stable mode instead copies each token into
+ * storage of its own, in bulk, so the views it hands out remain valid
+ * until the next call to parse_chunk() or completed(), or until the
+ * token_parser is destroyed.  Consumers may then keep the views
+ * themselves rather than copying what they refer to.
+ */
+
+#if __cplusplus < 201703L
+#error "hubbub/token.hpp requires C++17"
+#endif
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <string_view>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+#include <hubbub/hubbub.hpp>
+
+namespace hubbub {
+
+/**
+ * View a tokeniser string
+ */
+inline std::string_view view(const hubbub_string &str)
+{
+	return std::string_view(reinterpret_cast<const char *>(str.ptr),
+			str.len);
+}
+
+/**
+ * View of a tag attribute
+ */
+class attribute_view {
+public:
+	explicit attribute_view(const hubbub_attribute &attr) : attr_(&attr)
+	{
+	}
+
+	hubbub_ns ns() const { return attr_->ns; }
+	std::string_view name() const { return view(attr_->name); }
+	std::string_view value() const { return view(attr_->value); }
+	/** ID of the interned value, or 0 (see HUBBUB_PARSER_INTERN_VALUES) */
+	uint32_t value_id() const { return attr_->value_id; }
+
+	const hubbub_attribute &raw() const { return *attr_; }
+
+private:
+	const hubbub_attribute *attr_;
+};
+
+/**
+ * View of a tag's attributes
+ */
+class attributes_view {
+public:
+	class iterator {
+	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef attribute_view value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const attribute_view *pointer;
+		typedef attribute_view reference;
+
+		iterator() : attr_(NULL) {}
+		explicit iterator(const hubbub_attribute *attr) : attr_(attr)
+		{
+		}
+
+		attribute_view operator*() const
+		{
+			return attribute_view(*attr_);
+		}
+
+		attribute_view operator[](difference_type n) const
+		{
+			return attribute_view(attr_[n]);
+		}
+
+		iterator &operator++() { ++attr_; return *this; }
+		iterator operator++(int) { return iterator(attr_++); }
+		iterator &operator--() { --attr_; return *this; }
+		iterator operator--(int) { return iterator(attr_--); }
+		iterator &operator+=(difference_type n)
+		{
+			attr_ += n;
+			return *this;
+		}
+		iterator &operator-=(difference_type n)
+		{
+			attr_ -= n;
+			return *this;
+		}
+		iterator operator+(difference_type n) const
+		{
+			return iterator(attr_ + n);
+		}
+		iterator operator-(difference_type n) const
+		{
+			return iterator(attr_ - n);
+		}
+		difference_type operator-(const iterator &other) const
+		{
+			return attr_ - other.attr_;
+		}
+
+		bool operator==(const iterator &o) const
+		{
+			return attr_ == o.attr_;
+		}
+		bool operator!=(const iterator &o) const
+		{
+			return attr_ != o.attr_;
+		}
+		bool operator<(const iterator &o) const
+		{
+			return attr_ < o.attr_;
+		}
+		bool operator>(const iterator &o) const
+		{
+			return attr_ > o.attr_;
+		}
+		bool operator<=(const iterator &o) const
+		{
+			return attr_ <= o.attr_;
+		}
+		bool operator>=(const iterator &o) const
+		{
+			return attr_ >= o.attr_;
+		}
+
+	private:
+		const hubbub_attribute *attr_;
+	};
+
+	attributes_view() : attrs_(NULL), n_attrs_(0) {}
+	attributes_view(const hubbub_attribute *attrs, uint32_t n_attrs)
+		: attrs_(attrs), n_attrs_(n_attrs)
+	{
+	}
+
+	size_t size() const { return n_attrs_; }
+	bool empty() const { return n_attrs_ == 0; }
+
+	attribute_view operator[](size_t i) const
+	{
+		return attribute_view(attrs_[i]);
+	}
+
+	iterator begin() const { return iterator(attrs_); }
+	iterator end() const { return iterator(attrs_ + n_attrs_); }
+
+#if __cplusplus >= 202002L
+	std::span<const hubbub_attribute> span() const
+	{
+		return std::span<const hubbub_attribute>(attrs_, n_attrs_);
+	}
+#endif
+
+private:
+	const hubbub_attribute *attrs_;
+	uint32_t n_attrs_;
+};
+
+/**
+ * View of a start or end tag
+ */
+class tag_view {
+public:
+	explicit tag_view(const hubbub_tag &tag) : tag_(tag) {}
+
+	hubbub_ns ns() const { return tag_.ns; }
+	std::string_view name() const { return view(tag_.name); }
+	bool self_closing() const { return tag_.self_closing; }
+
+	attributes_view attributes() const
+	{
+		return attributes_view(tag_.attributes, tag_.n_attributes);
+	}
+
+	const hubbub_tag &raw() const { return tag_; }
+
+private:
+	hubbub_tag tag_;
+};
+
+/**
+ * View of a doctype
+ */
+class doctype_view {
+public:
+	explicit doctype_view(const hubbub_doctype &doctype)
+		: doctype_(doctype)
+	{
+	}
+
+	std::string_view name() const { return view(doctype_.name); }
+	bool public_missing() const { return doctype_.public_missing; }
+	std::string_view public_id() const
+	{
+		return view(doctype_.public_id);
+	}
+	bool system_missing() const { return doctype_.system_missing; }
+	std::string_view system_id() const
+	{
+		return view(doctype_.system_id);
+	}
+	bool force_quirks() const { return doctype_.force_quirks; }
+
+	const hubbub_doctype &raw() const { return doctype_; }
+
+private:
+	hubbub_doctype doctype_;
+};
+
+/**
+ * View of a token
+ *
+ * Tokens, tags and doctypes hold their fixed part by value, so the views
+ * may themselves be kept for as long as the data they refer to.
+ */
+class token_view {
+public:
+	explicit token_view(const hubbub_token &token) : token_(token) {}
+
+	hubbub_token_type type() const { return token_.type; }
+
+	/** Only for HUBBUB_TOKEN_START_TAG and HUBBUB_TOKEN_END_TAG */
+	tag_view tag() const { return tag_view(token_.data.tag); }
+
+	/** Only for HUBBUB_TOKEN_DOCTYPE */
+	doctype_view doctype() const
+	{
+		return doctype_view(token_.data.doctype);
+	}
+
+	/** Only for HUBBUB_TOKEN_COMMENT */
+	std::string_view comment() const
+	{
+		return view(token_.data.comment);
+	}
+
+	/** Only for HUBBUB_TOKEN_CHARACTER */
+	std::string_view characters() const
+	{
+		return view(token_.data.character);
+	}
+
+	const hubbub_token &raw() const { return token_; }
+
+private:
+	hubbub_token token_;
+};
+
+/**
+ * Bump allocator for stable token data
+ *
+ * Blocks are kept across resets, so a document parsed in similarly sized
+ * chunks settles into a fixed set of blocks.
+ */
+class token_arena {
+public:
+	token_arena(hubbub_allocator_fn alloc, void *pw)
+		: alloc_(alloc), pw_(pw), head_(NULL), current_(NULL)
+	{
+	}
+
+	~token_arena()
+	{
+		while (head_ != NULL) {
+			block *next = head_->next;
+			alloc_(head_, 0, pw_);
+			head_ = next;
+		}
+	}
+
+	/**
+	 * Create an arena, using the client's allocator
+	 *
+	 * \param alloc   Memory (de)allocation function
+	 * \param pw      Pointer to client-specific private data
+	 * \param arena   Pointer to location to receive arena
+	 * \return HUBBUB_OK on success, HUBBUB_NOMEM on memory exhaustion
+	 */
+	static hubbub_error create(hubbub_allocator_fn alloc, void *pw,
+			token_arena **arena)
+	{
+		void *mem = alloc(NULL, sizeof(token_arena), pw);
+		if (mem == NULL)
+			return HUBBUB_NOMEM;
+
+		*arena = new (mem) token_arena(alloc, pw);
+
+		return HUBBUB_OK;
+	}
+
+	/**
+	 * Destroy an arena made by create()
+	 */
+	static void destroy(token_arena *arena)
+	{
+		hubbub_allocator_fn alloc = arena->alloc_;
+		void *pw = arena->pw_;
+
+		arena->~token_arena();
+		alloc(arena, 0, pw);
+	}
+
+	/**
+	 * Make all storage available again
+	 */
+	void reset()
+	{
+		for (block *b = head_; b != NULL; b = b->next)
+			b->used = 0;
+		current_ = head_;
+	}
+
+	/**
+	 * Allocate storage, aligned for any token data
+	 *
+	 * \param size  Number of bytes required
+	 * \return Pointer to storage, or NULL on memory exhaustion
+	 */
+	uint8_t *allocate(size_t size)
+	{
+		size = (size + ALIGN - 1) & ~(ALIGN - 1);
+
+		while (current_ != NULL &&
+				current_->size - current_->used < size) {
+			if (current_->next == NULL)
+				break;
+			current_ = current_->next;
+		}
+
+		if (current_ == NULL || current_->size - current_->used < size) {
+			size_t bsize = size > BLOCK_SIZE ? size : BLOCK_SIZE;
+			block *b = static_cast<block *>(alloc_(NULL,
+					sizeof(block) + bsize, pw_));
+			if (b == NULL)
+				return NULL;
+
+			b->next = NULL;
+			b->size = bsize;
+			b->used = 0;
+
+			if (current_ == NULL)
+				head_ = b;
+			else
+				current_->next = b;
+			current_ = b;
+		}
+
+		uint8_t *ptr = reinterpret_cast<uint8_t *>(current_ + 1) +
+				current_->used;
+		current_->used += size;
+
+		return ptr;
+	}
+
+	/**
+	 * Copy a token's data into the arena, in a single allocation
+	 *
+	 * \param token  Token to update
+	 * \return HUBBUB_OK on success, HUBBUB_NOMEM on memory exhaustion
+	 */
+	hubbub_error copy(hubbub_token &token)
+	{
+		size_t size = 0;
+		uint8_t *ptr;
+
+		switch (token.type) {
+		case HUBBUB_TOKEN_DOCTYPE:
+			size = token.data.doctype.name.len +
+					token.data.doctype.public_id.len +
+					token.data.doctype.system_id.len;
+			break;
+		case HUBBUB_TOKEN_START_TAG:
+		case HUBBUB_TOKEN_END_TAG:
+			size = token.data.tag.n_attributes *
+					sizeof(hubbub_attribute) +
+					token.data.tag.name.len;
+			for (uint32_t i = 0; i < token.data.tag.n_attributes;
+					i++) {
+				size += token.data.tag.attributes[i].name.len +
+					token.data.tag.attributes[i].value.len;
+			}
+			break;
+		case HUBBUB_TOKEN_COMMENT:
+			size = token.data.comment.len;
+			break;
+		case HUBBUB_TOKEN_CHARACTER:
+			size = token.data.character.len;
+			break;
+		case HUBBUB_TOKEN_EOF:
+			break;
+		}
+
+		if (size == 0)
+			return HUBBUB_OK;
+
+		ptr = allocate(size);
+		if (ptr == NULL)
+			return HUBBUB_NOMEM;
+
+		switch (token.type) {
+		case HUBBUB_TOKEN_DOCTYPE:
+			ptr = copy_string(token.data.doctype.name, ptr);
+			ptr = copy_string(token.data.doctype.public_id, ptr);
+			copy_string(token.data.doctype.system_id, ptr);
+			break;
+		case HUBBUB_TOKEN_START_TAG:
+		case HUBBUB_TOKEN_END_TAG:
+		{
+			hubbub_tag &tag = token.data.tag;
+
+			if (tag.n_attributes > 0) {
+				hubbub_attribute *attrs =
+					reinterpret_cast<hubbub_attribute *>(
+							ptr);
+
+				std::memcpy(attrs, tag.attributes, tag.n_attributes *
+						sizeof(hubbub_attribute));
+				ptr += tag.n_attributes *
+						sizeof(hubbub_attribute);
+
+				for (uint32_t i = 0; i < tag.n_attributes;
+						i++) {
+					ptr = copy_string(attrs[i].name, ptr);
+					ptr = copy_string(attrs[i].value, ptr);
+				}
+
+				tag.attributes = attrs;
+			}
+
+			copy_string(tag.name, ptr);
+		}
+			break;
+		case HUBBUB_TOKEN_COMMENT:
+			copy_string(token.data.comment, ptr);
+			break;
+		case HUBBUB_TOKEN_CHARACTER:
+			copy_string(token.data.character, ptr);
+			break;
+		case HUBBUB_TOKEN_EOF:
+			break;
+		}
+
+		return HUBBUB_OK;
+	}
+
+private:
+	token_arena(const token_arena &);
+	token_arena &operator=(const token_arena &);
+
+	static const size_t ALIGN = alignof(std::max_align_t);
+	static const size_t BLOCK_SIZE = 64 * 1024;
+
+	struct alignas(std::max_align_t) block {
+		block *next;		/**< Next block */
+		size_t size;		/**< Usable bytes after this header */
+		size_t used;		/**< Bytes handed out */
+	};
+
+	/**
+	 * Move a string's data to the given location
+	 *
+	 * \param str  String to update
+	 * \param ptr  Location to copy to
+	 * \return Location following the copy
+	 */
+	static uint8_t *copy_string(hubbub_string &str, uint8_t *ptr)
+	{
+		if (str.len > 0)
+			std::memcpy(ptr, str.ptr, str.len);
+		str.ptr = ptr;
+
+		return ptr + str.len;
+	}
+
+	hubbub_allocator_fn alloc_;
+	void *pw_;
+	block *head_;			/**< First block */
+	block *current_;		/**< Block being allocated from */
+};
+
+/**
+ * Parser delivering token views to Handler
+ *
+ * Handler must provide
+ *
+ *   hubbub_error token(const hubbub::token_view &token);
+ *
+ * The parser refers to itself from the tokeniser's callback, so instances
+ * can be neither copied nor moved.
+ */
+template <typename Handler>
+class token_parser {
+public:
+	token_parser() : parser_(NULL), handler_(NULL), arena_(NULL) {}
+
+	~token_parser()
+	{
+		destroy();
+	}
+
+	/**
+	 * Create the underlying parser and attach it to a handler
+	 *
+	 * \param handler  Token handler; must outlive the parser
+	 * \param enc      Source document encoding, or NULL to autodetect
+	 * \param fix_enc  Permit fixing up of encoding if it's frequently
+	 *                 misused
+	 * \param stable   Whether views must remain valid until the next
+	 *                 call to parse_chunk() or completed()
+	 * \param alloc    Memory (de)allocation function
+	 * \param pw       Pointer to client-specific private data
+	 * \return HUBBUB_OK on success, appropriate error otherwise.
+	 */
+	hubbub_error create(Handler &handler, const char *enc = NULL,
+			bool fix_enc = false, bool stable = false,
+			hubbub_allocator_fn alloc = allocator, void *pw = NULL)
+	{
+		hubbub_parser_optparams params;
+		hubbub_error error;
+
+		destroy();
+
+		if (stable) {
+			error = token_arena::create(alloc, pw, &arena_);
+			if (error != HUBBUB_OK)
+				return error;
+		}
+
+		error = hubbub_parser_create(enc, fix_enc, alloc, pw,
+				&parser_);
+		if (error != HUBBUB_OK) {
+			parser_ = NULL;
+			destroy();
+			return error;
+		}
+
+		handler_ = &handler;
+
+		params.token_handler.handler = handle_token;
+		params.token_handler.pw = this;
+		error = hubbub_parser_setopt(parser_,
+				HUBBUB_PARSER_TOKEN_HANDLER, &params);
+		if (error != HUBBUB_OK)
+			destroy();
+
+		return error;
+	}
+
+	/**
+	 * Destroy the underlying parser, if any
+	 */
+	void destroy()
+	{
+		if (parser_ != NULL) {
+			hubbub_parser_destroy(parser_);
+			parser_ = NULL;
+		}
+
+		if (arena_ != NULL) {
+			token_arena::destroy(arena_);
+			arena_ = NULL;
+		}
+
+		handler_ = NULL;
+	}
+
+	hubbub_error setopt(hubbub_parser_opttype type,
+			hubbub_parser_optparams &params)
+	{
+		return hubbub_parser_setopt(parser_, type, &params);
+	}
+
+	hubbub_error parse_chunk(const uint8_t *data, size_t len)
+	{
+		if (arena_ != NULL)
+			arena_->reset();
+
+		return hubbub_parser_parse_chunk(parser_, data, len);
+	}
+
+	hubbub_error insert_chunk(const uint8_t *data, size_t len)
+	{
+		return hubbub_parser_insert_chunk(parser_, data, len);
+	}
+
+	hubbub_error completed()
+	{
+		if (arena_ != NULL)
+			arena_->reset();
+
+		return hubbub_parser_completed(parser_);
+	}
+
+	const char *read_charset(hubbub_charset_source &source)
+	{
+		return hubbub_parser_read_charset(parser_, &source);
+	}
+
+	/** The underlying parser, for the rest of the C API */
+	hubbub_parser *get() const
+	{
+		return parser_;
+	}
+
+private:
+	token_parser(const token_parser &);
+	token_parser &operator=(const token_parser &);
+
+	static hubbub_error handle_token(const hubbub_token *token, void *pw)
+	{
+		token_parser *self = static_cast<token_parser *>(pw);
+
+		if (self->arena_ != NULL) {
+			hubbub_token copy = *token;
+			hubbub_error error = self->arena_->copy(copy);
+			if (error != HUBBUB_OK)
+				return error;
+
+			return self->handler_->token(token_view(copy));
+		}
+
+		return self->handler_->token(token_view(*token));
+	}
+
+	hubbub_parser *parser_;		/**< Underlying parser */
+	Handler *handler_;		/**< Client's token handler */
+	token_arena *arena_;		/**< Storage for stable views */
+};
+
+}
+
+#endif
@@ -254,6 +254,11 @@ typedef hubbub_error (*hubbub_tree_set_quirks_mode)(void *ctx,
  *         HUBBUB_ENCODINGCHANGE to stop processing immediately and 
  *                               return control to the client,
  *         appropriate error otherwise.
+ *
+ * If all the input consumed so far is ASCII, the parser will usually have
+ * switched to the new charset already. In that case,
+ * hubbub_parser_read_charset() reports it with a source of
+ * HUBBUB_CHARSET_CONFIDENT, and there is no need to reprocess the document.
  */
 typedef hubbub_error (*hubbub_tree_encoding_change)(void *ctx, 
 		const char *encname);
@@ -292,6 +297,45 @@ typedef struct hubbub_tree_handler {
 	void *ctx;					/**< Context pointer */
 } hubbub_tree_handler;
 
+/**
+ * Recorder of tree operations
+ *
+ * A tree recorder stands in for a tree handler while a document is parsed,
+ * recording the operations the treebuilder makes.  The recording may then
+ * be replayed into any number of tree handlers, so the tree is constructed
+ * once however many representations of it are built.
+ */
+typedef struct hubbub_tree_recorder hubbub_tree_recorder;
+
+/**
+ * Tree handler into which a recording is replayed
+ */
+typedef struct hubbub_tree_target {
+	const hubbub_tree_handler *handler;	/**< Tree handler */
+	void *document_node;			/**< Its document node */
+} hubbub_tree_target;
+
+/* Create a tree recorder */
+hubbub_error hubbub_tree_recorder_create(
+		hubbub_tree_encoding_change encoding_change, void *ctx,
+		hubbub_allocator_fn alloc, void *pw,
+		hubbub_tree_recorder **recorder);
+/* Destroy a tree recorder */
+hubbub_error hubbub_tree_recorder_destroy(hubbub_tree_recorder *recorder);
+
+/* Retrieve the tree handler and document node to give to the parser */
+hubbub_error hubbub_tree_recorder_handler(hubbub_tree_recorder *recorder,
+		hubbub_tree_handler **handler, void **document_node);
+
+/* Read the operations recorded so far */
+hubbub_error hubbub_tree_recorder_read(const hubbub_tree_recorder *recorder,
+		const uint8_t **data, size_t *len);
+
+/* Replay recorded operations into one or more tree handlers */
+hubbub_error hubbub_tree_replay(const uint8_t *data, size_t len,
+		const hubbub_tree_target *targets, size_t n_targets,
+		hubbub_allocator_fn alloc, void *pw);
+
 #ifdef __cplusplus
 }
 #endif
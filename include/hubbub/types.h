@@ -36,6 +36,16 @@ typedef enum hubbub_content_model {
 	HUBBUB_CONTENT_MODEL_PLAINTEXT
 } hubbub_content_model;
 
+/**
+ * Condition on which to stop parsing early
+ */
+typedef enum hubbub_stop_condition {
+	HUBBUB_STOP_NEVER,		/**< Parse the entire document */
+	HUBBUB_STOP_AFTER_HEAD,		/**< Once the head element is closed */
+	HUBBUB_STOP_AFTER_ELEMENT,	/**< Once an HTML element is closed */
+	HUBBUB_STOP_AFTER_START_TAGS	/**< After a number of start tags */
+} hubbub_stop_condition;
+
 /**
  * Quirks mode flag
  */
@@ -85,6 +95,9 @@ typedef struct hubbub_attribute {
 	hubbub_ns ns;			/**< Attribute namespace */
 	hubbub_string name;		/**< Attribute name */
 	hubbub_string value;		/**< Attribute value */
+	uint32_t value_id;		/**< ID of the interned value, or 0 if
+					 * the value isn't interned (see
+					 * HUBBUB_PARSER_INTERN_VALUES) */
 } hubbub_attribute;
 
 /**
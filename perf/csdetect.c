@@ -0,0 +1,85 @@
+#define _GNU_SOURCE
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/fcntl.h>
+#include <sys/mman.h>
+
+#include <parserutils/charset/mibenum.h>
+
+#include <hubbub/types.h>
+
+#include "charset/detect.h"
+#include "utils/utils.h"
+
+#define ITERATIONS 10000
+
+/* Time detection of each #data section in a csdetect test file */
+int main(int argc, char **argv)
+{
+	struct stat info;
+	int fd;
+	char *file, *end, *data, *next;
+	size_t total = 0;
+	clock_t start, elapsed = 0;
+	int i, tests = 0;
+
+	if (argc != 2) {
+		printf("Usage: %s <csdetect test file>\n", argv[0]);
+		return 1;
+	}
+
+	stat(argv[1], &info);
+	fd = open(argv[1], 0);
+	file = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	end = file + info.st_size;
+
+	for (data = file; data < end; data = next) {
+		char *enc;
+		size_t len;
+		uint16_t mibenum = 0;
+		uint32_t source = 0;
+		parserutils_error error = PARSERUTILS_OK;
+
+		data = memmem(data, end - data, "#data\n", 6);
+		if (data == NULL)
+			break;
+		data += 6;
+
+		enc = memmem(data, end - data, "\n#encoding\n", 11);
+		assert(enc != NULL);
+		len = enc - data;
+		next = enc + 11;
+
+		start = clock();
+		for (i = 0; i < ITERATIONS; i++) {
+			mibenum = 0;
+			source = HUBBUB_CHARSET_UNKNOWN;
+			error = hubbub_charset_extract((const uint8_t *) data,
+					len, &mibenum, &source);
+		}
+		elapsed += clock() - start;
+
+		assert(error == PARSERUTILS_OK);
+		UNUSED(error);
+
+		total += len;
+		tests++;
+
+		printf("%d: %s\n", tests,
+				parserutils_charset_mibenum_to_name(mibenum));
+	}
+
+	printf("%d tests, %zu bytes, %.1f MB/s\n", tests, total,
+			(double) total * ITERATIONS /
+			((double) elapsed / CLOCKS_PER_SEC) / 1e6);
+
+	return 0;
+}
@@ -1,4 +1,7 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <assert.h>
 
 #include <sys/types.h>
@@ -10,13 +13,67 @@
 #include <libxml/parser.h>
 #include <libxml/tree.h>
 
-int main(int argc, char **argv)
+#include "hubbub_libxml.h"
+
+#define ITERATIONS 20
+
+static void *myrealloc(void *ptr, size_t len, void *pw)
+{
+	(void) pw;
+
+	return realloc(ptr, len);
+}
+
+static htmlDocPtr parse_libxml2(const char *file, size_t len)
 {
+	return htmlReadMemory(file, len, NULL, NULL,
+			HTML_PARSE_RECOVER | HTML_PARSE_NOERROR |
+			HTML_PARSE_NOWARNING);
+}
+
+static htmlDocPtr parse_hubbub(const char *file, size_t len)
+{
+	hubbub_libxml *binding;
+	hubbub_error error;
 	htmlDocPtr doc;
 
+	if (hubbub_libxml_create(NULL, true, myrealloc, NULL, &binding) !=
+			HUBBUB_OK)
+		return NULL;
+
+	error = hubbub_libxml_parse_chunk(binding,
+			(const uint8_t *) file, len);
+	if (error == HUBBUB_ENCODINGCHANGE)
+		error = hubbub_libxml_parse_chunk(binding,
+				(const uint8_t *) file, len);
+	if (error == HUBBUB_OK)
+		error = hubbub_libxml_completed(binding);
+
+	doc = (error == HUBBUB_OK) ?
+			hubbub_libxml_extract_document(binding) : NULL;
+
+	hubbub_libxml_destroy(binding);
+
+	return doc;
+}
+
+/* Time building a libxml2 tree with libxml2's own HTML parser, and with
+ * hubbub through bindings/libxml */
+int main(int argc, char **argv)
+{
+	static const struct {
+		const char *name;
+		htmlDocPtr (*parse)(const char *file, size_t len);
+	} parsers[] = {
+		{ "libxml2", parse_libxml2 },
+		{ "hubbub", parse_hubbub }
+	};
+	htmlDocPtr doc;
 	struct stat info;
 	int fd;
 	char *file;
+	size_t i;
+	int j;
 
 	if (argc != 2) {
 		printf("Usage: %s <file>\n", argv[0]);
@@ -31,22 +88,29 @@ int main(int argc, char **argv)
 	fd = open(argv[1], 0);
 	file = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
 
-	doc = htmlReadMemory(file, info.st_size, NULL, NULL,
-			HTML_PARSE_RECOVER | HTML_PARSE_NOERROR |
-			HTML_PARSE_NOWARNING);
-#if 0
-	doc = htmlReadFile(argv[1], NULL, HTML_PARSE_RECOVER |
-			HTML_PARSE_NOERROR | HTML_PARSE_NOWARNING);
-#endif
-	if (!doc) {
-		printf("FAIL\n");
-		return 1;
-	}
+	for (i = 0; i < sizeof(parsers) / sizeof(parsers[0]); i++) {
+		clock_t start = clock(), elapsed;
+
+		for (j = 0; j < ITERATIONS; j++) {
+			doc = parsers[i].parse(file, info.st_size);
+			if (!doc) {
+				printf("%s: FAIL\n", parsers[i].name);
+				return 1;
+			}
+
+			xmlFreeDoc(doc);
+		}
 
-	xmlFreeDoc(doc);
+		elapsed = clock() - start;
+
+		printf("%s: %.2f ms/parse, %.1f MB/s\n", parsers[i].name,
+				(double) elapsed * 1000 / CLOCKS_PER_SEC /
+				ITERATIONS,
+				(double) info.st_size * ITERATIONS /
+				((double) elapsed / CLOCKS_PER_SEC) / 1e6);
+	}
 
 	xmlCleanupParser();
 
 	return 0;
 }
-
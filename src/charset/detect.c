@@ -19,12 +19,14 @@
 
 static uint16_t hubbub_charset_read_bom(const uint8_t *data, size_t len);
 static uint16_t hubbub_charset_scan_meta(const uint8_t *data, size_t len);
+static bool hubbub_charset_skip_tag(const uint8_t **pos, const uint8_t *end);
 static uint16_t hubbub_charset_parse_attributes(const uint8_t **pos,
 		const uint8_t *end);
 static bool hubbub_charset_get_attribute(const uint8_t **data,
 		const uint8_t *end,
 		const uint8_t **name, uint32_t *namelen,
 		const uint8_t **value, uint32_t *valuelen);
+static bool hubbub_charset_is_utf8(const uint8_t *data, size_t len);
 
 /**
  * Extract a charset from a chunk of data
@@ -70,7 +72,8 @@ parserutils_error hubbub_charset_extract(const uint8_t *data, size_t len,
 
 	/* 2. */
 
-	/** \todo We probably want to wait for ~512 bytes of data / 500ms here */
+	/** \todo We probably want to wait for HUBBUB_CHARSET_SCAN_LIMIT bytes
+	 * of data / 500ms here */
 
 	/* 3. */
 
@@ -130,7 +133,14 @@ parserutils_error hubbub_charset_extract(const uint8_t *data, size_t len,
 	/* No charset was specified within the document, attempt to
 	 * autodetect the encoding from the data that we have available. */
 
-	/** \todo Charset autodetection */
+	charset = hubbub_charset_autodetect(data,
+			min(HUBBUB_CHARSET_DETECT_LIMIT, len));
+	if (charset != 0) {
+		*mibenum = charset;
+		*source = HUBBUB_CHARSET_TENTATIVE;
+
+		return PARSERUTILS_OK;
+	}
 
 	/* We failed to autodetect a charset, so use the default fallback */
 default_encoding:
@@ -187,6 +197,9 @@ uint16_t hubbub_charset_read_bom(const uint8_t *data, size_t len)
 
 #define ADVANCE(a)							\
 	while (pos < end - SLEN(a)) {					\
+		pos = memchr(pos, a[0], (end - SLEN(a)) - pos);		\
+		if (pos == NULL)					\
+			return 0;					\
 		if (PEEK(a))						\
 			break;						\
 		pos++;							\
@@ -199,12 +212,20 @@ uint16_t hubbub_charset_read_bom(const uint8_t *data, size_t len)
 	(a == 0x09 || a == 0x0a || a == 0x0c ||				\
 			a == 0x0d || a == 0x20 || a == 0x2f)
 
+#define ISALPHA(a)							\
+	(0x41 <= ((a) & ~0x20) && ((a) & ~0x20) <= 0x5A)
+
 /**
  * Search for a meta charset within a buffer of data
  *
  * \param data  Pointer to buffer containing data
  * \param len   Length of buffer
  * \return MIB enum representing encoding, or 0 if none found
+ *
+ * Only the first HUBBUB_CHARSET_SCAN_LIMIT bytes of data are considered.
+ * Every step of the algorithm other than (e) starts at a '<', so we use
+ * memchr() (which is vectorised by most C libraries) to skip straight to
+ * the next one and then dispatch on the character that follows it.
  */
 uint16_t hubbub_charset_scan_meta(const uint8_t *data, size_t len)
 {
@@ -215,72 +236,87 @@ uint16_t hubbub_charset_scan_meta(const uint8_t *data, size_t len)
 	if (data == NULL)
 		return 0;
 
-	end = pos + min(512, len);
+	end = pos + min(HUBBUB_CHARSET_SCAN_LIMIT, len);
 
 	/* 1. */
 	while (pos < end) {
-		/* a */
-		if (PEEK("<!--")) {
-			pos += SLEN("<!--");
-			ADVANCE("-->");
-		/* b */
-		} else if (PEEK("<meta")) {
-			if (pos + SLEN("<meta") >= end - 1)
-				return 0;
+		/* e - skip everything that isn't a '<' */
+		pos = memchr(pos, '<', end - pos);
+		if (pos == NULL)
+			return 0;
 
-			if (ISSPACE(*(pos + SLEN("<meta")))) {
-				/* 1 */
-				pos += SLEN("<meta");
+		if (pos + 1 >= end)
+			break;
 
-				mibenum = hubbub_charset_parse_attributes(
-						&pos, end);
-				if (mibenum != 0)
-					return mibenum;
+		switch (pos[1]) {
+		case '!':
+			/* a */
+			if (PEEK("<!--")) {
+				pos += SLEN("<!--");
+				ADVANCE("-->");
+			/* d */
+			} else if (PEEK("<!")) {
+				pos++;
+				ADVANCE(">");
+			}
+			break;
+		case '/':
+			/* c */
+			if (PEEK("</") && pos < end - 3 && ISALPHA(pos[2])) {
+				/* skip '<' */
+				pos++;
 
-				if (pos >= end)
+				if (hubbub_charset_skip_tag(&pos, end) == false)
 					return 0;
-			}
-		/* c */
-		} else if ((PEEK("</") && (pos < end - 3 &&
-				(0x41 <= (*(pos + 2) & ~ 0x20) &&
-				(*(pos + 2) & ~ 0x20) <= 0x5A))) ||
-				(pos < end - 2 && *pos == '<' &&
-				(0x41 <= (*(pos + 1) & ~ 0x20) &&
-				(*(pos + 1) & ~ 0x20) <= 0x5A))) {
-
-			/* skip '<' */
-			pos++;
 
-			/* 1. */
-			while (pos < end) {
-				if (ISSPACE(*pos) ||
-						*pos == '>' || *pos == '<')
-					break;
+				/* 2 */
+				if (*pos == '<')
+					continue;
+			/* d */
+			} else if (PEEK("</")) {
+				pos++;
+				ADVANCE(">");
+			}
+			break;
+		case '?':
+			/* d */
+			if (PEEK("<?")) {
 				pos++;
+				ADVANCE(">");
 			}
+			break;
+		default:
+			/* b */
+			if (PEEK("<meta")) {
+				if (pos + SLEN("<meta") >= end - 1)
+					return 0;
 
-			if (pos >= end)
-				return 0;
+				if (ISSPACE(*(pos + SLEN("<meta")))) {
+					/* 1 */
+					pos += SLEN("<meta");
+
+					mibenum = hubbub_charset_parse_attributes(
+							&pos, end);
+					if (mibenum != 0)
+						return mibenum;
+
+					if (pos >= end)
+						return 0;
+				}
+			/* c */
+			} else if (pos < end - 2 && ISALPHA(pos[1])) {
+				/* skip '<' */
+				pos++;
 
-			/* 3 */
-			if (*pos != '<') {
-				const uint8_t *n;
-				const uint8_t *v;
-				uint32_t nl, vl;
-
-				while (hubbub_charset_get_attribute(&pos, end,
-						&n, &nl, &v, &vl))
-					; /* do nothing */
-			/* 2 */
-			} else
-				continue;
-		/* d */
-		} else if (PEEK("<!") || PEEK("</") || PEEK("<?")) {
-			pos++;
-			ADVANCE(">");
-		}
+				if (hubbub_charset_skip_tag(&pos, end) == false)
+					return 0;
 
-		/* e - do nothing */
+				/* 2 */
+				if (*pos == '<')
+					continue;
+			}
+			break;
+		}
 
 		/* 2 */
 		pos++;
@@ -289,6 +325,48 @@ uint16_t hubbub_charset_scan_meta(const uint8_t *data, size_t len)
 	return 0;
 }
 
+/**
+ * Skip over a tag which isn't a meta tag
+ *
+ * \param pos  Pointer to pointer to tag name (updated on exit)
+ * \param end  Pointer to end of data stream
+ * \return false if the end of the data was reached, true otherwise
+ *
+ * On exit, ::pos points to a '<' if the tag was unterminated and the
+ * scan must resume from that character.
+ */
+bool hubbub_charset_skip_tag(const uint8_t **pos, const uint8_t *end)
+{
+	const uint8_t *p = *pos;
+
+	/* 1. */
+	while (p < end) {
+		if (ISSPACE(*p) || *p == '>' || *p == '<')
+			break;
+		p++;
+	}
+
+	if (p >= end) {
+		*pos = p;
+		return false;
+	}
+
+	/* 3 */
+	if (*p != '<') {
+		const uint8_t *n;
+		const uint8_t *v;
+		uint32_t nl, vl;
+
+		while (hubbub_charset_get_attribute(&p, end,
+				&n, &nl, &v, &vl))
+			; /* do nothing */
+	}
+
+	*pos = p;
+
+	return p < end;
+}
+
 /**
  * Parse attributes on a meta tag
  *
@@ -656,6 +734,490 @@ bool hubbub_charset_get_attribute(const uint8_t **data, const uint8_t *end,
 	return false;
 }
 
+/** Scores returned by a model for a byte sequence it cannot represent */
+#define IMPOSSIBLE (-0x10000)
+
+/** Minimum score a model must reach for its charset to be used */
+#define MIN_SCORE 8
+
+/** Bytes which would mark an ASCII character as non-ASCII, word-at-a-time */
+#define HIGH_BITS ((uint64_t) 0x8080808080808080ULL)
+
+#define ISLATIN(a)	(ISALPHA(a) && (a) < 0x80)
+
+#define S(x)   x, SLEN(x)
+
+/**
+ * Statistical model for a legacy character set
+ *
+ * The model is fed each byte in turn, together with the byte before it, and
+ * returns a weight reflecting how typical that byte pair is of text in the
+ * character set. Multibyte models use ::state to track a pending lead byte.
+ */
+typedef struct hubbub_charset_model {
+	const char *name;		/**< Character set name */
+	size_t len;			/**< Length of name */
+
+	/** Score a byte, given the previous one */
+	int (*score)(uint8_t *state, uint8_t prev, uint8_t c);
+} hubbub_charset_model;
+
+static int hubbub_charset_score_windows1252(uint8_t *state, uint8_t prev,
+		uint8_t c);
+static int hubbub_charset_score_windows1251(uint8_t *state, uint8_t prev,
+		uint8_t c);
+static int hubbub_charset_score_koi8r(uint8_t *state, uint8_t prev,
+		uint8_t c);
+static int hubbub_charset_score_windows1253(uint8_t *state, uint8_t prev,
+		uint8_t c);
+static int hubbub_charset_score_sjis(uint8_t *state, uint8_t prev,
+		uint8_t c);
+static int hubbub_charset_score_eucjp(uint8_t *state, uint8_t prev,
+		uint8_t c);
+static int hubbub_charset_score_gbk(uint8_t *state, uint8_t prev,
+		uint8_t c);
+
+/**
+ * Models for autodetection, in order of preference when scores are equal
+ */
+static const hubbub_charset_model models[] = {
+	{ S("Windows-1252"), hubbub_charset_score_windows1252 },
+	{ S("Windows-1251"), hubbub_charset_score_windows1251 },
+	{ S("KOI8-R"), hubbub_charset_score_koi8r },
+	{ S("Windows-1253"), hubbub_charset_score_windows1253 },
+	{ S("Shift_JIS"), hubbub_charset_score_sjis },
+	{ S("EUC-JP"), hubbub_charset_score_eucjp },
+	{ S("GBK"), hubbub_charset_score_gbk }
+};
+
+/**
+ * Attempt to determine the charset of a buffer of data from its contents
+ *
+ * \param data  Pointer to buffer containing data
+ * \param len   Buffer length
+ * \return MIB enum representing encoding, or 0 if undetermined
+ *
+ * All of the data is considered, so callers should bound len; see
+ * HUBBUB_CHARSET_DETECT_LIMIT. Data which is entirely ASCII is left
+ * undetermined.
+ */
+uint16_t hubbub_charset_autodetect(const uint8_t *data, size_t len)
+{
+	uint8_t state[N_ELEMENTS(models)];
+	int32_t score[N_ELEMENTS(models)];
+	size_t pos, i, best;
+	uint8_t prev;
+
+	pos = hubbub_charset_ascii_prefix(data, len);
+	if (pos == len)
+		return 0;
+
+	if (hubbub_charset_is_utf8(data + pos, len - pos)) {
+		return parserutils_charset_mibenum_from_name("UTF-8",
+				SLEN("UTF-8"));
+	}
+
+	for (i = 0; i < N_ELEMENTS(models); i++) {
+		state[i] = 0;
+		score[i] = 0;
+	}
+
+	/* Everything before pos is ASCII, which all the models agree on */
+	prev = pos > 0 ? data[pos - 1] : ' ';
+
+	for (; pos < len; pos++) {
+		for (i = 0; i < N_ELEMENTS(models); i++) {
+			int s;
+
+			if (score[i] == IMPOSSIBLE)
+				continue;
+
+			/* A charset which can't encode the data is out for
+			 * good, however well it has scored so far */
+			s = models[i].score(&state[i], prev, data[pos]);
+			if (s == IMPOSSIBLE)
+				score[i] = IMPOSSIBLE;
+			else
+				score[i] += s;
+		}
+
+		prev = data[pos];
+	}
+
+	best = 0;
+	for (i = 1; i < N_ELEMENTS(models); i++) {
+		if (score[i] > score[best])
+			best = i;
+	}
+
+	/* Require some positive evidence before overriding the default */
+	if (score[best] < MIN_SCORE)
+		return 0;
+
+	return parserutils_charset_mibenum_from_name(models[best].name,
+			models[best].len);
+}
+
+/**
+ * Find the length of the ASCII prefix of a buffer of data
+ *
+ * \param data  Pointer to buffer containing data
+ * \param len   Buffer length
+ * \return Offset of first non-ASCII byte, or ::len if there is none
+ */
+size_t hubbub_charset_ascii_prefix(const uint8_t *data, size_t len)
+{
+	size_t pos = 0;
+	uint64_t word;
+
+	/* Test 8 bytes at a time, then find the exact byte */
+	while (pos + sizeof(word) <= len) {
+		memcpy(&word, data + pos, sizeof(word));
+		if ((word & HIGH_BITS) != 0)
+			break;
+		pos += sizeof(word);
+	}
+
+	while (pos < len && data[pos] < 0x80)
+		pos++;
+
+	return pos;
+}
+
+/**
+ * Determine whether a buffer of data is well-formed UTF-8
+ *
+ * \param data  Pointer to buffer containing data
+ * \param len   Buffer length
+ * \return true if data is UTF-8, false otherwise
+ *
+ * A sequence which is truncated by the end of the buffer is permitted.
+ */
+bool hubbub_charset_is_utf8(const uint8_t *data, size_t len)
+{
+	size_t pos = 0;
+
+	while (pos < len) {
+		uint8_t c = data[pos], lo = 0x80, hi = 0xBF;
+		size_t need, i;
+
+		if (c < 0x80) {
+			pos += hubbub_charset_ascii_prefix(data + pos,
+					len - pos);
+			continue;
+		}
+
+		if (0xC2 <= c && c <= 0xDF) {
+			need = 1;
+		} else if (0xE0 <= c && c <= 0xEF) {
+			need = 2;
+			if (c == 0xE0)
+				lo = 0xA0;
+			else if (c == 0xED)
+				hi = 0x9F;
+		} else if (0xF0 <= c && c <= 0xF4) {
+			need = 3;
+			if (c == 0xF0)
+				lo = 0x90;
+			else if (c == 0xF4)
+				hi = 0x8F;
+		} else {
+			return false;
+		}
+
+		pos++;
+
+		for (i = 0; i < need && pos < len; i++, pos++) {
+			if (data[pos] < lo || hi < data[pos])
+				return false;
+
+			lo = 0x80;
+			hi = 0xBF;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Score a byte as Windows-1252
+ *
+ * Accented letters usually appear within words of ASCII letters, rather
+ * than in runs.
+ */
+int hubbub_charset_score_windows1252(uint8_t *state, uint8_t prev, uint8_t c)
+{
+	UNUSED(state);
+
+	if (c < 0x80)
+		return ISLATIN(c) && prev >= 0xC0 ? 2 : 0;
+
+	/* Undefined */
+	if (c == 0x81 || c == 0x8D || c == 0x8F || c == 0x90 || c == 0x9D)
+		return IMPOSSIBLE;
+
+	if (prev >= 0x80)
+		return -2;
+
+	/* Typographic punctuation */
+	if ((0x91 <= c && c <= 0x97) || c == 0x85 || c == 0xA0 ||
+			c == 0xAB || c == 0xBB)
+		return 1;
+
+	if (c >= 0xC0 && c != 0xD7 && c != 0xF7)
+		return ISLATIN(prev) ? 2 : 0;
+
+	return 0;
+}
+
+/**
+ * Score a byte as Windows-1251
+ *
+ * Cyrillic words are runs of high bytes, mostly lowercase (0xE0-0xFF).
+ */
+int hubbub_charset_score_windows1251(uint8_t *state, uint8_t prev, uint8_t c)
+{
+	/* о е а и н т с р в л */
+	static const uint8_t frequent[] = "\xEE\xE5\xE0\xE8\xED"
+			"\xF2\xF1\xF0\xE2\xEB";
+
+	UNUSED(state);
+
+	if (c < 0x80)
+		return ISLATIN(c) && prev >= 0xC0 ? -1 : 0;
+
+	if (c == 0x98)
+		return IMPOSSIBLE;
+
+	if (c < 0xC0) {
+		/* ё, or typographic punctuation */
+		if (c == 0xB8 || c == 0xA8)
+			return 1;
+		if ((0x91 <= c && c <= 0x97) || c == 0x85 || c == 0xA0 ||
+				c == 0xAB || c == 0xB9 || c == 0xBB)
+			return 0;
+		return -1;
+	}
+
+	if (ISLATIN(prev))
+		return -1;
+
+	/* Uppercase following lowercase is unusual */
+	if (c < 0xE0)
+		return prev >= 0xE0 ? -2 : 0;
+
+	/* Only count letters within words */
+	if (prev < 0xC0)
+		return 0;
+
+	return memchr(frequent, c, SLEN(frequent)) != NULL ? 3 : 1;
+}
+
+/**
+ * Score a byte as KOI8-R
+ *
+ * As Windows-1251, but lowercase letters are 0xC0-0xDF.
+ */
+int hubbub_charset_score_koi8r(uint8_t *state, uint8_t prev, uint8_t c)
+{
+	/* о е а и н т с р в л */
+	static const uint8_t frequent[] = "\xCF\xC5\xC1\xC9\xCE"
+			"\xD4\xD3\xD2\xD7\xCC";
+
+	UNUSED(state);
+
+	if (c < 0x80)
+		return ISLATIN(c) && prev >= 0xC0 ? -1 : 0;
+
+	/* ё, or box drawing */
+	if (c < 0xC0)
+		return c == 0xA3 || c == 0xB3 ? 1 : -2;
+
+	if (ISLATIN(prev))
+		return -1;
+
+	if (c >= 0xE0)
+		return 0xC0 <= prev && prev < 0xE0 ? -2 : 0;
+
+	if (prev < 0xC0)
+		return 0;
+
+	return memchr(frequent, c, SLEN(frequent)) != NULL ? 3 : 1;
+}
+
+/**
+ * Score a byte as Windows-1253
+ *
+ * Greek lowercase letters are 0xDC-0xFE.
+ */
+int hubbub_charset_score_windows1253(uint8_t *state, uint8_t prev, uint8_t c)
+{
+	/* α ο ι ε τ ν */
+	static const uint8_t frequent[] = "\xE1\xEF\xE9\xE5\xF4\xED";
+
+	UNUSED(state);
+
+	if (c < 0x80)
+		return ISLATIN(c) && prev >= 0xC1 ? -1 : 0;
+
+	/* Undefined */
+	if (c == 0x81 || c == 0x88 || c == 0x8A || c == 0x8C ||
+			(0x8D <= c && c <= 0x90) || c == 0x98 ||
+			c == 0x9A || (0x9C <= c && c <= 0x9F) ||
+			c == 0xAA || c == 0xD2 || c == 0xFF)
+		return IMPOSSIBLE;
+
+	if (c < 0xC1) {
+		if ((0x91 <= c && c <= 0x97) || c == 0x85 || c == 0xA0 ||
+				c == 0xAB || c == 0xBB)
+			return 0;
+		return -1;
+	}
+
+	if (ISLATIN(prev))
+		return -1;
+
+	if (c < 0xDC)
+		return prev >= 0xDC ? -2 : 0;
+
+	if (prev < 0xC1)
+		return 0;
+
+	return memchr(frequent, c, SLEN(frequent)) != NULL ? 3 : 1;
+}
+
+/**
+ * Score a byte as Shift_JIS
+ *
+ * Kana and JIS level 1 kanji are the most common double-byte characters.
+ */
+int hubbub_charset_score_sjis(uint8_t *state, uint8_t prev, uint8_t c)
+{
+	uint8_t lead = *state;
+
+	UNUSED(prev);
+
+	if (lead == 0) {
+		if (c < 0x80 || (0xA1 <= c && c <= 0xDF))
+			return 0;
+
+		if ((0x81 <= c && c <= 0x9F) || (0xE0 <= c && c <= 0xFC)) {
+			*state = c;
+			return 0;
+		}
+
+		return IMPOSSIBLE;
+	}
+
+	*state = 0;
+
+	if (c < 0x40 || c == 0x7F || c > 0xFC)
+		return IMPOSSIBLE;
+
+	/* Hiragana, katakana */
+	if ((lead == 0x82 && 0x9F <= c && c <= 0xF1) ||
+			(lead == 0x83 && c <= 0x96))
+		return 3;
+
+	/* Punctuation, level 1 kanji */
+	if ((lead == 0x81 && c <= 0x5B) || (0x88 <= lead && lead <= 0x98))
+		return 2;
+
+	return 0;
+}
+
+/**
+ * Score a byte as EUC-JP
+ *
+ * Kana and JIS level 1 kanji are the most common double-byte characters.
+ */
+int hubbub_charset_score_eucjp(uint8_t *state, uint8_t prev, uint8_t c)
+{
+	uint8_t lead = *state;
+
+	UNUSED(prev);
+
+	if (lead == 0) {
+		if (c < 0x80)
+			return 0;
+
+		if (c == 0x8E || c == 0x8F || (0xA1 <= c && c <= 0xFE)) {
+			*state = c;
+			return 0;
+		}
+
+		return IMPOSSIBLE;
+	}
+
+	*state = 0;
+
+	if (c < 0xA1 || c == 0xFF)
+		return IMPOSSIBLE;
+
+	/* JIS X 0212 is three bytes long: wait for the final one */
+	if (lead == 0x8F) {
+		*state = 0x80;
+		return 0;
+	}
+
+	/* Half-width katakana */
+	if (lead == 0x8E)
+		return c <= 0xDF ? 0 : IMPOSSIBLE;
+
+	/* Hiragana, katakana */
+	if ((lead == 0xA4 && c <= 0xF3) || (lead == 0xA5 && c <= 0xF6))
+		return 3;
+
+	/* Punctuation, level 1 kanji */
+	if (lead == 0xA1 || (0xB0 <= lead && lead <= 0xCF))
+		return 2;
+
+	return 0;
+}
+
+/**
+ * Score a byte as GBK
+ *
+ * GB2312 level 1 hanzi are the most common double-byte characters.
+ */
+int hubbub_charset_score_gbk(uint8_t *state, uint8_t prev, uint8_t c)
+{
+	uint8_t lead = *state;
+
+	UNUSED(prev);
+
+	if (lead == 0) {
+		if (c <= 0x80)
+			return 0;
+
+		if (c != 0xFF) {
+			*state = c;
+			return 0;
+		}
+
+		return IMPOSSIBLE;
+	}
+
+	*state = 0;
+
+	if (c < 0x40 || c == 0x7F || c == 0xFF)
+		return IMPOSSIBLE;
+
+	/* Level 1 hanzi */
+	if (0xB0 <= lead && lead <= 0xD7 && c >= 0xA1)
+		return 3;
+
+	/* Punctuation */
+	if (lead == 0xA1 && c >= 0xA1)
+		return 2;
+
+	/* Level 2 hanzi */
+	if (0xD8 <= lead && lead <= 0xF7 && c >= 0xA1)
+		return 1;
+
+	return 0;
+}
+
 /**
  * Fix charsets, according to the override table in HTML5,
  * section 8.2.2.2. Character encoding requirements
@@ -12,6 +12,23 @@
 
 #include <parserutils/errors.h>
 
+/**
+ * Number of bytes at the start of a document which are searched for a
+ * meta charset. The spec recommends 1024; pages with large inline head
+ * content may want to build with -DHUBBUB_CHARSET_SCAN_LIMIT=1024.
+ */
+#ifndef HUBBUB_CHARSET_SCAN_LIMIT
+#define HUBBUB_CHARSET_SCAN_LIMIT 512
+#endif
+
+/**
+ * Number of bytes at the start of a document which are examined when
+ * autodetecting its charset. The cost of detection is linear in this.
+ */
+#ifndef HUBBUB_CHARSET_DETECT_LIMIT
+#define HUBBUB_CHARSET_DETECT_LIMIT 4096
+#endif
+
 /* Extract a charset from a chunk of data */
 parserutils_error hubbub_charset_extract(const uint8_t *data, size_t len,
 		uint16_t *mibenum, uint32_t *source);
@@ -20,6 +37,12 @@ parserutils_error hubbub_charset_extract(const uint8_t *data, size_t len,
 uint16_t hubbub_charset_parse_content(const uint8_t *value,
                 uint32_t valuelen);
 
+/* Determine the charset of a chunk of data from its contents */
+uint16_t hubbub_charset_autodetect(const uint8_t *data, size_t len);
+
+/* Find the length of the ASCII prefix of a chunk of data */
+size_t hubbub_charset_ascii_prefix(const uint8_t *data, size_t len);
+
 /* Fix up frequently misused character sets */
 void hubbub_charset_fix_charset(uint16_t *charset);
 
@@ -0,0 +1,1877 @@
+/*
+ * This file is part of Hubbub.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ */
+
+#include <string.h>
+
+#include <parserutils/charset/mibenum.h>
+
+#include "utils/utils.h"
+
+#include "singlebyte.h"
+
+/**
+ * Single-byte charset conversion table
+ *
+ * Each entry holds the UTF-8 encoding of a byte in the range 0x80-0xFF:
+ * its length, followed by up to three bytes of data. Bytes which are
+ * undefined in the charset map to U+FFFD.
+ */
+struct hubbub_charset_table {
+	const char *name;		/**< Charset name */
+	size_t len;			/**< Length of name */
+	const uint8_t (*utf8)[4];	/**< UTF-8 for bytes 0x80-0xFF */
+};
+
+/** Bytes which would mark an ASCII character as non-ASCII */
+#define HIGH_BITS ((uint64_t) 0x8080808080808080ULL)
+
+#define S(x)   x, SLEN(x)
+
+static const uint8_t windows_1250[128][4] = {
+	{ 3, 0xE2, 0x82, 0xAC }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xE2, 0x80, 0x9A }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xE2, 0x80, 0x9E }, { 3, 0xE2, 0x80, 0xA6 },
+	{ 3, 0xE2, 0x80, 0xA0 }, { 3, 0xE2, 0x80, 0xA1 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0xB0 },
+	{ 2, 0xC5, 0xA0 }, { 3, 0xE2, 0x80, 0xB9 },
+	{ 2, 0xC5, 0x9A }, { 2, 0xC5, 0xA4 },
+	{ 2, 0xC5, 0xBD }, { 2, 0xC5, 0xB9 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0x98 },
+	{ 3, 0xE2, 0x80, 0x99 }, { 3, 0xE2, 0x80, 0x9C },
+	{ 3, 0xE2, 0x80, 0x9D }, { 3, 0xE2, 0x80, 0xA2 },
+	{ 3, 0xE2, 0x80, 0x93 }, { 3, 0xE2, 0x80, 0x94 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x84, 0xA2 },
+	{ 2, 0xC5, 0xA1 }, { 3, 0xE2, 0x80, 0xBA },
+	{ 2, 0xC5, 0x9B }, { 2, 0xC5, 0xA5 },
+	{ 2, 0xC5, 0xBE }, { 2, 0xC5, 0xBA },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xCB, 0x87 },
+	{ 2, 0xCB, 0x98 }, { 2, 0xC5, 0x81 },
+	{ 2, 0xC2, 0xA4 }, { 2, 0xC4, 0x84 },
+	{ 2, 0xC2, 0xA6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC2, 0xA8 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xC5, 0x9E }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 2, 0xC5, 0xBB },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xCB, 0x9B }, { 2, 0xC5, 0x82 },
+	{ 2, 0xC2, 0xB4 }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC2, 0xB8 }, { 2, 0xC4, 0x85 },
+	{ 2, 0xC5, 0x9F }, { 2, 0xC2, 0xBB },
+	{ 2, 0xC4, 0xBD }, { 2, 0xCB, 0x9D },
+	{ 2, 0xC4, 0xBE }, { 2, 0xC5, 0xBC },
+	{ 2, 0xC5, 0x94 }, { 2, 0xC3, 0x81 },
+	{ 2, 0xC3, 0x82 }, { 2, 0xC4, 0x82 },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC4, 0xB9 },
+	{ 2, 0xC4, 0x86 }, { 2, 0xC3, 0x87 },
+	{ 2, 0xC4, 0x8C }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC4, 0x98 }, { 2, 0xC3, 0x8B },
+	{ 2, 0xC4, 0x9A }, { 2, 0xC3, 0x8D },
+	{ 2, 0xC3, 0x8E }, { 2, 0xC4, 0x8E },
+	{ 2, 0xC4, 0x90 }, { 2, 0xC5, 0x83 },
+	{ 2, 0xC5, 0x87 }, { 2, 0xC3, 0x93 },
+	{ 2, 0xC3, 0x94 }, { 2, 0xC5, 0x90 },
+	{ 2, 0xC3, 0x96 }, { 2, 0xC3, 0x97 },
+	{ 2, 0xC5, 0x98 }, { 2, 0xC5, 0xAE },
+	{ 2, 0xC3, 0x9A }, { 2, 0xC5, 0xB0 },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC3, 0x9D },
+	{ 2, 0xC5, 0xA2 }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC5, 0x95 }, { 2, 0xC3, 0xA1 },
+	{ 2, 0xC3, 0xA2 }, { 2, 0xC4, 0x83 },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC4, 0xBA },
+	{ 2, 0xC4, 0x87 }, { 2, 0xC3, 0xA7 },
+	{ 2, 0xC4, 0x8D }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC4, 0x99 }, { 2, 0xC3, 0xAB },
+	{ 2, 0xC4, 0x9B }, { 2, 0xC3, 0xAD },
+	{ 2, 0xC3, 0xAE }, { 2, 0xC4, 0x8F },
+	{ 2, 0xC4, 0x91 }, { 2, 0xC5, 0x84 },
+	{ 2, 0xC5, 0x88 }, { 2, 0xC3, 0xB3 },
+	{ 2, 0xC3, 0xB4 }, { 2, 0xC5, 0x91 },
+	{ 2, 0xC3, 0xB6 }, { 2, 0xC3, 0xB7 },
+	{ 2, 0xC5, 0x99 }, { 2, 0xC5, 0xAF },
+	{ 2, 0xC3, 0xBA }, { 2, 0xC5, 0xB1 },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC3, 0xBD },
+	{ 2, 0xC5, 0xA3 }, { 2, 0xCB, 0x99 }
+};
+
+static const uint8_t windows_1251[128][4] = {
+	{ 2, 0xD0, 0x82 }, { 2, 0xD0, 0x83 },
+	{ 3, 0xE2, 0x80, 0x9A }, { 2, 0xD1, 0x93 },
+	{ 3, 0xE2, 0x80, 0x9E }, { 3, 0xE2, 0x80, 0xA6 },
+	{ 3, 0xE2, 0x80, 0xA0 }, { 3, 0xE2, 0x80, 0xA1 },
+	{ 3, 0xE2, 0x82, 0xAC }, { 3, 0xE2, 0x80, 0xB0 },
+	{ 2, 0xD0, 0x89 }, { 3, 0xE2, 0x80, 0xB9 },
+	{ 2, 0xD0, 0x8A }, { 2, 0xD0, 0x8C },
+	{ 2, 0xD0, 0x8B }, { 2, 0xD0, 0x8F },
+	{ 2, 0xD1, 0x92 }, { 3, 0xE2, 0x80, 0x98 },
+	{ 3, 0xE2, 0x80, 0x99 }, { 3, 0xE2, 0x80, 0x9C },
+	{ 3, 0xE2, 0x80, 0x9D }, { 3, 0xE2, 0x80, 0xA2 },
+	{ 3, 0xE2, 0x80, 0x93 }, { 3, 0xE2, 0x80, 0x94 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x84, 0xA2 },
+	{ 2, 0xD1, 0x99 }, { 3, 0xE2, 0x80, 0xBA },
+	{ 2, 0xD1, 0x9A }, { 2, 0xD1, 0x9C },
+	{ 2, 0xD1, 0x9B }, { 2, 0xD1, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xD0, 0x8E },
+	{ 2, 0xD1, 0x9E }, { 2, 0xD0, 0x88 },
+	{ 2, 0xC2, 0xA4 }, { 2, 0xD2, 0x90 },
+	{ 2, 0xC2, 0xA6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xD0, 0x81 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xD0, 0x84 }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 2, 0xD0, 0x87 },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xD0, 0x86 }, { 2, 0xD1, 0x96 },
+	{ 2, 0xD2, 0x91 }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xD1, 0x91 }, { 3, 0xE2, 0x84, 0x96 },
+	{ 2, 0xD1, 0x94 }, { 2, 0xC2, 0xBB },
+	{ 2, 0xD1, 0x98 }, { 2, 0xD0, 0x85 },
+	{ 2, 0xD1, 0x95 }, { 2, 0xD1, 0x97 },
+	{ 2, 0xD0, 0x90 }, { 2, 0xD0, 0x91 },
+	{ 2, 0xD0, 0x92 }, { 2, 0xD0, 0x93 },
+	{ 2, 0xD0, 0x94 }, { 2, 0xD0, 0x95 },
+	{ 2, 0xD0, 0x96 }, { 2, 0xD0, 0x97 },
+	{ 2, 0xD0, 0x98 }, { 2, 0xD0, 0x99 },
+	{ 2, 0xD0, 0x9A }, { 2, 0xD0, 0x9B },
+	{ 2, 0xD0, 0x9C }, { 2, 0xD0, 0x9D },
+	{ 2, 0xD0, 0x9E }, { 2, 0xD0, 0x9F },
+	{ 2, 0xD0, 0xA0 }, { 2, 0xD0, 0xA1 },
+	{ 2, 0xD0, 0xA2 }, { 2, 0xD0, 0xA3 },
+	{ 2, 0xD0, 0xA4 }, { 2, 0xD0, 0xA5 },
+	{ 2, 0xD0, 0xA6 }, { 2, 0xD0, 0xA7 },
+	{ 2, 0xD0, 0xA8 }, { 2, 0xD0, 0xA9 },
+	{ 2, 0xD0, 0xAA }, { 2, 0xD0, 0xAB },
+	{ 2, 0xD0, 0xAC }, { 2, 0xD0, 0xAD },
+	{ 2, 0xD0, 0xAE }, { 2, 0xD0, 0xAF },
+	{ 2, 0xD0, 0xB0 }, { 2, 0xD0, 0xB1 },
+	{ 2, 0xD0, 0xB2 }, { 2, 0xD0, 0xB3 },
+	{ 2, 0xD0, 0xB4 }, { 2, 0xD0, 0xB5 },
+	{ 2, 0xD0, 0xB6 }, { 2, 0xD0, 0xB7 },
+	{ 2, 0xD0, 0xB8 }, { 2, 0xD0, 0xB9 },
+	{ 2, 0xD0, 0xBA }, { 2, 0xD0, 0xBB },
+	{ 2, 0xD0, 0xBC }, { 2, 0xD0, 0xBD },
+	{ 2, 0xD0, 0xBE }, { 2, 0xD0, 0xBF },
+	{ 2, 0xD1, 0x80 }, { 2, 0xD1, 0x81 },
+	{ 2, 0xD1, 0x82 }, { 2, 0xD1, 0x83 },
+	{ 2, 0xD1, 0x84 }, { 2, 0xD1, 0x85 },
+	{ 2, 0xD1, 0x86 }, { 2, 0xD1, 0x87 },
+	{ 2, 0xD1, 0x88 }, { 2, 0xD1, 0x89 },
+	{ 2, 0xD1, 0x8A }, { 2, 0xD1, 0x8B },
+	{ 2, 0xD1, 0x8C }, { 2, 0xD1, 0x8D },
+	{ 2, 0xD1, 0x8E }, { 2, 0xD1, 0x8F }
+};
+
+static const uint8_t windows_1252[128][4] = {
+	{ 3, 0xE2, 0x82, 0xAC }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xE2, 0x80, 0x9A }, { 2, 0xC6, 0x92 },
+	{ 3, 0xE2, 0x80, 0x9E }, { 3, 0xE2, 0x80, 0xA6 },
+	{ 3, 0xE2, 0x80, 0xA0 }, { 3, 0xE2, 0x80, 0xA1 },
+	{ 2, 0xCB, 0x86 }, { 3, 0xE2, 0x80, 0xB0 },
+	{ 2, 0xC5, 0xA0 }, { 3, 0xE2, 0x80, 0xB9 },
+	{ 2, 0xC5, 0x92 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xC5, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0x98 },
+	{ 3, 0xE2, 0x80, 0x99 }, { 3, 0xE2, 0x80, 0x9C },
+	{ 3, 0xE2, 0x80, 0x9D }, { 3, 0xE2, 0x80, 0xA2 },
+	{ 3, 0xE2, 0x80, 0x93 }, { 3, 0xE2, 0x80, 0x94 },
+	{ 2, 0xCB, 0x9C }, { 3, 0xE2, 0x84, 0xA2 },
+	{ 2, 0xC5, 0xA1 }, { 3, 0xE2, 0x80, 0xBA },
+	{ 2, 0xC5, 0x93 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xC5, 0xBE }, { 2, 0xC5, 0xB8 },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xC2, 0xA1 },
+	{ 2, 0xC2, 0xA2 }, { 2, 0xC2, 0xA3 },
+	{ 2, 0xC2, 0xA4 }, { 2, 0xC2, 0xA5 },
+	{ 2, 0xC2, 0xA6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC2, 0xA8 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xC2, 0xAA }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 2, 0xC2, 0xAF },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xC2, 0xB2 }, { 2, 0xC2, 0xB3 },
+	{ 2, 0xC2, 0xB4 }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC2, 0xB8 }, { 2, 0xC2, 0xB9 },
+	{ 2, 0xC2, 0xBA }, { 2, 0xC2, 0xBB },
+	{ 2, 0xC2, 0xBC }, { 2, 0xC2, 0xBD },
+	{ 2, 0xC2, 0xBE }, { 2, 0xC2, 0xBF },
+	{ 2, 0xC3, 0x80 }, { 2, 0xC3, 0x81 },
+	{ 2, 0xC3, 0x82 }, { 2, 0xC3, 0x83 },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC3, 0x85 },
+	{ 2, 0xC3, 0x86 }, { 2, 0xC3, 0x87 },
+	{ 2, 0xC3, 0x88 }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC3, 0x8A }, { 2, 0xC3, 0x8B },
+	{ 2, 0xC3, 0x8C }, { 2, 0xC3, 0x8D },
+	{ 2, 0xC3, 0x8E }, { 2, 0xC3, 0x8F },
+	{ 2, 0xC3, 0x90 }, { 2, 0xC3, 0x91 },
+	{ 2, 0xC3, 0x92 }, { 2, 0xC3, 0x93 },
+	{ 2, 0xC3, 0x94 }, { 2, 0xC3, 0x95 },
+	{ 2, 0xC3, 0x96 }, { 2, 0xC3, 0x97 },
+	{ 2, 0xC3, 0x98 }, { 2, 0xC3, 0x99 },
+	{ 2, 0xC3, 0x9A }, { 2, 0xC3, 0x9B },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC3, 0x9D },
+	{ 2, 0xC3, 0x9E }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC3, 0xA0 }, { 2, 0xC3, 0xA1 },
+	{ 2, 0xC3, 0xA2 }, { 2, 0xC3, 0xA3 },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC3, 0xA5 },
+	{ 2, 0xC3, 0xA6 }, { 2, 0xC3, 0xA7 },
+	{ 2, 0xC3, 0xA8 }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC3, 0xAA }, { 2, 0xC3, 0xAB },
+	{ 2, 0xC3, 0xAC }, { 2, 0xC3, 0xAD },
+	{ 2, 0xC3, 0xAE }, { 2, 0xC3, 0xAF },
+	{ 2, 0xC3, 0xB0 }, { 2, 0xC3, 0xB1 },
+	{ 2, 0xC3, 0xB2 }, { 2, 0xC3, 0xB3 },
+	{ 2, 0xC3, 0xB4 }, { 2, 0xC3, 0xB5 },
+	{ 2, 0xC3, 0xB6 }, { 2, 0xC3, 0xB7 },
+	{ 2, 0xC3, 0xB8 }, { 2, 0xC3, 0xB9 },
+	{ 2, 0xC3, 0xBA }, { 2, 0xC3, 0xBB },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC3, 0xBD },
+	{ 2, 0xC3, 0xBE }, { 2, 0xC3, 0xBF }
+};
+
+static const uint8_t windows_1253[128][4] = {
+	{ 3, 0xE2, 0x82, 0xAC }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xE2, 0x80, 0x9A }, { 2, 0xC6, 0x92 },
+	{ 3, 0xE2, 0x80, 0x9E }, { 3, 0xE2, 0x80, 0xA6 },
+	{ 3, 0xE2, 0x80, 0xA0 }, { 3, 0xE2, 0x80, 0xA1 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0xB0 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0xB9 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0x98 },
+	{ 3, 0xE2, 0x80, 0x99 }, { 3, 0xE2, 0x80, 0x9C },
+	{ 3, 0xE2, 0x80, 0x9D }, { 3, 0xE2, 0x80, 0xA2 },
+	{ 3, 0xE2, 0x80, 0x93 }, { 3, 0xE2, 0x80, 0x94 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x84, 0xA2 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0xBA },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xCE, 0x85 },
+	{ 2, 0xCE, 0x86 }, { 2, 0xC2, 0xA3 },
+	{ 2, 0xC2, 0xA4 }, { 2, 0xC2, 0xA5 },
+	{ 2, 0xC2, 0xA6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC2, 0xA8 }, { 2, 0xC2, 0xA9 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 3, 0xE2, 0x80, 0x95 },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xC2, 0xB2 }, { 2, 0xC2, 0xB3 },
+	{ 2, 0xCE, 0x84 }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xCE, 0x88 }, { 2, 0xCE, 0x89 },
+	{ 2, 0xCE, 0x8A }, { 2, 0xC2, 0xBB },
+	{ 2, 0xCE, 0x8C }, { 2, 0xC2, 0xBD },
+	{ 2, 0xCE, 0x8E }, { 2, 0xCE, 0x8F },
+	{ 2, 0xCE, 0x90 }, { 2, 0xCE, 0x91 },
+	{ 2, 0xCE, 0x92 }, { 2, 0xCE, 0x93 },
+	{ 2, 0xCE, 0x94 }, { 2, 0xCE, 0x95 },
+	{ 2, 0xCE, 0x96 }, { 2, 0xCE, 0x97 },
+	{ 2, 0xCE, 0x98 }, { 2, 0xCE, 0x99 },
+	{ 2, 0xCE, 0x9A }, { 2, 0xCE, 0x9B },
+	{ 2, 0xCE, 0x9C }, { 2, 0xCE, 0x9D },
+	{ 2, 0xCE, 0x9E }, { 2, 0xCE, 0x9F },
+	{ 2, 0xCE, 0xA0 }, { 2, 0xCE, 0xA1 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xCE, 0xA3 },
+	{ 2, 0xCE, 0xA4 }, { 2, 0xCE, 0xA5 },
+	{ 2, 0xCE, 0xA6 }, { 2, 0xCE, 0xA7 },
+	{ 2, 0xCE, 0xA8 }, { 2, 0xCE, 0xA9 },
+	{ 2, 0xCE, 0xAA }, { 2, 0xCE, 0xAB },
+	{ 2, 0xCE, 0xAC }, { 2, 0xCE, 0xAD },
+	{ 2, 0xCE, 0xAE }, { 2, 0xCE, 0xAF },
+	{ 2, 0xCE, 0xB0 }, { 2, 0xCE, 0xB1 },
+	{ 2, 0xCE, 0xB2 }, { 2, 0xCE, 0xB3 },
+	{ 2, 0xCE, 0xB4 }, { 2, 0xCE, 0xB5 },
+	{ 2, 0xCE, 0xB6 }, { 2, 0xCE, 0xB7 },
+	{ 2, 0xCE, 0xB8 }, { 2, 0xCE, 0xB9 },
+	{ 2, 0xCE, 0xBA }, { 2, 0xCE, 0xBB },
+	{ 2, 0xCE, 0xBC }, { 2, 0xCE, 0xBD },
+	{ 2, 0xCE, 0xBE }, { 2, 0xCE, 0xBF },
+	{ 2, 0xCF, 0x80 }, { 2, 0xCF, 0x81 },
+	{ 2, 0xCF, 0x82 }, { 2, 0xCF, 0x83 },
+	{ 2, 0xCF, 0x84 }, { 2, 0xCF, 0x85 },
+	{ 2, 0xCF, 0x86 }, { 2, 0xCF, 0x87 },
+	{ 2, 0xCF, 0x88 }, { 2, 0xCF, 0x89 },
+	{ 2, 0xCF, 0x8A }, { 2, 0xCF, 0x8B },
+	{ 2, 0xCF, 0x8C }, { 2, 0xCF, 0x8D },
+	{ 2, 0xCF, 0x8E }, { 3, 0xEF, 0xBF, 0xBD }
+};
+
+static const uint8_t windows_1254[128][4] = {
+	{ 3, 0xE2, 0x82, 0xAC }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xE2, 0x80, 0x9A }, { 2, 0xC6, 0x92 },
+	{ 3, 0xE2, 0x80, 0x9E }, { 3, 0xE2, 0x80, 0xA6 },
+	{ 3, 0xE2, 0x80, 0xA0 }, { 3, 0xE2, 0x80, 0xA1 },
+	{ 2, 0xCB, 0x86 }, { 3, 0xE2, 0x80, 0xB0 },
+	{ 2, 0xC5, 0xA0 }, { 3, 0xE2, 0x80, 0xB9 },
+	{ 2, 0xC5, 0x92 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0x98 },
+	{ 3, 0xE2, 0x80, 0x99 }, { 3, 0xE2, 0x80, 0x9C },
+	{ 3, 0xE2, 0x80, 0x9D }, { 3, 0xE2, 0x80, 0xA2 },
+	{ 3, 0xE2, 0x80, 0x93 }, { 3, 0xE2, 0x80, 0x94 },
+	{ 2, 0xCB, 0x9C }, { 3, 0xE2, 0x84, 0xA2 },
+	{ 2, 0xC5, 0xA1 }, { 3, 0xE2, 0x80, 0xBA },
+	{ 2, 0xC5, 0x93 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xC5, 0xB8 },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xC2, 0xA1 },
+	{ 2, 0xC2, 0xA2 }, { 2, 0xC2, 0xA3 },
+	{ 2, 0xC2, 0xA4 }, { 2, 0xC2, 0xA5 },
+	{ 2, 0xC2, 0xA6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC2, 0xA8 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xC2, 0xAA }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 2, 0xC2, 0xAF },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xC2, 0xB2 }, { 2, 0xC2, 0xB3 },
+	{ 2, 0xC2, 0xB4 }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC2, 0xB8 }, { 2, 0xC2, 0xB9 },
+	{ 2, 0xC2, 0xBA }, { 2, 0xC2, 0xBB },
+	{ 2, 0xC2, 0xBC }, { 2, 0xC2, 0xBD },
+	{ 2, 0xC2, 0xBE }, { 2, 0xC2, 0xBF },
+	{ 2, 0xC3, 0x80 }, { 2, 0xC3, 0x81 },
+	{ 2, 0xC3, 0x82 }, { 2, 0xC3, 0x83 },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC3, 0x85 },
+	{ 2, 0xC3, 0x86 }, { 2, 0xC3, 0x87 },
+	{ 2, 0xC3, 0x88 }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC3, 0x8A }, { 2, 0xC3, 0x8B },
+	{ 2, 0xC3, 0x8C }, { 2, 0xC3, 0x8D },
+	{ 2, 0xC3, 0x8E }, { 2, 0xC3, 0x8F },
+	{ 2, 0xC4, 0x9E }, { 2, 0xC3, 0x91 },
+	{ 2, 0xC3, 0x92 }, { 2, 0xC3, 0x93 },
+	{ 2, 0xC3, 0x94 }, { 2, 0xC3, 0x95 },
+	{ 2, 0xC3, 0x96 }, { 2, 0xC3, 0x97 },
+	{ 2, 0xC3, 0x98 }, { 2, 0xC3, 0x99 },
+	{ 2, 0xC3, 0x9A }, { 2, 0xC3, 0x9B },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC4, 0xB0 },
+	{ 2, 0xC5, 0x9E }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC3, 0xA0 }, { 2, 0xC3, 0xA1 },
+	{ 2, 0xC3, 0xA2 }, { 2, 0xC3, 0xA3 },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC3, 0xA5 },
+	{ 2, 0xC3, 0xA6 }, { 2, 0xC3, 0xA7 },
+	{ 2, 0xC3, 0xA8 }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC3, 0xAA }, { 2, 0xC3, 0xAB },
+	{ 2, 0xC3, 0xAC }, { 2, 0xC3, 0xAD },
+	{ 2, 0xC3, 0xAE }, { 2, 0xC3, 0xAF },
+	{ 2, 0xC4, 0x9F }, { 2, 0xC3, 0xB1 },
+	{ 2, 0xC3, 0xB2 }, { 2, 0xC3, 0xB3 },
+	{ 2, 0xC3, 0xB4 }, { 2, 0xC3, 0xB5 },
+	{ 2, 0xC3, 0xB6 }, { 2, 0xC3, 0xB7 },
+	{ 2, 0xC3, 0xB8 }, { 2, 0xC3, 0xB9 },
+	{ 2, 0xC3, 0xBA }, { 2, 0xC3, 0xBB },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC4, 0xB1 },
+	{ 2, 0xC5, 0x9F }, { 2, 0xC3, 0xBF }
+};
+
+static const uint8_t windows_1255[128][4] = {
+	{ 3, 0xE2, 0x82, 0xAC }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xE2, 0x80, 0x9A }, { 2, 0xC6, 0x92 },
+	{ 3, 0xE2, 0x80, 0x9E }, { 3, 0xE2, 0x80, 0xA6 },
+	{ 3, 0xE2, 0x80, 0xA0 }, { 3, 0xE2, 0x80, 0xA1 },
+	{ 2, 0xCB, 0x86 }, { 3, 0xE2, 0x80, 0xB0 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0xB9 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0x98 },
+	{ 3, 0xE2, 0x80, 0x99 }, { 3, 0xE2, 0x80, 0x9C },
+	{ 3, 0xE2, 0x80, 0x9D }, { 3, 0xE2, 0x80, 0xA2 },
+	{ 3, 0xE2, 0x80, 0x93 }, { 3, 0xE2, 0x80, 0x94 },
+	{ 2, 0xCB, 0x9C }, { 3, 0xE2, 0x84, 0xA2 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0xBA },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xC2, 0xA1 },
+	{ 2, 0xC2, 0xA2 }, { 2, 0xC2, 0xA3 },
+	{ 3, 0xE2, 0x82, 0xAA }, { 2, 0xC2, 0xA5 },
+	{ 2, 0xC2, 0xA6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC2, 0xA8 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xC3, 0x97 }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 2, 0xC2, 0xAF },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xC2, 0xB2 }, { 2, 0xC2, 0xB3 },
+	{ 2, 0xC2, 0xB4 }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC2, 0xB8 }, { 2, 0xC2, 0xB9 },
+	{ 2, 0xC3, 0xB7 }, { 2, 0xC2, 0xBB },
+	{ 2, 0xC2, 0xBC }, { 2, 0xC2, 0xBD },
+	{ 2, 0xC2, 0xBE }, { 2, 0xC2, 0xBF },
+	{ 2, 0xD6, 0xB0 }, { 2, 0xD6, 0xB1 },
+	{ 2, 0xD6, 0xB2 }, { 2, 0xD6, 0xB3 },
+	{ 2, 0xD6, 0xB4 }, { 2, 0xD6, 0xB5 },
+	{ 2, 0xD6, 0xB6 }, { 2, 0xD6, 0xB7 },
+	{ 2, 0xD6, 0xB8 }, { 2, 0xD6, 0xB9 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xD6, 0xBB },
+	{ 2, 0xD6, 0xBC }, { 2, 0xD6, 0xBD },
+	{ 2, 0xD6, 0xBE }, { 2, 0xD6, 0xBF },
+	{ 2, 0xD7, 0x80 }, { 2, 0xD7, 0x81 },
+	{ 2, 0xD7, 0x82 }, { 2, 0xD7, 0x83 },
+	{ 2, 0xD7, 0xB0 }, { 2, 0xD7, 0xB1 },
+	{ 2, 0xD7, 0xB2 }, { 2, 0xD7, 0xB3 },
+	{ 2, 0xD7, 0xB4 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xD7, 0x90 }, { 2, 0xD7, 0x91 },
+	{ 2, 0xD7, 0x92 }, { 2, 0xD7, 0x93 },
+	{ 2, 0xD7, 0x94 }, { 2, 0xD7, 0x95 },
+	{ 2, 0xD7, 0x96 }, { 2, 0xD7, 0x97 },
+	{ 2, 0xD7, 0x98 }, { 2, 0xD7, 0x99 },
+	{ 2, 0xD7, 0x9A }, { 2, 0xD7, 0x9B },
+	{ 2, 0xD7, 0x9C }, { 2, 0xD7, 0x9D },
+	{ 2, 0xD7, 0x9E }, { 2, 0xD7, 0x9F },
+	{ 2, 0xD7, 0xA0 }, { 2, 0xD7, 0xA1 },
+	{ 2, 0xD7, 0xA2 }, { 2, 0xD7, 0xA3 },
+	{ 2, 0xD7, 0xA4 }, { 2, 0xD7, 0xA5 },
+	{ 2, 0xD7, 0xA6 }, { 2, 0xD7, 0xA7 },
+	{ 2, 0xD7, 0xA8 }, { 2, 0xD7, 0xA9 },
+	{ 2, 0xD7, 0xAA }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0x8E },
+	{ 3, 0xE2, 0x80, 0x8F }, { 3, 0xEF, 0xBF, 0xBD }
+};
+
+static const uint8_t windows_1256[128][4] = {
+	{ 3, 0xE2, 0x82, 0xAC }, { 2, 0xD9, 0xBE },
+	{ 3, 0xE2, 0x80, 0x9A }, { 2, 0xC6, 0x92 },
+	{ 3, 0xE2, 0x80, 0x9E }, { 3, 0xE2, 0x80, 0xA6 },
+	{ 3, 0xE2, 0x80, 0xA0 }, { 3, 0xE2, 0x80, 0xA1 },
+	{ 2, 0xCB, 0x86 }, { 3, 0xE2, 0x80, 0xB0 },
+	{ 2, 0xD9, 0xB9 }, { 3, 0xE2, 0x80, 0xB9 },
+	{ 2, 0xC5, 0x92 }, { 2, 0xDA, 0x86 },
+	{ 2, 0xDA, 0x98 }, { 2, 0xDA, 0x88 },
+	{ 2, 0xDA, 0xAF }, { 3, 0xE2, 0x80, 0x98 },
+	{ 3, 0xE2, 0x80, 0x99 }, { 3, 0xE2, 0x80, 0x9C },
+	{ 3, 0xE2, 0x80, 0x9D }, { 3, 0xE2, 0x80, 0xA2 },
+	{ 3, 0xE2, 0x80, 0x93 }, { 3, 0xE2, 0x80, 0x94 },
+	{ 2, 0xDA, 0xA9 }, { 3, 0xE2, 0x84, 0xA2 },
+	{ 2, 0xDA, 0x91 }, { 3, 0xE2, 0x80, 0xBA },
+	{ 2, 0xC5, 0x93 }, { 3, 0xE2, 0x80, 0x8C },
+	{ 3, 0xE2, 0x80, 0x8D }, { 2, 0xDA, 0xBA },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xD8, 0x8C },
+	{ 2, 0xC2, 0xA2 }, { 2, 0xC2, 0xA3 },
+	{ 2, 0xC2, 0xA4 }, { 2, 0xC2, 0xA5 },
+	{ 2, 0xC2, 0xA6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC2, 0xA8 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xDA, 0xBE }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 2, 0xC2, 0xAF },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xC2, 0xB2 }, { 2, 0xC2, 0xB3 },
+	{ 2, 0xC2, 0xB4 }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC2, 0xB8 }, { 2, 0xC2, 0xB9 },
+	{ 2, 0xD8, 0x9B }, { 2, 0xC2, 0xBB },
+	{ 2, 0xC2, 0xBC }, { 2, 0xC2, 0xBD },
+	{ 2, 0xC2, 0xBE }, { 2, 0xD8, 0x9F },
+	{ 2, 0xDB, 0x81 }, { 2, 0xD8, 0xA1 },
+	{ 2, 0xD8, 0xA2 }, { 2, 0xD8, 0xA3 },
+	{ 2, 0xD8, 0xA4 }, { 2, 0xD8, 0xA5 },
+	{ 2, 0xD8, 0xA6 }, { 2, 0xD8, 0xA7 },
+	{ 2, 0xD8, 0xA8 }, { 2, 0xD8, 0xA9 },
+	{ 2, 0xD8, 0xAA }, { 2, 0xD8, 0xAB },
+	{ 2, 0xD8, 0xAC }, { 2, 0xD8, 0xAD },
+	{ 2, 0xD8, 0xAE }, { 2, 0xD8, 0xAF },
+	{ 2, 0xD8, 0xB0 }, { 2, 0xD8, 0xB1 },
+	{ 2, 0xD8, 0xB2 }, { 2, 0xD8, 0xB3 },
+	{ 2, 0xD8, 0xB4 }, { 2, 0xD8, 0xB5 },
+	{ 2, 0xD8, 0xB6 }, { 2, 0xC3, 0x97 },
+	{ 2, 0xD8, 0xB7 }, { 2, 0xD8, 0xB8 },
+	{ 2, 0xD8, 0xB9 }, { 2, 0xD8, 0xBA },
+	{ 2, 0xD9, 0x80 }, { 2, 0xD9, 0x81 },
+	{ 2, 0xD9, 0x82 }, { 2, 0xD9, 0x83 },
+	{ 2, 0xC3, 0xA0 }, { 2, 0xD9, 0x84 },
+	{ 2, 0xC3, 0xA2 }, { 2, 0xD9, 0x85 },
+	{ 2, 0xD9, 0x86 }, { 2, 0xD9, 0x87 },
+	{ 2, 0xD9, 0x88 }, { 2, 0xC3, 0xA7 },
+	{ 2, 0xC3, 0xA8 }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC3, 0xAA }, { 2, 0xC3, 0xAB },
+	{ 2, 0xD9, 0x89 }, { 2, 0xD9, 0x8A },
+	{ 2, 0xC3, 0xAE }, { 2, 0xC3, 0xAF },
+	{ 2, 0xD9, 0x8B }, { 2, 0xD9, 0x8C },
+	{ 2, 0xD9, 0x8D }, { 2, 0xD9, 0x8E },
+	{ 2, 0xC3, 0xB4 }, { 2, 0xD9, 0x8F },
+	{ 2, 0xD9, 0x90 }, { 2, 0xC3, 0xB7 },
+	{ 2, 0xD9, 0x91 }, { 2, 0xC3, 0xB9 },
+	{ 2, 0xD9, 0x92 }, { 2, 0xC3, 0xBB },
+	{ 2, 0xC3, 0xBC }, { 3, 0xE2, 0x80, 0x8E },
+	{ 3, 0xE2, 0x80, 0x8F }, { 2, 0xDB, 0x92 }
+};
+
+static const uint8_t windows_1257[128][4] = {
+	{ 3, 0xE2, 0x82, 0xAC }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xE2, 0x80, 0x9A }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xE2, 0x80, 0x9E }, { 3, 0xE2, 0x80, 0xA6 },
+	{ 3, 0xE2, 0x80, 0xA0 }, { 3, 0xE2, 0x80, 0xA1 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0xB0 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0xB9 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xC2, 0xA8 },
+	{ 2, 0xCB, 0x87 }, { 2, 0xC2, 0xB8 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0x98 },
+	{ 3, 0xE2, 0x80, 0x99 }, { 3, 0xE2, 0x80, 0x9C },
+	{ 3, 0xE2, 0x80, 0x9D }, { 3, 0xE2, 0x80, 0xA2 },
+	{ 3, 0xE2, 0x80, 0x93 }, { 3, 0xE2, 0x80, 0x94 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x84, 0xA2 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0xBA },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xC2, 0xAF },
+	{ 2, 0xCB, 0x9B }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xC2, 0xA0 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xC2, 0xA2 }, { 2, 0xC2, 0xA3 },
+	{ 2, 0xC2, 0xA4 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xC2, 0xA6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC3, 0x98 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xC5, 0x96 }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 2, 0xC3, 0x86 },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xC2, 0xB2 }, { 2, 0xC2, 0xB3 },
+	{ 2, 0xC2, 0xB4 }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC3, 0xB8 }, { 2, 0xC2, 0xB9 },
+	{ 2, 0xC5, 0x97 }, { 2, 0xC2, 0xBB },
+	{ 2, 0xC2, 0xBC }, { 2, 0xC2, 0xBD },
+	{ 2, 0xC2, 0xBE }, { 2, 0xC3, 0xA6 },
+	{ 2, 0xC4, 0x84 }, { 2, 0xC4, 0xAE },
+	{ 2, 0xC4, 0x80 }, { 2, 0xC4, 0x86 },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC3, 0x85 },
+	{ 2, 0xC4, 0x98 }, { 2, 0xC4, 0x92 },
+	{ 2, 0xC4, 0x8C }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC5, 0xB9 }, { 2, 0xC4, 0x96 },
+	{ 2, 0xC4, 0xA2 }, { 2, 0xC4, 0xB6 },
+	{ 2, 0xC4, 0xAA }, { 2, 0xC4, 0xBB },
+	{ 2, 0xC5, 0xA0 }, { 2, 0xC5, 0x83 },
+	{ 2, 0xC5, 0x85 }, { 2, 0xC3, 0x93 },
+	{ 2, 0xC5, 0x8C }, { 2, 0xC3, 0x95 },
+	{ 2, 0xC3, 0x96 }, { 2, 0xC3, 0x97 },
+	{ 2, 0xC5, 0xB2 }, { 2, 0xC5, 0x81 },
+	{ 2, 0xC5, 0x9A }, { 2, 0xC5, 0xAA },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC5, 0xBB },
+	{ 2, 0xC5, 0xBD }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC4, 0x85 }, { 2, 0xC4, 0xAF },
+	{ 2, 0xC4, 0x81 }, { 2, 0xC4, 0x87 },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC3, 0xA5 },
+	{ 2, 0xC4, 0x99 }, { 2, 0xC4, 0x93 },
+	{ 2, 0xC4, 0x8D }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC5, 0xBA }, { 2, 0xC4, 0x97 },
+	{ 2, 0xC4, 0xA3 }, { 2, 0xC4, 0xB7 },
+	{ 2, 0xC4, 0xAB }, { 2, 0xC4, 0xBC },
+	{ 2, 0xC5, 0xA1 }, { 2, 0xC5, 0x84 },
+	{ 2, 0xC5, 0x86 }, { 2, 0xC3, 0xB3 },
+	{ 2, 0xC5, 0x8D }, { 2, 0xC3, 0xB5 },
+	{ 2, 0xC3, 0xB6 }, { 2, 0xC3, 0xB7 },
+	{ 2, 0xC5, 0xB3 }, { 2, 0xC5, 0x82 },
+	{ 2, 0xC5, 0x9B }, { 2, 0xC5, 0xAB },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC5, 0xBC },
+	{ 2, 0xC5, 0xBE }, { 2, 0xCB, 0x99 }
+};
+
+static const uint8_t windows_1258[128][4] = {
+	{ 3, 0xE2, 0x82, 0xAC }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xE2, 0x80, 0x9A }, { 2, 0xC6, 0x92 },
+	{ 3, 0xE2, 0x80, 0x9E }, { 3, 0xE2, 0x80, 0xA6 },
+	{ 3, 0xE2, 0x80, 0xA0 }, { 3, 0xE2, 0x80, 0xA1 },
+	{ 2, 0xCB, 0x86 }, { 3, 0xE2, 0x80, 0xB0 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0xB9 },
+	{ 2, 0xC5, 0x92 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0x98 },
+	{ 3, 0xE2, 0x80, 0x99 }, { 3, 0xE2, 0x80, 0x9C },
+	{ 3, 0xE2, 0x80, 0x9D }, { 3, 0xE2, 0x80, 0xA2 },
+	{ 3, 0xE2, 0x80, 0x93 }, { 3, 0xE2, 0x80, 0x94 },
+	{ 2, 0xCB, 0x9C }, { 3, 0xE2, 0x84, 0xA2 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0xBA },
+	{ 2, 0xC5, 0x93 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xC5, 0xB8 },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xC2, 0xA1 },
+	{ 2, 0xC2, 0xA2 }, { 2, 0xC2, 0xA3 },
+	{ 2, 0xC2, 0xA4 }, { 2, 0xC2, 0xA5 },
+	{ 2, 0xC2, 0xA6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC2, 0xA8 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xC2, 0xAA }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 2, 0xC2, 0xAF },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xC2, 0xB2 }, { 2, 0xC2, 0xB3 },
+	{ 2, 0xC2, 0xB4 }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC2, 0xB8 }, { 2, 0xC2, 0xB9 },
+	{ 2, 0xC2, 0xBA }, { 2, 0xC2, 0xBB },
+	{ 2, 0xC2, 0xBC }, { 2, 0xC2, 0xBD },
+	{ 2, 0xC2, 0xBE }, { 2, 0xC2, 0xBF },
+	{ 2, 0xC3, 0x80 }, { 2, 0xC3, 0x81 },
+	{ 2, 0xC3, 0x82 }, { 2, 0xC4, 0x82 },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC3, 0x85 },
+	{ 2, 0xC3, 0x86 }, { 2, 0xC3, 0x87 },
+	{ 2, 0xC3, 0x88 }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC3, 0x8A }, { 2, 0xC3, 0x8B },
+	{ 2, 0xCC, 0x80 }, { 2, 0xC3, 0x8D },
+	{ 2, 0xC3, 0x8E }, { 2, 0xC3, 0x8F },
+	{ 2, 0xC4, 0x90 }, { 2, 0xC3, 0x91 },
+	{ 2, 0xCC, 0x89 }, { 2, 0xC3, 0x93 },
+	{ 2, 0xC3, 0x94 }, { 2, 0xC6, 0xA0 },
+	{ 2, 0xC3, 0x96 }, { 2, 0xC3, 0x97 },
+	{ 2, 0xC3, 0x98 }, { 2, 0xC3, 0x99 },
+	{ 2, 0xC3, 0x9A }, { 2, 0xC3, 0x9B },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC6, 0xAF },
+	{ 2, 0xCC, 0x83 }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC3, 0xA0 }, { 2, 0xC3, 0xA1 },
+	{ 2, 0xC3, 0xA2 }, { 2, 0xC4, 0x83 },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC3, 0xA5 },
+	{ 2, 0xC3, 0xA6 }, { 2, 0xC3, 0xA7 },
+	{ 2, 0xC3, 0xA8 }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC3, 0xAA }, { 2, 0xC3, 0xAB },
+	{ 2, 0xCC, 0x81 }, { 2, 0xC3, 0xAD },
+	{ 2, 0xC3, 0xAE }, { 2, 0xC3, 0xAF },
+	{ 2, 0xC4, 0x91 }, { 2, 0xC3, 0xB1 },
+	{ 2, 0xCC, 0xA3 }, { 2, 0xC3, 0xB3 },
+	{ 2, 0xC3, 0xB4 }, { 2, 0xC6, 0xA1 },
+	{ 2, 0xC3, 0xB6 }, { 2, 0xC3, 0xB7 },
+	{ 2, 0xC3, 0xB8 }, { 2, 0xC3, 0xB9 },
+	{ 2, 0xC3, 0xBA }, { 2, 0xC3, 0xBB },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC6, 0xB0 },
+	{ 3, 0xE2, 0x82, 0xAB }, { 2, 0xC3, 0xBF }
+};
+
+static const uint8_t iso_8859_1[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xC2, 0xA1 },
+	{ 2, 0xC2, 0xA2 }, { 2, 0xC2, 0xA3 },
+	{ 2, 0xC2, 0xA4 }, { 2, 0xC2, 0xA5 },
+	{ 2, 0xC2, 0xA6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC2, 0xA8 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xC2, 0xAA }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 2, 0xC2, 0xAF },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xC2, 0xB2 }, { 2, 0xC2, 0xB3 },
+	{ 2, 0xC2, 0xB4 }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC2, 0xB8 }, { 2, 0xC2, 0xB9 },
+	{ 2, 0xC2, 0xBA }, { 2, 0xC2, 0xBB },
+	{ 2, 0xC2, 0xBC }, { 2, 0xC2, 0xBD },
+	{ 2, 0xC2, 0xBE }, { 2, 0xC2, 0xBF },
+	{ 2, 0xC3, 0x80 }, { 2, 0xC3, 0x81 },
+	{ 2, 0xC3, 0x82 }, { 2, 0xC3, 0x83 },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC3, 0x85 },
+	{ 2, 0xC3, 0x86 }, { 2, 0xC3, 0x87 },
+	{ 2, 0xC3, 0x88 }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC3, 0x8A }, { 2, 0xC3, 0x8B },
+	{ 2, 0xC3, 0x8C }, { 2, 0xC3, 0x8D },
+	{ 2, 0xC3, 0x8E }, { 2, 0xC3, 0x8F },
+	{ 2, 0xC3, 0x90 }, { 2, 0xC3, 0x91 },
+	{ 2, 0xC3, 0x92 }, { 2, 0xC3, 0x93 },
+	{ 2, 0xC3, 0x94 }, { 2, 0xC3, 0x95 },
+	{ 2, 0xC3, 0x96 }, { 2, 0xC3, 0x97 },
+	{ 2, 0xC3, 0x98 }, { 2, 0xC3, 0x99 },
+	{ 2, 0xC3, 0x9A }, { 2, 0xC3, 0x9B },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC3, 0x9D },
+	{ 2, 0xC3, 0x9E }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC3, 0xA0 }, { 2, 0xC3, 0xA1 },
+	{ 2, 0xC3, 0xA2 }, { 2, 0xC3, 0xA3 },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC3, 0xA5 },
+	{ 2, 0xC3, 0xA6 }, { 2, 0xC3, 0xA7 },
+	{ 2, 0xC3, 0xA8 }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC3, 0xAA }, { 2, 0xC3, 0xAB },
+	{ 2, 0xC3, 0xAC }, { 2, 0xC3, 0xAD },
+	{ 2, 0xC3, 0xAE }, { 2, 0xC3, 0xAF },
+	{ 2, 0xC3, 0xB0 }, { 2, 0xC3, 0xB1 },
+	{ 2, 0xC3, 0xB2 }, { 2, 0xC3, 0xB3 },
+	{ 2, 0xC3, 0xB4 }, { 2, 0xC3, 0xB5 },
+	{ 2, 0xC3, 0xB6 }, { 2, 0xC3, 0xB7 },
+	{ 2, 0xC3, 0xB8 }, { 2, 0xC3, 0xB9 },
+	{ 2, 0xC3, 0xBA }, { 2, 0xC3, 0xBB },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC3, 0xBD },
+	{ 2, 0xC3, 0xBE }, { 2, 0xC3, 0xBF }
+};
+
+static const uint8_t iso_8859_2[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xC4, 0x84 },
+	{ 2, 0xCB, 0x98 }, { 2, 0xC5, 0x81 },
+	{ 2, 0xC2, 0xA4 }, { 2, 0xC4, 0xBD },
+	{ 2, 0xC5, 0x9A }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC2, 0xA8 }, { 2, 0xC5, 0xA0 },
+	{ 2, 0xC5, 0x9E }, { 2, 0xC5, 0xA4 },
+	{ 2, 0xC5, 0xB9 }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC5, 0xBD }, { 2, 0xC5, 0xBB },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC4, 0x85 },
+	{ 2, 0xCB, 0x9B }, { 2, 0xC5, 0x82 },
+	{ 2, 0xC2, 0xB4 }, { 2, 0xC4, 0xBE },
+	{ 2, 0xC5, 0x9B }, { 2, 0xCB, 0x87 },
+	{ 2, 0xC2, 0xB8 }, { 2, 0xC5, 0xA1 },
+	{ 2, 0xC5, 0x9F }, { 2, 0xC5, 0xA5 },
+	{ 2, 0xC5, 0xBA }, { 2, 0xCB, 0x9D },
+	{ 2, 0xC5, 0xBE }, { 2, 0xC5, 0xBC },
+	{ 2, 0xC5, 0x94 }, { 2, 0xC3, 0x81 },
+	{ 2, 0xC3, 0x82 }, { 2, 0xC4, 0x82 },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC4, 0xB9 },
+	{ 2, 0xC4, 0x86 }, { 2, 0xC3, 0x87 },
+	{ 2, 0xC4, 0x8C }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC4, 0x98 }, { 2, 0xC3, 0x8B },
+	{ 2, 0xC4, 0x9A }, { 2, 0xC3, 0x8D },
+	{ 2, 0xC3, 0x8E }, { 2, 0xC4, 0x8E },
+	{ 2, 0xC4, 0x90 }, { 2, 0xC5, 0x83 },
+	{ 2, 0xC5, 0x87 }, { 2, 0xC3, 0x93 },
+	{ 2, 0xC3, 0x94 }, { 2, 0xC5, 0x90 },
+	{ 2, 0xC3, 0x96 }, { 2, 0xC3, 0x97 },
+	{ 2, 0xC5, 0x98 }, { 2, 0xC5, 0xAE },
+	{ 2, 0xC3, 0x9A }, { 2, 0xC5, 0xB0 },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC3, 0x9D },
+	{ 2, 0xC5, 0xA2 }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC5, 0x95 }, { 2, 0xC3, 0xA1 },
+	{ 2, 0xC3, 0xA2 }, { 2, 0xC4, 0x83 },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC4, 0xBA },
+	{ 2, 0xC4, 0x87 }, { 2, 0xC3, 0xA7 },
+	{ 2, 0xC4, 0x8D }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC4, 0x99 }, { 2, 0xC3, 0xAB },
+	{ 2, 0xC4, 0x9B }, { 2, 0xC3, 0xAD },
+	{ 2, 0xC3, 0xAE }, { 2, 0xC4, 0x8F },
+	{ 2, 0xC4, 0x91 }, { 2, 0xC5, 0x84 },
+	{ 2, 0xC5, 0x88 }, { 2, 0xC3, 0xB3 },
+	{ 2, 0xC3, 0xB4 }, { 2, 0xC5, 0x91 },
+	{ 2, 0xC3, 0xB6 }, { 2, 0xC3, 0xB7 },
+	{ 2, 0xC5, 0x99 }, { 2, 0xC5, 0xAF },
+	{ 2, 0xC3, 0xBA }, { 2, 0xC5, 0xB1 },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC3, 0xBD },
+	{ 2, 0xC5, 0xA3 }, { 2, 0xCB, 0x99 }
+};
+
+static const uint8_t iso_8859_3[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xC4, 0xA6 },
+	{ 2, 0xCB, 0x98 }, { 2, 0xC2, 0xA3 },
+	{ 2, 0xC2, 0xA4 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xC4, 0xA4 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC2, 0xA8 }, { 2, 0xC4, 0xB0 },
+	{ 2, 0xC5, 0x9E }, { 2, 0xC4, 0x9E },
+	{ 2, 0xC4, 0xB4 }, { 2, 0xC2, 0xAD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xC5, 0xBB },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC4, 0xA7 },
+	{ 2, 0xC2, 0xB2 }, { 2, 0xC2, 0xB3 },
+	{ 2, 0xC2, 0xB4 }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC4, 0xA5 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC2, 0xB8 }, { 2, 0xC4, 0xB1 },
+	{ 2, 0xC5, 0x9F }, { 2, 0xC4, 0x9F },
+	{ 2, 0xC4, 0xB5 }, { 2, 0xC2, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xC5, 0xBC },
+	{ 2, 0xC3, 0x80 }, { 2, 0xC3, 0x81 },
+	{ 2, 0xC3, 0x82 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC4, 0x8A },
+	{ 2, 0xC4, 0x88 }, { 2, 0xC3, 0x87 },
+	{ 2, 0xC3, 0x88 }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC3, 0x8A }, { 2, 0xC3, 0x8B },
+	{ 2, 0xC3, 0x8C }, { 2, 0xC3, 0x8D },
+	{ 2, 0xC3, 0x8E }, { 2, 0xC3, 0x8F },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xC3, 0x91 },
+	{ 2, 0xC3, 0x92 }, { 2, 0xC3, 0x93 },
+	{ 2, 0xC3, 0x94 }, { 2, 0xC4, 0xA0 },
+	{ 2, 0xC3, 0x96 }, { 2, 0xC3, 0x97 },
+	{ 2, 0xC4, 0x9C }, { 2, 0xC3, 0x99 },
+	{ 2, 0xC3, 0x9A }, { 2, 0xC3, 0x9B },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC5, 0xAC },
+	{ 2, 0xC5, 0x9C }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC3, 0xA0 }, { 2, 0xC3, 0xA1 },
+	{ 2, 0xC3, 0xA2 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC4, 0x8B },
+	{ 2, 0xC4, 0x89 }, { 2, 0xC3, 0xA7 },
+	{ 2, 0xC3, 0xA8 }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC3, 0xAA }, { 2, 0xC3, 0xAB },
+	{ 2, 0xC3, 0xAC }, { 2, 0xC3, 0xAD },
+	{ 2, 0xC3, 0xAE }, { 2, 0xC3, 0xAF },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xC3, 0xB1 },
+	{ 2, 0xC3, 0xB2 }, { 2, 0xC3, 0xB3 },
+	{ 2, 0xC3, 0xB4 }, { 2, 0xC4, 0xA1 },
+	{ 2, 0xC3, 0xB6 }, { 2, 0xC3, 0xB7 },
+	{ 2, 0xC4, 0x9D }, { 2, 0xC3, 0xB9 },
+	{ 2, 0xC3, 0xBA }, { 2, 0xC3, 0xBB },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC5, 0xAD },
+	{ 2, 0xC5, 0x9D }, { 2, 0xCB, 0x99 }
+};
+
+static const uint8_t iso_8859_4[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xC4, 0x84 },
+	{ 2, 0xC4, 0xB8 }, { 2, 0xC5, 0x96 },
+	{ 2, 0xC2, 0xA4 }, { 2, 0xC4, 0xA8 },
+	{ 2, 0xC4, 0xBB }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC2, 0xA8 }, { 2, 0xC5, 0xA0 },
+	{ 2, 0xC4, 0x92 }, { 2, 0xC4, 0xA2 },
+	{ 2, 0xC5, 0xA6 }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC5, 0xBD }, { 2, 0xC2, 0xAF },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC4, 0x85 },
+	{ 2, 0xCB, 0x9B }, { 2, 0xC5, 0x97 },
+	{ 2, 0xC2, 0xB4 }, { 2, 0xC4, 0xA9 },
+	{ 2, 0xC4, 0xBC }, { 2, 0xCB, 0x87 },
+	{ 2, 0xC2, 0xB8 }, { 2, 0xC5, 0xA1 },
+	{ 2, 0xC4, 0x93 }, { 2, 0xC4, 0xA3 },
+	{ 2, 0xC5, 0xA7 }, { 2, 0xC5, 0x8A },
+	{ 2, 0xC5, 0xBE }, { 2, 0xC5, 0x8B },
+	{ 2, 0xC4, 0x80 }, { 2, 0xC3, 0x81 },
+	{ 2, 0xC3, 0x82 }, { 2, 0xC3, 0x83 },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC3, 0x85 },
+	{ 2, 0xC3, 0x86 }, { 2, 0xC4, 0xAE },
+	{ 2, 0xC4, 0x8C }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC4, 0x98 }, { 2, 0xC3, 0x8B },
+	{ 2, 0xC4, 0x96 }, { 2, 0xC3, 0x8D },
+	{ 2, 0xC3, 0x8E }, { 2, 0xC4, 0xAA },
+	{ 2, 0xC4, 0x90 }, { 2, 0xC5, 0x85 },
+	{ 2, 0xC5, 0x8C }, { 2, 0xC4, 0xB6 },
+	{ 2, 0xC3, 0x94 }, { 2, 0xC3, 0x95 },
+	{ 2, 0xC3, 0x96 }, { 2, 0xC3, 0x97 },
+	{ 2, 0xC3, 0x98 }, { 2, 0xC5, 0xB2 },
+	{ 2, 0xC3, 0x9A }, { 2, 0xC3, 0x9B },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC5, 0xA8 },
+	{ 2, 0xC5, 0xAA }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC4, 0x81 }, { 2, 0xC3, 0xA1 },
+	{ 2, 0xC3, 0xA2 }, { 2, 0xC3, 0xA3 },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC3, 0xA5 },
+	{ 2, 0xC3, 0xA6 }, { 2, 0xC4, 0xAF },
+	{ 2, 0xC4, 0x8D }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC4, 0x99 }, { 2, 0xC3, 0xAB },
+	{ 2, 0xC4, 0x97 }, { 2, 0xC3, 0xAD },
+	{ 2, 0xC3, 0xAE }, { 2, 0xC4, 0xAB },
+	{ 2, 0xC4, 0x91 }, { 2, 0xC5, 0x86 },
+	{ 2, 0xC5, 0x8D }, { 2, 0xC4, 0xB7 },
+	{ 2, 0xC3, 0xB4 }, { 2, 0xC3, 0xB5 },
+	{ 2, 0xC3, 0xB6 }, { 2, 0xC3, 0xB7 },
+	{ 2, 0xC3, 0xB8 }, { 2, 0xC5, 0xB3 },
+	{ 2, 0xC3, 0xBA }, { 2, 0xC3, 0xBB },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC5, 0xA9 },
+	{ 2, 0xC5, 0xAB }, { 2, 0xCB, 0x99 }
+};
+
+static const uint8_t iso_8859_5[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xD0, 0x81 },
+	{ 2, 0xD0, 0x82 }, { 2, 0xD0, 0x83 },
+	{ 2, 0xD0, 0x84 }, { 2, 0xD0, 0x85 },
+	{ 2, 0xD0, 0x86 }, { 2, 0xD0, 0x87 },
+	{ 2, 0xD0, 0x88 }, { 2, 0xD0, 0x89 },
+	{ 2, 0xD0, 0x8A }, { 2, 0xD0, 0x8B },
+	{ 2, 0xD0, 0x8C }, { 2, 0xC2, 0xAD },
+	{ 2, 0xD0, 0x8E }, { 2, 0xD0, 0x8F },
+	{ 2, 0xD0, 0x90 }, { 2, 0xD0, 0x91 },
+	{ 2, 0xD0, 0x92 }, { 2, 0xD0, 0x93 },
+	{ 2, 0xD0, 0x94 }, { 2, 0xD0, 0x95 },
+	{ 2, 0xD0, 0x96 }, { 2, 0xD0, 0x97 },
+	{ 2, 0xD0, 0x98 }, { 2, 0xD0, 0x99 },
+	{ 2, 0xD0, 0x9A }, { 2, 0xD0, 0x9B },
+	{ 2, 0xD0, 0x9C }, { 2, 0xD0, 0x9D },
+	{ 2, 0xD0, 0x9E }, { 2, 0xD0, 0x9F },
+	{ 2, 0xD0, 0xA0 }, { 2, 0xD0, 0xA1 },
+	{ 2, 0xD0, 0xA2 }, { 2, 0xD0, 0xA3 },
+	{ 2, 0xD0, 0xA4 }, { 2, 0xD0, 0xA5 },
+	{ 2, 0xD0, 0xA6 }, { 2, 0xD0, 0xA7 },
+	{ 2, 0xD0, 0xA8 }, { 2, 0xD0, 0xA9 },
+	{ 2, 0xD0, 0xAA }, { 2, 0xD0, 0xAB },
+	{ 2, 0xD0, 0xAC }, { 2, 0xD0, 0xAD },
+	{ 2, 0xD0, 0xAE }, { 2, 0xD0, 0xAF },
+	{ 2, 0xD0, 0xB0 }, { 2, 0xD0, 0xB1 },
+	{ 2, 0xD0, 0xB2 }, { 2, 0xD0, 0xB3 },
+	{ 2, 0xD0, 0xB4 }, { 2, 0xD0, 0xB5 },
+	{ 2, 0xD0, 0xB6 }, { 2, 0xD0, 0xB7 },
+	{ 2, 0xD0, 0xB8 }, { 2, 0xD0, 0xB9 },
+	{ 2, 0xD0, 0xBA }, { 2, 0xD0, 0xBB },
+	{ 2, 0xD0, 0xBC }, { 2, 0xD0, 0xBD },
+	{ 2, 0xD0, 0xBE }, { 2, 0xD0, 0xBF },
+	{ 2, 0xD1, 0x80 }, { 2, 0xD1, 0x81 },
+	{ 2, 0xD1, 0x82 }, { 2, 0xD1, 0x83 },
+	{ 2, 0xD1, 0x84 }, { 2, 0xD1, 0x85 },
+	{ 2, 0xD1, 0x86 }, { 2, 0xD1, 0x87 },
+	{ 2, 0xD1, 0x88 }, { 2, 0xD1, 0x89 },
+	{ 2, 0xD1, 0x8A }, { 2, 0xD1, 0x8B },
+	{ 2, 0xD1, 0x8C }, { 2, 0xD1, 0x8D },
+	{ 2, 0xD1, 0x8E }, { 2, 0xD1, 0x8F },
+	{ 3, 0xE2, 0x84, 0x96 }, { 2, 0xD1, 0x91 },
+	{ 2, 0xD1, 0x92 }, { 2, 0xD1, 0x93 },
+	{ 2, 0xD1, 0x94 }, { 2, 0xD1, 0x95 },
+	{ 2, 0xD1, 0x96 }, { 2, 0xD1, 0x97 },
+	{ 2, 0xD1, 0x98 }, { 2, 0xD1, 0x99 },
+	{ 2, 0xD1, 0x9A }, { 2, 0xD1, 0x9B },
+	{ 2, 0xD1, 0x9C }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xD1, 0x9E }, { 2, 0xD1, 0x9F }
+};
+
+static const uint8_t iso_8859_6[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xC2, 0xA4 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xD8, 0x8C }, { 2, 0xC2, 0xAD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xD8, 0x9B },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xD8, 0x9F },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xD8, 0xA1 },
+	{ 2, 0xD8, 0xA2 }, { 2, 0xD8, 0xA3 },
+	{ 2, 0xD8, 0xA4 }, { 2, 0xD8, 0xA5 },
+	{ 2, 0xD8, 0xA6 }, { 2, 0xD8, 0xA7 },
+	{ 2, 0xD8, 0xA8 }, { 2, 0xD8, 0xA9 },
+	{ 2, 0xD8, 0xAA }, { 2, 0xD8, 0xAB },
+	{ 2, 0xD8, 0xAC }, { 2, 0xD8, 0xAD },
+	{ 2, 0xD8, 0xAE }, { 2, 0xD8, 0xAF },
+	{ 2, 0xD8, 0xB0 }, { 2, 0xD8, 0xB1 },
+	{ 2, 0xD8, 0xB2 }, { 2, 0xD8, 0xB3 },
+	{ 2, 0xD8, 0xB4 }, { 2, 0xD8, 0xB5 },
+	{ 2, 0xD8, 0xB6 }, { 2, 0xD8, 0xB7 },
+	{ 2, 0xD8, 0xB8 }, { 2, 0xD8, 0xB9 },
+	{ 2, 0xD8, 0xBA }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xD9, 0x80 }, { 2, 0xD9, 0x81 },
+	{ 2, 0xD9, 0x82 }, { 2, 0xD9, 0x83 },
+	{ 2, 0xD9, 0x84 }, { 2, 0xD9, 0x85 },
+	{ 2, 0xD9, 0x86 }, { 2, 0xD9, 0x87 },
+	{ 2, 0xD9, 0x88 }, { 2, 0xD9, 0x89 },
+	{ 2, 0xD9, 0x8A }, { 2, 0xD9, 0x8B },
+	{ 2, 0xD9, 0x8C }, { 2, 0xD9, 0x8D },
+	{ 2, 0xD9, 0x8E }, { 2, 0xD9, 0x8F },
+	{ 2, 0xD9, 0x90 }, { 2, 0xD9, 0x91 },
+	{ 2, 0xD9, 0x92 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD }
+};
+
+static const uint8_t iso_8859_7[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 3, 0xE2, 0x80, 0x98 },
+	{ 3, 0xE2, 0x80, 0x99 }, { 2, 0xC2, 0xA3 },
+	{ 3, 0xE2, 0x82, 0xAC }, { 3, 0xE2, 0x82, 0xAF },
+	{ 2, 0xC2, 0xA6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC2, 0xA8 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xCD, 0xBA }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0x95 },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xC2, 0xB2 }, { 2, 0xC2, 0xB3 },
+	{ 2, 0xCE, 0x84 }, { 2, 0xCE, 0x85 },
+	{ 2, 0xCE, 0x86 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xCE, 0x88 }, { 2, 0xCE, 0x89 },
+	{ 2, 0xCE, 0x8A }, { 2, 0xC2, 0xBB },
+	{ 2, 0xCE, 0x8C }, { 2, 0xC2, 0xBD },
+	{ 2, 0xCE, 0x8E }, { 2, 0xCE, 0x8F },
+	{ 2, 0xCE, 0x90 }, { 2, 0xCE, 0x91 },
+	{ 2, 0xCE, 0x92 }, { 2, 0xCE, 0x93 },
+	{ 2, 0xCE, 0x94 }, { 2, 0xCE, 0x95 },
+	{ 2, 0xCE, 0x96 }, { 2, 0xCE, 0x97 },
+	{ 2, 0xCE, 0x98 }, { 2, 0xCE, 0x99 },
+	{ 2, 0xCE, 0x9A }, { 2, 0xCE, 0x9B },
+	{ 2, 0xCE, 0x9C }, { 2, 0xCE, 0x9D },
+	{ 2, 0xCE, 0x9E }, { 2, 0xCE, 0x9F },
+	{ 2, 0xCE, 0xA0 }, { 2, 0xCE, 0xA1 },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 2, 0xCE, 0xA3 },
+	{ 2, 0xCE, 0xA4 }, { 2, 0xCE, 0xA5 },
+	{ 2, 0xCE, 0xA6 }, { 2, 0xCE, 0xA7 },
+	{ 2, 0xCE, 0xA8 }, { 2, 0xCE, 0xA9 },
+	{ 2, 0xCE, 0xAA }, { 2, 0xCE, 0xAB },
+	{ 2, 0xCE, 0xAC }, { 2, 0xCE, 0xAD },
+	{ 2, 0xCE, 0xAE }, { 2, 0xCE, 0xAF },
+	{ 2, 0xCE, 0xB0 }, { 2, 0xCE, 0xB1 },
+	{ 2, 0xCE, 0xB2 }, { 2, 0xCE, 0xB3 },
+	{ 2, 0xCE, 0xB4 }, { 2, 0xCE, 0xB5 },
+	{ 2, 0xCE, 0xB6 }, { 2, 0xCE, 0xB7 },
+	{ 2, 0xCE, 0xB8 }, { 2, 0xCE, 0xB9 },
+	{ 2, 0xCE, 0xBA }, { 2, 0xCE, 0xBB },
+	{ 2, 0xCE, 0xBC }, { 2, 0xCE, 0xBD },
+	{ 2, 0xCE, 0xBE }, { 2, 0xCE, 0xBF },
+	{ 2, 0xCF, 0x80 }, { 2, 0xCF, 0x81 },
+	{ 2, 0xCF, 0x82 }, { 2, 0xCF, 0x83 },
+	{ 2, 0xCF, 0x84 }, { 2, 0xCF, 0x85 },
+	{ 2, 0xCF, 0x86 }, { 2, 0xCF, 0x87 },
+	{ 2, 0xCF, 0x88 }, { 2, 0xCF, 0x89 },
+	{ 2, 0xCF, 0x8A }, { 2, 0xCF, 0x8B },
+	{ 2, 0xCF, 0x8C }, { 2, 0xCF, 0x8D },
+	{ 2, 0xCF, 0x8E }, { 3, 0xEF, 0xBF, 0xBD }
+};
+
+static const uint8_t iso_8859_8[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 2, 0xC2, 0xA2 }, { 2, 0xC2, 0xA3 },
+	{ 2, 0xC2, 0xA4 }, { 2, 0xC2, 0xA5 },
+	{ 2, 0xC2, 0xA6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC2, 0xA8 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xC3, 0x97 }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 2, 0xC2, 0xAF },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xC2, 0xB2 }, { 2, 0xC2, 0xB3 },
+	{ 2, 0xC2, 0xB4 }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC2, 0xB8 }, { 2, 0xC2, 0xB9 },
+	{ 2, 0xC3, 0xB7 }, { 2, 0xC2, 0xBB },
+	{ 2, 0xC2, 0xBC }, { 2, 0xC2, 0xBD },
+	{ 2, 0xC2, 0xBE }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0x97 },
+	{ 2, 0xD7, 0x90 }, { 2, 0xD7, 0x91 },
+	{ 2, 0xD7, 0x92 }, { 2, 0xD7, 0x93 },
+	{ 2, 0xD7, 0x94 }, { 2, 0xD7, 0x95 },
+	{ 2, 0xD7, 0x96 }, { 2, 0xD7, 0x97 },
+	{ 2, 0xD7, 0x98 }, { 2, 0xD7, 0x99 },
+	{ 2, 0xD7, 0x9A }, { 2, 0xD7, 0x9B },
+	{ 2, 0xD7, 0x9C }, { 2, 0xD7, 0x9D },
+	{ 2, 0xD7, 0x9E }, { 2, 0xD7, 0x9F },
+	{ 2, 0xD7, 0xA0 }, { 2, 0xD7, 0xA1 },
+	{ 2, 0xD7, 0xA2 }, { 2, 0xD7, 0xA3 },
+	{ 2, 0xD7, 0xA4 }, { 2, 0xD7, 0xA5 },
+	{ 2, 0xD7, 0xA6 }, { 2, 0xD7, 0xA7 },
+	{ 2, 0xD7, 0xA8 }, { 2, 0xD7, 0xA9 },
+	{ 2, 0xD7, 0xAA }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE2, 0x80, 0x8E },
+	{ 3, 0xE2, 0x80, 0x8F }, { 3, 0xEF, 0xBF, 0xBD }
+};
+
+static const uint8_t iso_8859_9[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xC2, 0xA1 },
+	{ 2, 0xC2, 0xA2 }, { 2, 0xC2, 0xA3 },
+	{ 2, 0xC2, 0xA4 }, { 2, 0xC2, 0xA5 },
+	{ 2, 0xC2, 0xA6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC2, 0xA8 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xC2, 0xAA }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 2, 0xC2, 0xAF },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xC2, 0xB2 }, { 2, 0xC2, 0xB3 },
+	{ 2, 0xC2, 0xB4 }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC2, 0xB8 }, { 2, 0xC2, 0xB9 },
+	{ 2, 0xC2, 0xBA }, { 2, 0xC2, 0xBB },
+	{ 2, 0xC2, 0xBC }, { 2, 0xC2, 0xBD },
+	{ 2, 0xC2, 0xBE }, { 2, 0xC2, 0xBF },
+	{ 2, 0xC3, 0x80 }, { 2, 0xC3, 0x81 },
+	{ 2, 0xC3, 0x82 }, { 2, 0xC3, 0x83 },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC3, 0x85 },
+	{ 2, 0xC3, 0x86 }, { 2, 0xC3, 0x87 },
+	{ 2, 0xC3, 0x88 }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC3, 0x8A }, { 2, 0xC3, 0x8B },
+	{ 2, 0xC3, 0x8C }, { 2, 0xC3, 0x8D },
+	{ 2, 0xC3, 0x8E }, { 2, 0xC3, 0x8F },
+	{ 2, 0xC4, 0x9E }, { 2, 0xC3, 0x91 },
+	{ 2, 0xC3, 0x92 }, { 2, 0xC3, 0x93 },
+	{ 2, 0xC3, 0x94 }, { 2, 0xC3, 0x95 },
+	{ 2, 0xC3, 0x96 }, { 2, 0xC3, 0x97 },
+	{ 2, 0xC3, 0x98 }, { 2, 0xC3, 0x99 },
+	{ 2, 0xC3, 0x9A }, { 2, 0xC3, 0x9B },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC4, 0xB0 },
+	{ 2, 0xC5, 0x9E }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC3, 0xA0 }, { 2, 0xC3, 0xA1 },
+	{ 2, 0xC3, 0xA2 }, { 2, 0xC3, 0xA3 },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC3, 0xA5 },
+	{ 2, 0xC3, 0xA6 }, { 2, 0xC3, 0xA7 },
+	{ 2, 0xC3, 0xA8 }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC3, 0xAA }, { 2, 0xC3, 0xAB },
+	{ 2, 0xC3, 0xAC }, { 2, 0xC3, 0xAD },
+	{ 2, 0xC3, 0xAE }, { 2, 0xC3, 0xAF },
+	{ 2, 0xC4, 0x9F }, { 2, 0xC3, 0xB1 },
+	{ 2, 0xC3, 0xB2 }, { 2, 0xC3, 0xB3 },
+	{ 2, 0xC3, 0xB4 }, { 2, 0xC3, 0xB5 },
+	{ 2, 0xC3, 0xB6 }, { 2, 0xC3, 0xB7 },
+	{ 2, 0xC3, 0xB8 }, { 2, 0xC3, 0xB9 },
+	{ 2, 0xC3, 0xBA }, { 2, 0xC3, 0xBB },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC4, 0xB1 },
+	{ 2, 0xC5, 0x9F }, { 2, 0xC3, 0xBF }
+};
+
+static const uint8_t iso_8859_10[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xC4, 0x84 },
+	{ 2, 0xC4, 0x92 }, { 2, 0xC4, 0xA2 },
+	{ 2, 0xC4, 0xAA }, { 2, 0xC4, 0xA8 },
+	{ 2, 0xC4, 0xB6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC4, 0xBB }, { 2, 0xC4, 0x90 },
+	{ 2, 0xC5, 0xA0 }, { 2, 0xC5, 0xA6 },
+	{ 2, 0xC5, 0xBD }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC5, 0xAA }, { 2, 0xC5, 0x8A },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC4, 0x85 },
+	{ 2, 0xC4, 0x93 }, { 2, 0xC4, 0xA3 },
+	{ 2, 0xC4, 0xAB }, { 2, 0xC4, 0xA9 },
+	{ 2, 0xC4, 0xB7 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC4, 0xBC }, { 2, 0xC4, 0x91 },
+	{ 2, 0xC5, 0xA1 }, { 2, 0xC5, 0xA7 },
+	{ 2, 0xC5, 0xBE }, { 3, 0xE2, 0x80, 0x95 },
+	{ 2, 0xC5, 0xAB }, { 2, 0xC5, 0x8B },
+	{ 2, 0xC4, 0x80 }, { 2, 0xC3, 0x81 },
+	{ 2, 0xC3, 0x82 }, { 2, 0xC3, 0x83 },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC3, 0x85 },
+	{ 2, 0xC3, 0x86 }, { 2, 0xC4, 0xAE },
+	{ 2, 0xC4, 0x8C }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC4, 0x98 }, { 2, 0xC3, 0x8B },
+	{ 2, 0xC4, 0x96 }, { 2, 0xC3, 0x8D },
+	{ 2, 0xC3, 0x8E }, { 2, 0xC3, 0x8F },
+	{ 2, 0xC3, 0x90 }, { 2, 0xC5, 0x85 },
+	{ 2, 0xC5, 0x8C }, { 2, 0xC3, 0x93 },
+	{ 2, 0xC3, 0x94 }, { 2, 0xC3, 0x95 },
+	{ 2, 0xC3, 0x96 }, { 2, 0xC5, 0xA8 },
+	{ 2, 0xC3, 0x98 }, { 2, 0xC5, 0xB2 },
+	{ 2, 0xC3, 0x9A }, { 2, 0xC3, 0x9B },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC3, 0x9D },
+	{ 2, 0xC3, 0x9E }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC4, 0x81 }, { 2, 0xC3, 0xA1 },
+	{ 2, 0xC3, 0xA2 }, { 2, 0xC3, 0xA3 },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC3, 0xA5 },
+	{ 2, 0xC3, 0xA6 }, { 2, 0xC4, 0xAF },
+	{ 2, 0xC4, 0x8D }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC4, 0x99 }, { 2, 0xC3, 0xAB },
+	{ 2, 0xC4, 0x97 }, { 2, 0xC3, 0xAD },
+	{ 2, 0xC3, 0xAE }, { 2, 0xC3, 0xAF },
+	{ 2, 0xC3, 0xB0 }, { 2, 0xC5, 0x86 },
+	{ 2, 0xC5, 0x8D }, { 2, 0xC3, 0xB3 },
+	{ 2, 0xC3, 0xB4 }, { 2, 0xC3, 0xB5 },
+	{ 2, 0xC3, 0xB6 }, { 2, 0xC5, 0xA9 },
+	{ 2, 0xC3, 0xB8 }, { 2, 0xC5, 0xB3 },
+	{ 2, 0xC3, 0xBA }, { 2, 0xC3, 0xBB },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC3, 0xBD },
+	{ 2, 0xC3, 0xBE }, { 2, 0xC4, 0xB8 }
+};
+
+static const uint8_t iso_8859_11[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 3, 0xE0, 0xB8, 0x81 },
+	{ 3, 0xE0, 0xB8, 0x82 }, { 3, 0xE0, 0xB8, 0x83 },
+	{ 3, 0xE0, 0xB8, 0x84 }, { 3, 0xE0, 0xB8, 0x85 },
+	{ 3, 0xE0, 0xB8, 0x86 }, { 3, 0xE0, 0xB8, 0x87 },
+	{ 3, 0xE0, 0xB8, 0x88 }, { 3, 0xE0, 0xB8, 0x89 },
+	{ 3, 0xE0, 0xB8, 0x8A }, { 3, 0xE0, 0xB8, 0x8B },
+	{ 3, 0xE0, 0xB8, 0x8C }, { 3, 0xE0, 0xB8, 0x8D },
+	{ 3, 0xE0, 0xB8, 0x8E }, { 3, 0xE0, 0xB8, 0x8F },
+	{ 3, 0xE0, 0xB8, 0x90 }, { 3, 0xE0, 0xB8, 0x91 },
+	{ 3, 0xE0, 0xB8, 0x92 }, { 3, 0xE0, 0xB8, 0x93 },
+	{ 3, 0xE0, 0xB8, 0x94 }, { 3, 0xE0, 0xB8, 0x95 },
+	{ 3, 0xE0, 0xB8, 0x96 }, { 3, 0xE0, 0xB8, 0x97 },
+	{ 3, 0xE0, 0xB8, 0x98 }, { 3, 0xE0, 0xB8, 0x99 },
+	{ 3, 0xE0, 0xB8, 0x9A }, { 3, 0xE0, 0xB8, 0x9B },
+	{ 3, 0xE0, 0xB8, 0x9C }, { 3, 0xE0, 0xB8, 0x9D },
+	{ 3, 0xE0, 0xB8, 0x9E }, { 3, 0xE0, 0xB8, 0x9F },
+	{ 3, 0xE0, 0xB8, 0xA0 }, { 3, 0xE0, 0xB8, 0xA1 },
+	{ 3, 0xE0, 0xB8, 0xA2 }, { 3, 0xE0, 0xB8, 0xA3 },
+	{ 3, 0xE0, 0xB8, 0xA4 }, { 3, 0xE0, 0xB8, 0xA5 },
+	{ 3, 0xE0, 0xB8, 0xA6 }, { 3, 0xE0, 0xB8, 0xA7 },
+	{ 3, 0xE0, 0xB8, 0xA8 }, { 3, 0xE0, 0xB8, 0xA9 },
+	{ 3, 0xE0, 0xB8, 0xAA }, { 3, 0xE0, 0xB8, 0xAB },
+	{ 3, 0xE0, 0xB8, 0xAC }, { 3, 0xE0, 0xB8, 0xAD },
+	{ 3, 0xE0, 0xB8, 0xAE }, { 3, 0xE0, 0xB8, 0xAF },
+	{ 3, 0xE0, 0xB8, 0xB0 }, { 3, 0xE0, 0xB8, 0xB1 },
+	{ 3, 0xE0, 0xB8, 0xB2 }, { 3, 0xE0, 0xB8, 0xB3 },
+	{ 3, 0xE0, 0xB8, 0xB4 }, { 3, 0xE0, 0xB8, 0xB5 },
+	{ 3, 0xE0, 0xB8, 0xB6 }, { 3, 0xE0, 0xB8, 0xB7 },
+	{ 3, 0xE0, 0xB8, 0xB8 }, { 3, 0xE0, 0xB8, 0xB9 },
+	{ 3, 0xE0, 0xB8, 0xBA }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xE0, 0xB8, 0xBF },
+	{ 3, 0xE0, 0xB9, 0x80 }, { 3, 0xE0, 0xB9, 0x81 },
+	{ 3, 0xE0, 0xB9, 0x82 }, { 3, 0xE0, 0xB9, 0x83 },
+	{ 3, 0xE0, 0xB9, 0x84 }, { 3, 0xE0, 0xB9, 0x85 },
+	{ 3, 0xE0, 0xB9, 0x86 }, { 3, 0xE0, 0xB9, 0x87 },
+	{ 3, 0xE0, 0xB9, 0x88 }, { 3, 0xE0, 0xB9, 0x89 },
+	{ 3, 0xE0, 0xB9, 0x8A }, { 3, 0xE0, 0xB9, 0x8B },
+	{ 3, 0xE0, 0xB9, 0x8C }, { 3, 0xE0, 0xB9, 0x8D },
+	{ 3, 0xE0, 0xB9, 0x8E }, { 3, 0xE0, 0xB9, 0x8F },
+	{ 3, 0xE0, 0xB9, 0x90 }, { 3, 0xE0, 0xB9, 0x91 },
+	{ 3, 0xE0, 0xB9, 0x92 }, { 3, 0xE0, 0xB9, 0x93 },
+	{ 3, 0xE0, 0xB9, 0x94 }, { 3, 0xE0, 0xB9, 0x95 },
+	{ 3, 0xE0, 0xB9, 0x96 }, { 3, 0xE0, 0xB9, 0x97 },
+	{ 3, 0xE0, 0xB9, 0x98 }, { 3, 0xE0, 0xB9, 0x99 },
+	{ 3, 0xE0, 0xB9, 0x9A }, { 3, 0xE0, 0xB9, 0x9B },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD },
+	{ 3, 0xEF, 0xBF, 0xBD }, { 3, 0xEF, 0xBF, 0xBD }
+};
+
+static const uint8_t iso_8859_13[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 3, 0xE2, 0x80, 0x9D },
+	{ 2, 0xC2, 0xA2 }, { 2, 0xC2, 0xA3 },
+	{ 2, 0xC2, 0xA4 }, { 3, 0xE2, 0x80, 0x9E },
+	{ 2, 0xC2, 0xA6 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC3, 0x98 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xC5, 0x96 }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 2, 0xC3, 0x86 },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xC2, 0xB2 }, { 2, 0xC2, 0xB3 },
+	{ 3, 0xE2, 0x80, 0x9C }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC3, 0xB8 }, { 2, 0xC2, 0xB9 },
+	{ 2, 0xC5, 0x97 }, { 2, 0xC2, 0xBB },
+	{ 2, 0xC2, 0xBC }, { 2, 0xC2, 0xBD },
+	{ 2, 0xC2, 0xBE }, { 2, 0xC3, 0xA6 },
+	{ 2, 0xC4, 0x84 }, { 2, 0xC4, 0xAE },
+	{ 2, 0xC4, 0x80 }, { 2, 0xC4, 0x86 },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC3, 0x85 },
+	{ 2, 0xC4, 0x98 }, { 2, 0xC4, 0x92 },
+	{ 2, 0xC4, 0x8C }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC5, 0xB9 }, { 2, 0xC4, 0x96 },
+	{ 2, 0xC4, 0xA2 }, { 2, 0xC4, 0xB6 },
+	{ 2, 0xC4, 0xAA }, { 2, 0xC4, 0xBB },
+	{ 2, 0xC5, 0xA0 }, { 2, 0xC5, 0x83 },
+	{ 2, 0xC5, 0x85 }, { 2, 0xC3, 0x93 },
+	{ 2, 0xC5, 0x8C }, { 2, 0xC3, 0x95 },
+	{ 2, 0xC3, 0x96 }, { 2, 0xC3, 0x97 },
+	{ 2, 0xC5, 0xB2 }, { 2, 0xC5, 0x81 },
+	{ 2, 0xC5, 0x9A }, { 2, 0xC5, 0xAA },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC5, 0xBB },
+	{ 2, 0xC5, 0xBD }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC4, 0x85 }, { 2, 0xC4, 0xAF },
+	{ 2, 0xC4, 0x81 }, { 2, 0xC4, 0x87 },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC3, 0xA5 },
+	{ 2, 0xC4, 0x99 }, { 2, 0xC4, 0x93 },
+	{ 2, 0xC4, 0x8D }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC5, 0xBA }, { 2, 0xC4, 0x97 },
+	{ 2, 0xC4, 0xA3 }, { 2, 0xC4, 0xB7 },
+	{ 2, 0xC4, 0xAB }, { 2, 0xC4, 0xBC },
+	{ 2, 0xC5, 0xA1 }, { 2, 0xC5, 0x84 },
+	{ 2, 0xC5, 0x86 }, { 2, 0xC3, 0xB3 },
+	{ 2, 0xC5, 0x8D }, { 2, 0xC3, 0xB5 },
+	{ 2, 0xC3, 0xB6 }, { 2, 0xC3, 0xB7 },
+	{ 2, 0xC5, 0xB3 }, { 2, 0xC5, 0x82 },
+	{ 2, 0xC5, 0x9B }, { 2, 0xC5, 0xAB },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC5, 0xBC },
+	{ 2, 0xC5, 0xBE }, { 3, 0xE2, 0x80, 0x99 }
+};
+
+static const uint8_t iso_8859_14[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 3, 0xE1, 0xB8, 0x82 },
+	{ 3, 0xE1, 0xB8, 0x83 }, { 2, 0xC2, 0xA3 },
+	{ 2, 0xC4, 0x8A }, { 2, 0xC4, 0x8B },
+	{ 3, 0xE1, 0xB8, 0x8A }, { 2, 0xC2, 0xA7 },
+	{ 3, 0xE1, 0xBA, 0x80 }, { 2, 0xC2, 0xA9 },
+	{ 3, 0xE1, 0xBA, 0x82 }, { 3, 0xE1, 0xB8, 0x8B },
+	{ 3, 0xE1, 0xBB, 0xB2 }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 2, 0xC5, 0xB8 },
+	{ 3, 0xE1, 0xB8, 0x9E }, { 3, 0xE1, 0xB8, 0x9F },
+	{ 2, 0xC4, 0xA0 }, { 2, 0xC4, 0xA1 },
+	{ 3, 0xE1, 0xB9, 0x80 }, { 3, 0xE1, 0xB9, 0x81 },
+	{ 2, 0xC2, 0xB6 }, { 3, 0xE1, 0xB9, 0x96 },
+	{ 3, 0xE1, 0xBA, 0x81 }, { 3, 0xE1, 0xB9, 0x97 },
+	{ 3, 0xE1, 0xBA, 0x83 }, { 3, 0xE1, 0xB9, 0xA0 },
+	{ 3, 0xE1, 0xBB, 0xB3 }, { 3, 0xE1, 0xBA, 0x84 },
+	{ 3, 0xE1, 0xBA, 0x85 }, { 3, 0xE1, 0xB9, 0xA1 },
+	{ 2, 0xC3, 0x80 }, { 2, 0xC3, 0x81 },
+	{ 2, 0xC3, 0x82 }, { 2, 0xC3, 0x83 },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC3, 0x85 },
+	{ 2, 0xC3, 0x86 }, { 2, 0xC3, 0x87 },
+	{ 2, 0xC3, 0x88 }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC3, 0x8A }, { 2, 0xC3, 0x8B },
+	{ 2, 0xC3, 0x8C }, { 2, 0xC3, 0x8D },
+	{ 2, 0xC3, 0x8E }, { 2, 0xC3, 0x8F },
+	{ 2, 0xC5, 0xB4 }, { 2, 0xC3, 0x91 },
+	{ 2, 0xC3, 0x92 }, { 2, 0xC3, 0x93 },
+	{ 2, 0xC3, 0x94 }, { 2, 0xC3, 0x95 },
+	{ 2, 0xC3, 0x96 }, { 3, 0xE1, 0xB9, 0xAA },
+	{ 2, 0xC3, 0x98 }, { 2, 0xC3, 0x99 },
+	{ 2, 0xC3, 0x9A }, { 2, 0xC3, 0x9B },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC3, 0x9D },
+	{ 2, 0xC5, 0xB6 }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC3, 0xA0 }, { 2, 0xC3, 0xA1 },
+	{ 2, 0xC3, 0xA2 }, { 2, 0xC3, 0xA3 },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC3, 0xA5 },
+	{ 2, 0xC3, 0xA6 }, { 2, 0xC3, 0xA7 },
+	{ 2, 0xC3, 0xA8 }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC3, 0xAA }, { 2, 0xC3, 0xAB },
+	{ 2, 0xC3, 0xAC }, { 2, 0xC3, 0xAD },
+	{ 2, 0xC3, 0xAE }, { 2, 0xC3, 0xAF },
+	{ 2, 0xC5, 0xB5 }, { 2, 0xC3, 0xB1 },
+	{ 2, 0xC3, 0xB2 }, { 2, 0xC3, 0xB3 },
+	{ 2, 0xC3, 0xB4 }, { 2, 0xC3, 0xB5 },
+	{ 2, 0xC3, 0xB6 }, { 3, 0xE1, 0xB9, 0xAB },
+	{ 2, 0xC3, 0xB8 }, { 2, 0xC3, 0xB9 },
+	{ 2, 0xC3, 0xBA }, { 2, 0xC3, 0xBB },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC3, 0xBD },
+	{ 2, 0xC5, 0xB7 }, { 2, 0xC3, 0xBF }
+};
+
+static const uint8_t iso_8859_15[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xC2, 0xA1 },
+	{ 2, 0xC2, 0xA2 }, { 2, 0xC2, 0xA3 },
+	{ 3, 0xE2, 0x82, 0xAC }, { 2, 0xC2, 0xA5 },
+	{ 2, 0xC5, 0xA0 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC5, 0xA1 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xC2, 0xAA }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC2, 0xAC }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC2, 0xAE }, { 2, 0xC2, 0xAF },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xC2, 0xB2 }, { 2, 0xC2, 0xB3 },
+	{ 2, 0xC5, 0xBD }, { 2, 0xC2, 0xB5 },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC5, 0xBE }, { 2, 0xC2, 0xB9 },
+	{ 2, 0xC2, 0xBA }, { 2, 0xC2, 0xBB },
+	{ 2, 0xC5, 0x92 }, { 2, 0xC5, 0x93 },
+	{ 2, 0xC5, 0xB8 }, { 2, 0xC2, 0xBF },
+	{ 2, 0xC3, 0x80 }, { 2, 0xC3, 0x81 },
+	{ 2, 0xC3, 0x82 }, { 2, 0xC3, 0x83 },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC3, 0x85 },
+	{ 2, 0xC3, 0x86 }, { 2, 0xC3, 0x87 },
+	{ 2, 0xC3, 0x88 }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC3, 0x8A }, { 2, 0xC3, 0x8B },
+	{ 2, 0xC3, 0x8C }, { 2, 0xC3, 0x8D },
+	{ 2, 0xC3, 0x8E }, { 2, 0xC3, 0x8F },
+	{ 2, 0xC3, 0x90 }, { 2, 0xC3, 0x91 },
+	{ 2, 0xC3, 0x92 }, { 2, 0xC3, 0x93 },
+	{ 2, 0xC3, 0x94 }, { 2, 0xC3, 0x95 },
+	{ 2, 0xC3, 0x96 }, { 2, 0xC3, 0x97 },
+	{ 2, 0xC3, 0x98 }, { 2, 0xC3, 0x99 },
+	{ 2, 0xC3, 0x9A }, { 2, 0xC3, 0x9B },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC3, 0x9D },
+	{ 2, 0xC3, 0x9E }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC3, 0xA0 }, { 2, 0xC3, 0xA1 },
+	{ 2, 0xC3, 0xA2 }, { 2, 0xC3, 0xA3 },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC3, 0xA5 },
+	{ 2, 0xC3, 0xA6 }, { 2, 0xC3, 0xA7 },
+	{ 2, 0xC3, 0xA8 }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC3, 0xAA }, { 2, 0xC3, 0xAB },
+	{ 2, 0xC3, 0xAC }, { 2, 0xC3, 0xAD },
+	{ 2, 0xC3, 0xAE }, { 2, 0xC3, 0xAF },
+	{ 2, 0xC3, 0xB0 }, { 2, 0xC3, 0xB1 },
+	{ 2, 0xC3, 0xB2 }, { 2, 0xC3, 0xB3 },
+	{ 2, 0xC3, 0xB4 }, { 2, 0xC3, 0xB5 },
+	{ 2, 0xC3, 0xB6 }, { 2, 0xC3, 0xB7 },
+	{ 2, 0xC3, 0xB8 }, { 2, 0xC3, 0xB9 },
+	{ 2, 0xC3, 0xBA }, { 2, 0xC3, 0xBB },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC3, 0xBD },
+	{ 2, 0xC3, 0xBE }, { 2, 0xC3, 0xBF }
+};
+
+static const uint8_t iso_8859_16[128][4] = {
+	{ 2, 0xC2, 0x80 }, { 2, 0xC2, 0x81 },
+	{ 2, 0xC2, 0x82 }, { 2, 0xC2, 0x83 },
+	{ 2, 0xC2, 0x84 }, { 2, 0xC2, 0x85 },
+	{ 2, 0xC2, 0x86 }, { 2, 0xC2, 0x87 },
+	{ 2, 0xC2, 0x88 }, { 2, 0xC2, 0x89 },
+	{ 2, 0xC2, 0x8A }, { 2, 0xC2, 0x8B },
+	{ 2, 0xC2, 0x8C }, { 2, 0xC2, 0x8D },
+	{ 2, 0xC2, 0x8E }, { 2, 0xC2, 0x8F },
+	{ 2, 0xC2, 0x90 }, { 2, 0xC2, 0x91 },
+	{ 2, 0xC2, 0x92 }, { 2, 0xC2, 0x93 },
+	{ 2, 0xC2, 0x94 }, { 2, 0xC2, 0x95 },
+	{ 2, 0xC2, 0x96 }, { 2, 0xC2, 0x97 },
+	{ 2, 0xC2, 0x98 }, { 2, 0xC2, 0x99 },
+	{ 2, 0xC2, 0x9A }, { 2, 0xC2, 0x9B },
+	{ 2, 0xC2, 0x9C }, { 2, 0xC2, 0x9D },
+	{ 2, 0xC2, 0x9E }, { 2, 0xC2, 0x9F },
+	{ 2, 0xC2, 0xA0 }, { 2, 0xC4, 0x84 },
+	{ 2, 0xC4, 0x85 }, { 2, 0xC5, 0x81 },
+	{ 3, 0xE2, 0x82, 0xAC }, { 3, 0xE2, 0x80, 0x9E },
+	{ 2, 0xC5, 0xA0 }, { 2, 0xC2, 0xA7 },
+	{ 2, 0xC5, 0xA1 }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xC8, 0x98 }, { 2, 0xC2, 0xAB },
+	{ 2, 0xC5, 0xB9 }, { 2, 0xC2, 0xAD },
+	{ 2, 0xC5, 0xBA }, { 2, 0xC5, 0xBB },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB1 },
+	{ 2, 0xC4, 0x8C }, { 2, 0xC5, 0x82 },
+	{ 2, 0xC5, 0xBD }, { 3, 0xE2, 0x80, 0x9D },
+	{ 2, 0xC2, 0xB6 }, { 2, 0xC2, 0xB7 },
+	{ 2, 0xC5, 0xBE }, { 2, 0xC4, 0x8D },
+	{ 2, 0xC8, 0x99 }, { 2, 0xC2, 0xBB },
+	{ 2, 0xC5, 0x92 }, { 2, 0xC5, 0x93 },
+	{ 2, 0xC5, 0xB8 }, { 2, 0xC5, 0xBC },
+	{ 2, 0xC3, 0x80 }, { 2, 0xC3, 0x81 },
+	{ 2, 0xC3, 0x82 }, { 2, 0xC4, 0x82 },
+	{ 2, 0xC3, 0x84 }, { 2, 0xC4, 0x86 },
+	{ 2, 0xC3, 0x86 }, { 2, 0xC3, 0x87 },
+	{ 2, 0xC3, 0x88 }, { 2, 0xC3, 0x89 },
+	{ 2, 0xC3, 0x8A }, { 2, 0xC3, 0x8B },
+	{ 2, 0xC3, 0x8C }, { 2, 0xC3, 0x8D },
+	{ 2, 0xC3, 0x8E }, { 2, 0xC3, 0x8F },
+	{ 2, 0xC4, 0x90 }, { 2, 0xC5, 0x83 },
+	{ 2, 0xC3, 0x92 }, { 2, 0xC3, 0x93 },
+	{ 2, 0xC3, 0x94 }, { 2, 0xC5, 0x90 },
+	{ 2, 0xC3, 0x96 }, { 2, 0xC5, 0x9A },
+	{ 2, 0xC5, 0xB0 }, { 2, 0xC3, 0x99 },
+	{ 2, 0xC3, 0x9A }, { 2, 0xC3, 0x9B },
+	{ 2, 0xC3, 0x9C }, { 2, 0xC4, 0x98 },
+	{ 2, 0xC8, 0x9A }, { 2, 0xC3, 0x9F },
+	{ 2, 0xC3, 0xA0 }, { 2, 0xC3, 0xA1 },
+	{ 2, 0xC3, 0xA2 }, { 2, 0xC4, 0x83 },
+	{ 2, 0xC3, 0xA4 }, { 2, 0xC4, 0x87 },
+	{ 2, 0xC3, 0xA6 }, { 2, 0xC3, 0xA7 },
+	{ 2, 0xC3, 0xA8 }, { 2, 0xC3, 0xA9 },
+	{ 2, 0xC3, 0xAA }, { 2, 0xC3, 0xAB },
+	{ 2, 0xC3, 0xAC }, { 2, 0xC3, 0xAD },
+	{ 2, 0xC3, 0xAE }, { 2, 0xC3, 0xAF },
+	{ 2, 0xC4, 0x91 }, { 2, 0xC5, 0x84 },
+	{ 2, 0xC3, 0xB2 }, { 2, 0xC3, 0xB3 },
+	{ 2, 0xC3, 0xB4 }, { 2, 0xC5, 0x91 },
+	{ 2, 0xC3, 0xB6 }, { 2, 0xC5, 0x9B },
+	{ 2, 0xC5, 0xB1 }, { 2, 0xC3, 0xB9 },
+	{ 2, 0xC3, 0xBA }, { 2, 0xC3, 0xBB },
+	{ 2, 0xC3, 0xBC }, { 2, 0xC4, 0x99 },
+	{ 2, 0xC8, 0x9B }, { 2, 0xC3, 0xBF }
+};
+
+static const uint8_t koi8_r[128][4] = {
+	{ 3, 0xE2, 0x94, 0x80 }, { 3, 0xE2, 0x94, 0x82 },
+	{ 3, 0xE2, 0x94, 0x8C }, { 3, 0xE2, 0x94, 0x90 },
+	{ 3, 0xE2, 0x94, 0x94 }, { 3, 0xE2, 0x94, 0x98 },
+	{ 3, 0xE2, 0x94, 0x9C }, { 3, 0xE2, 0x94, 0xA4 },
+	{ 3, 0xE2, 0x94, 0xAC }, { 3, 0xE2, 0x94, 0xB4 },
+	{ 3, 0xE2, 0x94, 0xBC }, { 3, 0xE2, 0x96, 0x80 },
+	{ 3, 0xE2, 0x96, 0x84 }, { 3, 0xE2, 0x96, 0x88 },
+	{ 3, 0xE2, 0x96, 0x8C }, { 3, 0xE2, 0x96, 0x90 },
+	{ 3, 0xE2, 0x96, 0x91 }, { 3, 0xE2, 0x96, 0x92 },
+	{ 3, 0xE2, 0x96, 0x93 }, { 3, 0xE2, 0x8C, 0xA0 },
+	{ 3, 0xE2, 0x96, 0xA0 }, { 3, 0xE2, 0x88, 0x99 },
+	{ 3, 0xE2, 0x88, 0x9A }, { 3, 0xE2, 0x89, 0x88 },
+	{ 3, 0xE2, 0x89, 0xA4 }, { 3, 0xE2, 0x89, 0xA5 },
+	{ 2, 0xC2, 0xA0 }, { 3, 0xE2, 0x8C, 0xA1 },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB2 },
+	{ 2, 0xC2, 0xB7 }, { 2, 0xC3, 0xB7 },
+	{ 3, 0xE2, 0x95, 0x90 }, { 3, 0xE2, 0x95, 0x91 },
+	{ 3, 0xE2, 0x95, 0x92 }, { 2, 0xD1, 0x91 },
+	{ 3, 0xE2, 0x95, 0x93 }, { 3, 0xE2, 0x95, 0x94 },
+	{ 3, 0xE2, 0x95, 0x95 }, { 3, 0xE2, 0x95, 0x96 },
+	{ 3, 0xE2, 0x95, 0x97 }, { 3, 0xE2, 0x95, 0x98 },
+	{ 3, 0xE2, 0x95, 0x99 }, { 3, 0xE2, 0x95, 0x9A },
+	{ 3, 0xE2, 0x95, 0x9B }, { 3, 0xE2, 0x95, 0x9C },
+	{ 3, 0xE2, 0x95, 0x9D }, { 3, 0xE2, 0x95, 0x9E },
+	{ 3, 0xE2, 0x95, 0x9F }, { 3, 0xE2, 0x95, 0xA0 },
+	{ 3, 0xE2, 0x95, 0xA1 }, { 2, 0xD0, 0x81 },
+	{ 3, 0xE2, 0x95, 0xA2 }, { 3, 0xE2, 0x95, 0xA3 },
+	{ 3, 0xE2, 0x95, 0xA4 }, { 3, 0xE2, 0x95, 0xA5 },
+	{ 3, 0xE2, 0x95, 0xA6 }, { 3, 0xE2, 0x95, 0xA7 },
+	{ 3, 0xE2, 0x95, 0xA8 }, { 3, 0xE2, 0x95, 0xA9 },
+	{ 3, 0xE2, 0x95, 0xAA }, { 3, 0xE2, 0x95, 0xAB },
+	{ 3, 0xE2, 0x95, 0xAC }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xD1, 0x8E }, { 2, 0xD0, 0xB0 },
+	{ 2, 0xD0, 0xB1 }, { 2, 0xD1, 0x86 },
+	{ 2, 0xD0, 0xB4 }, { 2, 0xD0, 0xB5 },
+	{ 2, 0xD1, 0x84 }, { 2, 0xD0, 0xB3 },
+	{ 2, 0xD1, 0x85 }, { 2, 0xD0, 0xB8 },
+	{ 2, 0xD0, 0xB9 }, { 2, 0xD0, 0xBA },
+	{ 2, 0xD0, 0xBB }, { 2, 0xD0, 0xBC },
+	{ 2, 0xD0, 0xBD }, { 2, 0xD0, 0xBE },
+	{ 2, 0xD0, 0xBF }, { 2, 0xD1, 0x8F },
+	{ 2, 0xD1, 0x80 }, { 2, 0xD1, 0x81 },
+	{ 2, 0xD1, 0x82 }, { 2, 0xD1, 0x83 },
+	{ 2, 0xD0, 0xB6 }, { 2, 0xD0, 0xB2 },
+	{ 2, 0xD1, 0x8C }, { 2, 0xD1, 0x8B },
+	{ 2, 0xD0, 0xB7 }, { 2, 0xD1, 0x88 },
+	{ 2, 0xD1, 0x8D }, { 2, 0xD1, 0x89 },
+	{ 2, 0xD1, 0x87 }, { 2, 0xD1, 0x8A },
+	{ 2, 0xD0, 0xAE }, { 2, 0xD0, 0x90 },
+	{ 2, 0xD0, 0x91 }, { 2, 0xD0, 0xA6 },
+	{ 2, 0xD0, 0x94 }, { 2, 0xD0, 0x95 },
+	{ 2, 0xD0, 0xA4 }, { 2, 0xD0, 0x93 },
+	{ 2, 0xD0, 0xA5 }, { 2, 0xD0, 0x98 },
+	{ 2, 0xD0, 0x99 }, { 2, 0xD0, 0x9A },
+	{ 2, 0xD0, 0x9B }, { 2, 0xD0, 0x9C },
+	{ 2, 0xD0, 0x9D }, { 2, 0xD0, 0x9E },
+	{ 2, 0xD0, 0x9F }, { 2, 0xD0, 0xAF },
+	{ 2, 0xD0, 0xA0 }, { 2, 0xD0, 0xA1 },
+	{ 2, 0xD0, 0xA2 }, { 2, 0xD0, 0xA3 },
+	{ 2, 0xD0, 0x96 }, { 2, 0xD0, 0x92 },
+	{ 2, 0xD0, 0xAC }, { 2, 0xD0, 0xAB },
+	{ 2, 0xD0, 0x97 }, { 2, 0xD0, 0xA8 },
+	{ 2, 0xD0, 0xAD }, { 2, 0xD0, 0xA9 },
+	{ 2, 0xD0, 0xA7 }, { 2, 0xD0, 0xAA }
+};
+
+static const uint8_t koi8_u[128][4] = {
+	{ 3, 0xE2, 0x94, 0x80 }, { 3, 0xE2, 0x94, 0x82 },
+	{ 3, 0xE2, 0x94, 0x8C }, { 3, 0xE2, 0x94, 0x90 },
+	{ 3, 0xE2, 0x94, 0x94 }, { 3, 0xE2, 0x94, 0x98 },
+	{ 3, 0xE2, 0x94, 0x9C }, { 3, 0xE2, 0x94, 0xA4 },
+	{ 3, 0xE2, 0x94, 0xAC }, { 3, 0xE2, 0x94, 0xB4 },
+	{ 3, 0xE2, 0x94, 0xBC }, { 3, 0xE2, 0x96, 0x80 },
+	{ 3, 0xE2, 0x96, 0x84 }, { 3, 0xE2, 0x96, 0x88 },
+	{ 3, 0xE2, 0x96, 0x8C }, { 3, 0xE2, 0x96, 0x90 },
+	{ 3, 0xE2, 0x96, 0x91 }, { 3, 0xE2, 0x96, 0x92 },
+	{ 3, 0xE2, 0x96, 0x93 }, { 3, 0xE2, 0x8C, 0xA0 },
+	{ 3, 0xE2, 0x96, 0xA0 }, { 3, 0xE2, 0x88, 0x99 },
+	{ 3, 0xE2, 0x88, 0x9A }, { 3, 0xE2, 0x89, 0x88 },
+	{ 3, 0xE2, 0x89, 0xA4 }, { 3, 0xE2, 0x89, 0xA5 },
+	{ 2, 0xC2, 0xA0 }, { 3, 0xE2, 0x8C, 0xA1 },
+	{ 2, 0xC2, 0xB0 }, { 2, 0xC2, 0xB2 },
+	{ 2, 0xC2, 0xB7 }, { 2, 0xC3, 0xB7 },
+	{ 3, 0xE2, 0x95, 0x90 }, { 3, 0xE2, 0x95, 0x91 },
+	{ 3, 0xE2, 0x95, 0x92 }, { 2, 0xD1, 0x91 },
+	{ 2, 0xD1, 0x94 }, { 3, 0xE2, 0x95, 0x94 },
+	{ 2, 0xD1, 0x96 }, { 2, 0xD1, 0x97 },
+	{ 3, 0xE2, 0x95, 0x97 }, { 3, 0xE2, 0x95, 0x98 },
+	{ 3, 0xE2, 0x95, 0x99 }, { 3, 0xE2, 0x95, 0x9A },
+	{ 3, 0xE2, 0x95, 0x9B }, { 2, 0xD2, 0x91 },
+	{ 3, 0xE2, 0x95, 0x9D }, { 3, 0xE2, 0x95, 0x9E },
+	{ 3, 0xE2, 0x95, 0x9F }, { 3, 0xE2, 0x95, 0xA0 },
+	{ 3, 0xE2, 0x95, 0xA1 }, { 2, 0xD0, 0x81 },
+	{ 2, 0xD0, 0x84 }, { 3, 0xE2, 0x95, 0xA3 },
+	{ 2, 0xD0, 0x86 }, { 2, 0xD0, 0x87 },
+	{ 3, 0xE2, 0x95, 0xA6 }, { 3, 0xE2, 0x95, 0xA7 },
+	{ 3, 0xE2, 0x95, 0xA8 }, { 3, 0xE2, 0x95, 0xA9 },
+	{ 3, 0xE2, 0x95, 0xAA }, { 2, 0xD2, 0x90 },
+	{ 3, 0xE2, 0x95, 0xAC }, { 2, 0xC2, 0xA9 },
+	{ 2, 0xD1, 0x8E }, { 2, 0xD0, 0xB0 },
+	{ 2, 0xD0, 0xB1 }, { 2, 0xD1, 0x86 },
+	{ 2, 0xD0, 0xB4 }, { 2, 0xD0, 0xB5 },
+	{ 2, 0xD1, 0x84 }, { 2, 0xD0, 0xB3 },
+	{ 2, 0xD1, 0x85 }, { 2, 0xD0, 0xB8 },
+	{ 2, 0xD0, 0xB9 }, { 2, 0xD0, 0xBA },
+	{ 2, 0xD0, 0xBB }, { 2, 0xD0, 0xBC },
+	{ 2, 0xD0, 0xBD }, { 2, 0xD0, 0xBE },
+	{ 2, 0xD0, 0xBF }, { 2, 0xD1, 0x8F },
+	{ 2, 0xD1, 0x80 }, { 2, 0xD1, 0x81 },
+	{ 2, 0xD1, 0x82 }, { 2, 0xD1, 0x83 },
+	{ 2, 0xD0, 0xB6 }, { 2, 0xD0, 0xB2 },
+	{ 2, 0xD1, 0x8C }, { 2, 0xD1, 0x8B },
+	{ 2, 0xD0, 0xB7 }, { 2, 0xD1, 0x88 },
+	{ 2, 0xD1, 0x8D }, { 2, 0xD1, 0x89 },
+	{ 2, 0xD1, 0x87 }, { 2, 0xD1, 0x8A },
+	{ 2, 0xD0, 0xAE }, { 2, 0xD0, 0x90 },
+	{ 2, 0xD0, 0x91 }, { 2, 0xD0, 0xA6 },
+	{ 2, 0xD0, 0x94 }, { 2, 0xD0, 0x95 },
+	{ 2, 0xD0, 0xA4 }, { 2, 0xD0, 0x93 },
+	{ 2, 0xD0, 0xA5 }, { 2, 0xD0, 0x98 },
+	{ 2, 0xD0, 0x99 }, { 2, 0xD0, 0x9A },
+	{ 2, 0xD0, 0x9B }, { 2, 0xD0, 0x9C },
+	{ 2, 0xD0, 0x9D }, { 2, 0xD0, 0x9E },
+	{ 2, 0xD0, 0x9F }, { 2, 0xD0, 0xAF },
+	{ 2, 0xD0, 0xA0 }, { 2, 0xD0, 0xA1 },
+	{ 2, 0xD0, 0xA2 }, { 2, 0xD0, 0xA3 },
+	{ 2, 0xD0, 0x96 }, { 2, 0xD0, 0x92 },
+	{ 2, 0xD0, 0xAC }, { 2, 0xD0, 0xAB },
+	{ 2, 0xD0, 0x97 }, { 2, 0xD0, 0xA8 },
+	{ 2, 0xD0, 0xAD }, { 2, 0xD0, 0xA9 },
+	{ 2, 0xD0, 0xA7 }, { 2, 0xD0, 0xAA }
+};
+
+static const hubbub_charset_table tables[] = {
+	{ S("Windows-1250"), windows_1250 },
+	{ S("Windows-1251"), windows_1251 },
+	{ S("Windows-1252"), windows_1252 },
+	{ S("Windows-1253"), windows_1253 },
+	{ S("Windows-1254"), windows_1254 },
+	{ S("Windows-1255"), windows_1255 },
+	{ S("Windows-1256"), windows_1256 },
+	{ S("Windows-1257"), windows_1257 },
+	{ S("Windows-1258"), windows_1258 },
+	{ S("ISO-8859-1"), iso_8859_1 },
+	{ S("ISO-8859-2"), iso_8859_2 },
+	{ S("ISO-8859-3"), iso_8859_3 },
+	{ S("ISO-8859-4"), iso_8859_4 },
+	{ S("ISO-8859-5"), iso_8859_5 },
+	{ S("ISO-8859-6"), iso_8859_6 },
+	{ S("ISO-8859-7"), iso_8859_7 },
+	{ S("ISO-8859-8"), iso_8859_8 },
+	{ S("ISO-8859-9"), iso_8859_9 },
+	{ S("ISO-8859-10"), iso_8859_10 },
+	{ S("ISO-8859-11"), iso_8859_11 },
+	{ S("ISO-8859-13"), iso_8859_13 },
+	{ S("ISO-8859-14"), iso_8859_14 },
+	{ S("ISO-8859-15"), iso_8859_15 },
+	{ S("ISO-8859-16"), iso_8859_16 },
+	{ S("KOI8-R"), koi8_r },
+	{ S("KOI8-U"), koi8_u }
+};
+
+/**
+ * Find the conversion table for a single-byte charset
+ *
+ * \param mibenum  MIB enum of charset
+ * \return Pointer to table, or NULL if the charset isn't supported
+ */
+const hubbub_charset_table *hubbub_charset_table_find(uint16_t mibenum)
+{
+	size_t i;
+
+	if (mibenum == 0)
+		return NULL;
+
+	for (i = 0; i < N_ELEMENTS(tables); i++) {
+		if (parserutils_charset_mibenum_from_name(tables[i].name,
+				tables[i].len) == mibenum)
+			return &tables[i];
+	}
+
+	return NULL;
+}
+
+/**
+ * Convert single-byte charset data to UTF-8
+ *
+ * \param table  Conversion table for charset
+ * \param data   Data to convert
+ * \param len    Length, in bytes, of data
+ * \param utf8   Pointer to output buffer, which must be at least
+ *               HUBBUB_CHARSET_TRANSCODE_MAX * len bytes long
+ * \return Number of bytes written to output buffer
+ */
+size_t hubbub_charset_transcode(const hubbub_charset_table *table,
+		const uint8_t *data, size_t len, uint8_t *utf8)
+{
+	uint8_t *out = utf8;
+	size_t pos = 0;
+
+	while (pos < len) {
+		const uint8_t *u;
+		uint8_t c;
+
+		/* Copy runs of ASCII 16 bytes at a time */
+		while (pos + 16 <= len) {
+			uint64_t a, b;
+
+			memcpy(&a, data + pos, sizeof(a));
+			memcpy(&b, data + pos + 8, sizeof(b));
+			if (((a | b) & HIGH_BITS) != 0)
+				break;
+
+			memcpy(out, data + pos, 16);
+			out += 16;
+			pos += 16;
+		}
+
+		if (pos == len)
+			break;
+
+		c = data[pos++];
+		if (c < 0x80) {
+			*out++ = c;
+			continue;
+		}
+
+		/* There's always room for all three bytes, as each
+		 * input byte has that much space reserved for it */
+		u = table->utf8[c - 0x80];
+		memcpy(out, u + 1, 3);
+		out += u[0];
+	}
+
+	return out - utf8;
+}
@@ -0,0 +1,26 @@
+/*
+ * This file is part of Hubbub.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ */
+
+#ifndef hubbub_charset_singlebyte_h_
+#define hubbub_charset_singlebyte_h_
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/** Maximum number of bytes of UTF-8 output per byte of input */
+#define HUBBUB_CHARSET_TRANSCODE_MAX 3
+
+typedef struct hubbub_charset_table hubbub_charset_table;
+
+/* Find the conversion table for a single-byte charset */
+const hubbub_charset_table *hubbub_charset_table_find(uint16_t mibenum);
+
+/* Convert single-byte charset data to UTF-8 */
+size_t hubbub_charset_transcode(const hubbub_charset_table *table,
+		const uint8_t *data, size_t len, uint8_t *utf8);
+
+#endif
+
@@ -6,17 +6,23 @@
  */
 
 #include <assert.h>
+#include <stdint.h>
 #include <string.h>
 
+#include <sys/uio.h>
+
 #include <parserutils/charset/mibenum.h>
 #include <parserutils/input/inputstream.h>
 
 #include <hubbub/parser.h>
 
 #include "charset/detect.h"
+#include "charset/singlebyte.h"
 #include "tokeniser/tokeniser.h"
+#include "treebuilder/textbuilder.h"
 #include "treebuilder/treebuilder.h"
 #include "utils/parserutilserror.h"
+#include "utils/utils.h"
 
 /**
  * Hubbub parser object
@@ -25,11 +31,76 @@ struct hubbub_parser {
 	parserutils_inputstream *stream;	/**< Input stream instance */
 	hubbub_tokeniser *tok;		/**< Tokeniser instance */
 	hubbub_treebuilder *tb;		/**< Treebuilder instance */
+	hubbub_textbuilder *txt;	/**< Textbuilder instance, if only
+					 * text is wanted */
+	struct {
+		const char **names;
+		const char **tags;
+	} attribute_filter;		/**< Client's attribute filter, set
+					 * on the tokeniser whenever the
+					 * textbuilder isn't in use */
+
+	bool can_switch;		/**< Charset may be switched in place */
+	bool ascii_only;		/**< All input so far is ASCII */
+	uint64_t ascii_len;		/**< Length of input before the first
+					 * non-ASCII byte, once decoded */
+	uint8_t *raw;			/**< Input from the first non-ASCII
+					 * byte on, kept while the charset
+					 * may be switched */
+	size_t raw_len;			/**< Length of raw input */
+	size_t raw_alloc;		/**< Allocated size of raw */
+	const struct iovec *iov;	/**< Input being parsed, not in raw */
+	int iovcnt;			/**< Number of buffers in iov */
+	size_t iovskip;			/**< Length of ASCII prefix of iov */
+	parserutils_inputstream *old_stream;	/**< Stream replaced by a
+						 * charset switch, pending
+						 * destruction */
+
+	bool detect;			/**< Charset is to be detected */
+	const hubbub_charset_table *table;	/**< Conversion table, if
+						 * we're converting the input
+						 * to UTF-8 ourselves */
+	uint16_t mibenum;		/**< Charset being converted */
+	uint32_t source;		/**< Source of converted charset */
+	uint8_t *utf8;			/**< Conversion output buffer */
+
+	bool stopped;			/**< A stop condition has been met */
+
+	hubbub_recorder *recorder;	/**< Recorder of emitted tokens, or
+					 * NULL if not recording */
 
 	hubbub_allocator_fn alloc;	/**< Memory (de)allocation function */
 	void *pw;			/**< Client data */
 };
 
+static hubbub_error hubbub_parser_change_charset(const char *charset,
+		void *pw);
+static parserutils_error hubbub_parser_switch_input(hubbub_parser *parser,
+		parserutils_inputstream *from, size_t len);
+static void hubbub_parser_discard_old_stream(hubbub_parser *parser);
+static void hubbub_parser_scan_input(hubbub_parser *parser,
+		const struct iovec *iov, int cnt);
+static void hubbub_parser_save_input(hubbub_parser *parser);
+static void hubbub_parser_no_switch(hubbub_parser *parser);
+static hubbub_error hubbub_parser_detect_charset(hubbub_parser *parser,
+		const uint8_t *data, size_t len);
+static hubbub_error hubbub_parser_detect_charset_iov(hubbub_parser *parser,
+		const struct iovec *iov, int cnt);
+static hubbub_error hubbub_parser_run(hubbub_parser *parser);
+static parserutils_error hubbub_parser_append(hubbub_parser *parser,
+		const uint8_t *data, size_t len);
+static parserutils_error hubbub_parser_decode_input(
+		parserutils_inputstream *stream, size_t len);
+static parserutils_error hubbub_parser_copy_input(
+		parserutils_inputstream *from, parserutils_inputstream *to);
+
+/** Number of bytes of input converted to UTF-8 at a time */
+#define CONVERT_CHUNK 4096
+
+/** Number of bytes at the start of a document used to detect its charset */
+#define DETECT_PREFIX \
+	max(HUBBUB_CHARSET_SCAN_LIMIT, HUBBUB_CHARSET_DETECT_LIMIT)
+
 /**
  * Create a hubbub parser
  *
@@ -48,6 +119,7 @@ hubbub_error hubbub_parser_create(const char *enc, bool fix_enc,
 {
 	parserutils_error perror;
 	hubbub_error error;
+	hubbub_treebuilder_optparams tbparams;
 	hubbub_parser *p;
 
 	if (alloc == NULL || parser == NULL)
@@ -70,6 +142,20 @@ hubbub_error hubbub_parser_create(const char *enc, bool fix_enc,
 		}
 	}
 
+	/* Single-byte charsets are converted to UTF-8 before the input
+	 * stream sees them, as we can do so much more cheaply */
+	p->table = NULL;
+	p->mibenum = 0;
+	p->source = HUBBUB_CHARSET_CONFIDENT;
+
+	if (enc != NULL) {
+		p->mibenum = parserutils_charset_mibenum_from_name(enc,
+				strlen(enc));
+		p->table = hubbub_charset_table_find(p->mibenum);
+		if (p->table != NULL)
+			enc = "UTF-8";
+	}
+
 	perror = parserutils_inputstream_create(enc,
 		enc != NULL ? HUBBUB_CHARSET_CONFIDENT : HUBBUB_CHARSET_UNKNOWN,
 		hubbub_charset_extract, alloc, pw, &p->stream);
@@ -93,6 +179,31 @@ hubbub_error hubbub_parser_create(const char *enc, bool fix_enc,
 		return error;
 	}
 
+	tbparams.charset_handler.handler = hubbub_parser_change_charset;
+	tbparams.charset_handler.pw = p;
+	hubbub_treebuilder_setopt(p->tb, HUBBUB_TREEBUILDER_CHARSET_HANDLER,
+			&tbparams);
+
+	p->txt = NULL;
+	p->attribute_filter.names = NULL;
+	p->attribute_filter.tags = NULL;
+
+	p->can_switch = false;
+	p->ascii_only = true;
+	p->ascii_len = 0;
+	p->raw = NULL;
+	p->raw_len = 0;
+	p->raw_alloc = 0;
+	p->iov = NULL;
+	p->old_stream = NULL;
+
+	p->detect = (enc == NULL);
+	p->utf8 = NULL;
+
+	p->stopped = false;
+
+	p->recorder = NULL;
+
 	p->alloc = alloc;
 	p->pw = pw;
 
@@ -101,6 +212,194 @@ hubbub_error hubbub_parser_create(const char *enc, bool fix_enc,
 	return HUBBUB_OK;
 }
 
+/**
+ * Create a hubbub parser for a document fragment
+ *
+ * The fragment is parsed as if it were the content of an element named
+ * ::context_name in namespace ::context_ns. The nodes it produces are
+ * appended, via the tree handler, to a single html element which is the
+ * only child of the document node.
+ *
+ * \param context_ns    Namespace of the context element
+ * \param context_name  Name of the context element
+ * \param enc           Source fragment encoding, or NULL to autodetect
+ * \param fix_enc       Permit fixing up of encoding if it's frequently misused
+ * \param alloc         Memory (de)allocation function
+ * \param pw            Pointer to client-specific private data (may be NULL)
+ * \param parser        Pointer to location to receive parser instance
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_BADPARM on bad parameters,
+ *         HUBBUB_NOMEM on memory exhaustion,
+ *         HUBBUB_BADENCODING if ::enc is unsupported
+ */
+hubbub_error hubbub_parser_create_fragment(hubbub_ns context_ns,
+		const char *context_name, const char *enc, bool fix_enc,
+		hubbub_allocator_fn alloc, void *pw, hubbub_parser **parser)
+{
+	hubbub_error error;
+	hubbub_treebuilder_optparams tbparams;
+	hubbub_parser *p;
+
+	if (context_name == NULL || parser == NULL)
+		return HUBBUB_BADPARM;
+
+	error = hubbub_parser_create(enc, fix_enc, alloc, pw, &p);
+	if (error != HUBBUB_OK)
+		return error;
+
+	/* A fragment's charset is that of the document it's destined for */
+	p->can_switch = false;
+
+	tbparams.fragment_context.ns = context_ns;
+	tbparams.fragment_context.name = context_name;
+
+	error = hubbub_treebuilder_setopt(p->tb,
+			HUBBUB_TREEBUILDER_FRAGMENT_CONTEXT, &tbparams);
+	if (error != HUBBUB_OK) {
+		hubbub_parser_destroy(p);
+		return error;
+	}
+
+	*parser = p;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Clone a hubbub parser
+ *
+ * The clone carries on from exactly where the original has got to, so a
+ * common prefix of several documents need only be parsed once. If there
+ * is a treebuilder, the client must have made a copy of the tree built
+ * so far: each node the parser holds a reference to is passed to
+ * ::handler, which must supply its counterpart in the copy. The clone
+ * has the same handlers as the original; the client will usually want
+ * to change at least the tree handler's context.
+ *
+ * Parsers may be cloned between calls to hubbub_parser_parse_chunk(),
+ * provided that the input so far ends on a character boundary and is
+ * (or has been converted to) UTF-8.
+ *
+ * \param parser   Parser instance to clone
+ * \param handler  Node mapping function, or NULL if there's no treebuilder
+ * \param pw       Pointer to client data for ::handler
+ * \param clone    Pointer to location to receive clone
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_BADPARM on bad parameters,
+ *         HUBBUB_NOMEM on memory exhaustion,
+ *         HUBBUB_INVALID if the parser can't be cloned in its current state,
+ *         appropriate error from ::handler otherwise
+ */
+hubbub_error hubbub_parser_clone(hubbub_parser *parser,
+		hubbub_clone_handler handler, void *pw, hubbub_parser **clone)
+{
+	parserutils_error perror;
+	hubbub_error error;
+	hubbub_treebuilder_optparams tbparams;
+	hubbub_parser *p;
+	const char *charset;
+	uint32_t source;
+
+	if (parser == NULL || clone == NULL ||
+			(parser->tb != NULL && handler == NULL))
+		return HUBBUB_BADPARM;
+
+	if (parser->old_stream != NULL)
+		return HUBBUB_INVALID;
+
+	/* The clone's input stream is fed decoded data, so it had
+	 * better be decoded to the charset that the clone will use */
+	perror = hubbub_parser_decode_input(parser->stream, SIZE_MAX);
+	if (perror != PARSERUTILS_OK)
+		return hubbub_error_from_parserutils_error(perror);
+
+	charset = parserutils_inputstream_read_charset(parser->stream, &source);
+	if (source != HUBBUB_CHARSET_UNKNOWN &&
+			strcasecmp(charset, "UTF-8") != 0)
+		return HUBBUB_INVALID;
+
+	p = parser->alloc(NULL, sizeof(hubbub_parser), parser->pw);
+	if (p == NULL)
+		return HUBBUB_NOMEM;
+
+	*p = *parser;
+
+	p->utf8 = NULL;
+
+	p->raw = NULL;
+	p->raw_len = 0;
+	p->raw_alloc = 0;
+
+	/* The clone doesn't record what the original has seen */
+	p->recorder = NULL;
+
+	perror = parserutils_inputstream_create(
+			source != HUBBUB_CHARSET_UNKNOWN ? charset : NULL,
+			source, hubbub_charset_extract, p->alloc, p->pw,
+			&p->stream);
+	if (perror != PARSERUTILS_OK) {
+		p->alloc(p, 0, p->pw);
+		return hubbub_error_from_parserutils_error(perror);
+	}
+
+	perror = hubbub_parser_copy_input(parser->stream, p->stream);
+	if (perror != PARSERUTILS_OK) {
+		parserutils_inputstream_destroy(p->stream);
+		p->alloc(p, 0, p->pw);
+		return hubbub_error_from_parserutils_error(perror);
+	}
+
+	error = hubbub_tokeniser_clone(parser->tok, p->stream, &p->tok);
+	if (error != HUBBUB_OK) {
+		parserutils_inputstream_destroy(p->stream);
+		p->alloc(p, 0, p->pw);
+		return error;
+	}
+
+	if (parser->tb != NULL) {
+		error = hubbub_treebuilder_clone(parser->tb, p->tok,
+				handler, pw, &p->tb);
+		if (error != HUBBUB_OK) {
+			hubbub_tokeniser_destroy(p->tok);
+			parserutils_inputstream_destroy(p->stream);
+			p->alloc(p, 0, p->pw);
+			return error;
+		}
+
+		tbparams.charset_handler.handler =
+				hubbub_parser_change_charset;
+		tbparams.charset_handler.pw = p;
+		hubbub_treebuilder_setopt(p->tb,
+				HUBBUB_TREEBUILDER_CHARSET_HANDLER, &tbparams);
+	}
+
+	if (parser->txt != NULL) {
+		error = hubbub_textbuilder_clone(parser->txt, p->tok, &p->txt);
+		if (error != HUBBUB_OK) {
+			hubbub_tokeniser_destroy(p->tok);
+			parserutils_inputstream_destroy(p->stream);
+			p->alloc(p, 0, p->pw);
+			return error;
+		}
+	}
+
+	/* Without its own copy of the raw input, the clone can't switch
+	 * charset in place, and must have the document reprocessed */
+	if (parser->raw_len > 0) {
+		p->raw = p->alloc(NULL, parser->raw_len, p->pw);
+		if (p->raw != NULL) {
+			memcpy(p->raw, parser->raw, parser->raw_len);
+			p->raw_len = p->raw_alloc = parser->raw_len;
+		} else {
+			p->can_switch = false;
+		}
+	}
+
+	*clone = p;
+
+	return HUBBUB_OK;
+}
+
 /**
  * Destroy a hubbub parser
  *
@@ -114,10 +413,23 @@ hubbub_error hubbub_parser_destroy(hubbub_parser *parser)
 
 	hubbub_treebuilder_destroy(parser->tb);
 
+	hubbub_textbuilder_destroy(parser->txt);
+
 	hubbub_tokeniser_destroy(parser->tok);
 
+	if (parser->recorder != NULL)
+		hubbub_recorder_destroy(parser->recorder);
+
 	parserutils_inputstream_destroy(parser->stream);
 
+	hubbub_parser_discard_old_stream(parser);
+
+	if (parser->utf8 != NULL)
+		parser->alloc(parser->utf8, 0, parser->pw);
+
+	if (parser->raw != NULL)
+		parser->alloc(parser->raw, 0, parser->pw);
+
 	parser->alloc(parser, 0, parser->pw);
 
 	return HUBBUB_OK;
@@ -148,9 +460,45 @@ hubbub_error hubbub_parser_setopt(hubbub_parser *parser,
 			hubbub_treebuilder_destroy(parser->tb);
 			parser->tb = NULL;
 		}
-		result = hubbub_tokeniser_setopt(parser->tok,
-				HUBBUB_TOKENISER_TOKEN_HANDLER,
-				(hubbub_tokeniser_optparams *) params);
+		if (parser->txt != NULL) {
+			hubbub_tokeniser_optparams filter;
+
+			/* The textbuilder replaced the client's attribute
+			 * filter with its own, so put the client's back */
+			hubbub_textbuilder_destroy(parser->txt);
+			parser->txt = NULL;
+
+			filter.attribute_filter.names =
+					parser->attribute_filter.names;
+			filter.attribute_filter.tags =
+					parser->attribute_filter.tags;
+			result = hubbub_tokeniser_setopt(parser->tok,
+					HUBBUB_TOKENISER_ATTRIBUTE_FILTER,
+					&filter);
+		}
+		if (result == HUBBUB_OK) {
+			result = hubbub_tokeniser_setopt(parser->tok,
+					HUBBUB_TOKENISER_TOKEN_HANDLER,
+					(hubbub_tokeniser_optparams *) params);
+		}
+		break;
+
+	case HUBBUB_PARSER_TEXT_HANDLER:
+		/* No tree is wanted, so replace the treebuilder */
+		if (parser->tb != NULL) {
+			hubbub_treebuilder_destroy(parser->tb);
+			parser->tb = NULL;
+		}
+		if (parser->txt == NULL) {
+			result = hubbub_textbuilder_create(parser->tok,
+					parser->alloc, parser->pw,
+					&parser->txt);
+		}
+		if (result == HUBBUB_OK) {
+			result = hubbub_textbuilder_setopt(parser->txt,
+					HUBBUB_TEXTBUILDER_TEXT_HANDLER,
+					(hubbub_textbuilder_optparams *) params);
+		}
 		break;
 
 	case HUBBUB_PARSER_ERROR_HANDLER:
@@ -202,6 +550,83 @@ hubbub_error hubbub_parser_setopt(hubbub_parser *parser,
 					HUBBUB_TREEBUILDER_ENABLE_SCRIPTING,
 					(hubbub_treebuilder_optparams *) params);
 		}
+		if (parser->txt != NULL) {
+			result = hubbub_textbuilder_setopt(parser->txt,
+					HUBBUB_TEXTBUILDER_ENABLE_SCRIPTING,
+					(hubbub_textbuilder_optparams *) params);
+		}
+		break;
+
+	case HUBBUB_PARSER_IGNORE_WHITESPACE:
+		if (parser->tb != NULL) {
+			result = hubbub_treebuilder_setopt(parser->tb,
+					HUBBUB_TREEBUILDER_IGNORE_WHITESPACE,
+					(hubbub_treebuilder_optparams *) params);
+		}
+		break;
+
+	case HUBBUB_PARSER_STOP:
+		/* Clients with their own token handler can simply return
+		 * HUBBUB_STOPPED from it */
+		if (parser->tb == NULL)
+			return HUBBUB_INVALID;
+
+		result = hubbub_treebuilder_setopt(parser->tb,
+				HUBBUB_TREEBUILDER_STOP,
+				(hubbub_treebuilder_optparams *) params);
+		break;
+
+	case HUBBUB_PARSER_ATTRIBUTE_FILTER:
+		/* The treebuilder reads attributes, such as a meta element's
+		 * charset, to decide the tree, so only clients with their
+		 * own handler can have them filtered */
+		if (parser->tb != NULL)
+			return HUBBUB_INVALID;
+
+		parser->attribute_filter.names = params->attribute_filter.names;
+		parser->attribute_filter.tags = params->attribute_filter.tags;
+
+		/* The textbuilder wants no attributes at all, so the filter
+		 * only takes effect once it has been replaced */
+		if (parser->txt == NULL) {
+			result = hubbub_tokeniser_setopt(parser->tok,
+					HUBBUB_TOKENISER_ATTRIBUTE_FILTER,
+					(hubbub_tokeniser_optparams *) params);
+		}
+		break;
+
+	case HUBBUB_PARSER_INTERN_VALUES:
+		result = hubbub_tokeniser_setopt(parser->tok,
+				HUBBUB_TOKENISER_INTERN_VALUES,
+				(hubbub_tokeniser_optparams *) params);
+		break;
+
+	case HUBBUB_PARSER_STREAMING:
+		result = hubbub_tokeniser_setopt(parser->tok,
+				HUBBUB_TOKENISER_STREAMING,
+				(hubbub_tokeniser_optparams *) params);
+		break;
+
+	case HUBBUB_PARSER_RECORD_TOKENS:
+	{
+		hubbub_tokeniser_optparams tokparams;
+
+		if (params->record_tokens && parser->recorder == NULL) {
+			result = hubbub_recorder_create(
+					HUBBUB_RECORDING_TOKENS, parser->alloc,
+					parser->pw, &parser->recorder);
+		} else if (!params->record_tokens &&
+				parser->recorder != NULL) {
+			hubbub_recorder_destroy(parser->recorder);
+			parser->recorder = NULL;
+		}
+
+		if (result == HUBBUB_OK) {
+			tokparams.recorder = parser->recorder;
+			result = hubbub_tokeniser_setopt(parser->tok,
+					HUBBUB_TOKENISER_RECORDER, &tokparams);
+		}
+	}
 		break;
 
 	default:
@@ -229,6 +654,18 @@ hubbub_error hubbub_parser_insert_chunk(hubbub_parser *parser,
 	if (parser == NULL || data == NULL)
 		return HUBBUB_BADPARM;
 
+	if (parser->stopped)
+		return HUBBUB_STOPPED;
+
+	/* Inserted data is already UTF-8, so it can't be redecoded. It's
+	 * inserted at the current position, ahead of all unconsumed input */
+	if (parser->can_switch) {
+		if (hubbub_charset_ascii_prefix(data, len) != len)
+			hubbub_parser_no_switch(parser);
+		else
+			parser->ascii_len += len;
+	}
+
 	return hubbub_tokeniser_insert_chunk(parser->tok, data, len);
 }
 
@@ -238,22 +675,126 @@ hubbub_error hubbub_parser_insert_chunk(hubbub_parser *parser,
  * \param parser  Parser instance to use
  * \param data    Data to parse (encoded in the input charset)
  * \param len     Length, in bytes, of data
- * \return HUBBUB_OK on success, appropriate error otherwise
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_STOPPED if parsing has ended early (see HUBBUB_PARSER_STOP),
+ *         appropriate error otherwise
  */
 hubbub_error hubbub_parser_parse_chunk(hubbub_parser *parser,
 		const uint8_t *data, size_t len)
 {
 	parserutils_error perror;
 	hubbub_error error;
+	struct iovec iov;
 
 	if (parser == NULL || data == NULL)
 		return HUBBUB_BADPARM;
 
-	perror = parserutils_inputstream_append(parser->stream, data, len);
-	if (perror != PARSERUTILS_OK)
+	/* Leave the data well alone if it'll never be parsed */
+	if (parser->stopped)
+		return HUBBUB_STOPPED;
+
+	/* There's nothing to detect the charset from in an empty chunk */
+	if (parser->detect && len > 0) {
+		error = hubbub_parser_detect_charset(parser, data, len);
+		if (error != HUBBUB_OK)
+			return error;
+	}
+
+	iov.iov_base = (void *) data;
+	iov.iov_len = len;
+	hubbub_parser_scan_input(parser, &iov, 1);
+
+	perror = hubbub_parser_append(parser, data, len);
+	if (perror != PARSERUTILS_OK) {
+		hubbub_parser_no_switch(parser);
 		return hubbub_error_from_parserutils_error(perror);
+	}
+
+	error = hubbub_parser_run(parser);
+
+	hubbub_parser_save_input(parser);
+
+	return error;
+}
+
+/**
+ * Pass a chain of buffers to a hubbub parser for parsing
+ *
+ * This is equivalent to passing the concatenated contents of the buffers
+ * to hubbub_parser_parse_chunk(), without the client having to make a
+ * contiguous copy of them first. The chain is tokenised in one go, once
+ * all of it has been added to the input stream. Empty buffers, whose base
+ * may be NULL, are ignored.
+ *
+ * \param parser  Parser instance to use
+ * \param iov     Buffers of data to parse (encoded in the input charset)
+ * \param cnt     Number of buffers
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_STOPPED if parsing has ended early (see HUBBUB_PARSER_STOP),
+ *         appropriate error otherwise
+ */
+hubbub_error hubbub_parser_parse_iov(hubbub_parser *parser,
+		const struct iovec *iov, int cnt)
+{
+	parserutils_error perror;
+	hubbub_error error;
+	int i;
+
+	if (parser == NULL || cnt < 0 || (iov == NULL && cnt > 0))
+		return HUBBUB_BADPARM;
+
+	for (i = 0; i < cnt; i++) {
+		if (iov[i].iov_base == NULL && iov[i].iov_len > 0)
+			return HUBBUB_BADPARM;
+	}
+
+	/* Leave the data well alone if it'll never be parsed */
+	if (parser->stopped)
+		return HUBBUB_STOPPED;
+
+	if (parser->detect) {
+		error = hubbub_parser_detect_charset_iov(parser, iov, cnt);
+		if (error != HUBBUB_OK)
+			return error;
+	}
+
+	hubbub_parser_scan_input(parser, iov, cnt);
+
+	for (i = 0; i < cnt; i++) {
+		/* Appending no data at all would mark the end of input */
+		if (iov[i].iov_len == 0)
+			continue;
+
+		perror = hubbub_parser_append(parser, iov[i].iov_base,
+				iov[i].iov_len);
+		if (perror != PARSERUTILS_OK) {
+			hubbub_parser_no_switch(parser);
+			return hubbub_error_from_parserutils_error(perror);
+		}
+	}
+
+	error = hubbub_parser_run(parser);
+
+	hubbub_parser_save_input(parser);
+
+	return error;
+}
+
+/**
+ * Tokenise the data added to the parser's input stream
+ *
+ * \param parser  Parser instance
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_STOPPED if parsing has ended early,
+ *         appropriate error otherwise
+ */
+hubbub_error hubbub_parser_run(hubbub_parser *parser)
+{
+	parserutils_error perror;
+	hubbub_error error;
 
 	error = hubbub_tokeniser_run(parser->tok);
+	hubbub_parser_discard_old_stream(parser);
 	if (error == HUBBUB_BADENCODING) {
 		/* Ok, we autodetected an encoding that we don't actually
 		 * support. We've not actually processed any data at this
@@ -272,6 +813,9 @@ hubbub_error hubbub_parser_parse_chunk(hubbub_parser *parser,
 		error = hubbub_tokeniser_run(parser->tok);
 	}
 
+	if (error == HUBBUB_STOPPED)
+		parser->stopped = true;
+
 	if (error != HUBBUB_OK)
 		return error;
 
@@ -282,7 +826,9 @@ hubbub_error hubbub_parser_parse_chunk(hubbub_parser *parser,
  * Inform the parser that the last chunk of data has been parsed
  *
  * \param parser  Parser to inform
- * \return HUBBUB_OK on success, appropriate error otherwise
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_STOPPED if parsing has ended early (see HUBBUB_PARSER_STOP),
+ *         appropriate error otherwise
  */
 hubbub_error hubbub_parser_completed(hubbub_parser *parser)
 {
@@ -292,17 +838,91 @@ hubbub_error hubbub_parser_completed(hubbub_parser *parser)
 	if (parser == NULL)
 		return HUBBUB_BADPARM;
 
+	if (parser->stopped)
+		return HUBBUB_STOPPED;
+
 	perror = parserutils_inputstream_append(parser->stream, NULL, 0);
 	if (perror != PARSERUTILS_OK)
 		return hubbub_error_from_parserutils_error(perror);
 
 	error = hubbub_tokeniser_run(parser->tok);
+	hubbub_parser_discard_old_stream(parser);
+	hubbub_parser_save_input(parser);
+	if (error == HUBBUB_STOPPED)
+		parser->stopped = true;
 	if (error != HUBBUB_OK)
 		return error;
 
 	return HUBBUB_OK;
 }
 
+/**
+ * Read the tokens recorded so far
+ *
+ * \param parser  Parser instance to query
+ * \param data    Pointer to location to receive recording
+ * \param len     Pointer to location to receive its length, in bytes
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_BADPARM on bad parameters,
+ *         HUBBUB_INVALID if the parser isn't recording tokens,
+ *         HUBBUB_NOMEM if a token could not be recorded
+ *
+ * The recording belongs to the parser. It is valid until the parser next
+ * processes any input, or is destroyed, so clients wishing to keep it
+ * must copy it. See hubbub_parser_replay().
+ *
+ * Failing to record a token doesn't affect parsing, but the recording
+ * then stops short of it, and should not be cached.
+ */
+hubbub_error hubbub_parser_read_recording(hubbub_parser *parser,
+		const uint8_t **data, size_t *len)
+{
+	if (parser == NULL || data == NULL || len == NULL)
+		return HUBBUB_BADPARM;
+
+	if (parser->recorder == NULL)
+		return HUBBUB_INVALID;
+
+	return hubbub_recorder_read(parser->recorder, data, len);
+}
+
+/**
+ * Process a recording of tokens, in place of tokenising a document
+ *
+ * The tokens are passed straight to the parser's token handler, which by
+ * default is the treebuilder. The treebuilder steers the tokeniser as it
+ * goes, so a recording made with one kind of token handler should only
+ * be replayed into the same kind: a recording made while building a tree
+ * replays into any parser building a tree, for instance.
+ *
+ * A parser used for replay must not also be given document data.
+ *
+ * \param parser  Parser instance to use
+ * \param data    Recording, as read by hubbub_parser_read_recording()
+ * \param len     Length of recording, in bytes
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_STOPPED if parsing has ended early (see HUBBUB_PARSER_STOP),
+ *         HUBBUB_INVALID if the recording is malformed,
+ *         appropriate error otherwise
+ */
+hubbub_error hubbub_parser_replay(hubbub_parser *parser,
+		const uint8_t *data, size_t len)
+{
+	hubbub_error error;
+
+	if (parser == NULL || data == NULL)
+		return HUBBUB_BADPARM;
+
+	if (parser->stopped)
+		return HUBBUB_STOPPED;
+
+	error = hubbub_tokeniser_replay(parser->tok, data, len);
+	if (error == HUBBUB_STOPPED)
+		parser->stopped = true;
+
+	return error;
+}
+
 /**
  * Read the document charset
  *
@@ -319,6 +939,11 @@ const char *hubbub_parser_read_charset(hubbub_parser *parser,
 	if (parser == NULL || source == NULL)
 		return NULL;
 
+	if (parser->table != NULL) {
+		*source = (hubbub_charset_source) parser->source;
+		return parserutils_charset_mibenum_to_name(parser->mibenum);
+	}
+
 	name = parserutils_inputstream_read_charset(parser->stream, &src);
 
 	*source = (hubbub_charset_source) src;
@@ -326,3 +951,519 @@ const char *hubbub_parser_read_charset(hubbub_parser *parser,
 	return name;
 }
 
+/**
+ * Read the amount of input consumed
+ *
+ * \param parser  Parser instance to query
+ * \param offset  Pointer to location to receive offset
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * The offset counts bytes of input after conversion to UTF-8, including
+ * any inserted with hubbub_parser_insert_chunk(). It's 64 bits wide, so
+ * it's good for input of any length; in particular, for long streams
+ * parsed with HUBBUB_PARSER_STREAMING.
+ */
+hubbub_error hubbub_parser_read_offset(hubbub_parser *parser,
+		uint64_t *offset)
+{
+	if (parser == NULL || offset == NULL)
+		return HUBBUB_BADPARM;
+
+	*offset = hubbub_tokeniser_read_offset(parser->tok);
+
+	return HUBBUB_OK;
+}
+
+
+/**
+ * Switch the document charset without reprocessing the document
+ *
+ * \param charset  Name of the new charset
+ * \param pw       Parser instance
+ * \return HUBBUB_OK if the charset was changed,
+ *         HUBBUB_INVALID if the document must be reprocessed instead,
+ *         appropriate error otherwise
+ *
+ * Nothing need be done if the charset is the one we're converting from
+ * already. Otherwise, this is only possible if the input consumed so far,
+ * including the meta element being processed, is entirely ASCII, as it
+ * then decodes identically in any ASCII-compatible charset. The input
+ * stream cannot change decoder once it has started decoding, so we replace
+ * it with one in the new charset. That is given the rest of the ASCII
+ * prefix of the input, as decoded, followed by the raw input from the
+ * first non-ASCII byte on, to be decoded afresh.
+ */
+hubbub_error hubbub_parser_change_charset(const char *charset, void *pw)
+{
+	hubbub_parser *parser = (hubbub_parser *) pw;
+	hubbub_tokeniser_optparams params;
+	const hubbub_charset_table *table;
+	parserutils_inputstream *stream, *old_stream;
+	const hubbub_charset_table *old_table;
+	parserutils_error perror;
+	uint64_t offset;
+	uint16_t mibenum;
+	size_t len = SIZE_MAX;
+
+	mibenum = parserutils_charset_mibenum_from_name(charset,
+			strlen(charset));
+
+	/* If we're already converting from that charset, there's nothing to
+	 * change, however much of the input isn't ASCII */
+	if (parser->table != NULL && mibenum == parser->mibenum) {
+		parser->source = HUBBUB_CHARSET_CONFIDENT;
+		hubbub_parser_no_switch(parser);
+		return HUBBUB_OK;
+	}
+
+	if (parser->can_switch == false || parser->old_stream != NULL)
+		return HUBBUB_INVALID;
+
+	/* The new charset must be ASCII-compatible, too */
+	if (strncasecmp(charset, "UTF-16", SLEN("UTF-16")) == 0 ||
+			strncasecmp(charset, "UTF-32", SLEN("UTF-32")) == 0)
+		return HUBBUB_INVALID;
+
+	if (parser->ascii_only == false) {
+		offset = hubbub_tokeniser_read_offset(parser->tok);
+		if (offset + hubbub_tokeniser_read_pending(parser->tok) >
+				parser->ascii_len)
+			return HUBBUB_INVALID;
+
+		len = parser->ascii_len - offset;
+	}
+
+	/* Decode the ASCII input we have. The result is the same whichever
+	 * decoder is in use. */
+	perror = hubbub_parser_decode_input(parser->stream, len);
+	if (perror != PARSERUTILS_OK)
+		return hubbub_error_from_parserutils_error(perror);
+
+	table = hubbub_charset_table_find(mibenum);
+
+	perror = parserutils_inputstream_create(
+			table != NULL ? "UTF-8" : charset,
+			HUBBUB_CHARSET_CONFIDENT, hubbub_charset_extract,
+			parser->alloc, parser->pw, &stream);
+	if (perror != PARSERUTILS_OK)
+		return hubbub_error_from_parserutils_error(perror);
+
+	old_stream = parser->stream;
+	old_table = parser->table;
+
+	parser->stream = stream;
+	parser->table = table;
+
+	perror = hubbub_parser_switch_input(parser, old_stream, len);
+	if (perror != PARSERUTILS_OK) {
+		parser->stream = old_stream;
+		parser->table = old_table;
+		parserutils_inputstream_destroy(stream);
+		return hubbub_error_from_parserutils_error(perror);
+	}
+
+	params.input = stream;
+	hubbub_tokeniser_setopt(parser->tok, HUBBUB_TOKENISER_INPUT, &params);
+
+	/* The tokeniser may still be looking at data in the old stream,
+	 * so keep it until control returns to us */
+	parser->old_stream = old_stream;
+
+	parser->mibenum = mibenum;
+	parser->source = HUBBUB_CHARSET_CONFIDENT;
+
+	hubbub_parser_no_switch(parser);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Give the input to a parser's new input stream, after a charset switch
+ *
+ * \param parser  Parser instance, with its new stream and table in place
+ * \param from    The stream being replaced
+ * \param len     Length of decoded ASCII input to copy from ::from
+ * \return PARSERUTILS_OK on success, appropriate error otherwise
+ */
+parserutils_error hubbub_parser_switch_input(hubbub_parser *parser,
+		parserutils_inputstream *from, size_t len)
+{
+	parserutils_error perror = PARSERUTILS_OK;
+	size_t skip = parser->iovskip;
+	int i;
+
+	len = min(len, from->utf8->length - from->cursor);
+	if (len > 0) {
+		perror = parserutils_inputstream_append(parser->stream,
+				from->utf8->data + from->cursor, len);
+	}
+
+	if (perror == PARSERUTILS_OK && parser->raw_len > 0)
+		perror = hubbub_parser_append(parser, parser->raw,
+				parser->raw_len);
+
+	/* The chain being parsed is in neither the raw input nor
+	 * the stream's decoded data, bar its ASCII prefix */
+	for (i = 0; parser->iov != NULL && i < parser->iovcnt &&
+			perror == PARSERUTILS_OK; i++) {
+		size_t chunk = parser->iov[i].iov_len;
+
+		if (skip >= chunk) {
+			skip -= chunk;
+			continue;
+		}
+
+		perror = hubbub_parser_append(parser,
+				(const uint8_t *) parser->iov[i].iov_base + skip,
+				chunk - skip);
+		skip = 0;
+	}
+
+	if (perror == PARSERUTILS_OK && from->had_eof)
+		perror = parserutils_inputstream_append(parser->stream,
+				NULL, 0);
+
+	/* The tokeniser expects to find the unconsumed input decoded */
+	if (perror == PARSERUTILS_OK)
+		perror = hubbub_parser_decode_input(parser->stream, SIZE_MAX);
+
+	return perror;
+}
+
+/**
+ * Decode the data in an input stream
+ *
+ * \param stream  The stream to decode
+ * \param len     Length of data to decode beyond the current position,
+ *                or SIZE_MAX to decode all of it
+ * \return PARSERUTILS_OK on success, appropriate error otherwise
+ */
+parserutils_error hubbub_parser_decode_input(parserutils_inputstream *stream,
+		size_t len)
+{
+	parserutils_error perror = PARSERUTILS_OK;
+	const uint8_t *ptr;
+	size_t got;
+
+	while (perror == PARSERUTILS_OK &&
+			stream->utf8->length - stream->cursor < len) {
+		perror = parserutils_inputstream_peek(stream,
+				stream->utf8->length - stream->cursor,
+				&ptr, &got);
+	}
+
+	if (perror != PARSERUTILS_OK && perror != PARSERUTILS_NEEDDATA &&
+			perror != PARSERUTILS_EOF)
+		return perror;
+
+	return PARSERUTILS_OK;
+}
+
+/**
+ * Copy the unconsumed, decoded, data in one input stream to another
+ *
+ * \param from  The stream to copy from
+ * \param to    The (UTF-8) stream to copy to
+ * \return PARSERUTILS_OK on success, appropriate error otherwise
+ */
+parserutils_error hubbub_parser_copy_input(parserutils_inputstream *from,
+		parserutils_inputstream *to)
+{
+	parserutils_error perror = PARSERUTILS_OK;
+	size_t len = from->utf8->length - from->cursor;
+
+	if (len > 0) {
+		perror = parserutils_inputstream_append(to,
+				from->utf8->data + from->cursor, len);
+	}
+
+	if (perror == PARSERUTILS_OK && from->had_eof)
+		perror = parserutils_inputstream_append(to, NULL, 0);
+
+	/* The tokeniser expects to find the unconsumed input decoded */
+	if (perror == PARSERUTILS_OK)
+		perror = hubbub_parser_decode_input(to, SIZE_MAX);
+
+	return perror;
+}
+
+/**
+ * Destroy an input stream replaced by a charset switch
+ *
+ * \param parser  Parser instance
+ */
+void hubbub_parser_discard_old_stream(hubbub_parser *parser)
+{
+	if (parser->old_stream != NULL) {
+		parserutils_inputstream_destroy(parser->old_stream);
+		parser->old_stream = NULL;
+	}
+}
+
+/**
+ * Note the extent of the ASCII prefix of the input, before parsing it
+ *
+ * \param parser  Parser instance
+ * \param iov     Buffers of data about to be parsed
+ * \param cnt     Number of buffers
+ *
+ * The buffers are referred to until hubbub_parser_save_input() is called,
+ * so the raw input is only copied if it's still wanted then.
+ */
+void hubbub_parser_scan_input(hubbub_parser *parser,
+		const struct iovec *iov, int cnt)
+{
+	int i;
+
+	if (parser->can_switch == false)
+		return;
+
+	parser->iov = iov;
+	parser->iovcnt = cnt;
+	parser->iovskip = 0;
+
+	/* Stops scanning after the first non-ASCII byte in the document */
+	for (i = 0; i < cnt && parser->ascii_only; i++) {
+		size_t len = hubbub_charset_ascii_prefix(iov[i].iov_base,
+				iov[i].iov_len);
+
+		parser->ascii_len += len;
+		parser->iovskip += len;
+
+		if (len != iov[i].iov_len)
+			parser->ascii_only = false;
+	}
+}
+
+/**
+ * Keep any raw input which a charset switch would need, after parsing
+ *
+ * \param parser  Parser instance
+ *
+ * Once the tokeniser has read beyond the ASCII prefix of the input, the
+ * charset can no longer be switched in place, so nothing need be kept.
+ * Usually, that happens in the same call as the first non-ASCII byte is
+ * passed to the parser.
+ */
+void hubbub_parser_save_input(hubbub_parser *parser)
+{
+	const struct iovec *iov = parser->iov;
+	size_t skip = parser->iovskip;
+	int i;
+
+	parser->iov = NULL;
+
+	if (parser->can_switch == false || parser->ascii_only)
+		return;
+
+	if (hubbub_tokeniser_read_offset(parser->tok) +
+			hubbub_tokeniser_read_pending(parser->tok) >
+			parser->ascii_len) {
+		hubbub_parser_no_switch(parser);
+		return;
+	}
+
+	for (i = 0; iov != NULL && i < parser->iovcnt; i++) {
+		size_t len = iov[i].iov_len;
+
+		if (skip >= len) {
+			skip -= len;
+			continue;
+		}
+
+		len -= skip;
+
+		if (parser->raw_len + len > parser->raw_alloc) {
+			size_t size = max(parser->raw_alloc * 2,
+					parser->raw_len + len);
+			uint8_t *raw = parser->alloc(parser->raw, size,
+					parser->pw);
+
+			/* Leave it to the client to reprocess the document */
+			if (raw == NULL) {
+				hubbub_parser_no_switch(parser);
+				return;
+			}
+
+			parser->raw = raw;
+			parser->raw_alloc = size;
+		}
+
+		memcpy(parser->raw + parser->raw_len,
+				(const uint8_t *) iov[i].iov_base + skip, len);
+		parser->raw_len += len;
+		skip = 0;
+	}
+}
+
+/**
+ * Give up on switching charset in place
+ *
+ * \param parser  Parser instance
+ */
+void hubbub_parser_no_switch(hubbub_parser *parser)
+{
+	parser->can_switch = false;
+	parser->iov = NULL;
+
+	if (parser->raw != NULL) {
+		parser->alloc(parser->raw, 0, parser->pw);
+		parser->raw = NULL;
+		parser->raw_len = 0;
+		parser->raw_alloc = 0;
+	}
+}
+
+/**
+ * Determine the document charset from the first non-empty chunk of input
+ *
+ * \param parser  Parser instance
+ * \param data    First chunk of data
+ * \param len     Length, in bytes, of data
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * This is what the input stream would do, but doing it here lets us find
+ * out whether we can convert the input to UTF-8 ourselves.
+ */
+hubbub_error hubbub_parser_detect_charset(hubbub_parser *parser,
+		const uint8_t *data, size_t len)
+{
+	parserutils_error perror;
+	uint16_t mibenum = 0;
+	uint32_t source = HUBBUB_CHARSET_UNKNOWN;
+	const char *enc;
+
+	parser->detect = false;
+
+	perror = hubbub_charset_extract(data, len, &mibenum, &source);
+	if (perror != PARSERUTILS_OK)
+		return hubbub_error_from_parserutils_error(perror);
+
+	/* A tentative charset may be switched in place later, as long as its
+	 * decoder leaves ASCII as is. That's true of ours, and of UTF-8, but
+	 * not of every other (Shift_JIS may map 0x5C to U+00A5, say). */
+	parser->can_switch = (source != HUBBUB_CHARSET_CONFIDENT);
+
+	enc = parserutils_charset_mibenum_to_name(mibenum);
+	parser->table = hubbub_charset_table_find(mibenum);
+	if (parser->table == NULL) {
+		if (strcasecmp(enc, "UTF-8") != 0)
+			parser->can_switch = false;
+
+		perror = parserutils_inputstream_change_charset(
+				parser->stream, enc, source);
+		if (perror != PARSERUTILS_BADENCODING)
+			return hubbub_error_from_parserutils_error(perror);
+
+		/* We detected a charset that we don't actually support,
+		 * so fall back to Windows-1252 and hope for the best */
+		mibenum = parserutils_charset_mibenum_from_name(
+				"Windows-1252", SLEN("Windows-1252"));
+		source = HUBBUB_CHARSET_TENTATIVE;
+
+		parser->table = hubbub_charset_table_find(mibenum);
+		assert(parser->table != NULL);
+
+		parser->can_switch = true;
+	}
+
+	parser->mibenum = mibenum;
+	parser->source = source;
+
+	perror = parserutils_inputstream_change_charset(parser->stream,
+			"UTF-8", HUBBUB_CHARSET_CONFIDENT);
+
+	return hubbub_error_from_parserutils_error(perror);
+}
+
+/**
+ * Determine the document charset from the first chain of buffers with data
+ *
+ * \param parser  Parser instance
+ * \param iov     First chain of buffers
+ * \param cnt     Number of buffers
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Detection considers only the start of the document, so that much of the
+ * chain is gathered together, if it isn't all in the first buffer. If
+ * every buffer is empty, detection is left until there's some data.
+ */
+hubbub_error hubbub_parser_detect_charset_iov(hubbub_parser *parser,
+		const struct iovec *iov, int cnt)
+{
+	hubbub_error error;
+	uint8_t *prefix;
+	size_t len = 0;
+	int i;
+
+	/* Wait for some data to detect the charset from */
+	while (cnt > 0 && iov[0].iov_len == 0) {
+		iov++;
+		cnt--;
+	}
+
+	if (cnt == 0)
+		return HUBBUB_OK;
+
+	if (cnt == 1 || iov[0].iov_len >= DETECT_PREFIX)
+		return hubbub_parser_detect_charset(parser,
+				iov[0].iov_base, iov[0].iov_len);
+
+	prefix = parser->alloc(NULL, DETECT_PREFIX, parser->pw);
+	if (prefix == NULL)
+		return HUBBUB_NOMEM;
+
+	for (i = 0; i < cnt && len < DETECT_PREFIX; i++) {
+		size_t chunk = min(iov[i].iov_len, DETECT_PREFIX - len);
+
+		if (chunk == 0)
+			continue;
+
+		memcpy(prefix + len, iov[i].iov_base, chunk);
+		len += chunk;
+	}
+
+	error = hubbub_parser_detect_charset(parser, prefix, len);
+
+	parser->alloc(prefix, 0, parser->pw);
+
+	return error;
+}
+
+/**
+ * Append data to the parser's input stream
+ *
+ * \param parser  Parser instance
+ * \param data    Data to append (encoded in the input charset)
+ * \param len     Length, in bytes, of data
+ * \return PARSERUTILS_OK on success, appropriate error otherwise
+ */
+parserutils_error hubbub_parser_append(hubbub_parser *parser,
+		const uint8_t *data, size_t len)
+{
+	parserutils_error perror = PARSERUTILS_OK;
+
+	if (parser->table == NULL)
+		return parserutils_inputstream_append(parser->stream, data, len);
+
+	if (parser->utf8 == NULL) {
+		parser->utf8 = parser->alloc(NULL, CONVERT_CHUNK *
+				HUBBUB_CHARSET_TRANSCODE_MAX, parser->pw);
+		if (parser->utf8 == NULL)
+			return PARSERUTILS_NOMEM;
+	}
+
+	while (len > 0 && perror == PARSERUTILS_OK) {
+		size_t chunk = min(len, CONVERT_CHUNK);
+		size_t utf8len = hubbub_charset_transcode(parser->table,
+				data, chunk, parser->utf8);
+
+		perror = parserutils_inputstream_append(parser->stream,
+				parser->utf8, utf8len);
+
+		data += chunk;
+		len -= chunk;
+	}
+
+	return perror;
+}
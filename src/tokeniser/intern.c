@@ -0,0 +1,209 @@
+/*
+ * This file is part of Hubbub.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ */
+
+#include <string.h>
+
+#include "tokeniser/intern.h"
+
+/*
+ * The cache is an open addressed hash table of the values seen so far,
+ * whose bytes are copied into blocks which are never moved or freed
+ * before the cache is, so interned strings keep their address.  Both
+ * the number of values and their length are bounded, so the cache never
+ * exceeds a few hundred kilobytes, however long the document.
+ */
+
+/** Number of hash table slots; a power of 2, at most half full */
+#define INTERN_SLOTS		(HUBBUB_INTERN_MAX_VALUES * 2)
+/** Size of a block of string data */
+#define INTERN_BLOCK_SIZE	4096
+/** Initial number of entries allocated */
+#define INTERN_ENTRIES_INITIAL	64
+
+/**
+ * Block of interned string data
+ */
+typedef struct intern_block {
+	struct intern_block *next;	/**< Previous block */
+	size_t used;			/**< Bytes used in data */
+	uint8_t data[INTERN_BLOCK_SIZE];	/**< String data */
+} intern_block;
+
+/**
+ * Interned value
+ */
+typedef struct intern_entry {
+	const uint8_t *ptr;		/**< Value, in a block */
+	uint32_t len;			/**< Byte length of value */
+	uint32_t hash;			/**< Hash of value */
+} intern_entry;
+
+/**
+ * Cache of attribute values
+ */
+struct hubbub_intern {
+	uint16_t slots[INTERN_SLOTS];	/**< ID of the value in each slot,
+					 * or 0 if the slot is free */
+
+	intern_entry *entries;		/**< Values, by ID - 1 */
+	uint32_t n_entries;		/**< Number of values */
+	uint32_t entries_alloc;		/**< Number of entries allocated */
+
+	intern_block *blocks;		/**< Most recent block */
+
+	hubbub_allocator_fn alloc;	/**< Memory (de)allocation function */
+	void *pw;			/**< Client data */
+};
+
+/**
+ * Create a value cache
+ *
+ * \param alloc   Memory (de)allocation function
+ * \param pw      Pointer to client-specific private data (may be NULL)
+ * \param intern  Pointer to location to receive cache
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_BADPARM on bad parameters,
+ *         HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error hubbub_intern_create(hubbub_allocator_fn alloc, void *pw,
+		hubbub_intern **intern)
+{
+	hubbub_intern *in;
+
+	if (alloc == NULL || intern == NULL)
+		return HUBBUB_BADPARM;
+
+	in = alloc(NULL, sizeof(hubbub_intern), pw);
+	if (in == NULL)
+		return HUBBUB_NOMEM;
+
+	memset(in->slots, 0, sizeof(in->slots));
+	in->entries = NULL;
+	in->n_entries = 0;
+	in->entries_alloc = 0;
+	in->blocks = NULL;
+	in->alloc = alloc;
+	in->pw = pw;
+
+	*intern = in;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Destroy a value cache
+ *
+ * \param intern  The cache to destroy
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Strings interned by the cache are freed with it.
+ */
+hubbub_error hubbub_intern_destroy(hubbub_intern *intern)
+{
+	intern_block *block, *next;
+
+	if (intern == NULL)
+		return HUBBUB_BADPARM;
+
+	for (block = intern->blocks; block != NULL; block = next) {
+		next = block->next;
+		intern->alloc(block, 0, intern->pw);
+	}
+
+	intern->alloc(intern->entries, 0, intern->pw);
+	intern->alloc(intern, 0, intern->pw);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Intern a string, if there is room for it
+ *
+ * \param intern  The cache to use
+ * \param str     The string, which is updated to point at the cache's copy
+ * \param id      Pointer to location to receive the string's ID, or 0 if
+ *                it is too long or the cache is full
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * Equal strings are given the same ID and the same copy, which remains
+ * valid until the cache is destroyed.
+ */
+hubbub_error hubbub_intern_string(hubbub_intern *intern,
+		hubbub_string *str, uint32_t *id)
+{
+	const uint8_t *ptr = str->ptr;
+	uint32_t len = str->len;
+	uint32_t hash = 2166136261u;
+	intern_entry *entry;
+	intern_block *block;
+	uint32_t slot, i;
+
+	*id = 0;
+
+	if (str->len > HUBBUB_INTERN_MAX_LENGTH)
+		return HUBBUB_OK;
+
+	for (i = 0; i < len; i++) {
+		hash ^= ptr[i];
+		hash *= 16777619u;
+	}
+
+	for (slot = hash & (INTERN_SLOTS - 1); intern->slots[slot] != 0;
+			slot = (slot + 1) & (INTERN_SLOTS - 1)) {
+		entry = &intern->entries[intern->slots[slot] - 1];
+
+		if (entry->hash == hash && entry->len == len &&
+				(len == 0 ||
+				memcmp(entry->ptr, ptr, len) == 0)) {
+			str->ptr = entry->ptr;
+			*id = intern->slots[slot];
+			return HUBBUB_OK;
+		}
+	}
+
+	if (intern->n_entries == HUBBUB_INTERN_MAX_VALUES)
+		return HUBBUB_OK;
+
+	if (intern->n_entries == intern->entries_alloc) {
+		uint32_t n = intern->entries_alloc == 0 ?
+				INTERN_ENTRIES_INITIAL :
+				intern->entries_alloc * 2;
+		intern_entry *entries = intern->alloc(intern->entries,
+				n * sizeof(intern_entry), intern->pw);
+		if (entries == NULL)
+			return HUBBUB_NOMEM;
+
+		intern->entries = entries;
+		intern->entries_alloc = n;
+	}
+
+	block = intern->blocks;
+	if (block == NULL || INTERN_BLOCK_SIZE - block->used < len) {
+		block = intern->alloc(NULL, sizeof(intern_block), intern->pw);
+		if (block == NULL)
+			return HUBBUB_NOMEM;
+
+		block->next = intern->blocks;
+		block->used = 0;
+		intern->blocks = block;
+	}
+
+	entry = &intern->entries[intern->n_entries];
+	entry->ptr = block->data + block->used;
+	entry->len = len;
+	entry->hash = hash;
+
+	if (len > 0)
+		memcpy(block->data + block->used, ptr, len);
+	block->used += len;
+
+	intern->slots[slot] = ++intern->n_entries;
+
+	str->ptr = entry->ptr;
+	*id = intern->n_entries;
+
+	return HUBBUB_OK;
+}
@@ -0,0 +1,34 @@
+/*
+ * This file is part of Hubbub.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ */
+
+#ifndef hubbub_tokeniser_intern_h_
+#define hubbub_tokeniser_intern_h_
+
+#include <inttypes.h>
+
+#include <hubbub/errors.h>
+#include <hubbub/functypes.h>
+#include <hubbub/types.h>
+
+/** Longest attribute value which is interned, in bytes */
+#define HUBBUB_INTERN_MAX_LENGTH	64
+/** Most distinct values interned; later ones are passed through */
+#define HUBBUB_INTERN_MAX_VALUES	4096
+
+typedef struct hubbub_intern hubbub_intern;
+
+/* Create a value cache */
+hubbub_error hubbub_intern_create(hubbub_allocator_fn alloc, void *pw,
+		hubbub_intern **intern);
+/* Destroy a value cache */
+hubbub_error hubbub_intern_destroy(hubbub_intern *intern);
+
+/* Intern a string, if there is room for it */
+hubbub_error hubbub_intern_string(hubbub_intern *intern,
+		hubbub_string *str, uint32_t *id);
+
+#endif
+
@@ -0,0 +1,793 @@
+/*
+ * This file is part of Hubbub.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "tokeniser/recorder.h"
+#include "utils/utils.h"
+
+/*
+ * A recording is a header followed by a sequence of records, in a compact
+ * binary form.  The header identifies what is recorded:
+ *
+ *   magic version		version is currently 1
+ *
+ * A recording of tokens (HUBBUB_RECORDING_TOKENS) holds nothing else, so
+ * can be replayed without any further tokenisation.  Other recordings
+ * use the same encoding of tokens, strings and names.
+ *
+ * Each token starts with a byte holding its type in the low three bits
+ * and type-specific flags above them:
+ *
+ *   DOCTYPE		REC_PUBLIC_MISSING, REC_SYSTEM_MISSING,
+ *			REC_FORCE_QUIRKS; name atom, public id string
+ *			and system id string, each unless missing
+ *   START_TAG, END_TAG	REC_SELF_CLOSING, namespace in REC_NS_MASK;
+ *			name atom and attribute list
+ *   COMMENT, CHARACTER	string
+ *   EOF		nothing
+ *
+ * Strings are a varint byte length followed by the bytes. Names are
+ * atoms: a varint index into the table of names seen so far, where an
+ * index equal to the size of the table introduces a new name whose
+ * string follows. Varints are little-endian base 128.  An attribute list
+ * is a varint count, then for each attribute a namespace byte, name atom
+ * and value string.
+ *
+ * On replay, token data points straight into the recording, so the cost
+ * is little more than reading it once.
+ */
+
+#define REC_MAGIC_LEN		4
+#define REC_VERSION		1
+#define REC_HEADER_LEN		(REC_MAGIC_LEN + 1)
+
+#define REC_TYPE_MASK		0x07
+#define REC_PUBLIC_MISSING	(1 << 3)
+#define REC_SYSTEM_MISSING	(1 << 4)
+#define REC_FORCE_QUIRKS	(1 << 5)
+#define REC_SELF_CLOSING	(1 << 3)
+#define REC_NS_SHIFT		4
+#define REC_NS_MASK		(0x07 << REC_NS_SHIFT)
+
+/** Longest varint needed for a size_t */
+#define REC_VARINT_MAX		((sizeof(size_t) * 8 + 6) / 7)
+
+/** Initial number of slots in the atom table; must be a power of 2 */
+#define REC_ATOMS_INITIAL	64
+
+/**
+ * Entry in the recorder's atom table
+ */
+typedef struct recorder_atom {
+	size_t offset;		/**< Offset of name in recording, or 0 if
+				 * the slot is free */
+	size_t len;		/**< Byte length of name */
+	uint32_t index;		/**< Index of atom in the recording */
+} recorder_atom;
+
+/**
+ * Recorder
+ */
+struct hubbub_recorder {
+	uint8_t *data;			/**< Recording */
+	size_t len;			/**< Bytes used in recording */
+	size_t alloc_len;		/**< Bytes allocated for recording */
+
+	recorder_atom *atoms;		/**< Open addressed atom table */
+	uint32_t atoms_size;		/**< Number of slots in table */
+	uint32_t n_atoms;		/**< Number of atoms in table */
+
+	hubbub_error error;		/**< Why a token couldn't be
+					 * recorded, or HUBBUB_OK */
+
+	hubbub_allocator_fn alloc;	/**< Memory (de)allocation function */
+	void *pw;			/**< Client data */
+};
+
+static hubbub_error recorder_reserve(hubbub_recorder *recorder, size_t len);
+static void recorder_varint(hubbub_recorder *recorder, size_t value);
+static hubbub_error recorder_grow_atoms(hubbub_recorder *recorder);
+
+/**
+ * Create a recorder
+ *
+ * \param magic     Magic number identifying the recording's content, one
+ *                  of the HUBBUB_RECORDING_* strings
+ * \param alloc     Memory (de)allocation function
+ * \param pw        Pointer to client-specific private data (may be NULL)
+ * \param recorder  Pointer to location to receive recorder instance
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_BADPARM on bad parameters,
+ *         HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error hubbub_recorder_create(const char *magic,
+		hubbub_allocator_fn alloc, void *pw,
+		hubbub_recorder **recorder)
+{
+	hubbub_recorder *rec;
+
+	if (magic == NULL || strlen(magic) != REC_MAGIC_LEN ||
+			alloc == NULL || recorder == NULL)
+		return HUBBUB_BADPARM;
+
+	rec = alloc(NULL, sizeof(hubbub_recorder), pw);
+	if (rec == NULL)
+		return HUBBUB_NOMEM;
+
+	rec->alloc_len = 4096;
+	rec->data = alloc(NULL, rec->alloc_len, pw);
+	if (rec->data == NULL) {
+		alloc(rec, 0, pw);
+		return HUBBUB_NOMEM;
+	}
+
+	rec->atoms_size = REC_ATOMS_INITIAL;
+	rec->atoms = alloc(NULL, rec->atoms_size * sizeof(recorder_atom), pw);
+	if (rec->atoms == NULL) {
+		alloc(rec->data, 0, pw);
+		alloc(rec, 0, pw);
+		return HUBBUB_NOMEM;
+	}
+	memset(rec->atoms, 0, rec->atoms_size * sizeof(recorder_atom));
+	rec->n_atoms = 0;
+
+	memcpy(rec->data, magic, REC_MAGIC_LEN);
+	rec->data[REC_MAGIC_LEN] = REC_VERSION;
+	rec->len = REC_HEADER_LEN;
+	rec->error = HUBBUB_OK;
+
+	rec->alloc = alloc;
+	rec->pw = pw;
+
+	*recorder = rec;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Destroy a recorder
+ *
+ * \param recorder  The recorder instance to destroy
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error hubbub_recorder_destroy(hubbub_recorder *recorder)
+{
+	if (recorder == NULL)
+		return HUBBUB_BADPARM;
+
+	recorder->alloc(recorder->atoms, 0, recorder->pw);
+	recorder->alloc(recorder->data, 0, recorder->pw);
+	recorder->alloc(recorder, 0, recorder->pw);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Append a token to a recording
+ *
+ * \param recorder  The recorder instance
+ * \param token     The token to record
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * If the token can't be recorded, the recording is cut back to the end
+ * of the previous token, and nothing more is recorded: a recording with
+ * a token missing can't be replayed. The error is then reported by
+ * hubbub_recorder_read().
+ */
+hubbub_error hubbub_recorder_token(hubbub_recorder *recorder,
+		const hubbub_token *token)
+{
+	hubbub_error error;
+	uint8_t type = token->type;
+	size_t start = recorder->len;
+
+	if (recorder->error != HUBBUB_OK)
+		return recorder->error;
+
+	error = recorder_reserve(recorder, 1);
+	if (error != HUBBUB_OK) {
+		recorder->error = error;
+		return error;
+	}
+
+	switch (token->type) {
+	case HUBBUB_TOKEN_DOCTYPE:
+	{
+		const hubbub_doctype *doctype = &token->data.doctype;
+
+		if (doctype->public_missing)
+			type |= REC_PUBLIC_MISSING;
+		if (doctype->system_missing)
+			type |= REC_SYSTEM_MISSING;
+		if (doctype->force_quirks)
+			type |= REC_FORCE_QUIRKS;
+		recorder->data[recorder->len++] = type;
+
+		error = hubbub_recorder_name(recorder, &doctype->name);
+		if (error == HUBBUB_OK && !doctype->public_missing) {
+			error = hubbub_recorder_string(recorder,
+					&doctype->public_id);
+		}
+		if (error == HUBBUB_OK && !doctype->system_missing) {
+			error = hubbub_recorder_string(recorder,
+					&doctype->system_id);
+		}
+	}
+		break;
+	case HUBBUB_TOKEN_START_TAG:
+	case HUBBUB_TOKEN_END_TAG:
+	{
+		const hubbub_tag *tag = &token->data.tag;
+
+		if (tag->self_closing)
+			type |= REC_SELF_CLOSING;
+		type |= (tag->ns << REC_NS_SHIFT) & REC_NS_MASK;
+		recorder->data[recorder->len++] = type;
+
+		error = hubbub_recorder_name(recorder, &tag->name);
+		if (error == HUBBUB_OK) {
+			error = hubbub_recorder_attributes(recorder,
+					tag->attributes, tag->n_attributes);
+		}
+	}
+		break;
+	case HUBBUB_TOKEN_COMMENT:
+		recorder->data[recorder->len++] = type;
+		error = hubbub_recorder_string(recorder, &token->data.comment);
+		break;
+	case HUBBUB_TOKEN_CHARACTER:
+		recorder->data[recorder->len++] = type;
+		error = hubbub_recorder_string(recorder,
+				&token->data.character);
+		break;
+	case HUBBUB_TOKEN_EOF:
+		recorder->data[recorder->len++] = type;
+		break;
+	}
+
+	/* Atoms added for the token are left in the table, but as nothing
+	 * more is recorded, they're never looked up */
+	if (error != HUBBUB_OK) {
+		recorder->len = start;
+		recorder->error = error;
+	}
+
+	return error;
+}
+
+/**
+ * Append a byte to a recording
+ *
+ * \param recorder  The recorder instance
+ * \param value     Value to append
+ * \return HUBBUB_OK on success, HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error hubbub_recorder_byte(hubbub_recorder *recorder, uint8_t value)
+{
+	hubbub_error error;
+
+	error = recorder_reserve(recorder, 1);
+	if (error != HUBBUB_OK)
+		return error;
+
+	recorder->data[recorder->len++] = value;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Append a varint to a recording
+ *
+ * \param recorder  The recorder instance
+ * \param value     Value to append
+ * \return HUBBUB_OK on success, HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error hubbub_recorder_varint(hubbub_recorder *recorder, size_t value)
+{
+	hubbub_error error;
+
+	error = recorder_reserve(recorder, REC_VARINT_MAX);
+	if (error != HUBBUB_OK)
+		return error;
+
+	recorder_varint(recorder, value);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Append a list of attributes to a recording
+ *
+ * \param recorder      The recorder instance
+ * \param attributes    Attributes to append
+ * \param n_attributes  Number of attributes
+ * \return HUBBUB_OK on success, HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error hubbub_recorder_attributes(hubbub_recorder *recorder,
+		const hubbub_attribute *attributes, uint32_t n_attributes)
+{
+	hubbub_error error;
+	uint32_t i;
+
+	error = hubbub_recorder_varint(recorder, n_attributes);
+
+	for (i = 0; i < n_attributes && error == HUBBUB_OK; i++) {
+		const hubbub_attribute *attr = &attributes[i];
+
+		error = hubbub_recorder_byte(recorder, attr->ns);
+		if (error == HUBBUB_OK)
+			error = hubbub_recorder_name(recorder, &attr->name);
+		if (error == HUBBUB_OK)
+			error = hubbub_recorder_string(recorder, &attr->value);
+	}
+
+	return error;
+}
+
+/**
+ * Read the recording made so far
+ *
+ * \param recorder  The recorder instance
+ * \param data      Pointer to location to receive recording
+ * \param len       Pointer to location to receive its length, in bytes
+ * \return HUBBUB_OK on success,
+ *         appropriate error if a token could not be recorded
+ *
+ * The recording is owned by the recorder, and is valid until anything
+ * more is recorded. If a token could not be recorded, the recording holds
+ * the tokens before it.
+ */
+hubbub_error hubbub_recorder_read(const hubbub_recorder *recorder,
+		const uint8_t **data, size_t *len)
+{
+	*data = recorder->data;
+	*len = recorder->len;
+
+	return recorder->error;
+}
+
+/**
+ * Append a string to a recording
+ *
+ * \param recorder  The recorder instance
+ * \param str       String to append
+ * \return HUBBUB_OK on success, HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error hubbub_recorder_string(hubbub_recorder *recorder,
+		const hubbub_string *str)
+{
+	hubbub_error error;
+
+	error = recorder_reserve(recorder, REC_VARINT_MAX + str->len);
+	if (error != HUBBUB_OK)
+		return error;
+
+	recorder_varint(recorder, str->len);
+	if (str->len > 0)
+		memcpy(recorder->data + recorder->len, str->ptr, str->len);
+	recorder->len += str->len;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Append a name to a recording, as an atom
+ *
+ * \param recorder  The recorder instance
+ * \param name      Name to append
+ * \return HUBBUB_OK on success, HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error hubbub_recorder_name(hubbub_recorder *recorder,
+		const hubbub_string *name)
+{
+	uint32_t hash = 2166136261u;
+	uint32_t mask, slot;
+	hubbub_error error;
+	size_t i;
+
+	/* FNV-1a */
+	for (i = 0; i < name->len; i++) {
+		hash ^= name->ptr[i];
+		hash *= 16777619u;
+	}
+
+	error = recorder_reserve(recorder, 2 * REC_VARINT_MAX + name->len);
+	if (error != HUBBUB_OK)
+		return error;
+
+	mask = recorder->atoms_size - 1;
+	for (slot = hash & mask; recorder->atoms[slot].offset != 0;
+			slot = (slot + 1) & mask) {
+		const recorder_atom *atom = &recorder->atoms[slot];
+
+		if (atom->len == name->len && memcmp(recorder->data +
+				atom->offset, name->ptr, name->len) == 0) {
+			recorder_varint(recorder, atom->index);
+			return HUBBUB_OK;
+		}
+	}
+
+	/* New name: introduce it */
+	recorder_varint(recorder, recorder->n_atoms);
+	recorder_varint(recorder, name->len);
+
+	recorder->atoms[slot].offset = recorder->len;
+	recorder->atoms[slot].len = name->len;
+	recorder->atoms[slot].index = recorder->n_atoms++;
+
+	if (name->len > 0)
+		memcpy(recorder->data + recorder->len, name->ptr, name->len);
+	recorder->len += name->len;
+
+	/* Keep the table at most half full */
+	if (recorder->n_atoms * 2 > recorder->atoms_size)
+		return recorder_grow_atoms(recorder);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Ensure there is space for more data in a recording
+ *
+ * \param recorder  The recorder instance
+ * \param len       Number of bytes required
+ * \return HUBBUB_OK on success, HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error recorder_reserve(hubbub_recorder *recorder, size_t len)
+{
+	size_t alloc_len = recorder->alloc_len;
+	uint8_t *data;
+
+	if (recorder->alloc_len - recorder->len >= len)
+		return HUBBUB_OK;
+
+	while (alloc_len - recorder->len < len)
+		alloc_len *= 2;
+
+	data = recorder->alloc(recorder->data, alloc_len, recorder->pw);
+	if (data == NULL)
+		return HUBBUB_NOMEM;
+
+	recorder->data = data;
+	recorder->alloc_len = alloc_len;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Append a varint to a recording, which must have space for it
+ *
+ * \param recorder  The recorder instance
+ * \param value     Value to append
+ */
+void recorder_varint(hubbub_recorder *recorder, size_t value)
+{
+	while (value >= 0x80) {
+		recorder->data[recorder->len++] = (value & 0x7f) | 0x80;
+		value >>= 7;
+	}
+
+	recorder->data[recorder->len++] = value;
+}
+
+/**
+ * Double the size of a recorder's atom table
+ *
+ * \param recorder  The recorder instance
+ * \return HUBBUB_OK on success, HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error recorder_grow_atoms(hubbub_recorder *recorder)
+{
+	uint32_t size = recorder->atoms_size * 2;
+	uint32_t mask = size - 1;
+	recorder_atom *atoms;
+	uint32_t i;
+
+	atoms = recorder->alloc(NULL, size * sizeof(recorder_atom),
+			recorder->pw);
+	if (atoms == NULL)
+		return HUBBUB_NOMEM;
+	memset(atoms, 0, size * sizeof(recorder_atom));
+
+	for (i = 0; i < recorder->atoms_size; i++) {
+		const recorder_atom *atom = &recorder->atoms[i];
+		const uint8_t *name = recorder->data + atom->offset;
+		uint32_t hash = 2166136261u;
+		uint32_t slot;
+		size_t j;
+
+		if (atom->offset == 0)
+			continue;
+
+		for (j = 0; j < atom->len; j++) {
+			hash ^= name[j];
+			hash *= 16777619u;
+		}
+
+		for (slot = hash & mask; atoms[slot].offset != 0;
+				slot = (slot + 1) & mask)
+			;
+
+		atoms[slot] = *atom;
+	}
+
+	recorder->alloc(recorder->atoms, 0, recorder->pw);
+	recorder->atoms = atoms;
+	recorder->atoms_size = size;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Start reading a recording
+ *
+ * \param replay  Reader to initialise
+ * \param magic   Magic number identifying the expected content, one of
+ *                the HUBBUB_RECORDING_* strings
+ * \param data    Recording
+ * \param len     Length of recording, in bytes
+ * \param alloc   Memory (de)allocation function
+ * \param pw      Pointer to client-specific private data (may be NULL)
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_BADPARM on bad parameters,
+ *         HUBBUB_INVALID if the recording is of something else
+ *
+ * The reader must be finalised once done with, unless this fails.
+ */
+hubbub_error hubbub_replay_init(hubbub_replay *replay, const char *magic,
+		const uint8_t *data, size_t len,
+		hubbub_allocator_fn alloc, void *pw)
+{
+	if (replay == NULL || magic == NULL || data == NULL || alloc == NULL)
+		return HUBBUB_BADPARM;
+
+	if (len < REC_HEADER_LEN ||
+			memcmp(data, magic, REC_MAGIC_LEN) != 0 ||
+			data[REC_MAGIC_LEN] != REC_VERSION)
+		return HUBBUB_INVALID;
+
+	memset(replay, 0, sizeof(hubbub_replay));
+	replay->ptr = data + REC_HEADER_LEN;
+	replay->end = data + len;
+	replay->alloc = alloc;
+	replay->pw = pw;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Finish reading a recording
+ *
+ * \param replay  The reader
+ */
+void hubbub_replay_finalise(hubbub_replay *replay)
+{
+	if (replay->attrs != NULL)
+		replay->alloc(replay->attrs, 0, replay->pw);
+	if (replay->names != NULL)
+		replay->alloc(replay->names, 0, replay->pw);
+}
+
+/**
+ * Read a name from a recording
+ *
+ * \param replay  The reader
+ * \param name    Pointer to location to receive name
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_INVALID if the recording is malformed,
+ *         HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error hubbub_replay_name(hubbub_replay *replay, hubbub_string *name)
+{
+	size_t index;
+
+	if (hubbub_replay_varint(replay, &index) == false ||
+			index > replay->n_names)
+		return HUBBUB_INVALID;
+
+	if (index < replay->n_names) {
+		*name = replay->names[index];
+		return HUBBUB_OK;
+	}
+
+	if (hubbub_replay_string(replay, name) == false)
+		return HUBBUB_INVALID;
+
+	if (replay->n_names == replay->names_alloc) {
+		size_t alloc = replay->names_alloc ?
+				replay->names_alloc * 2 : 64;
+		hubbub_string *names = replay->alloc(replay->names,
+				alloc * sizeof(hubbub_string), replay->pw);
+		if (names == NULL)
+			return HUBBUB_NOMEM;
+
+		replay->names = names;
+		replay->names_alloc = alloc;
+	}
+
+	replay->names[replay->n_names++] = *name;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Read a list of attributes from a recording
+ *
+ * \param replay        The reader
+ * \param attributes    Pointer to location to receive attributes, or NULL
+ *                      if there are none
+ * \param n_attributes  Pointer to location to receive number of attributes
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_INVALID if the recording is malformed,
+ *         HUBBUB_NOMEM on memory exhaustion
+ *
+ * The attributes belong to the reader, and are valid until it next reads
+ * any.
+ */
+hubbub_error hubbub_replay_attributes(hubbub_replay *replay,
+		hubbub_attribute **attributes, uint32_t *n_attributes)
+{
+	hubbub_error error;
+	size_t n, i;
+
+	/* Every attribute takes at least three bytes */
+	if (hubbub_replay_varint(replay, &n) == false ||
+			n > (size_t) (replay->end - replay->ptr) / 3)
+		return HUBBUB_INVALID;
+
+	if (n > replay->attrs_alloc) {
+		hubbub_attribute *attrs = replay->alloc(replay->attrs,
+				n * sizeof(hubbub_attribute), replay->pw);
+		if (attrs == NULL)
+			return HUBBUB_NOMEM;
+
+		replay->attrs = attrs;
+		replay->attrs_alloc = n;
+	}
+
+	for (i = 0; i < n; i++) {
+		hubbub_attribute *attr = &replay->attrs[i];
+
+		if (replay->ptr == replay->end)
+			return HUBBUB_INVALID;
+		attr->ns = (hubbub_ns) *replay->ptr++;
+
+		error = hubbub_replay_name(replay, &attr->name);
+		if (error != HUBBUB_OK)
+			return error;
+		if (hubbub_replay_string(replay, &attr->value) == false)
+			return HUBBUB_INVALID;
+		attr->value_id = 0;
+	}
+
+	*attributes = n > 0 ? replay->attrs : NULL;
+	*n_attributes = n;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Read a token from a recording
+ *
+ * \param replay  The reader
+ * \param token   Pointer to location to receive token
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_INVALID if the recording is malformed,
+ *         HUBBUB_NOMEM on memory exhaustion
+ *
+ * Token data points into the recording, or belongs to the reader.
+ */
+hubbub_error hubbub_replay_token(hubbub_replay *replay, hubbub_token *token)
+{
+	hubbub_error error = HUBBUB_OK;
+	uint8_t type;
+
+	if (replay->ptr == replay->end)
+		return HUBBUB_INVALID;
+
+	type = *replay->ptr++;
+	token->type = (hubbub_token_type) (type & REC_TYPE_MASK);
+
+	switch (token->type) {
+	case HUBBUB_TOKEN_DOCTYPE:
+	{
+		hubbub_doctype *doctype = &token->data.doctype;
+
+		doctype->public_missing = (type & REC_PUBLIC_MISSING) != 0;
+		doctype->system_missing = (type & REC_SYSTEM_MISSING) != 0;
+		doctype->force_quirks = (type & REC_FORCE_QUIRKS) != 0;
+		doctype->public_id.ptr = doctype->system_id.ptr = NULL;
+		doctype->public_id.len = doctype->system_id.len = 0;
+
+		error = hubbub_replay_name(replay, &doctype->name);
+		if (error == HUBBUB_OK && !doctype->public_missing &&
+				!hubbub_replay_string(replay,
+						&doctype->public_id))
+			error = HUBBUB_INVALID;
+		if (error == HUBBUB_OK && !doctype->system_missing &&
+				!hubbub_replay_string(replay,
+						&doctype->system_id))
+			error = HUBBUB_INVALID;
+	}
+		break;
+	case HUBBUB_TOKEN_START_TAG:
+	case HUBBUB_TOKEN_END_TAG:
+	{
+		hubbub_tag *tag = &token->data.tag;
+
+		tag->self_closing = (type & REC_SELF_CLOSING) != 0;
+		tag->ns = (hubbub_ns) ((type & REC_NS_MASK) >> REC_NS_SHIFT);
+
+		error = hubbub_replay_name(replay, &tag->name);
+		if (error == HUBBUB_OK) {
+			error = hubbub_replay_attributes(replay,
+					&tag->attributes, &tag->n_attributes);
+		}
+	}
+		break;
+	case HUBBUB_TOKEN_COMMENT:
+		if (!hubbub_replay_string(replay, &token->data.comment))
+			error = HUBBUB_INVALID;
+		break;
+	case HUBBUB_TOKEN_CHARACTER:
+		if (!hubbub_replay_string(replay, &token->data.character))
+			error = HUBBUB_INVALID;
+		break;
+	case HUBBUB_TOKEN_EOF:
+		break;
+	default:
+		error = HUBBUB_INVALID;
+	}
+
+	return error;
+}
+
+/**
+ * Pass the tokens in a recording to a token handler
+ *
+ * \param data        Recording of tokens
+ * \param len         Length of recording, in bytes
+ * \param handler     Token handler
+ * \param handler_pw  Client data for ::handler
+ * \param alloc       Memory (de)allocation function
+ * \param pw          Pointer to client-specific private data (may be NULL)
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_INVALID if the recording is malformed,
+ *         HUBBUB_NOMEM on memory exhaustion,
+ *         the handler's error if it fails
+ *
+ * Token data points into ::data, and is valid for as long as it is.
+ * Replay ends at the first token the handler does not accept.
+ */
+hubbub_error hubbub_recorder_replay(const uint8_t *data, size_t len,
+		hubbub_token_handler handler, void *handler_pw,
+		hubbub_allocator_fn alloc, void *pw)
+{
+	hubbub_replay replay;
+	hubbub_token token;
+	hubbub_error error;
+
+	if (handler == NULL)
+		return HUBBUB_BADPARM;
+
+	error = hubbub_replay_init(&replay, HUBBUB_RECORDING_TOKENS,
+			data, len, alloc, pw);
+	if (error != HUBBUB_OK)
+		return error;
+
+	while (replay.ptr < replay.end && error == HUBBUB_OK) {
+		error = hubbub_replay_token(&replay, &token);
+		if (error == HUBBUB_OK)
+			error = handler(&token, handler_pw);
+	}
+
+	hubbub_replay_finalise(&replay);
+
+	return error;
+}
+
@@ -0,0 +1,143 @@
+/*
+ * This file is part of Hubbub.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ */
+
+#ifndef hubbub_tokeniser_recorder_h_
+#define hubbub_tokeniser_recorder_h_
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include <hubbub/errors.h>
+#include <hubbub/functypes.h>
+#include <hubbub/types.h>
+
+/* Magic numbers identifying the content of a recording */
+#define HUBBUB_RECORDING_TOKENS	"HBTK"
+#define HUBBUB_RECORDING_TREE	"HBTR"
+
+typedef struct hubbub_recorder hubbub_recorder;
+
+/* Create a recorder */
+hubbub_error hubbub_recorder_create(const char *magic,
+		hubbub_allocator_fn alloc, void *pw,
+		hubbub_recorder **recorder);
+/* Destroy a recorder */
+hubbub_error hubbub_recorder_destroy(hubbub_recorder *recorder);
+
+/* Append a byte to a recording */
+hubbub_error hubbub_recorder_byte(hubbub_recorder *recorder, uint8_t value);
+/* Append a varint to a recording */
+hubbub_error hubbub_recorder_varint(hubbub_recorder *recorder, size_t value);
+/* Append a string to a recording */
+hubbub_error hubbub_recorder_string(hubbub_recorder *recorder,
+		const hubbub_string *str);
+/* Append a name to a recording */
+hubbub_error hubbub_recorder_name(hubbub_recorder *recorder,
+		const hubbub_string *name);
+/* Append a list of attributes to a recording */
+hubbub_error hubbub_recorder_attributes(hubbub_recorder *recorder,
+		const hubbub_attribute *attributes, uint32_t n_attributes);
+/* Append a token to a recording */
+hubbub_error hubbub_recorder_token(hubbub_recorder *recorder,
+		const hubbub_token *token);
+
+/* Read the recording made so far */
+hubbub_error hubbub_recorder_read(const hubbub_recorder *recorder,
+		const uint8_t **data, size_t *len);
+
+/**
+ * Reader of a recording
+ */
+typedef struct hubbub_replay {
+	const uint8_t *ptr;		/**< Current position */
+	const uint8_t *end;		/**< End of recording */
+
+	hubbub_string *names;		/**< Names seen so far */
+	size_t n_names;			/**< Number of names */
+	size_t names_alloc;		/**< Number of names allocated */
+
+	hubbub_attribute *attrs;	/**< Most recently read attributes */
+	size_t attrs_alloc;		/**< Number of attributes allocated */
+
+	hubbub_allocator_fn alloc;	/**< Memory (de)allocation function */
+	void *pw;			/**< Client data */
+} hubbub_replay;
+
+/* Start reading a recording */
+hubbub_error hubbub_replay_init(hubbub_replay *replay, const char *magic,
+		const uint8_t *data, size_t len,
+		hubbub_allocator_fn alloc, void *pw);
+/* Finish reading a recording */
+void hubbub_replay_finalise(hubbub_replay *replay);
+
+/* Read a name from a recording */
+hubbub_error hubbub_replay_name(hubbub_replay *replay, hubbub_string *name);
+/* Read a list of attributes from a recording */
+hubbub_error hubbub_replay_attributes(hubbub_replay *replay,
+		hubbub_attribute **attributes, uint32_t *n_attributes);
+/* Read a token from a recording */
+hubbub_error hubbub_replay_token(hubbub_replay *replay, hubbub_token *token);
+
+/* Pass the tokens in a recording to a token handler */
+hubbub_error hubbub_recorder_replay(const uint8_t *data, size_t len,
+		hubbub_token_handler handler, void *handler_pw,
+		hubbub_allocator_fn alloc, void *pw);
+
+/**
+ * Read a varint from a recording
+ *
+ * \param replay  The reader
+ * \param value   Pointer to location to receive value
+ * \return true on success, false if the recording is malformed
+ */
+static inline bool hubbub_replay_varint(hubbub_replay *replay, size_t *value)
+{
+	const uint8_t *p = replay->ptr;
+	size_t v = 0;
+	unsigned shift = 0;
+
+	while (p < replay->end && shift < sizeof(size_t) * 8) {
+		uint8_t c = *p++;
+
+		v |= (size_t) (c & 0x7f) << shift;
+		if ((c & 0x80) == 0) {
+			replay->ptr = p;
+			*value = v;
+			return true;
+		}
+
+		shift += 7;
+	}
+
+	return false;
+}
+
+/**
+ * Read a string from a recording
+ *
+ * \param replay  The reader
+ * \param str     Pointer to location to receive string, which points
+ *                into the recording
+ * \return true on success, false if the recording is malformed
+ */
+static inline bool hubbub_replay_string(hubbub_replay *replay,
+		hubbub_string *str)
+{
+	size_t len;
+
+	if (hubbub_replay_varint(replay, &len) == false ||
+			len > (size_t) (replay->end - replay->ptr))
+		return false;
+
+	str->ptr = replay->ptr;
+	str->len = len;
+	replay->ptr += len;
+
+	return true;
+}
+
+#endif
+
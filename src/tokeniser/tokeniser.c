@@ -18,6 +18,7 @@
 
 #include "hubbub/errors.h"
 #include "tokeniser/entities.h"
+#include "tokeniser/intern.h"
 #include "tokeniser/tokeniser.h"
 
 /**
@@ -157,6 +158,10 @@ typedef struct hubbub_tokeniser_context {
 
 	uint32_t allowed_char;			/**< Used for quote matching */
 
+	bool skip_attribute;			/**< Whether the current
+						 * attribute is being
+						 * filtered out */
+
 } hubbub_tokeniser_context;
 
 /**
@@ -169,6 +174,8 @@ struct hubbub_tokeniser {
 	bool escape_flag;		/**< Escape flag **/
 	bool process_cdata_section;	/**< Whether to process CDATA sections*/
 	bool paused; /**< flag for if parsing is currently paused */
+	bool stopped;			/**< Whether a token handler has
+					 * asked for tokenisation to end */
 
 	parserutils_inputstream *input;	/**< Input stream */
 	parserutils_buffer *buffer;	/**< Input buffer */
@@ -182,6 +189,22 @@ struct hubbub_tokeniser {
 	hubbub_error_handler error_handler;	/**< Error handling callback */
 	void *error_pw;				/**< Error handler data */
 
+	const char **attr_names;	/**< Attributes to keep, or NULL */
+	const char **attr_tags;		/**< Tags to keep attributes on,
+					 * or NULL */
+
+	hubbub_recorder *recorder;	/**< Recorder of emitted tokens, or
+					 * NULL */
+
+	bool intern_values;		/**< Whether to intern attribute
+					 * values */
+	hubbub_intern *intern;		/**< Cache of interned values, or
+					 * NULL if not yet needed */
+
+	bool streaming;			/**< Whether to discard consumed
+					 * input */
+	uint64_t offset;		/**< Bytes of input consumed */
+
 	hubbub_allocator_fn alloc;	/**< Memory (de)allocation function */
 	void *alloc_pw;			/**< Client private data */
 };
@@ -266,6 +289,19 @@ static hubbub_error hubbub_tokeniser_handle_numbered_entity(
 static hubbub_error hubbub_tokeniser_handle_named_entity(
 		hubbub_tokeniser *tokeniser);
 
+static bool hubbub_tokeniser_name_listed(const char **list,
+		const uint8_t *name, size_t len);
+static bool hubbub_tokeniser_skip_tag_attributes(hubbub_tokeniser *tokeniser);
+static hubbub_error hubbub_tokeniser_filter_attribute(
+		hubbub_tokeniser *tokeniser);
+static hubbub_error hubbub_tokeniser_skip_quoted_value(
+		hubbub_tokeniser *tokeniser, const uint8_t *cptr, size_t len,
+		uint8_t quote);
+
+static inline void hubbub_tokeniser_advance(hubbub_tokeniser *tokeniser,
+		size_t bytes);
+static void hubbub_tokeniser_discard_consumed(hubbub_tokeniser *tokeniser);
+
 static inline hubbub_error emit_character_token(hubbub_tokeniser *tokeniser,
 		const hubbub_string *chars);
 static inline hubbub_error emit_current_chars(hubbub_tokeniser *tokeniser);
@@ -321,6 +357,7 @@ hubbub_error hubbub_tokeniser_create(parserutils_inputstream *input,
 	tok->process_cdata_section = false;
 
 	tok->paused = false;
+	tok->stopped = false;
 
 	tok->input = input;
 
@@ -330,6 +367,17 @@ hubbub_error hubbub_tokeniser_create(parserutils_inputstream *input,
 	tok->error_handler = NULL;
 	tok->error_pw = NULL;
 
+	tok->attr_names = NULL;
+	tok->attr_tags = NULL;
+
+	tok->recorder = NULL;
+
+	tok->intern_values = false;
+	tok->intern = NULL;
+
+	tok->streaming = false;
+	tok->offset = 0;
+
 	tok->alloc = alloc;
 	tok->alloc_pw = pw;
 
@@ -356,6 +404,9 @@ hubbub_error hubbub_tokeniser_destroy(hubbub_tokeniser *tokeniser)
 				0, tokeniser->alloc_pw);
 	}
 
+	if (tokeniser->intern != NULL)
+		hubbub_intern_destroy(tokeniser->intern);
+
 	parserutils_buffer_destroy(tokeniser->insert_buf);
 
 	parserutils_buffer_destroy(tokeniser->buffer);
@@ -365,6 +416,96 @@ hubbub_error hubbub_tokeniser_destroy(hubbub_tokeniser *tokeniser)
 	return HUBBUB_OK;
 }
 
+/**
+ * Clone a hubbub tokeniser
+ *
+ * The clone is in exactly the state of the original, part-built token
+ * and all. It reads from ::input, which must contain the same unconsumed
+ * data as the original's input stream, and reports tokens to the same
+ * handler until told otherwise.
+ *
+ * \param tokeniser  The tokeniser instance to clone
+ * \param input      Input stream for the clone
+ * \param clone      Pointer to location to receive clone
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_BADPARM on bad parameters,
+ *         HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error hubbub_tokeniser_clone(hubbub_tokeniser *tokeniser,
+		parserutils_inputstream *input, hubbub_tokeniser **clone)
+{
+	parserutils_error perror;
+	hubbub_tokeniser *tok;
+	hubbub_tag *ctag;
+
+	if (tokeniser == NULL || input == NULL || clone == NULL)
+		return HUBBUB_BADPARM;
+
+	tok = tokeniser->alloc(NULL, sizeof(hubbub_tokeniser),
+			tokeniser->alloc_pw);
+	if (tok == NULL)
+		return HUBBUB_NOMEM;
+
+	*tok = *tokeniser;
+
+	tok->input = input;
+
+	/* Recordings aren't shared */
+	tok->recorder = NULL;
+
+	/* Nor are interned values, whose IDs are per tokeniser */
+	tok->intern = NULL;
+
+	ctag = &tok->context.current_tag;
+	ctag->attributes = NULL;
+
+	perror = parserutils_buffer_create(tok->alloc, tok->alloc_pw,
+			&tok->buffer);
+	if (perror != PARSERUTILS_OK) {
+		tok->alloc(tok, 0, tok->alloc_pw);
+		return hubbub_error_from_parserutils_error(perror);
+	}
+
+	perror = parserutils_buffer_create(tok->alloc, tok->alloc_pw,
+			&tok->insert_buf);
+	if (perror != PARSERUTILS_OK) {
+		parserutils_buffer_destroy(tok->buffer);
+		tok->alloc(tok, 0, tok->alloc_pw);
+		return hubbub_error_from_parserutils_error(perror);
+	}
+
+	/* Token data lives in the buffer, as offsets and lengths */
+	perror = parserutils_buffer_append(tok->buffer,
+			tokeniser->buffer->data, tokeniser->buffer->length);
+	if (perror == PARSERUTILS_OK) {
+		perror = parserutils_buffer_append(tok->insert_buf,
+				tokeniser->insert_buf->data,
+				tokeniser->insert_buf->length);
+	}
+
+	if (perror == PARSERUTILS_OK && ctag->n_attributes > 0) {
+		ctag->attributes = tok->alloc(NULL, ctag->n_attributes *
+				sizeof(hubbub_attribute), tok->alloc_pw);
+		if (ctag->attributes == NULL) {
+			perror = PARSERUTILS_NOMEM;
+		} else {
+			memcpy(ctag->attributes,
+				tokeniser->context.current_tag.attributes,
+				ctag->n_attributes *
+				sizeof(hubbub_attribute));
+		}
+	}
+
+	if (perror != PARSERUTILS_OK) {
+		hubbub_tokeniser_destroy(tok);
+		return hubbub_error_from_parserutils_error(perror);
+	}
+
+	*clone = tok;
+
+	return HUBBUB_OK;
+}
+
 /**
  * Configure a hubbub tokeniser
  *
@@ -406,6 +547,28 @@ hubbub_error hubbub_tokeniser_setopt(hubbub_tokeniser *tokeniser,
 				err = hubbub_tokeniser_run(tokeniser);
 			}
 		}
+		break;
+	case HUBBUB_TOKENISER_INPUT:
+		/* The new stream must contain the same unconsumed data */
+		if (params->input == NULL)
+			return HUBBUB_BADPARM;
+		tokeniser->input = params->input;
+		break;
+	case HUBBUB_TOKENISER_ATTRIBUTE_FILTER:
+		/* The lists are not copied, so must outlive the tokeniser */
+		tokeniser->attr_names = params->attribute_filter.names;
+		tokeniser->attr_tags = params->attribute_filter.tags;
+		break;
+	case HUBBUB_TOKENISER_RECORDER:
+		tokeniser->recorder = params->recorder;
+		break;
+	case HUBBUB_TOKENISER_INTERN_VALUES:
+		/* Values already interned stay valid until destruction */
+		tokeniser->intern_values = params->intern_values;
+		break;
+	case HUBBUB_TOKENISER_STREAMING:
+		tokeniser->streaming = params->streaming;
+		break;
 	}
 
 	return err;
@@ -437,6 +600,40 @@ hubbub_error hubbub_tokeniser_insert_chunk(hubbub_tokeniser *tokeniser,
 	return HUBBUB_OK;
 }
 
+/**
+ * Pass the tokens in a recording to the token handler
+ *
+ * \param tokeniser  The tokeniser instance
+ * \param data       Recording made by a hubbub_recorder
+ * \param len        Length of recording, in bytes
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ *
+ * The recording stands in for the tokeniser's input: the tokeniser's own
+ * state is untouched, other than to note a request to stop.
+ */
+hubbub_error hubbub_tokeniser_replay(hubbub_tokeniser *tokeniser,
+		const uint8_t *data, size_t len)
+{
+	hubbub_error error;
+
+	if (tokeniser == NULL || data == NULL)
+		return HUBBUB_BADPARM;
+
+	if (tokeniser->stopped == true)
+		return HUBBUB_STOPPED;
+
+	if (tokeniser->token_handler == NULL)
+		return HUBBUB_OK;
+
+	error = hubbub_recorder_replay(data, len, tokeniser->token_handler,
+			tokeniser->token_pw, tokeniser->alloc,
+			tokeniser->alloc_pw);
+	if (error == HUBBUB_STOPPED)
+		tokeniser->stopped = true;
+
+	return error;
+}
+
 /**
  * Process remaining data in the input stream
  *
@@ -453,6 +650,9 @@ hubbub_error hubbub_tokeniser_run(hubbub_tokeniser *tokeniser)
 	if (tokeniser->paused == true)
 		return HUBBUB_PAUSED;
 
+	if (tokeniser->stopped == true)
+		return HUBBUB_STOPPED;
+
 #if 0
 #define state(x) \
 		case x: \
@@ -621,11 +821,92 @@ hubbub_error hubbub_tokeniser_run(hubbub_tokeniser *tokeniser)
 					tokeniser);
 			break;
 		}
+
+		/* Character tokens are emitted without checking the
+		 * handler's response, so look for a stop or pause here.
+		 * A pause is reported even if we've run out of input, so
+		 * that the client knows to resume us */
+		if (tokeniser->stopped == true)
+			cont = HUBBUB_STOPPED;
+		else if (tokeniser->paused == true && (cont == HUBBUB_OK ||
+				cont == HUBBUB_NEEDDATA))
+			cont = HUBBUB_PAUSED;
 	}
 
+	if (tokeniser->streaming)
+		hubbub_tokeniser_discard_consumed(tokeniser);
+
 	return (cont == HUBBUB_NEEDDATA) ? HUBBUB_OK : cont;
 }
 
+/**
+ * Read the amount of input consumed
+ *
+ * \param tokeniser  The tokeniser instance to query
+ * \return Number of bytes of (UTF-8) input consumed so far
+ */
+uint64_t hubbub_tokeniser_read_offset(hubbub_tokeniser *tokeniser)
+{
+	return tokeniser->offset;
+}
+
+/**
+ * Read the amount of input read, but not yet consumed
+ *
+ * \param tokeniser  The tokeniser instance to query
+ * \return Number of bytes of (UTF-8) input beyond the offset which make up
+ *         the token being processed
+ *
+ * Input is consumed once a token has been handled, so while the token
+ * handler is running, this is the length of the token's source.
+ */
+size_t hubbub_tokeniser_read_pending(hubbub_tokeniser *tokeniser)
+{
+	return tokeniser->context.pending;
+}
+
+/**
+ * Advance the input stream's current position
+ *
+ * \param tokeniser  The tokeniser instance
+ * \param bytes      The number of bytes to advance
+ */
+void hubbub_tokeniser_advance(hubbub_tokeniser *tokeniser, size_t bytes)
+{
+	parserutils_inputstream_advance(tokeniser->input, bytes);
+	tokeniser->offset += bytes;
+}
+
+/**
+ * Discard input that the tokeniser has finished with
+ *
+ * \param tokeniser  The tokeniser instance
+ *
+ * Between runs, the tokeniser refers to nothing before the stream's
+ * current position. Input is only discarded once there's more of it than
+ * remains unconsumed, so the cost of moving the remainder is amortised.
+ *
+ * libparserutils has no API for this, so it relies on the layout of
+ * parserutils_inputstream: utf8 holds the input decoded so far, cursor
+ * is the offset of the current position within it, and nothing else in
+ * the stream records an offset into utf8. Any change to how the stream
+ * buffers its input must be reflected here. test/tokeniser.c checks that
+ * the buffer stays bounded, and test/parser.c that streaming leaves the
+ * tokens emitted unchanged.
+ */
+void hubbub_tokeniser_discard_consumed(hubbub_tokeniser *tokeniser)
+{
+	parserutils_inputstream *input = tokeniser->input;
+	size_t consumed = input->cursor;
+
+	if (consumed < HUBBUB_TOKENISER_DISCARD_MIN ||
+			consumed < input->utf8->length - consumed)
+		return;
+
+	parserutils_buffer_discard(input->utf8, 0, consumed);
+	input->cursor = 0;
+}
+
 
 /**
  * Various macros for manipulating buffers.
@@ -758,7 +1039,7 @@ hubbub_error hubbub_tokeniser_handle_data(hubbub_tokeniser *tokeniser)
 			emit_character_token(tokeniser, &u_fffd_str);
 
 			/* Advance past NUL */
-			parserutils_inputstream_advance(tokeniser->input, 1);
+			hubbub_tokeniser_advance(tokeniser, 1);
 		} else if (c == '\r') {
 			error = parserutils_inputstream_peek(
 					tokeniser->input,
@@ -782,7 +1063,7 @@ hubbub_error hubbub_tokeniser_handle_data(hubbub_tokeniser *tokeniser)
 			}
 
 			/* Advance over */
-			parserutils_inputstream_advance(tokeniser->input, 1);
+			hubbub_tokeniser_advance(tokeniser, 1);
 		} else {
 			/* Just collect into buffer */
 			tokeniser->context.pending += len;
@@ -797,8 +1078,17 @@ hubbub_error hubbub_tokeniser_handle_data(hubbub_tokeniser *tokeniser)
 	}
 
 	if (error == PARSERUTILS_EOF) {
+		/* The handler of those characters may have paused us, in
+		 * which case the EOF token waits until we're resumed */
+		if (tokeniser->paused == true)
+			return HUBBUB_PAUSED;
+
 		token.type = HUBBUB_TOKEN_EOF;
 		hubbub_tokeniser_emit_token(tokeniser, &token);
+
+		/* Nothing follows the EOF token, so a pause asked for by
+		 * its handler has nothing to hold back */
+		tokeniser->paused = false;
 	}
 
 	if (error == PARSERUTILS_EOF) {
@@ -837,7 +1127,7 @@ hubbub_error hubbub_tokeniser_handle_character_reference_data(
 			hubbub_tokeniser_emit_token(tokeniser, &token);
 
 			/* +1 for ampersand */
-			parserutils_inputstream_advance(tokeniser->input,
+			hubbub_tokeniser_advance(tokeniser,
 					tokeniser->context.match_entity.length
 							+ 1);
 		} else {
@@ -858,7 +1148,7 @@ hubbub_error hubbub_tokeniser_handle_character_reference_data(
 			token.data.character.len = len;
 
 			hubbub_tokeniser_emit_token(tokeniser, &token);
-			parserutils_inputstream_advance(tokeniser->input, len);
+			hubbub_tokeniser_advance(tokeniser, len);
 		}
 
 		/* Reset for next time */
@@ -913,7 +1203,7 @@ hubbub_error hubbub_tokeniser_handle_tag_open(hubbub_tokeniser *tokeniser)
 		tokeniser->state = STATE_DATA;
 	} else if (tokeniser->content_model == HUBBUB_CONTENT_MODEL_PCDATA) {
 		if (c == '!') {
-			parserutils_inputstream_advance(tokeniser->input,
+			hubbub_tokeniser_advance(tokeniser,
 					SLEN("<!"));
 
 			tokeniser->context.pending = 0;
@@ -947,8 +1237,8 @@ hubbub_error hubbub_tokeniser_handle_tag_open(hubbub_tokeniser *tokeniser)
 			/** \todo parse error */
 
 			/* Cursor still at "<", need to advance past it */
-			parserutils_inputstream_advance(
-					tokeniser->input, SLEN("<"));
+			hubbub_tokeniser_advance(
+					tokeniser, SLEN("<"));
 			tokeniser->context.pending = 0;
 
 			tokeniser->state = STATE_BOGUS_COMMENT;
@@ -986,7 +1276,13 @@ hubbub_error hubbub_tokeniser_handle_close_tag_open(hubbub_tokeniser *tokeniser)
 		size_t start_tag_len =
 			tokeniser->context.last_start_tag_len;
 
-		while ((error = parserutils_inputstream_peek(tokeniser->input,
+		/* We may be back here, having matched the whole name, for
+		 * want of the character after it. Don't match further, as
+		 * a space would match the NUL after the name. */
+		error = PARSERUTILS_OK;
+		while (ctx->close_tag_match.match == false &&
+				(error = parserutils_inputstream_peek(
+					tokeniser->input,
 					ctx->pending +
 						ctx->close_tag_match.count,
 					&cptr,
@@ -1085,7 +1381,7 @@ hubbub_error hubbub_tokeniser_handle_close_tag_open(hubbub_tokeniser *tokeniser)
 			tokeniser->context.pending += len;
 
 			/* Now need to advance past "</>" */
-			parserutils_inputstream_advance(tokeniser->input,
+			hubbub_tokeniser_advance(tokeniser,
 					tokeniser->context.pending);
 			tokeniser->context.pending = 0;
 
@@ -1095,7 +1391,7 @@ hubbub_error hubbub_tokeniser_handle_close_tag_open(hubbub_tokeniser *tokeniser)
 			/** \todo parse error */
 
 			/* Cursor still at "</", need to advance past it */
-			parserutils_inputstream_advance(tokeniser->input,
+			hubbub_tokeniser_advance(tokeniser,
 					tokeniser->context.pending);
 			tokeniser->context.pending = 0;
 
@@ -1161,6 +1457,110 @@ hubbub_error hubbub_tokeniser_handle_tag_name(hubbub_tokeniser *tokeniser)
 	return HUBBUB_OK;
 }
 
+/**
+ * Determine if a name appears in an attribute filter list
+ *
+ * \param list  NULL-terminated list of names
+ * \param name  Name to look for
+ * \param len   Length, in bytes, of name
+ * \return true if the name is listed, false otherwise
+ */
+bool hubbub_tokeniser_name_listed(const char **list,
+		const uint8_t *name, size_t len)
+{
+	for (; *list != NULL; list++) {
+		if (strncmp(*list, (const char *) name, len) == 0 &&
+				(*list)[len] == '\0')
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * Determine if all attributes of the current tag are filtered out
+ *
+ * \param tokeniser  Tokeniser instance
+ * \return true if the tag's attributes are unwanted, false otherwise
+ */
+bool hubbub_tokeniser_skip_tag_attributes(hubbub_tokeniser *tokeniser)
+{
+	/* The tag name is always at the start of the buffer */
+	return tokeniser->attr_tags != NULL &&
+		hubbub_tokeniser_name_listed(tokeniser->attr_tags,
+			tokeniser->buffer->data,
+			tokeniser->context.current_tag.name.len) == false;
+}
+
+/**
+ * Discard the current attribute if its name is filtered out
+ *
+ * \param tokeniser  Tokeniser instance
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error hubbub_tokeniser_filter_attribute(hubbub_tokeniser *tokeniser)
+{
+	hubbub_tag *ctag = &tokeniser->context.current_tag;
+	hubbub_string *name;
+	size_t offset;
+	parserutils_error perror;
+
+	if (tokeniser->attr_names == NULL ||
+			tokeniser->context.skip_attribute)
+		return HUBBUB_OK;
+
+	/* The name was the last thing to be buffered */
+	name = &ctag->attributes[ctag->n_attributes - 1].name;
+	offset = tokeniser->buffer->length - name->len;
+
+	if (hubbub_tokeniser_name_listed(tokeniser->attr_names,
+			tokeniser->buffer->data + offset, name->len))
+		return HUBBUB_OK;
+
+	perror = parserutils_buffer_discard(tokeniser->buffer,
+			offset, name->len);
+	if (perror != PARSERUTILS_OK)
+		return hubbub_error_from_parserutils_error(perror);
+
+	ctag->n_attributes--;
+	tokeniser->context.skip_attribute = true;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Pass over a quoted value of a filtered out attribute
+ *
+ * Rather than walking it a character at a time, scan all the decoded
+ * data that follows for the closing quote.
+ *
+ * \param tokeniser  Tokeniser instance
+ * \param cptr       Pointer to current character
+ * \param len        Length, in bytes, of current character
+ * \param quote      Quote character that ends the value
+ * \return HUBBUB_OK
+ */
+hubbub_error hubbub_tokeniser_skip_quoted_value(hubbub_tokeniser *tokeniser,
+		const uint8_t *cptr, size_t len, uint8_t quote)
+{
+	const parserutils_buffer *utf8 = tokeniser->input->utf8;
+	size_t avail = utf8->data + utf8->length - cptr;
+	const uint8_t *end = memchr(cptr, quote, avail);
+
+	if (end != NULL) {
+		tokeniser->context.pending += end - cptr + 1;
+		tokeniser->state = STATE_AFTER_ATTRIBUTE_VALUE_Q;
+	} else {
+		/* Stop short of any trailing non-ASCII character */
+		while (avail > 0 && (cptr[avail - 1] & 0x80) != 0)
+			avail--;
+
+		tokeniser->context.pending += (avail > 0) ? avail : len;
+	}
+
+	return HUBBUB_OK;
+}
+
 hubbub_error hubbub_tokeniser_handle_before_attribute_name(
 		hubbub_tokeniser *tokeniser)
 {
@@ -1202,6 +1602,14 @@ hubbub_error hubbub_tokeniser_handle_before_attribute_name(
 			/** \todo parse error */
 		}
 
+		tokeniser->context.skip_attribute =
+				hubbub_tokeniser_skip_tag_attributes(tokeniser);
+		if (tokeniser->context.skip_attribute) {
+			tokeniser->context.pending += len;
+			tokeniser->state = STATE_ATTRIBUTE_NAME;
+			return HUBBUB_OK;
+		}
+
 		attr = tokeniser->alloc(ctag->attributes,
 				(ctag->n_attributes + 1) *
 					sizeof(hubbub_attribute),
@@ -1243,13 +1651,20 @@ hubbub_error hubbub_tokeniser_handle_attribute_name(hubbub_tokeniser *tokeniser)
 	parserutils_error error;
 	uint8_t c;
 
-	assert(ctag->attributes[ctag->n_attributes - 1].name.len > 0);
+	assert(tokeniser->context.skip_attribute ||
+			ctag->attributes[ctag->n_attributes - 1].name.len > 0);
 
 	error = parserutils_inputstream_peek(tokeniser->input, 
 			tokeniser->context.pending, &cptr, &len);
 
 	if (error != PARSERUTILS_OK) {
 		if (error == PARSERUTILS_EOF) {
+			hubbub_error err;
+
+			err = hubbub_tokeniser_filter_attribute(tokeniser);
+			if (err != HUBBUB_OK)
+				return err;
+
 			tokeniser->state = STATE_DATA;
 			return emit_current_tag(tokeniser);
 		} else {
@@ -1259,6 +1674,14 @@ hubbub_error hubbub_tokeniser_handle_attribute_name(hubbub_tokeniser *tokeniser)
 
 	c = *cptr;
 
+	if (c == '\t' || c == '\n' || c == '\f' || c == ' ' || c == '\r' ||
+			c == '=' || c == '>' || c == '/') {
+		/* End of name: decide whether to keep the attribute */
+		hubbub_error err = hubbub_tokeniser_filter_attribute(tokeniser);
+		if (err != HUBBUB_OK)
+			return err;
+	}
+
 	if (c == '\t' || c == '\n' || c == '\f' || c == ' ' || c == '\r') {
 		tokeniser->context.pending += len;
 		tokeniser->state = STATE_AFTER_ATTRIBUTE_NAME;
@@ -1272,6 +1695,8 @@ hubbub_error hubbub_tokeniser_handle_attribute_name(hubbub_tokeniser *tokeniser)
 	} else if (c == '/') {
 		tokeniser->context.pending += len;
 		tokeniser->state = STATE_SELF_CLOSING_START_TAG;
+	} else if (tokeniser->context.skip_attribute) {
+		tokeniser->context.pending += len;
 	} else if (c == '\0') {
 		COLLECT(ctag->attributes[ctag->n_attributes - 1].name,
 				u_fffd, sizeof(u_fffd));
@@ -1334,6 +1759,14 @@ hubbub_error hubbub_tokeniser_handle_after_attribute_name(
 			/** \todo parse error */
 		}
 
+		tokeniser->context.skip_attribute =
+				hubbub_tokeniser_skip_tag_attributes(tokeniser);
+		if (tokeniser->context.skip_attribute) {
+			tokeniser->context.pending += len;
+			tokeniser->state = STATE_ATTRIBUTE_NAME;
+			return HUBBUB_OK;
+		}
+
 		attr = tokeniser->alloc(ctag->attributes,
 				(ctag->n_attributes + 1) *
 					sizeof(hubbub_attribute),
@@ -1409,6 +1842,9 @@ hubbub_error hubbub_tokeniser_handle_before_attribute_value(
 
 		tokeniser->state = STATE_DATA;
 		return emit_current_tag(tokeniser);
+	} else if (tokeniser->context.skip_attribute) {
+		tokeniser->context.pending += len;
+		tokeniser->state = STATE_ATTRIBUTE_VALUE_UQ;
 	} else if (c == '\0') {
 		START_BUF(ctag->attributes[ctag->n_attributes - 1].value,
 				u_fffd, sizeof(u_fffd));
@@ -1451,6 +1887,10 @@ hubbub_error hubbub_tokeniser_handle_attribute_value_dq(
 		}
 	}
 
+	if (tokeniser->context.skip_attribute)
+		return hubbub_tokeniser_skip_quoted_value(tokeniser,
+				cptr, len, '"');
+
 	c = *cptr;
 
 	if (c == '"') {
@@ -1513,6 +1953,10 @@ hubbub_error hubbub_tokeniser_handle_attribute_value_sq(
 		}
 	}
 
+	if (tokeniser->context.skip_attribute)
+		return hubbub_tokeniser_skip_quoted_value(tokeniser,
+				cptr, len, '\'');
+
 	c = *cptr;
 
 	if (c == '\'') {
@@ -1577,12 +2021,14 @@ hubbub_error hubbub_tokeniser_handle_attribute_value_uq(
 
 	c = *cptr;
 
-	assert(c == '&' ||
+	assert(c == '&' || tokeniser->context.skip_attribute ||
 		ctag->attributes[ctag->n_attributes - 1].value.len >= 1);
 
 	if (c == '\t' || c == '\n' || c == '\f' || c == ' ' || c == '\r') {
 		tokeniser->context.pending += len;
 		tokeniser->state = STATE_BEFORE_ATTRIBUTE_NAME;
+	} else if (tokeniser->context.skip_attribute && c != '>') {
+		tokeniser->context.pending += len;
 	} else if (c == '&') {
 		tokeniser->context.prev_state = tokeniser->state;
 		tokeniser->state = STATE_CHARACTER_REFERENCE_IN_ATTRIBUTE_VALUE;
@@ -1872,7 +2318,7 @@ hubbub_error hubbub_tokeniser_handle_match_comment(hubbub_tokeniser *tokeniser)
 	tokeniser->context.pending = tokeniser->context.current_comment.len = 0;
 
 	if (*cptr == '-') {
-		parserutils_inputstream_advance(tokeniser->input, SLEN("--"));
+		hubbub_tokeniser_advance(tokeniser, SLEN("--"));
 		tokeniser->state = STATE_COMMENT_START;
 	} else {
 		tokeniser->state = STATE_BOGUS_COMMENT;
@@ -2033,7 +2479,7 @@ hubbub_error hubbub_tokeniser_handle_match_doctype(hubbub_tokeniser *tokeniser)
 
 	if (tokeniser->context.match_doctype.count == DOCTYPE_LEN) {
 		/* Skip over the DOCTYPE bit */
-		parserutils_inputstream_advance(tokeniser->input,
+		hubbub_tokeniser_advance(tokeniser,
 				tokeniser->context.pending);
 
 		memset(&tokeniser->context.current_doctype, 0,
@@ -2788,7 +3234,7 @@ hubbub_error hubbub_tokeniser_handle_match_cdata(hubbub_tokeniser *tokeniser)
 	tokeniser->context.pending += len;
 
 	if (tokeniser->context.match_cdata.count == CDATA_LEN) {
-		parserutils_inputstream_advance(tokeniser->input,
+		hubbub_tokeniser_advance(tokeniser,
 				tokeniser->context.match_cdata.count + len);
 		tokeniser->context.pending = 0;
 		tokeniser->context.match_cdata.end = 0;
@@ -2837,7 +3283,7 @@ hubbub_error hubbub_tokeniser_handle_cdata_block(hubbub_tokeniser *tokeniser)
 		emit_current_chars(tokeniser);
 
 		/* Now move past the "]]>" bit */
-		parserutils_inputstream_advance(tokeniser->input, SLEN("]]>"));
+		hubbub_tokeniser_advance(tokeniser, SLEN("]]>"));
 
 		tokeniser->state = STATE_DATA;
 	} else if (c == '\0') {
@@ -2849,7 +3295,7 @@ hubbub_error hubbub_tokeniser_handle_cdata_block(hubbub_tokeniser *tokeniser)
 		/* Perform NUL-byte replacement */
 		emit_character_token(tokeniser, &u_fffd_str);
 
-		parserutils_inputstream_advance(tokeniser->input, len);
+		hubbub_tokeniser_advance(tokeniser, len);
 		tokeniser->context.match_cdata.end = 0;
 	} else if (c == '\r') {
 		error = parserutils_inputstream_peek(
@@ -2873,7 +3319,7 @@ hubbub_error hubbub_tokeniser_handle_cdata_block(hubbub_tokeniser *tokeniser)
 		}
 
 		/* Advance over \r */
-		parserutils_inputstream_advance(tokeniser->input, 1);
+		hubbub_tokeniser_advance(tokeniser, 1);
 		tokeniser->context.match_cdata.end = 0;
 	} else {
 		tokeniser->context.pending += len;
@@ -3235,6 +3681,7 @@ hubbub_error emit_current_tag(hubbub_tokeniser *tokeniser)
 		ptr += attrs[i].name.len;
 		attrs[i].value.ptr = ptr;
 		ptr += attrs[i].value.len;
+		attrs[i].value_id = 0;
 	}
 
 
@@ -3274,6 +3721,24 @@ hubbub_error emit_current_tag(hubbub_tokeniser *tokeniser)
 
 	token.data.tag.n_attributes = n_attributes;
 
+	/* Point short values at the cache's copies */
+	if (tokeniser->intern_values && n_attributes > 0) {
+		if (tokeniser->intern == NULL) {
+			err = hubbub_intern_create(tokeniser->alloc,
+					tokeniser->alloc_pw,
+					&tokeniser->intern);
+			if (err != HUBBUB_OK)
+				return err;
+		}
+
+		for (i = 0; i < n_attributes; i++) {
+			err = hubbub_intern_string(tokeniser->intern,
+					&attrs[i].value, &attrs[i].value_id);
+			if (err != HUBBUB_OK)
+				return err;
+		}
+	}
+
 	err = hubbub_tokeniser_emit_token(tokeniser, &token);
 
 	if (token.type == HUBBUB_TOKEN_START_TAG) {
@@ -3409,6 +3874,11 @@ hubbub_error hubbub_tokeniser_emit_token(hubbub_tokeniser *tokeniser,
 	}
 #endif
 
+	/* Record the token as it is emitted. Failing to do so spoils only
+	 * the recording, which reports the failure when it's read */
+	if (tokeniser->recorder != NULL)
+		hubbub_recorder_token(tokeniser->recorder, token);
+
 	/* Emit the token */
 	if (tokeniser->token_handler) {
 		err = tokeniser->token_handler(token, tokeniser->token_pw);
@@ -3422,7 +3892,7 @@ hubbub_error hubbub_tokeniser_emit_token(hubbub_tokeniser *tokeniser,
 
 	/* Advance the pointer */
 	if (tokeniser->context.pending) {
-		parserutils_inputstream_advance(tokeniser->input,
+		hubbub_tokeniser_advance(tokeniser,
 				tokeniser->context.pending);
 		tokeniser->context.pending = 0;
 	}
@@ -3440,5 +3910,10 @@ hubbub_error hubbub_tokeniser_emit_token(hubbub_tokeniser *tokeniser,
 		tokeniser->paused = true;
 	}
 
+	/* Once stopped, the rest of the input is never looked at */
+	if (err == HUBBUB_STOPPED) {
+		tokeniser->stopped = true;
+	}
+
 	return err;
 }
@@ -17,6 +17,11 @@
 
 #include <parserutils/input/inputstream.h>
 
+#include "tokeniser/recorder.h"
+
+/** Least consumed input, in bytes, worth discarding when streaming */
+#define HUBBUB_TOKENISER_DISCARD_MIN	4096
+
 typedef struct hubbub_tokeniser hubbub_tokeniser;
 
 /**
@@ -27,7 +32,12 @@ typedef enum hubbub_tokeniser_opttype {
 	HUBBUB_TOKENISER_ERROR_HANDLER,
 	HUBBUB_TOKENISER_CONTENT_MODEL,
 	HUBBUB_TOKENISER_PROCESS_CDATA,
-	HUBBUB_TOKENISER_PAUSE
+	HUBBUB_TOKENISER_PAUSE,
+	HUBBUB_TOKENISER_INPUT,
+	HUBBUB_TOKENISER_ATTRIBUTE_FILTER,
+	HUBBUB_TOKENISER_RECORDER,
+	HUBBUB_TOKENISER_INTERN_VALUES,
+	HUBBUB_TOKENISER_STREAMING
 } hubbub_tokeniser_opttype;
 
 /**
@@ -51,6 +61,23 @@ typedef union hubbub_tokeniser_optparams {
 	bool process_cdata;		/**< Whether to process CDATA sections*/
 
 	bool pause_parse;		/**< Pause parsing */
+	parserutils_inputstream *input;	/**< Replacement input stream */
+
+	struct {
+		const char **names;	/**< Attributes to keep, or NULL */
+		const char **tags;	/**< Tags to keep them on, or NULL */
+	} attribute_filter;		/**< NULL-terminated lists of lower
+					 * case names. Other attributes are
+					 * skipped without being buffered */
+
+	hubbub_recorder *recorder;	/**< Recorder of emitted tokens, or
+					 * NULL. Not owned by the tokeniser */
+
+	bool intern_values;		/**< Whether to intern short
+					 * attribute values */
+
+	bool streaming;			/**< Whether to discard input once
+					 * it has been consumed */
 } hubbub_tokeniser_optparams;
 
 /* Create a hubbub tokeniser */
@@ -60,6 +87,10 @@ hubbub_error hubbub_tokeniser_create(parserutils_inputstream *input,
 /* Destroy a hubbub tokeniser */
 hubbub_error hubbub_tokeniser_destroy(hubbub_tokeniser *tokeniser);
 
+/* Clone a hubbub tokeniser */
+hubbub_error hubbub_tokeniser_clone(hubbub_tokeniser *tokeniser,
+		parserutils_inputstream *input, hubbub_tokeniser **clone);
+
 /* Configure a hubbub tokeniser */
 hubbub_error hubbub_tokeniser_setopt(hubbub_tokeniser *tokeniser,
 		hubbub_tokeniser_opttype type,
@@ -69,8 +100,18 @@ hubbub_error hubbub_tokeniser_setopt(hubbub_tokeniser *tokeniser,
 hubbub_error hubbub_tokeniser_insert_chunk(hubbub_tokeniser *tokeniser,
 		const uint8_t *data, size_t len);
 
+/* Pass the tokens in a recording to the token handler */
+hubbub_error hubbub_tokeniser_replay(hubbub_tokeniser *tokeniser,
+		const uint8_t *data, size_t len);
+
 /* Process remaining data in the input stream */
 hubbub_error hubbub_tokeniser_run(hubbub_tokeniser *tokeniser);
 
+/* Read the amount of input consumed */
+uint64_t hubbub_tokeniser_read_offset(hubbub_tokeniser *tokeniser);
+
+/* Read the amount of input read, but not yet consumed */
+size_t hubbub_tokeniser_read_pending(hubbub_tokeniser *tokeniser);
+
 #endif
 
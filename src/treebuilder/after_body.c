@@ -64,8 +64,7 @@ hubbub_error handle_after_body(hubbub_treebuilder *treebuilder,
 		break;
 	case HUBBUB_TOKEN_COMMENT:
 		err = process_comment_append(treebuilder, token,
-				treebuilder->context.element_stack[
-				0].node);
+				treebuilder->context.stack_node[0]);
 		break;
 	case HUBBUB_TOKEN_DOCTYPE:
 		/** \todo parse error */
@@ -91,9 +90,12 @@ hubbub_error handle_after_body(hubbub_treebuilder *treebuilder,
 				&token->data.tag.name);
 
 		if (type == HTML) {
-			/** \todo fragment case */
-			/** \todo parse error */
-			treebuilder->context.mode = AFTER_AFTER_BODY;
+			/* fragment case -- ignore */
+			if (treebuilder->context.fragment == false) {
+				treebuilder->context.mode = AFTER_AFTER_BODY;
+			} else {
+				/** \todo parse error */
+			}
 		} else {
 			/** \todo parse error */
 			treebuilder->context.mode = IN_BODY;
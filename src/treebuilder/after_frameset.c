@@ -39,8 +39,8 @@ hubbub_error handle_after_frameset(hubbub_treebuilder *treebuilder,
 		break;
 	case HUBBUB_TOKEN_COMMENT:
 		err = process_comment_append(treebuilder, token,
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 		break;
 	case HUBBUB_TOKEN_DOCTYPE:
 		/** \todo parse error */
@@ -65,9 +65,13 @@ hubbub_error handle_after_frameset(hubbub_treebuilder *treebuilder,
 				&token->data.tag.name);
 
 		if (type == HTML) {
-			/** \todo fragment case */
-			/** \todo parse error */
-			treebuilder->context.mode = AFTER_AFTER_FRAMESET;
+			/* fragment case -- ignore */
+			if (treebuilder->context.fragment == false) {
+				treebuilder->context.mode =
+						AFTER_AFTER_FRAMESET;
+			} else {
+				/** \todo parse error */
+			}
 		} else {
 			/** \todo parse error */
 		}
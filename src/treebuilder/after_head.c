@@ -34,8 +34,8 @@ hubbub_error handle_after_head(hubbub_treebuilder *treebuilder,
 		break;
 	case HUBBUB_TOKEN_COMMENT:
 		err = process_comment_append(treebuilder, token,
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 		break;
 	case HUBBUB_TOKEN_DOCTYPE:
 		/** \todo parse error */
@@ -34,8 +34,8 @@ hubbub_error handle_before_head(hubbub_treebuilder *treebuilder,
 		break;
 	case HUBBUB_TOKEN_COMMENT:
 		err = process_comment_append(treebuilder, token, 
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 		break;
 	case HUBBUB_TOKEN_DOCTYPE:
 		/** \todo parse error */
@@ -95,12 +95,12 @@ hubbub_error handle_before_head(hubbub_treebuilder *treebuilder,
 
 		treebuilder->tree_handler->ref_node(
 				treebuilder->tree_handler->ctx,
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 
 		treebuilder->context.head_element = 
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node;
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node];
 
 		treebuilder->context.mode = IN_HEAD;
 	}
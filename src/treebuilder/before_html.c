@@ -107,9 +107,11 @@ hubbub_error handle_before_html(hubbub_treebuilder *treebuilder,
 		 * before the one to insert at. For the first entry in 
 		 * the stack, this does not hold so we must insert
 		 * manually. */
-		treebuilder->context.element_stack[0].type = HTML;
-		treebuilder->context.element_stack[0].node = appended;
+		treebuilder->context.stack_kind[0].type = HTML;
+		treebuilder->context.stack_node[0] = appended;
 		treebuilder->context.current_node = 0;
+		treebuilder->context.current_table = 0;
+		treebuilder->context.current_anchor = 0;
 
 		/** \todo cache selection algorithm */
 
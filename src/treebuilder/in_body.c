@@ -144,8 +144,8 @@ hubbub_error handle_in_body(hubbub_treebuilder *treebuilder,
 		break;
 	case HUBBUB_TOKEN_COMMENT:
 		err = process_comment_append(treebuilder, token,
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 		break;
 	case HUBBUB_TOKEN_DOCTYPE:
 		/** \todo parse error */
@@ -160,7 +160,7 @@ hubbub_error handle_in_body(hubbub_treebuilder *treebuilder,
 		for (i = treebuilder->context.current_node; 
 				i > 0; i--) {
 			element_type type = 
-				treebuilder->context.element_stack[i].type;
+				treebuilder->context.stack_kind[i].type;
 
 			if (!(type == DD || type == DT || type == LI ||
 					type == P || type == TBODY || 
@@ -197,6 +197,21 @@ hubbub_error process_character(hubbub_treebuilder *treebuilder,
 	bool lr_flag = treebuilder->context.strip_leading_lr;
 	const uint8_t *p;
 
+	if (treebuilder->context.ignore_whitespace &&
+			treebuilder->context.after_block) {
+		/* Whitespace starting a line is not rendered, unless it's
+		 * preformatted */
+		for (p = dummy.ptr; p < dummy.ptr + dummy.len; p++) {
+			if (*p != 0x0009 && *p != 0x000a &&
+					*p != 0x000c && *p != 0x0020)
+				break;
+		}
+
+		if (p == dummy.ptr + dummy.len &&
+				in_preformatted(treebuilder) == false)
+			return HUBBUB_OK;
+	}
+
 	err = reconstruct_active_formatting_list(treebuilder);
 	if (err != HUBBUB_OK)
 		return err;
@@ -317,7 +332,7 @@ hubbub_error process_start_tag(hubbub_treebuilder *treebuilder,
 		if (err == HUBBUB_OK) {
 			treebuilder->context.frameset_ok = false;
 
-			treebuilder->context.element_stack[
+			treebuilder->context.stack_links[
 				current_table(treebuilder)].tainted = false;
 			treebuilder->context.mode = IN_TABLE;
 		}
@@ -490,7 +505,7 @@ hubbub_error process_html_in_body(hubbub_treebuilder *treebuilder,
 
 	return treebuilder->tree_handler->add_attributes(
 			treebuilder->tree_handler->ctx,
-			treebuilder->context.element_stack[0].node,
+			treebuilder->context.stack_node[0],
 			token->data.tag.attributes, 
 			token->data.tag.n_attributes);
 }
@@ -507,12 +522,12 @@ hubbub_error process_body_in_body(hubbub_treebuilder *treebuilder,
 	/** \todo parse error */
 
 	if (treebuilder->context.current_node < 1 || 
-			treebuilder->context.element_stack[1].type != BODY)
+			treebuilder->context.stack_kind[1].type != BODY)
 		return HUBBUB_OK;
 
 	return treebuilder->tree_handler->add_attributes(
 			treebuilder->tree_handler->ctx,
-			treebuilder->context.element_stack[1].node,
+			treebuilder->context.stack_node[1],
 			token->data.tag.attributes,
 			token->data.tag.n_attributes);
 }
@@ -531,14 +546,14 @@ hubbub_error process_frameset_in_body(hubbub_treebuilder *treebuilder,
 	/** \todo parse error */
 
 	if (treebuilder->context.current_node < 1 ||
-			treebuilder->context.element_stack[1].type != BODY)
+			treebuilder->context.stack_kind[1].type != BODY)
 		return HUBBUB_OK;
 
 	if (treebuilder->context.frameset_ok == false)
 		return HUBBUB_OK;
 
 	err = remove_node_from_dom(treebuilder, 
-			treebuilder->context.element_stack[1].node);
+			treebuilder->context.stack_node[1]);
 	if (err != HUBBUB_OK)
 		return err;
 
@@ -590,7 +605,7 @@ hubbub_error process_hN_in_body(hubbub_treebuilder *treebuilder,
 			return err;
 	}
 
-	type = treebuilder->context.element_stack[
+	type = treebuilder->context.stack_kind[
 			treebuilder->context.current_node].type;
 
 	if (type == H1 || type == H2 || type == H3 || type == H4 ||
@@ -640,12 +655,12 @@ hubbub_error process_form_in_body(hubbub_treebuilder *treebuilder,
 		 * use it as the current form element */
 		treebuilder->tree_handler->ref_node(
 			treebuilder->tree_handler->ctx,
-			treebuilder->context.element_stack[
-			treebuilder->context.current_node].node);
+			treebuilder->context.stack_node[
+			treebuilder->context.current_node]);
 
 		treebuilder->context.form_element =
-			treebuilder->context.element_stack[
-			treebuilder->context.current_node].node;
+			treebuilder->context.stack_node[
+			treebuilder->context.current_node];
 	}
 
 	return HUBBUB_OK;
@@ -662,7 +677,7 @@ hubbub_error process_dd_dt_li_in_body(hubbub_treebuilder *treebuilder,
 		const hubbub_token *token, element_type type)
 {
 	hubbub_error err;
-	element_context *stack = treebuilder->context.element_stack;
+	element_kind *kind = treebuilder->context.stack_kind;
 	uint32_t node;
 
 	treebuilder->context.frameset_ok = false;
@@ -675,7 +690,7 @@ hubbub_error process_dd_dt_li_in_body(hubbub_treebuilder *treebuilder,
 
 	/* Find last LI/(DD,DT) on stack, if any */
 	for (node = treebuilder->context.current_node; node > 0; node--) {
-		element_type ntype = stack[node].type;
+		element_type ntype = kind[node].type;
 
 		if (type == LI && ntype == LI)
 			break;
@@ -692,8 +707,8 @@ hubbub_error process_dd_dt_li_in_body(hubbub_treebuilder *treebuilder,
 	}
 
 	/* If we found one, then pop all nodes up to and including it */
-	if (stack[node].type == LI || stack[node].type == DD ||
-			stack[node].type == DT) {
+	if (kind[node].type == LI || kind[node].type == DD ||
+			kind[node].type == DT) {
 		/* Check that we're only popping one node 
 		 * and emit a parse error if not */
 		if (treebuilder->context.current_node > node) {
@@ -795,7 +810,7 @@ hubbub_error process_a_in_body(hubbub_treebuilder *treebuilder,
 
 		/* Remove from the stack of open elements, if still there */
 		if (index <= treebuilder->context.current_node &&
-				treebuilder->context.element_stack[index].node 
+				treebuilder->context.stack_node[index] 
 				== node) {
 			hubbub_ns ns;
 			element_type otype;
@@ -819,12 +834,12 @@ hubbub_error process_a_in_body(hubbub_treebuilder *treebuilder,
 		return err;
 
 	treebuilder->tree_handler->ref_node(treebuilder->tree_handler->ctx,
-		treebuilder->context.element_stack[
-		treebuilder->context.current_node].node);
+		treebuilder->context.stack_node[
+		treebuilder->context.current_node]);
 
 	err = formatting_list_append(treebuilder, token->data.tag.ns, A, 
-		treebuilder->context.element_stack[
-			treebuilder->context.current_node].node, 
+		treebuilder->context.stack_node[
+			treebuilder->context.current_node], 
 		treebuilder->context.current_node);
 	if (err != HUBBUB_OK) {
 		hubbub_ns ns;
@@ -832,8 +847,8 @@ hubbub_error process_a_in_body(hubbub_treebuilder *treebuilder,
 		void *node;
 
 		remove_node_from_dom(treebuilder, 
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 
 		element_stack_pop(treebuilder, &ns, &type, &node);
 
@@ -872,12 +887,12 @@ hubbub_error process_presentational_in_body(hubbub_treebuilder *treebuilder,
 		return err;
 
 	treebuilder->tree_handler->ref_node(treebuilder->tree_handler->ctx,
-		treebuilder->context.element_stack[
-		treebuilder->context.current_node].node);
+		treebuilder->context.stack_node[
+		treebuilder->context.current_node]);
 
 	err = formatting_list_append(treebuilder, token->data.tag.ns, type, 
-		treebuilder->context.element_stack[
-		treebuilder->context.current_node].node, 
+		treebuilder->context.stack_node[
+		treebuilder->context.current_node], 
 		treebuilder->context.current_node);
 	if (err != HUBBUB_OK) {
 		hubbub_ns ns;
@@ -885,8 +900,8 @@ hubbub_error process_presentational_in_body(hubbub_treebuilder *treebuilder,
 		void *node;
 
 		remove_node_from_dom(treebuilder, 
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 
 		element_stack_pop(treebuilder, &ns, &type, &node);
 
@@ -938,12 +953,12 @@ hubbub_error process_nobr_in_body(hubbub_treebuilder *treebuilder,
 
 	treebuilder->tree_handler->ref_node(
 		treebuilder->tree_handler->ctx,
-		treebuilder->context.element_stack[
-		treebuilder->context.current_node].node);
+		treebuilder->context.stack_node[
+		treebuilder->context.current_node]);
 
 	err = formatting_list_append(treebuilder, token->data.tag.ns, NOBR, 
-		treebuilder->context.element_stack[
-		treebuilder->context.current_node].node, 
+		treebuilder->context.stack_node[
+		treebuilder->context.current_node], 
 		treebuilder->context.current_node);
 	if (err != HUBBUB_OK) {
 		hubbub_ns ns;
@@ -951,8 +966,8 @@ hubbub_error process_nobr_in_body(hubbub_treebuilder *treebuilder,
 		void *node;
 
 		remove_node_from_dom(treebuilder, 
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 
 		element_stack_pop(treebuilder, &ns, &type, &node);
 
@@ -999,12 +1014,12 @@ hubbub_error process_button_in_body(hubbub_treebuilder *treebuilder,
 
 	treebuilder->tree_handler->ref_node(
 		treebuilder->tree_handler->ctx,
-		treebuilder->context.element_stack[
-		treebuilder->context.current_node].node);
+		treebuilder->context.stack_node[
+		treebuilder->context.current_node]);
 
 	err = formatting_list_append(treebuilder, token->data.tag.ns, BUTTON, 
-		treebuilder->context.element_stack[
-		treebuilder->context.current_node].node,
+		treebuilder->context.stack_node[
+		treebuilder->context.current_node],
 		treebuilder->context.current_node);
 	if (err != HUBBUB_OK) {
 		hubbub_ns ns;
@@ -1012,8 +1027,8 @@ hubbub_error process_button_in_body(hubbub_treebuilder *treebuilder,
 		void *node;
 
 		remove_node_from_dom(treebuilder, 
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 
 		element_stack_pop(treebuilder, &ns, &type, &node);
 
@@ -1055,12 +1070,12 @@ hubbub_error process_applet_marquee_object_in_body(
 
 	treebuilder->tree_handler->ref_node(
 		treebuilder->tree_handler->ctx,
-		treebuilder->context.element_stack[
-		treebuilder->context.current_node].node);
+		treebuilder->context.stack_node[
+		treebuilder->context.current_node]);
 
 	err = formatting_list_append(treebuilder, token->data.tag.ns, type, 
-		treebuilder->context.element_stack[
-		treebuilder->context.current_node].node, 
+		treebuilder->context.stack_node[
+		treebuilder->context.current_node], 
 		treebuilder->context.current_node);
 	if (err != HUBBUB_OK) {
 		hubbub_ns ns;
@@ -1068,8 +1083,8 @@ hubbub_error process_applet_marquee_object_in_body(
 		void *node;
 
 		remove_node_from_dom(treebuilder, 
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 
 		element_stack_pop(treebuilder, &ns, &type, &node);
 
@@ -1191,6 +1206,7 @@ hubbub_error process_isindex_in_body(hubbub_treebuilder *treebuilder,
 		attrs[n_attrs].name.len = SLEN("name");
 		attrs[n_attrs].value.ptr = (const uint8_t *) "isindex";
 		attrs[n_attrs].value.len = SLEN("isindex");
+		attrs[n_attrs].value_id = 0;
 		n_attrs++;
 	}
 
@@ -1407,12 +1423,12 @@ hubbub_error process_0body_in_body(hubbub_treebuilder *treebuilder)
 	if (!element_in_scope(treebuilder, BODY, false)) {
 		/** \todo parse error */
 	} else {
-		element_context *stack = treebuilder->context.element_stack;
+		element_kind *kind = treebuilder->context.stack_kind;
 		uint32_t node;
 
 		for (node = treebuilder->context.current_node; 
 				node > 0; node--) {
-			element_type ntype = stack[node].type;
+			element_type ntype = kind[node].type;
 
 			if (ntype != DD && ntype != DT && ntype != LI && 
 					ntype != OPTGROUP && ntype != OPTION &&
@@ -1491,7 +1507,7 @@ hubbub_error process_0form_in_body(hubbub_treebuilder *treebuilder)
 	idx = element_in_scope(treebuilder, FORM, false);
 
 	if (idx == 0 || node == NULL || 
-			treebuilder->context.element_stack[idx].node != node) {
+			treebuilder->context.stack_node[idx] != node) {
 		/** \todo parse error */
 	} else {
 		hubbub_ns ns;
@@ -1500,8 +1516,8 @@ hubbub_error process_0form_in_body(hubbub_treebuilder *treebuilder)
 
 		close_implied_end_tags(treebuilder, UNKNOWN);
 
-		if (treebuilder->context.element_stack[
-				treebuilder->context.current_node].node != 
+		if (treebuilder->context.stack_node[
+				treebuilder->context.current_node] != 
 				node) {
 			/** \todo parse error */
 		}
@@ -1528,7 +1544,7 @@ hubbub_error process_0p_in_body(hubbub_treebuilder *treebuilder)
 	hubbub_error err = HUBBUB_OK;
 	uint32_t popped = 0;
 
-	if (treebuilder->context.element_stack[
+	if (treebuilder->context.stack_kind[
 			treebuilder->context.current_node].type != P) {
 		/** \todo parse error */
 	}
@@ -1672,7 +1688,8 @@ hubbub_error process_0presentational_in_body(hubbub_treebuilder *treebuilder,
 	/* Welcome to the adoption agency */
 
 	while (true) {
-		element_context *stack = treebuilder->context.element_stack;
+		element_kind *kind = treebuilder->context.stack_kind;
+		void **nodes = treebuilder->context.stack_node;
 
 		formatting_list_entry *entry;
 		uint32_t formatting_element;
@@ -1723,17 +1740,17 @@ hubbub_error process_0presentational_in_body(hubbub_treebuilder *treebuilder,
 			return err;
 
 		/* 7 */
-		if (stack[common_ancestor].type == TABLE ||
-				stack[common_ancestor].type == TBODY ||
-				stack[common_ancestor].type == TFOOT ||
-				stack[common_ancestor].type == THEAD ||
-				stack[common_ancestor].type == TR) {
+		if (kind[common_ancestor].type == TABLE ||
+				kind[common_ancestor].type == TBODY ||
+				kind[common_ancestor].type == TFOOT ||
+				kind[common_ancestor].type == THEAD ||
+				kind[common_ancestor].type == TR) {
 			err = aa_insert_into_foster_parent(treebuilder,
-					stack[last_node].node, &reparented);
+					nodes[last_node], &reparented);
 		} else {
 			err = aa_reparent_node(treebuilder, 
-					stack[last_node].node,
-					stack[common_ancestor].node,
+					nodes[last_node],
+					nodes[common_ancestor],
 					&reparented);
 		}
 		if (err != HUBBUB_OK)
@@ -1741,12 +1758,12 @@ hubbub_error process_0presentational_in_body(hubbub_treebuilder *treebuilder,
 
 		treebuilder->tree_handler->unref_node(
 				treebuilder->tree_handler->ctx,
-				stack[last_node].node);
+				nodes[last_node]);
 
 		/* If the reparented node is not the same as the one we were
 		 * previously using, then have it take the place of the other
 		 * one in the formatting list and stack. */
-		if (reparented != stack[last_node].node) {
+		if (reparented != nodes[last_node]) {
 			struct formatting_list_entry *node_entry;
 			for (node_entry = treebuilder->context.formatting_list_end;
 					node_entry != NULL; 
@@ -1758,13 +1775,13 @@ hubbub_error process_0presentational_in_body(hubbub_treebuilder *treebuilder,
 					node_entry->details.node = reparented;
 					treebuilder->tree_handler->unref_node(
 						treebuilder->tree_handler->ctx,
-						stack[last_node].node);
+						nodes[last_node]);
 					break;
 				}
 			}
 			/* Already have enough references, so don't need to 
 			 * explicitly reference it here. */
-			stack[last_node].node = reparented;
+			nodes[last_node] = reparented;
 		}
 
 		/* 8 */
@@ -1777,7 +1794,7 @@ hubbub_error process_0presentational_in_body(hubbub_treebuilder *treebuilder,
 		/* 9 */
 		err = treebuilder->tree_handler->reparent_children(
 				treebuilder->tree_handler->ctx,
-				stack[furthest_block].node, fe_clone);
+				nodes[furthest_block], fe_clone);
 		if (err != HUBBUB_OK) {
 			treebuilder->tree_handler->unref_node(
 					treebuilder->tree_handler->ctx,
@@ -1788,7 +1805,7 @@ hubbub_error process_0presentational_in_body(hubbub_treebuilder *treebuilder,
 		/* 10 */
 		err = treebuilder->tree_handler->append_child(
 				treebuilder->tree_handler->ctx,
-				stack[furthest_block].node, fe_clone,
+				nodes[furthest_block], fe_clone,
 				&clone_appended);
 		if (err != HUBBUB_OK) {
 			treebuilder->tree_handler->unref_node(
@@ -1822,8 +1839,9 @@ hubbub_error process_0presentational_in_body(hubbub_treebuilder *treebuilder,
 
 		/* Now, in the gap after furthest block,
 		 * we insert an entry for clone */
-		stack[furthest_block + 1].type = entry->details.type;
-		stack[furthest_block + 1].node = clone_appended;
+		kind[furthest_block + 1].ns = entry->details.ns;
+		kind[furthest_block + 1].type = entry->details.type;
+		nodes[furthest_block + 1] = clone_appended;
 
 		/* 11 */
 		err = formatting_list_remove(treebuilder, entry,
@@ -1943,7 +1961,7 @@ hubbub_error aa_find_furthest_block(hubbub_treebuilder *treebuilder,
 	uint32_t fb;
 
 	for (fb = fe_index + 1; fb <= treebuilder->context.current_node; fb++) {
-		element_type type = treebuilder->context.element_stack[fb].type;
+		element_type type = treebuilder->context.stack_kind[fb].type;
 
 		if (!(is_phrasing_element(type) || is_formatting_element(type)))
 			break;
@@ -2019,7 +2037,7 @@ hubbub_error aa_find_bookmark_location_reparenting_misnested(
 		bookmark *bookmark, uint32_t *last_node)
 {
 	hubbub_error err;
-	element_context *stack = treebuilder->context.element_stack;
+	void **nodes = treebuilder->context.stack_node;
 	uint32_t node, last, fb;
 	formatting_list_entry *node_entry;
 
@@ -2073,19 +2091,19 @@ hubbub_error aa_find_bookmark_location_reparenting_misnested(
 			return err;
 
 		/* vi */
-		err = aa_reparent_node(treebuilder, stack[last].node, 
-				stack[node].node, &reparented);
+		err = aa_reparent_node(treebuilder, nodes[last], 
+				nodes[node], &reparented);
 		if (err != HUBBUB_OK)
 			return err;
 
 		treebuilder->tree_handler->unref_node(
 				treebuilder->tree_handler->ctx,
-				stack[last].node);
+				nodes[last]);
 
 		/* If the reparented node is not the same as the one we were
 		 * previously using, then have it take the place of the other
 		 * one in the formatting list and stack. */
-		if (reparented != stack[last].node) {
+		if (reparented != nodes[last]) {
 			for (node_entry = 
 				treebuilder->context.formatting_list_end;
 					node_entry != NULL; 
@@ -2097,13 +2115,13 @@ hubbub_error aa_find_bookmark_location_reparenting_misnested(
 					node_entry->details.node = reparented;
 					treebuilder->tree_handler->unref_node(
 						treebuilder->tree_handler->ctx,
-						stack[last].node);
+						nodes[last]);
 					break;
 				}
 			}
 			/* Already have enough references, so don't need to 
 			 * explicitly reference it here. */
-			stack[last].node = reparented;
+			nodes[last] = reparented;
 		}
 
 		/* vii */
@@ -2131,22 +2149,25 @@ hubbub_error aa_find_bookmark_location_reparenting_misnested(
 hubbub_error aa_remove_element_stack_item(hubbub_treebuilder *treebuilder,
 		uint32_t index, uint32_t limit)
 {
-	element_context *stack = treebuilder->context.element_stack;
+	element_kind *kind = treebuilder->context.stack_kind;
+	void **nodes = treebuilder->context.stack_node;
 	uint32_t n;
 
 	assert(index < limit);
 	assert(limit <= treebuilder->context.current_node);
 
+	element_stack_unlink(treebuilder, index, limit);
+
 	/* First, scan over subsequent entries in the stack,
 	 * searching for them in the list of active formatting
 	 * entries. If found, update the corresponding
 	 * formatting list entry's stack index to match the
 	 * new stack location */
 	for (n = index + 1; n <= limit; n++) {
-		if (is_formatting_element(stack[n].type) ||
-				(is_scoping_element(stack[n].type) &&
-				stack[n].type != HTML &&
-				stack[n].type != TABLE)) {
+		if (is_formatting_element(kind[n].type) ||
+				(is_scoping_element(kind[n].type) &&
+				kind[n].type != HTML &&
+				kind[n].type != TABLE)) {
 			formatting_list_entry *e;
 
 			for (e = treebuilder->context.formatting_list_end;
@@ -2159,11 +2180,10 @@ hubbub_error aa_remove_element_stack_item(hubbub_treebuilder *treebuilder,
 
 	/* Reduce node's reference count */
 	treebuilder->tree_handler->unref_node(treebuilder->tree_handler->ctx,
-					stack[index].node);
+					nodes[index]);
 
 	/* Now, shuffle the stack up one, removing node in the process */
-	memmove(&stack[index], &stack[index + 1],
-			(limit - index) * sizeof(element_context));
+	element_stack_shift(treebuilder, index, limit);
 
 	return HUBBUB_OK;
 }
@@ -2205,7 +2225,7 @@ hubbub_error aa_clone_and_replace_entries(hubbub_treebuilder *treebuilder,
 			clone);
 
 	/* Replace node's stack entry with clone */
-	treebuilder->context.element_stack[element->stack_index].node = clone;
+	treebuilder->context.stack_node[element->stack_index] = clone;
 
 	treebuilder->tree_handler->unref_node(treebuilder->tree_handler->ctx,
 			onode);
@@ -2225,26 +2245,27 @@ hubbub_error aa_insert_into_foster_parent(hubbub_treebuilder *treebuilder,
 		void *node, void **inserted)
 {
 	hubbub_error err;
-	element_context *stack = treebuilder->context.element_stack;
+	void **nodes = treebuilder->context.stack_node;
+	element_links *links = treebuilder->context.stack_links;
 	void *foster_parent = NULL;
 	bool insert = false;
 
 	uint32_t cur_table = current_table(treebuilder);
 
-	stack[cur_table].tainted = true;
+	links[cur_table].tainted = true;
 
 	if (cur_table == 0) {
 		treebuilder->tree_handler->ref_node(
 				treebuilder->tree_handler->ctx,
-				stack[0].node);
+				nodes[0]);
 
-		foster_parent = stack[0].node;
+		foster_parent = nodes[0];
 	} else {
 		void *t_parent = NULL;
 
 		treebuilder->tree_handler->get_parent(
 			treebuilder->tree_handler->ctx,
-			stack[cur_table].node,
+			nodes[cur_table],
 			true, &t_parent);
 
 		if (t_parent != NULL) {
@@ -2253,8 +2274,8 @@ hubbub_error aa_insert_into_foster_parent(hubbub_treebuilder *treebuilder,
 		} else {
 			treebuilder->tree_handler->ref_node(
 					treebuilder->tree_handler->ctx,
-					stack[cur_table - 1].node);
-			foster_parent = stack[cur_table - 1].node;
+					nodes[cur_table - 1]);
+			foster_parent = nodes[cur_table - 1];
 		}
 	}
 
@@ -2270,7 +2291,7 @@ hubbub_error aa_insert_into_foster_parent(hubbub_treebuilder *treebuilder,
 		err = treebuilder->tree_handler->insert_before(
 				treebuilder->tree_handler->ctx,
 				foster_parent, node,
-				stack[cur_table].node,
+				nodes[cur_table],
 				inserted);
 	} else {
 		err = treebuilder->tree_handler->append_child(
@@ -2369,11 +2390,11 @@ hubbub_error process_0br_in_body(hubbub_treebuilder *treebuilder)
 hubbub_error process_0generic_in_body(hubbub_treebuilder *treebuilder, 
 		element_type type)
 {
-	element_context *stack = treebuilder->context.element_stack;
+	element_kind *kind = treebuilder->context.stack_kind;
 	uint32_t node = treebuilder->context.current_node;
 
 	do {
-		if (stack[node].type == type) {
+		if (kind[node].type == type) {
 			uint32_t popped = 0;
 			element_type otype;
 
@@ -2401,8 +2422,8 @@ hubbub_error process_0generic_in_body(hubbub_treebuilder *treebuilder,
 			}
 
 			break;
-		} else if (!is_formatting_element(stack[node].type) && 
-				!is_phrasing_element(stack[node].type)) {
+		} else if (!is_formatting_element(kind[node].type) && 
+				!is_phrasing_element(kind[node].type)) {
 			/** \todo parse error */
 			break;
 		}
@@ -80,7 +80,11 @@ hubbub_error handle_in_caption(hubbub_treebuilder *treebuilder,
 		element_type otype = UNKNOWN;
 		void *node;
 
-		/** \todo fragment case */
+		/* fragment case -- ignore if there's no caption */
+		if (!element_in_scope(treebuilder, CAPTION, true)) {
+			/** \todo parse error */
+			return HUBBUB_OK;
+		}
 
 		close_implied_end_tags(treebuilder, UNKNOWN);
 
@@ -75,9 +75,15 @@ hubbub_error handle_in_cell(hubbub_treebuilder *treebuilder,
 				type == COLGROUP || type == TBODY || 
 				type == TD || type == TFOOT || type == TH || 
 				type == THEAD || type == TR) {
-			/** \todo fragment case */
-			close_cell(treebuilder);
-			err = HUBBUB_REPROCESS;
+			/* fragment case -- ignore if there's no cell */
+			if (element_in_scope(treebuilder, TD, true) ||
+					element_in_scope(treebuilder, TH,
+							true)) {
+				close_cell(treebuilder);
+				err = HUBBUB_REPROCESS;
+			} else {
+				/** \todo parse error */
+			}
 		} else {
 			err = handle_in_body(treebuilder, token);
 		}
@@ -34,8 +34,8 @@ hubbub_error handle_in_column_group(hubbub_treebuilder *treebuilder,
 		break;
 	case HUBBUB_TOKEN_COMMENT:
 		err = process_comment_append(treebuilder, token,
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 		break;
 	case HUBBUB_TOKEN_DOCTYPE:
 		/** \todo parse error */
@@ -64,7 +64,6 @@ hubbub_error handle_in_column_group(hubbub_treebuilder *treebuilder,
 				&token->data.tag.name);
 
 		if (type == COLGROUP) {
-			/** \todo fragment case */
 			handled = true;
 		} else if (type == COL) {
 			/** \todo parse error */
@@ -74,7 +73,6 @@ hubbub_error handle_in_column_group(hubbub_treebuilder *treebuilder,
 	}
 		break;
 	case HUBBUB_TOKEN_EOF:
-		/** \todo fragment case */
 		err = HUBBUB_REPROCESS;
 		break;
 	}
@@ -84,6 +82,13 @@ hubbub_error handle_in_column_group(hubbub_treebuilder *treebuilder,
 		element_type otype;
 		void *node;
 
+		/* fragment case -- the colgroup is the context element,
+		 * so ignore the token (or stop parsing, at EOF) */
+		if (current_node(treebuilder) == HTML) {
+			/** \todo parse error */
+			return HUBBUB_OK;
+		}
+
 		/* Pop the current node (which will be a colgroup) */
 		element_stack_pop(treebuilder, &ns, &otype, &node);
 
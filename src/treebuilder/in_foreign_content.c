@@ -29,112 +29,159 @@ typedef struct
 	const char *proper;	/**< Correctly cased version */
 } case_changes;
 
-static const case_changes svg_attributes[] = {
-	{ S("attributename"),		"attributeName" },
-	{ S("attributetype"),		"attributeType" },
-	{ S("basefrequency"),		"baseFrequency" },
-	{ S("baseprofile"),		"baseProfile" },
-	{ S("calcmode"),		"calcMode" },
-	{ S("clippathunits"),		"clipPathUnits" },
-	{ S("contentscripttype"),	"contentScriptType" },
-	{ S("contentstyletype"),	"contentStyleType" },
-	{ S("diffuseconstant"),		"diffuseConstant" },
-	{ S("edgemode"),		"edgeMode" },
-	{ S("externalresourcesrequired"),	"externalResourcesRequired" },
-	{ S("filterres"),		"filterRes" },
-	{ S("filterunits"),		"filterUnits" },
-	{ S("glyphref"),		"glyphRef" },
-	{ S("gradienttransform"),	"gradientTransform" },
-	{ S("gradientunits"),		"gradientUnits" },
-	{ S("kernelmatrix"),		"kernelMatrix" },
-	{ S("kernelunitlength"),	"kernelUnitLength" },
-	{ S("keypoints"),		"keyPoints" },
-	{ S("keysplines"),		"keySplines" },
-	{ S("keytimes"),		"keyTimes" },
-	{ S("lengthadjust"),		"lengthAdjust" },
-	{ S("limitingconeangle"),	"limitingConeAngle" },
-	{ S("markerheight"),		"markerHeight" },
-	{ S("markerunits"),		"markerUnits" },
-	{ S("markerwidth"),		"markerWidth" },
-	{ S("maskcontentunits"),	"maskContentUnits" },
-	{ S("maskunits"),		"maskUnits" },
-	{ S("numoctaves"),		"numOctaves" },
-	{ S("pathlength"),		"pathLength" },
-	{ S("patterncontentunits"),	"patternContentUnits" },
-	{ S("patterntransform"),	"patternTransform" },
-	{ S("patternunits"),		"patternUnits" },
-	{ S("pointsatx"),		"pointsAtX" },
-	{ S("pointsaty"),		"pointsAtY" },
-	{ S("pointsatz"),		"pointsAtZ" },
-	{ S("preservealpha"),		"preserveAlpha" },
-	{ S("preserveaspectratio"),	"preserveAspectRatio" },
-	{ S("primitiveunits"),		"primitiveUnits" },
-	{ S("refx"),			"refX" },
-	{ S("refy"),			"refY" },
-	{ S("repeatcount"),		"repeatCount" },
-	{ S("repeatdur"),		"repeatDur" },
-	{ S("requiredextensions"),	"requiredExtensions" },
-	{ S("requiredfeatures"),	"requiredFeatures" },
-	{ S("specularconstant"),	"specularConstant" },
-	{ S("specularexponent"),	"specularExponent" },
-	{ S("spreadmethod"),		"spreadMethod" },
-	{ S("startoffset"),		"startOffset" },
-	{ S("stddeviation"),		"stdDeviation" },
-	{ S("stitchtiles"),		"stitchTiles" },
-	{ S("surfacescale"),		"surfaceScale" },
-	{ S("systemlanguage"),		"systemLanguage" },
-	{ S("tablevalues"),		"tableValues" },
-	{ S("targetx"),			"targetX" },
-	{ S("targety"),			"targetY" },
-	{ S("textlength"),		"textLength" },
-	{ S("viewbox"),			"viewBox" },
-	{ S("viewtarget"),		"viewTarget" },
-	{ S("xchannelselector"),	"xChannelSelector" },
-	{ S("ychannelselector"),	"yChannelSelector" },
-	{ S("zoomandpan"),		"zoomAndPan" },
+/* The SVG case change tables are perfect hash tables, indexed by the value
+ * computed in svg_case_change() modulo the table size. The association
+ * values were found by search so that no two names in either table share
+ * a slot. If a name is added, the values (and possibly the table sizes)
+ * must be recomputed. */
+#define SVG_ATTRIBUTES_SIZE	128
+#define SVG_TAGNAMES_SIZE	64
+
+/**
+ * Association values for the SVG name hash, indexed by letter
+ */
+static const uint8_t svg_name_asso[26] = {
+	 34,  76,  18,  30, 126, 118, 112,  68,  21,  77,  81, 120,  31,
+	  7,  51,  86,  38,  58,  55,  81,  46,  87,  75,  61,  60,  22
 };
 
-static const case_changes svg_tagnames[] = {
-	{ S("altglyph"),		"altGlyph" },
-	{ S("altglyphdef"),		"altGlyphDef" },
-	{ S("altglyphitem"),		"altGlyphItem" },
-	{ S("animatecolor"),		"animateColor" },
-	{ S("animatemotion"),		"animateMotion" },
-	{ S("animatetransform"),	"animateTransform" },
-	{ S("clippath"),		"clipPath" },
-	{ S("feblend"),			"feBlend" },
-	{ S("fecolormatrix"),		"feColorMatrix" },
-	{ S("fecomponenttransfer"),	"feComponentTransfer" },
-	{ S("fecomposite"),		"feComposite" },
-	{ S("feconvolvematrix"),	"feConvolveMatrix" },
-	{ S("fediffuselighting"),	"feDiffuseLighting" },
-	{ S("fedisplacementmap"),	"feDisplacementMap" },
-	{ S("fedistantlight"),		"feDistantLight" },
-	{ S("feflood"),			"feFlood" },
-	{ S("fefunca"),			"feFuncA" },
-	{ S("fefuncb"),			"feFuncB" },
-	{ S("fefuncg"),			"feFuncG" },
-	{ S("fefuncr"),			"feFuncR" },
-	{ S("fegaussianblur"),		"feGaussianBlur" },
-	{ S("feimage"),			"feImage" },
-	{ S("femerge"),			"feMerge" },
-	{ S("femergenode"),		"feMergeNode" },
-	{ S("femorphology"),		"feMorphology" },
-	{ S("feoffset"),		"feOffset" },
-	{ S("fepointlight"),		"fePointLight" },
-	{ S("fespecularlighting"),	"feSpecularLighting" },
-	{ S("fespotlight"),		"feSpotLight" },
-	{ S("fetile"),			"feTile" },
-	{ S("feturbulence"),		"feTurbulence" },
-	{ S("foreignobject"),		"foreignObject" },
-	{ S("glyphref"),		"glyphRef" },
-	{ S("lineargradient"),		"linearGradient" },
-	{ S("radialgradient"),		"radialGradient" },
-	{ S("textpath"),		"textPath" },
+static const case_changes svg_attributes[SVG_ATTRIBUTES_SIZE] = {
+	[ 79] = { S("attributename"),		"attributeName" },
+	[105] = { S("attributetype"),		"attributeType" },
+	[ 28] = { S("basefrequency"),		"baseFrequency" },
+	[106] = { S("baseprofile"),		"baseProfile" },
+	[ 75] = { S("calcmode"),		"calcMode" },
+	[107] = { S("clippathunits"),		"clipPathUnits" },
+	[ 93] = { S("contentscripttype"),	"contentScriptType" },
+	[ 92] = { S("contentstyletype"),	"contentStyleType" },
+	[ 32] = { S("diffuseconstant"),		"diffuseConstant" },
+	[ 55] = { S("edgemode"),		"edgeMode" },
+	[111] = { S("externalresourcesrequired"),	"externalResourcesRequired" },
+	[112] = { S("filterres"),		"filterRes" },
+	[ 77] = { S("filterunits"),		"filterUnits" },
+	[ 40] = { S("glyphref"),		"glyphRef" },
+	[ 83] = { S("gradienttransform"),	"gradientTransform" },
+	[ 73] = { S("gradientunits"),		"gradientUnits" },
+	[ 84] = { S("kernelmatrix"),		"kernelMatrix" },
+	[ 21] = { S("kernelunitlength"),	"kernelUnitLength" },
+	[ 24] = { S("keypoints"),		"keyPoints" },
+	[ 25] = { S("keysplines"),		"keySplines" },
+	[ 47] = { S("keytimes"),		"keyTimes" },
+	[  3] = { S("lengthadjust"),		"lengthAdjust" },
+	[119] = { S("limitingconeangle"),	"limitingConeAngle" },
+	[108] = { S("markerheight"),		"markerHeight" },
+	[118] = { S("markerunits"),		"markerUnits" },
+	[ 12] = { S("markerwidth"),		"markerWidth" },
+	[123] = { S("maskcontentunits"),	"maskContentUnits" },
+	[116] = { S("maskunits"),		"maskUnits" },
+	[ 31] = { S("numoctaves"),		"numOctaves" },
+	[ 20] = { S("pathlength"),		"pathLength" },
+	[ 53] = { S("patterncontentunits"),	"patternContentUnits" },
+	[ 56] = { S("patterntransform"),	"patternTransform" },
+	[ 46] = { S("patternunits"),		"patternUnits" },
+	[ 62] = { S("pointsatx"),		"pointsAtX" },
+	[ 61] = { S("pointsaty"),		"pointsAtY" },
+	[ 23] = { S("pointsatz"),		"pointsAtZ" },
+	[ 91] = { S("preservealpha"),		"preserveAlpha" },
+	[109] = { S("preserveaspectratio"),	"preserveAspectRatio" },
+	[ 48] = { S("primitiveunits"),		"primitiveUnits" },
+	[121] = { S("refx"),			"refX" },
+	[120] = { S("refy"),			"refY" },
+	[ 68] = { S("repeatcount"),		"repeatCount" },
+	[ 27] = { S("repeatdur"),		"repeatDur" },
+	[ 54] = { S("requiredextensions"),	"requiredExtensions" },
+	[ 59] = { S("requiredfeatures"),	"requiredFeatures" },
+	[ 58] = { S("specularconstant"),	"specularConstant" },
+	[ 22] = { S("specularexponent"),	"specularExponent" },
+	[ 37] = { S("spreadmethod"),		"spreadMethod" },
+	[ 74] = { S("startoffset"),		"startOffset" },
+	[ 95] = { S("stddeviation"),		"stdDeviation" },
+	[113] = { S("stitchtiles"),		"stitchTiles" },
+	[ 99] = { S("surfacescale"),		"surfaceScale" },
+	[101] = { S("systemlanguage"),		"systemLanguage" },
+	[ 65] = { S("tablevalues"),		"tableValues" },
+	[ 19] = { S("targetx"),			"targetX" },
+	[ 18] = { S("targety"),			"targetY" },
+	[ 15] = { S("textlength"),		"textLength" },
+	[103] = { S("viewbox"),			"viewBox" },
+	[ 34] = { S("viewtarget"),		"viewTarget" },
+	[ 88] = { S("xchannelselector"),	"xChannelSelector" },
+	[ 87] = { S("ychannelselector"),	"yChannelSelector" },
+	[125] = { S("zoomandpan"),		"zoomAndPan" },
+};
+
+static const case_changes svg_tagnames[SVG_TAGNAMES_SIZE] = {
+	[ 42] = { S("altglyph"),		"altGlyph" },
+	[  1] = { S("altglyphdef"),		"altGlyphDef" },
+	[ 30] = { S("altglyphitem"),		"altGlyphItem" },
+	[ 32] = { S("animatecolor"),		"animateColor" },
+	[ 11] = { S("animatemotion"),		"animateMotion" },
+	[  4] = { S("animatetransform"),	"animateTransform" },
+	[  0] = { S("clippath"),		"clipPath" },
+	[ 25] = { S("feblend"),			"feBlend" },
+	[ 58] = { S("fecolormatrix"),		"feColorMatrix" },
+	[ 57] = { S("fecomponenttransfer"),	"feComponentTransfer" },
+	[ 20] = { S("fecomposite"),		"feComposite" },
+	[ 61] = { S("feconvolvematrix"),	"feConvolveMatrix" },
+	[ 12] = { S("fediffuselighting"),	"feDiffuseLighting" },
+	[ 60] = { S("fedisplacementmap"),	"feDisplacementMap" },
+	[  5] = { S("fedistantlight"),		"feDistantLight" },
+	[ 14] = { S("feflood"),			"feFlood" },
+	[ 38] = { S("fefunca"),			"feFuncA" },
+	[ 16] = { S("fefuncb"),			"feFuncB" },
+	[ 52] = { S("fefuncg"),			"feFuncG" },
+	[ 62] = { S("fefuncr"),			"feFuncR" },
+	[ 54] = { S("fegaussianblur"),		"feGaussianBlur" },
+	[ 29] = { S("feimage"),			"feImage" },
+	[ 53] = { S("femerge"),			"feMerge" },
+	[ 50] = { S("femergenode"),		"feMergeNode" },
+	[ 49] = { S("femorphology"),		"feMorphology" },
+	[  6] = { S("feoffset"),		"feOffset" },
+	[  3] = { S("fepointlight"),		"fePointLight" },
+	[ 13] = { S("fespecularlighting"),	"feSpecularLighting" },
+	[  2] = { S("fespotlight"),		"feSpotLight" },
+	[ 15] = { S("fetile"),			"feTile" },
+	[  7] = { S("feturbulence"),		"feTurbulence" },
+	[ 18] = { S("foreignobject"),		"foreignObject" },
+	[ 40] = { S("glyphref"),		"glyphRef" },
+	[ 21] = { S("lineargradient"),		"linearGradient" },
+	[ 23] = { S("radialgradient"),		"radialGradient" },
+	[ 63] = { S("textpath"),		"textPath" },
 };
 
 #undef S
 
+/**
+ * Find the correctly cased version of an SVG name
+ *
+ * \param table  Case change table to search (svg_attributes or svg_tagnames)
+ * \param size   Number of slots in the table
+ * \param name   Lower case name to look up
+ * \param len    Length of name in bytes
+ * \return Pointer to correctly cased name, or NULL if name isn't in table
+ */
+static inline const char *svg_case_change(const case_changes *table,
+		size_t size, const uint8_t *name, size_t len)
+{
+	const case_changes *entry;
+	size_t hash = len;
+
+	/* Every name in the tables is at least 4 bytes long */
+	if (len < 4)
+		return NULL;
+
+#define ASSO(c)	(('a' <= (c) && (c) <= 'z') ? svg_name_asso[(c) - 'a'] : 0)
+	hash += ASSO(name[0]) + ASSO(name[len - 1]) + ASSO(name[len - 3]);
+#undef ASSO
+
+	entry = &table[hash % size];
+
+	if (entry->len != len || memcmp(entry->attr, name, len) != 0)
+		return NULL;
+
+	return entry->proper;
+}
+
 /**
  * Adjust MathML attributes
  *
@@ -175,18 +222,12 @@ void adjust_svg_attributes(hubbub_treebuilder *treebuilder,
 	for (i = 0; i < tag->n_attributes; i++) {
 		hubbub_attribute *attr = &tag->attributes[i];
 
-		const uint8_t *name = attr->name.ptr;
-		size_t len = attr->name.len;
-		size_t j;
-
-		for (j = 0; j < N_ELEMENTS(svg_attributes); j++) {
-			if (hubbub_string_match(name, len,
-					(uint8_t *) svg_attributes[j].attr,
-					svg_attributes[j].len)) {
-				attr->name.ptr =
-					(uint8_t *) svg_attributes[j].proper;
-			}
-		}
+		const char *proper;
+
+		proper = svg_case_change(svg_attributes, SVG_ATTRIBUTES_SIZE,
+				attr->name.ptr, attr->name.len);
+		if (proper != NULL)
+			attr->name.ptr = (const uint8_t *) proper;
 	}
 }
 
@@ -199,25 +240,74 @@ void adjust_svg_attributes(hubbub_treebuilder *treebuilder,
 void adjust_svg_tagname(hubbub_treebuilder *treebuilder,
 		hubbub_tag *tag)
 {
-	const uint8_t *name = tag->name.ptr;
-	size_t len = tag->name.len;
-	size_t i;
+	const char *proper;
 
 	UNUSED(treebuilder);
 
-	for (i = 0; i < N_ELEMENTS(svg_tagnames); i++) {
-		if (hubbub_string_match(name, len,
-				(uint8_t *) svg_tagnames[i].attr,
-				svg_tagnames[i].len)) {
-			tag->name.ptr =	(uint8_t *) svg_tagnames[i].proper;
-		}
-	}
+	proper = svg_case_change(svg_tagnames, SVG_TAGNAMES_SIZE,
+			tag->name.ptr, tag->name.len);
+	if (proper != NULL)
+		tag->name.ptr = (const uint8_t *) proper;
 }
 
 
 
 #define S(s)		(uint8_t *) s, SLEN(s)
 
+/**
+ * Determine if a name is one of the local names permitted after "xlink:"
+ *
+ * \param name  Local name, following the prefix
+ * \param len   Length of name in bytes
+ * \return True iff the attribute should be placed in the XLink namespace
+ */
+static inline bool is_xlink_local_name(const uint8_t *name, size_t len)
+{
+	if (len == 0)
+		return false;
+
+	switch (name[0]) {
+	case 'a':
+		return hubbub_string_match(name, len, S("actuate")) ||
+				hubbub_string_match(name, len, S("arcrole"));
+	case 'h':
+		return hubbub_string_match(name, len, S("href"));
+	case 'r':
+		return hubbub_string_match(name, len, S("role"));
+	case 's':
+		return hubbub_string_match(name, len, S("show"));
+	case 't':
+		return hubbub_string_match(name, len, S("title")) ||
+				hubbub_string_match(name, len, S("type"));
+	}
+
+	return false;
+}
+
+/**
+ * Determine if a name is one of the local names permitted after "xml:"
+ *
+ * \param name  Local name, following the prefix
+ * \param len   Length of name in bytes
+ * \return True iff the attribute should be placed in the XML namespace
+ */
+static inline bool is_xml_local_name(const uint8_t *name, size_t len)
+{
+	if (len == 0)
+		return false;
+
+	switch (name[0]) {
+	case 'b':
+		return hubbub_string_match(name, len, S("base"));
+	case 'l':
+		return hubbub_string_match(name, len, S("lang"));
+	case 's':
+		return hubbub_string_match(name, len, S("space"));
+	}
+
+	return false;
+}
+
 /**
  * Adjust foreign attributes.
  *
@@ -233,57 +323,36 @@ void adjust_foreign_attributes(hubbub_treebuilder *treebuilder,
 	for (i = 0; i < tag->n_attributes; i++) {
 		hubbub_attribute *attr = &tag->attributes[i];
 		const uint8_t *name = attr->name.ptr;
+		size_t len = attr->name.len;
+
+		/* All the adjusted names start with "xl" or "xm" */
+		if (len < SLEN("xmlns") || name[0] != 'x' ||
+				(name[1] != 'm' && name[1] != 'l'))
+			continue;
 
 		/* 10 == strlen("xlink:href") */
-		if (attr->name.len >= 10 &&
-				strncmp((char *) name, "xlink:", 
-						SLEN("xlink:")) == 0) {
-			size_t len = attr->name.len - 6;
-			name += 6;
-
-			if (hubbub_string_match(name, len, S("actuate")) ||
-					hubbub_string_match(name, len,
-							S("arcrole")) ||
-					hubbub_string_match(name, len,
-							S("href")) ||
-					hubbub_string_match(name, len,
-							S("role")) ||
-					hubbub_string_match(name, len,
-							S("show")) ||
-					hubbub_string_match(name, len,
-							S("title")) ||
-					hubbub_string_match(name, len,
-							S("type"))) {
+		if (len >= 10 && strncmp((const char *) name, "xlink:",
+				SLEN("xlink:")) == 0) {
+			if (is_xlink_local_name(name + 6, len - 6)) {
 				attr->ns = HUBBUB_NS_XLINK;
 				attr->name.ptr += 6;
 				attr->name.len -= 6;
 			}
 		/* 8 == strlen("xml:base") */
-		} else if (attr->name.len >= 8 &&
-				strncmp((char *) name, "xml:", 
-						SLEN("xml:")) == 0) {
-			size_t len = attr->name.len - 4;
-			name += 4;
-
-			if (hubbub_string_match(name, len, S("base")) ||
-					hubbub_string_match(name, len,
-							S("lang")) ||
-					hubbub_string_match(name, len,
-							S("space"))) {
+		} else if (len >= 8 && strncmp((const char *) name, "xml:",
+				SLEN("xml:")) == 0) {
+			if (is_xml_local_name(name + 4, len - 4)) {
 				attr->ns = HUBBUB_NS_XML;
 				attr->name.ptr += 4;
 				attr->name.len -= 4;
 			}
-		} else if (hubbub_string_match(name, attr->name.len,
-						S("xmlns"))) {
+		} else if (hubbub_string_match(name, len, S("xmlns"))) {
 			attr->ns = HUBBUB_NS_XMLNS;
-		} else if (hubbub_string_match(name, attr->name.len,
-						S("xmlns:xlink"))) {
+		} else if (hubbub_string_match(name, len, S("xmlns:xlink"))) {
 			attr->ns = HUBBUB_NS_XMLNS;
 			attr->name.ptr += 6;
 			attr->name.len -= 6;
 		}
-
 	}
 }
 
@@ -300,13 +369,13 @@ void adjust_foreign_attributes(hubbub_treebuilder *treebuilder,
  */
 static bool element_in_scope_in_non_html_ns(hubbub_treebuilder *treebuilder)
 {
-	element_context *stack = treebuilder->context.element_stack;
+	element_kind *kind = treebuilder->context.stack_kind;
 	uint32_t node;
 
 	assert((signed) treebuilder->context.current_node >= 0);
 
 	for (node = treebuilder->context.current_node; node > 0; node--) {
-		element_type node_type = stack[node].type;
+		element_type node_type = kind[node].type;
 
 		/* The list of element types given in the spec here are the
 		 * scoping elements excluding TABLE and HTML. TABLE is handled
@@ -316,7 +385,7 @@ static bool element_in_scope_in_non_html_ns(hubbub_treebuilder *treebuilder)
 		if (node_type == TABLE || is_scoping_element(node_type))
 			break;
 
-		if (stack[node].ns != HUBBUB_NS_HTML)
+		if (kind[node].ns != HUBBUB_NS_HTML)
 			return true;
 	}
 
@@ -360,11 +429,11 @@ static hubbub_error process_as_in_secondary(hubbub_treebuilder *treebuilder,
  */
 static void foreign_break_out(hubbub_treebuilder *treebuilder)
 {
-	element_context *stack = treebuilder->context.element_stack;
+	element_kind *kind = treebuilder->context.stack_kind;
 
 	/** \todo parse error */
 
-	while (stack[treebuilder->context.current_node].ns !=
+	while (kind[treebuilder->context.current_node].ns !=
 			HUBBUB_NS_HTML) {
 		hubbub_ns ns;
 		element_type type;
@@ -398,15 +467,15 @@ hubbub_error handle_in_foreign_content(hubbub_treebuilder *treebuilder,
 		break;
 	case HUBBUB_TOKEN_COMMENT:
 		err = process_comment_append(treebuilder, token,
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 		break;
 	case HUBBUB_TOKEN_DOCTYPE:
 		/** \todo parse error */
 		break;
 	case HUBBUB_TOKEN_START_TAG:
 	{
-		hubbub_ns cur_node_ns = treebuilder->context.element_stack[
+		hubbub_ns cur_node_ns = treebuilder->context.stack_kind[
 				treebuilder->context.current_node].ns;
 
 		element_type cur_node = current_node(treebuilder);
@@ -41,7 +41,12 @@ static hubbub_error process_meta_in_head(hubbub_treebuilder *treebuilder,
 
 	/** \todo ack sc flag */
 
-	if (treebuilder->tree_handler->encoding_change == NULL)
+	/* A fragment's charset is that of the document it's destined for */
+	if (treebuilder->context.fragment)
+		return err;
+
+	if (treebuilder->tree_handler->encoding_change == NULL &&
+			treebuilder->charset_handler == NULL)
 		return err;
 
 	/* Grab UTF-16 MIBenums */
@@ -92,8 +97,20 @@ static hubbub_error process_meta_in_head(hubbub_treebuilder *treebuilder,
 
 		name = parserutils_charset_mibenum_to_name(charset_enc);
 
-		err = treebuilder->tree_handler->encoding_change(
-				treebuilder->tree_handler->ctx,	name);
+		/* Switch charset without reprocessing, if we can */
+		if (treebuilder->charset_handler != NULL) {
+			err = treebuilder->charset_handler(name,
+					treebuilder->charset_pw);
+			if (err == HUBBUB_INVALID)
+				err = HUBBUB_OK;
+			if (err != HUBBUB_OK)
+				return err;
+		}
+
+		if (treebuilder->tree_handler->encoding_change != NULL) {
+			err = treebuilder->tree_handler->encoding_change(
+					treebuilder->tree_handler->ctx,	name);
+		}
 	}
 
 	return err;
@@ -119,8 +136,8 @@ hubbub_error handle_in_head(hubbub_treebuilder *treebuilder,
 		break;
 	case HUBBUB_TOKEN_COMMENT:
 		err = process_comment_append(treebuilder, token,
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 		break;
 	case HUBBUB_TOKEN_DOCTYPE:
 		/** \todo parse error */
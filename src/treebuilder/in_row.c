@@ -53,7 +53,11 @@ static hubbub_error act_as_if_end_tag_tr(hubbub_treebuilder *treebuilder)
 	element_type otype;
 	void *node;
 
-	/** \todo fragment case */
+	/* fragment case -- ignore if there's no row */
+	if (!element_in_scope(treebuilder, TR, true)) {
+		/** \todo parse error */
+		return HUBBUB_OK;
+	}
 
 	table_clear_stack(treebuilder);
 
@@ -99,13 +103,13 @@ hubbub_error handle_in_row(hubbub_treebuilder *treebuilder,
 			/* ref node for formatting list */
 			treebuilder->tree_handler->ref_node(
 				treebuilder->tree_handler->ctx, 
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 
 			err = formatting_list_append(treebuilder, 
 					token->data.tag.ns, type,
-					treebuilder->context.element_stack[
-					treebuilder->context.current_node].node,
+					treebuilder->context.stack_node[
+					treebuilder->context.current_node],
 					treebuilder->context.current_node);
 			if (err != HUBBUB_OK) {
 				hubbub_ns ns;
@@ -115,8 +119,8 @@ hubbub_error handle_in_row(hubbub_treebuilder *treebuilder,
 				/* Revert changes */
 
 				remove_node_from_dom(treebuilder, 
-					treebuilder->context.element_stack[
-					treebuilder->context.current_node].node);
+					treebuilder->context.stack_node[
+					treebuilder->context.current_node]);
 				element_stack_pop(treebuilder, &ns, &type, 
 						&node);
 
@@ -36,8 +36,8 @@ hubbub_error handle_in_select(hubbub_treebuilder *treebuilder,
 		break;
 	case HUBBUB_TOKEN_COMMENT:
 		err = process_comment_append(treebuilder, token,
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 		break;
 	case HUBBUB_TOKEN_DOCTYPE:
 		/** \todo parse error */
@@ -90,13 +90,13 @@ hubbub_error handle_in_select(hubbub_treebuilder *treebuilder,
 				element_stack_pop_until(treebuilder, 
 						SELECT);
 				reset_insertion_mode(treebuilder);
+
+				if (type != SELECT)
+					err = HUBBUB_REPROCESS;
 			} else {
 				/* fragment case */
 				/** \todo parse error */
 			}
-
-			if (type != SELECT)
-				err = HUBBUB_REPROCESS;
 		} else if (type == SCRIPT) {
 			err = handle_in_head(treebuilder, token);
 		} else {
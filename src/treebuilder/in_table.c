@@ -22,21 +22,89 @@
  */
 static inline void clear_stack_table_context(hubbub_treebuilder *treebuilder)
 {
+	element_kind *kind = treebuilder->context.stack_kind;
 	hubbub_ns ns;
-	element_type type = current_node(treebuilder);
+	element_type type;
 	void *node;
 
-	while (type != TABLE && type != HTML) {
+	/* Nothing above the current table is a table */
+	while (treebuilder->context.current_node >
+			treebuilder->context.current_table &&
+			kind[treebuilder->context.current_node].type != HTML) {
 		element_stack_pop(treebuilder, &ns, &type, &node);
 
 		treebuilder->tree_handler->unref_node(
 				treebuilder->tree_handler->ctx,
 				node);
+	}
+}
+
 
-		type = current_node(treebuilder);
+/**
+ * Append character data to the pending table text.
+ *
+ * Runs of character tokens which would be foster parented are collected
+ * and inserted as a single text node when the run ends, rather than one
+ * text node per token.
+ *
+ * \param treebuilder  The treebuilder instance
+ * \param string       The character data to append
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+static hubbub_error append_pending_table_text(
+		hubbub_treebuilder *treebuilder, const hubbub_string *string)
+{
+	size_t len = treebuilder->context.pending_table_text.len;
+
+	if (len + string->len > treebuilder->context.pending_table_text.alloc) {
+		size_t alloc = (len + string->len + 255) & ~((size_t) 255);
+		uint8_t *temp;
+
+		temp = treebuilder->alloc(
+				treebuilder->context.pending_table_text.buf,
+				alloc, treebuilder->alloc_pw);
+		if (temp == NULL)
+			return HUBBUB_NOMEM;
+
+		treebuilder->context.pending_table_text.buf = temp;
+		treebuilder->context.pending_table_text.alloc = alloc;
 	}
+
+	memcpy(treebuilder->context.pending_table_text.buf + len,
+			string->ptr, string->len);
+	treebuilder->context.pending_table_text.len += string->len;
+
+	return HUBBUB_OK;
 }
 
+/**
+ * Foster parent the pending table text, as if in the "in body" mode.
+ *
+ * \param treebuilder  The treebuilder instance
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error flush_pending_table_text(hubbub_treebuilder *treebuilder)
+{
+	hubbub_token token;
+	hubbub_error err;
+
+	token.type = HUBBUB_TOKEN_CHARACTER;
+	token.data.character.ptr = treebuilder->context.pending_table_text.buf;
+	token.data.character.len = treebuilder->context.pending_table_text.len;
+
+	treebuilder->context.in_table_foster = true;
+
+	/** \todo parse error */
+	err = handle_in_body(treebuilder, &token);
+
+	treebuilder->context.in_table_foster = false;
+
+	/* Keep the text if it wasn't inserted, so it can be retried */
+	if (err == HUBBUB_OK)
+		treebuilder->context.pending_table_text.len = 0;
+
+	return err;
+}
 
 /**
  * Process an input start tag in the "in table" insertion mode.
@@ -79,20 +147,26 @@ hubbub_error handle_in_table(hubbub_treebuilder *treebuilder,
 
 	switch (token->type) {
 	case HUBBUB_TOKEN_CHARACTER:
-		if (treebuilder->context.element_stack[
+		if (treebuilder->context.pending_table_text.len > 0 ||
+				treebuilder->context.stack_links[
 				current_table(treebuilder)
 				].tainted) {
-			handled = false;
+			err = append_pending_table_text(treebuilder,
+					&token->data.character);
 		} else {
 			err = process_characters_expect_whitespace(
 					treebuilder, token, true);
-			handled = (err == HUBBUB_OK);
+			if (err == HUBBUB_REPROCESS) {
+				/* Leading whitespace has been stripped */
+				err = append_pending_table_text(treebuilder,
+						&token->data.character);
+			}
 		}
 		break;
 	case HUBBUB_TOKEN_COMMENT:
 		err = process_comment_append(treebuilder, token,
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 		break;
 	case HUBBUB_TOKEN_DOCTYPE:
 		/** \todo parse error */
@@ -101,7 +175,7 @@ hubbub_error handle_in_table(hubbub_treebuilder *treebuilder,
 	{
 		element_type type = element_type_from_name(treebuilder,
 				&token->data.tag.name);
-		bool tainted = treebuilder->context.element_stack[
+		bool tainted = treebuilder->context.stack_links[
 					current_table(treebuilder)
 					].tainted;
 
@@ -110,19 +184,19 @@ hubbub_error handle_in_table(hubbub_treebuilder *treebuilder,
 
 			treebuilder->tree_handler->ref_node(
 				treebuilder->tree_handler->ctx,
-				treebuilder->context.element_stack[
-				treebuilder->context.current_node].node);
+				treebuilder->context.stack_node[
+				treebuilder->context.current_node]);
 
 			err = formatting_list_append(treebuilder,
 					token->data.tag.ns, type,
-					treebuilder->context.element_stack[
-					treebuilder->context.current_node].node,
+					treebuilder->context.stack_node[
+					treebuilder->context.current_node],
 					treebuilder->context.current_node);
 			if (err != HUBBUB_OK) {
 				treebuilder->tree_handler->unref_node(
 					treebuilder->tree_handler->ctx,
-					treebuilder->context.element_stack[
-					treebuilder->context.current_node].node);
+					treebuilder->context.stack_node[
+					treebuilder->context.current_node]);
 
 				return err;
 			}
@@ -194,11 +268,13 @@ hubbub_error handle_in_table(hubbub_treebuilder *treebuilder,
 			/** \todo parse error */
 
 			/* This should match "</table>" handling */
-			element_stack_pop_until(treebuilder, TABLE);
+			if (element_in_scope(treebuilder, TABLE, true)) {
+				element_stack_pop_until(treebuilder, TABLE);
 
-			reset_insertion_mode(treebuilder);
+				reset_insertion_mode(treebuilder);
 
-			err = HUBBUB_REPROCESS;
+				err = HUBBUB_REPROCESS;
+			}
 		} else if (!tainted && (type == STYLE || type == SCRIPT)) {
 			err = handle_in_head(treebuilder, token);
 		} else if (!tainted && type == INPUT) {
@@ -215,11 +291,14 @@ hubbub_error handle_in_table(hubbub_treebuilder *treebuilder,
 				&token->data.tag.name);
 
 		if (type == TABLE) {
-			/** \todo fragment case */
+			/* fragment case -- ignore if there's no table */
+			if (element_in_scope(treebuilder, TABLE, true)) {
+				element_stack_pop_until(treebuilder, TABLE);
 
-			element_stack_pop_until(treebuilder, TABLE);
-
-			reset_insertion_mode(treebuilder);
+				reset_insertion_mode(treebuilder);
+			} else {
+				/** \todo parse error */
+			}
 		} else if (type == BODY || type == CAPTION || type == COL ||
 				type == COLGROUP || type == HTML ||
 				type == TBODY || type == TD || type == TFOOT ||
@@ -10,6 +10,8 @@
 
 #include "treebuilder/treebuilder.h"
 
+/* Elements are grouped by category for readability only: the categories
+ * an element belongs to are given by element_properties[], below. */
 typedef enum
 {
 /* Special */
@@ -36,21 +38,57 @@ typedef enum
 	UNKNOWN
 } element_type;
 
+/* Element properties */
+#define ELEMENT_SPECIAL		(1 << 0)	/**< Special element */
+#define ELEMENT_SCOPING		(1 << 1)	/**< Bounds default scope */
+#define ELEMENT_TABLE_SCOPING	(1 << 2)	/**< Bounds table scope */
+#define ELEMENT_FORMATTING	(1 << 3)	/**< Formatting element */
+#define ELEMENT_PHRASING	(1 << 4)	/**< Phrasing element */
+#define ELEMENT_IMPLIED_END	(1 << 5)	/**< End tag may be implied */
+#define ELEMENT_FORM_ASSOCIATED	(1 << 6)	/**< Form-associated element */
+#define ELEMENT_MODE_ANCHOR	(1 << 7)	/**< Decides insertion mode on
+						 * reset */
+
+/** Properties of each element type, indexed by type */
+extern const uint8_t element_properties[UNKNOWN + 1];
+
 /**
- * Item on the element stack
+ * Type and namespace of an item on the element stack
+ *
+ * Scope checks and other scans of the stack read nothing else, so these
+ * are kept apart from the rest of each item, and packed.
  */
-typedef struct element_context
+typedef struct element_kind
 {
-	hubbub_ns ns;			/**< Element namespace */
-	element_type type;		/**< Element type */
-	uint8_t *name;			/**< Element name (interned) */
+	uint8_t type;			/**< Element type */
+	uint8_t ns;			/**< Element namespace */
+} element_kind;
 
+/**
+ * Links between the tables and insertion mode anchors on the element stack
+ */
+typedef struct element_links
+{
 	bool tainted;			/**< Only for tables.  "Once the
 					 * current table has been tainted,
 					 * whitespace characters are inserted
 					 * into the foster parent element
 					 * instead of the current node." */
+	uint32_t prev_table;		/**< Only for tables. Stack index of
+					 * the next table down the stack,
+					 * or 0 if there is none */
+	uint32_t prev_anchor;		/**< Only for mode anchors. Stack
+					 * index of the next anchor down the
+					 * stack, or 0 if there is none */
+} element_links;
 
+/**
+ * Element in a formatting list
+ */
+typedef struct element_context
+{
+	hubbub_ns ns;			/**< Element namespace */
+	element_type type;		/**< Element type */
 	void *node;			/**< Node pointer */
 } element_context;
 
@@ -75,10 +113,19 @@ typedef struct hubbub_treebuilder_context
 	insertion_mode mode;		/**< The current insertion mode */
 	insertion_mode second_mode;	/**< The secondary insertion mode */
 
-#define ELEMENT_STACK_CHUNK 128
-	element_context *element_stack;	/**< Stack of open elements */
+	/* The stack of open elements is held as parallel arrays,
+	 * indexed by stack slot */
+#define ELEMENT_STACK_INITIAL 128
+	element_kind *stack_kind;	/**< Types and namespaces of elements */
+	void **stack_node;		/**< Nodes of elements */
+	element_links *stack_links;	/**< Links between tables and anchors */
 	uint32_t stack_alloc;		/**< Number of stack slots allocated */
 	uint32_t current_node;		/**< Index of current node in stack */
+	uint32_t current_table;		/**< Index of topmost table in stack,
+					 * or 0 if there is none */
+	uint32_t current_anchor;	/**< Index of topmost element in stack
+					 * which determines the insertion mode
+					 * on reset, or 0 if there is none */
 
 	formatting_list_entry *formatting_list;	/**< List of active formatting 
 						 * elements */
@@ -107,7 +154,29 @@ typedef struct hubbub_treebuilder_context
 					* inserted into the current node should
 					* be foster parented */
 
+	struct {
+		uint8_t *buf;		/**< Buffer holding text */
+		size_t len;		/**< Length of text in bytes */
+		size_t alloc;		/**< Size of buffer in bytes */
+	} pending_table_text;		/**< Character data in table context
+					 * awaiting foster parenting */
+
 	bool frameset_ok;		/**< Whether to process a frameset */
+
+	bool fragment;			/**< Whether we're parsing a fragment */
+	hubbub_ns fragment_ns;		/**< Namespace of context element */
+	element_type fragment_type;	/**< Type of context element */
+
+	hubbub_stop_condition stop;	/**< When to stop building */
+	element_type stop_type;		/**< Type of element to stop after */
+	uint32_t stop_count;		/**< Start tags left before stopping */
+	bool stopped;			/**< Whether the stop condition has
+					 * been met */
+
+	bool ignore_whitespace;		/**< Whether to drop whitespace
+					 * that cannot be rendered */
+	bool after_block;		/**< Whether the last thing inserted
+					 * was a block boundary */
 } hubbub_treebuilder_context;
 
 /**
@@ -124,6 +193,10 @@ struct hubbub_treebuilder
 	hubbub_error_handler error_handler;	/**< Error handler */
 	void *error_pw;				/**< Error handler data */
 
+	hubbub_treebuilder_charset_handler charset_handler;
+						/**< Charset switching callback */
+	void *charset_pw;			/**< Charset handler data */
+
 	hubbub_allocator_fn alloc;	/**< Memory (de)allocation function */
 	void *alloc_pw;			/**< Client private data */
 };
@@ -141,6 +214,7 @@ hubbub_error parse_generic_rcdata(hubbub_treebuilder *treebuilder,
 
 uint32_t element_in_scope(hubbub_treebuilder *treebuilder,
 		element_type type, bool in_table);
+bool in_preformatted(hubbub_treebuilder *treebuilder);
 hubbub_error reconstruct_active_formatting_list(
 		hubbub_treebuilder *treebuilder);
 void clear_active_formatting_list_to_marker(
@@ -159,10 +233,6 @@ hubbub_error complete_script(hubbub_treebuilder *treebuilder);
 element_type element_type_from_name(hubbub_treebuilder *treebuilder,
 		const hubbub_string *tag_name);
 
-bool is_special_element(element_type type);
-bool is_scoping_element(element_type type);
-bool is_formatting_element(element_type type);
-bool is_phrasing_element(element_type type);
 
 hubbub_error element_stack_push(hubbub_treebuilder *treebuilder,
 		hubbub_ns ns, element_type type, void *node);
@@ -173,6 +243,10 @@ hubbub_error element_stack_pop_until(hubbub_treebuilder *treebuilder,
 hubbub_error element_stack_remove(hubbub_treebuilder *treebuilder, 
 		uint32_t index, hubbub_ns *ns, element_type *type, 
 		void **removed);
+void element_stack_unlink(hubbub_treebuilder *treebuilder,
+		uint32_t index, uint32_t limit);
+void element_stack_shift(hubbub_treebuilder *treebuilder,
+		uint32_t index, uint32_t limit);
 uint32_t current_table(hubbub_treebuilder *treebuilder);
 element_type current_node(hubbub_treebuilder *treebuilder);
 element_type prev_node(hubbub_treebuilder *treebuilder);
@@ -204,6 +278,53 @@ void adjust_svg_tagname(hubbub_treebuilder *treebuilder,
 void adjust_foreign_attributes(hubbub_treebuilder *treebuilder,
 		hubbub_tag *tag);
 
+/**
+ * Determine if a node is a special element
+ *
+ * \param type  Node type to consider
+ * \return True iff node is a special element
+ */
+static inline bool is_special_element(element_type type)
+{
+	return (element_properties[type] & ELEMENT_SPECIAL) != 0;
+}
+
+/**
+ * Determine if a node is a scoping element
+ *
+ * \param type  Node type to consider
+ * \return True iff node is a scoping element
+ */
+static inline bool is_scoping_element(element_type type)
+{
+	return (element_properties[type] & ELEMENT_SCOPING) != 0;
+}
+
+/**
+ * Determine if a node is a formatting element
+ *
+ * \param type  Node type to consider
+ * \return True iff node is a formatting element
+ */
+static inline bool is_formatting_element(element_type type)
+{
+	return (element_properties[type] & ELEMENT_FORMATTING) != 0;
+}
+
+/**
+ * Determine if a node is a phrasing element
+ *
+ * \param type  Node type to consider
+ * \return True iff node is a phrasing element
+ */
+static inline bool is_phrasing_element(element_type type)
+{
+	return (element_properties[type] & ELEMENT_PHRASING) != 0;
+}
+
+/* in_table.c */
+hubbub_error flush_pending_table_text(hubbub_treebuilder *treebuilder);
+
 /* in_body.c */
 hubbub_error aa_insert_into_foster_parent(hubbub_treebuilder *treebuilder, 
 		void *node, void **inserted);
@@ -0,0 +1,538 @@
+/*
+ * This file is part of Hubbub.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "treebuilder/textbuilder.h"
+#include "utils/utils.h"
+
+/*
+ * The textbuilder is a stand-in for the treebuilder for clients that want
+ * only the visible text of a document. It builds no tree: it tracks just
+ * enough of the tree construction state to drive the tokeniser's content
+ * model and to tell visible text from invisible text.
+ */
+
+/** Element may appear before the body */
+#define TB_HEAD		(1 << 0)
+/** Element starts a new block of text */
+#define TB_BLOCK	(1 << 1)
+/** Element content is raw text that is never rendered */
+#define TB_HIDDEN_RAW	(1 << 2)
+/** Element content is markup that is never rendered */
+#define TB_HIDDEN	(1 << 3)
+/** A newline immediately after the start tag is ignored */
+#define TB_STRIP_LF	(1 << 4)
+/** Element switches to foreign content */
+#define TB_FOREIGN	(1 << 5)
+/** Element content depends on whether scripting is enabled */
+#define TB_NOSCRIPT	(1 << 6)
+
+#define S(x)   x, SLEN(x)
+
+static const struct {
+	const char *name;
+	size_t len;
+	uint32_t flags;
+	hubbub_content_model model;	/**< Content model of element */
+} name_flags_map[] = {
+	{ S("html"), TB_HEAD, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("head"), TB_HEAD, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("base"), TB_HEAD, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("basefont"), TB_HEAD, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("bgsound"), TB_HEAD, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("link"), TB_HEAD, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("meta"), TB_HEAD, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("title"), TB_HEAD | TB_HIDDEN_RAW, HUBBUB_CONTENT_MODEL_RCDATA },
+	{ S("style"), TB_HEAD | TB_HIDDEN_RAW, HUBBUB_CONTENT_MODEL_CDATA },
+	{ S("script"), TB_HEAD | TB_HIDDEN_RAW, HUBBUB_CONTENT_MODEL_CDATA },
+	{ S("noframes"), TB_HEAD | TB_HIDDEN_RAW, HUBBUB_CONTENT_MODEL_CDATA },
+	{ S("noscript"), TB_HEAD | TB_NOSCRIPT, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("template"), TB_HEAD | TB_HIDDEN, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("iframe"), TB_HIDDEN_RAW, HUBBUB_CONTENT_MODEL_CDATA },
+	{ S("noembed"), TB_HIDDEN_RAW, HUBBUB_CONTENT_MODEL_CDATA },
+	{ S("textarea"), TB_BLOCK | TB_STRIP_LF, HUBBUB_CONTENT_MODEL_RCDATA },
+	{ S("xmp"), TB_BLOCK, HUBBUB_CONTENT_MODEL_CDATA },
+	{ S("plaintext"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PLAINTEXT },
+	{ S("pre"), TB_BLOCK | TB_STRIP_LF, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("listing"), TB_BLOCK | TB_STRIP_LF, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("svg"), TB_FOREIGN, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("math"), TB_FOREIGN, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("address"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("article"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("aside"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("blockquote"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("br"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("caption"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("center"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("dd"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("details"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("dir"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("div"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("dl"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("dt"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("fieldset"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("figcaption"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("figure"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("footer"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("form"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("h1"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("h2"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("h3"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("h4"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("h5"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("h6"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("header"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("hr"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("li"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("main"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("menu"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("nav"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("ol"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("option"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("p"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("section"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("table"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("td"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("th"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("tr"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+	{ S("ul"), TB_BLOCK, HUBBUB_CONTENT_MODEL_PCDATA },
+};
+
+#undef S
+
+/** Attribute filter that keeps no attributes, as no text is in them */
+static const char *no_attributes[] = { NULL };
+
+/**
+ * Textbuilder object
+ */
+struct hubbub_textbuilder {
+	hubbub_tokeniser *tokeniser;	/**< Underlying tokeniser */
+
+	bool in_body;			/**< Whether the body has started */
+	bool raw_hidden;		/**< In an invisible raw text element */
+	uint32_t hidden;		/**< Depth of invisible elements */
+	uint32_t foreign;		/**< Depth of foreign content */
+	bool strip_lf;			/**< Ignore a leading newline */
+	bool need_break;		/**< A block boundary was crossed */
+	bool had_text;			/**< Whether text has been emitted */
+
+	bool scripting;			/**< Whether scripting is enabled */
+
+	hubbub_text_handler text_handler;	/**< Text handling callback */
+	void *text_pw;				/**< Text handler data */
+
+	hubbub_allocator_fn alloc;	/**< Memory (de)allocation function */
+	void *alloc_pw;			/**< Client private data */
+};
+
+static hubbub_error hubbub_textbuilder_token_handler(
+		const hubbub_token *token, void *pw);
+static int textbuilder_element(const hubbub_string *name);
+static void textbuilder_start_tag(hubbub_textbuilder *textbuilder,
+		const hubbub_tag *tag);
+static void textbuilder_end_tag(hubbub_textbuilder *textbuilder,
+		const hubbub_tag *tag);
+static hubbub_error textbuilder_characters(hubbub_textbuilder *textbuilder,
+		const hubbub_string *chars);
+
+/**
+ * Create a hubbub textbuilder
+ *
+ * \param tokeniser    Underlying tokeniser instance
+ * \param alloc        Memory (de)allocation function
+ * \param pw           Pointer to client-specific private data
+ * \param textbuilder  Pointer to location to receive textbuilder instance
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_BADPARM on bad parameters
+ *         HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error hubbub_textbuilder_create(hubbub_tokeniser *tokeniser,
+		hubbub_allocator_fn alloc, void *pw,
+		hubbub_textbuilder **textbuilder)
+{
+	hubbub_error error;
+	hubbub_textbuilder *tb;
+	hubbub_tokeniser_optparams tokparams;
+
+	if (tokeniser == NULL || alloc == NULL || textbuilder == NULL)
+		return HUBBUB_BADPARM;
+
+	tb = alloc(NULL, sizeof(hubbub_textbuilder), pw);
+	if (tb == NULL)
+		return HUBBUB_NOMEM;
+
+	tb->tokeniser = tokeniser;
+
+	tb->in_body = false;
+	tb->raw_hidden = false;
+	tb->hidden = 0;
+	tb->foreign = 0;
+	tb->strip_lf = false;
+	tb->need_break = false;
+	tb->had_text = false;
+
+	tb->scripting = false;
+
+	tb->text_handler = NULL;
+	tb->text_pw = NULL;
+
+	tb->alloc = alloc;
+	tb->alloc_pw = pw;
+
+	tokparams.attribute_filter.names = no_attributes;
+	tokparams.attribute_filter.tags = NULL;
+
+	error = hubbub_tokeniser_setopt(tokeniser,
+			HUBBUB_TOKENISER_ATTRIBUTE_FILTER, &tokparams);
+	if (error != HUBBUB_OK) {
+		alloc(tb, 0, pw);
+		return error;
+	}
+
+	tokparams.token_handler.handler = hubbub_textbuilder_token_handler;
+	tokparams.token_handler.pw = tb;
+
+	error = hubbub_tokeniser_setopt(tokeniser,
+			HUBBUB_TOKENISER_TOKEN_HANDLER, &tokparams);
+	if (error != HUBBUB_OK) {
+		alloc(tb, 0, pw);
+		return error;
+	}
+
+	*textbuilder = tb;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Destroy a hubbub textbuilder
+ *
+ * \param textbuilder  The textbuilder instance to destroy
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error hubbub_textbuilder_destroy(hubbub_textbuilder *textbuilder)
+{
+	hubbub_tokeniser_optparams tokparams;
+
+	if (textbuilder == NULL)
+		return HUBBUB_BADPARM;
+
+	tokparams.token_handler.handler = NULL;
+	tokparams.token_handler.pw = NULL;
+
+	hubbub_tokeniser_setopt(textbuilder->tokeniser,
+			HUBBUB_TOKENISER_TOKEN_HANDLER, &tokparams);
+
+	/* Any filter of the client's is the owner's to put back */
+	tokparams.attribute_filter.names = NULL;
+	tokparams.attribute_filter.tags = NULL;
+
+	hubbub_tokeniser_setopt(textbuilder->tokeniser,
+			HUBBUB_TOKENISER_ATTRIBUTE_FILTER, &tokparams);
+
+	textbuilder->alloc(textbuilder, 0, textbuilder->alloc_pw);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Clone a hubbub textbuilder
+ *
+ * \param textbuilder  The textbuilder instance to clone
+ * \param tokeniser    Tokeniser for the clone, which it will be attached to
+ * \param clone        Pointer to location to receive clone
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_BADPARM on bad parameters,
+ *         HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error hubbub_textbuilder_clone(hubbub_textbuilder *textbuilder,
+		hubbub_tokeniser *tokeniser, hubbub_textbuilder **clone)
+{
+	hubbub_error error;
+	hubbub_textbuilder *tb;
+	hubbub_tokeniser_optparams tokparams;
+
+	if (textbuilder == NULL || tokeniser == NULL || clone == NULL)
+		return HUBBUB_BADPARM;
+
+	tb = textbuilder->alloc(NULL, sizeof(hubbub_textbuilder),
+			textbuilder->alloc_pw);
+	if (tb == NULL)
+		return HUBBUB_NOMEM;
+
+	*tb = *textbuilder;
+
+	tb->tokeniser = tokeniser;
+
+	tokparams.token_handler.handler = hubbub_textbuilder_token_handler;
+	tokparams.token_handler.pw = tb;
+
+	error = hubbub_tokeniser_setopt(tokeniser,
+			HUBBUB_TOKENISER_TOKEN_HANDLER, &tokparams);
+	if (error != HUBBUB_OK) {
+		tb->alloc(tb, 0, tb->alloc_pw);
+		return error;
+	}
+
+	*clone = tb;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Set an option in the textbuilder
+ *
+ * \param textbuilder  Textbuilder instance to configure
+ * \param type         Option to set
+ * \param params       Option-specific parameters
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error hubbub_textbuilder_setopt(hubbub_textbuilder *textbuilder,
+		hubbub_textbuilder_opttype type,
+		hubbub_textbuilder_optparams *params)
+{
+	if (textbuilder == NULL || params == NULL)
+		return HUBBUB_BADPARM;
+
+	switch (type) {
+	case HUBBUB_TEXTBUILDER_TEXT_HANDLER:
+		textbuilder->text_handler = params->text_handler.handler;
+		textbuilder->text_pw = params->text_handler.pw;
+		break;
+	case HUBBUB_TEXTBUILDER_ENABLE_SCRIPTING:
+		textbuilder->scripting = params->enable_scripting;
+		break;
+	}
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Handle tokeniser emitting a token
+ *
+ * \param token  The emitted token
+ * \param pw     Pointer to textbuilder instance
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error hubbub_textbuilder_token_handler(const hubbub_token *token,
+		void *pw)
+{
+	hubbub_textbuilder *textbuilder = (hubbub_textbuilder *) pw;
+	bool strip_lf = textbuilder->strip_lf;
+
+	/* Only the token straight after the start tag may lose its LF */
+	textbuilder->strip_lf = false;
+
+	switch (token->type) {
+	case HUBBUB_TOKEN_START_TAG:
+		textbuilder_start_tag(textbuilder, &token->data.tag);
+		break;
+	case HUBBUB_TOKEN_END_TAG:
+		textbuilder_end_tag(textbuilder, &token->data.tag);
+		break;
+	case HUBBUB_TOKEN_CHARACTER:
+	{
+		hubbub_string chars = token->data.character;
+
+		if (strip_lf && chars.len > 0 && chars.ptr[0] == '\n') {
+			chars.ptr++;
+			chars.len--;
+		}
+
+		return textbuilder_characters(textbuilder, &chars);
+	}
+	case HUBBUB_TOKEN_DOCTYPE:
+	case HUBBUB_TOKEN_COMMENT:
+	case HUBBUB_TOKEN_EOF:
+		break;
+	}
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Find an element in the flags map
+ *
+ * \param name  Lower case tag name
+ * \return Index of element in map, or -1 if it is of no interest
+ */
+int textbuilder_element(const hubbub_string *name)
+{
+	uint32_t i;
+
+	for (i = 0; i < N_ELEMENTS(name_flags_map); i++) {
+		if (name_flags_map[i].len == name->len &&
+				memcmp(name_flags_map[i].name, name->ptr,
+					name->len) == 0)
+			return i;
+	}
+
+	return -1;
+}
+
+/**
+ * Process a start tag
+ *
+ * \param textbuilder  The textbuilder instance
+ * \param tag          The start tag
+ */
+void textbuilder_start_tag(hubbub_textbuilder *textbuilder,
+		const hubbub_tag *tag)
+{
+	hubbub_tokeniser_optparams params;
+	int i = textbuilder_element(&tag->name);
+	uint32_t flags = (i >= 0) ? name_flags_map[i].flags : 0;
+
+	if (textbuilder->foreign > 0) {
+		/* Foreign content is all markup; only track nesting, and
+		 * hide the content of script, style and title */
+		if (tag->self_closing)
+			return;
+
+		if (flags & TB_FOREIGN)
+			textbuilder->foreign++;
+		else if (flags & TB_HIDDEN_RAW)
+			textbuilder->raw_hidden = true;
+
+		return;
+	}
+
+	if ((flags & TB_HEAD) == 0)
+		textbuilder->in_body = true;
+
+	if (flags & TB_BLOCK)
+		textbuilder->need_break = true;
+
+	if (flags & TB_STRIP_LF)
+		textbuilder->strip_lf = true;
+
+	if (flags & TB_FOREIGN) {
+		if (tag->self_closing == false) {
+			textbuilder->foreign++;
+
+			params.process_cdata = true;
+			hubbub_tokeniser_setopt(textbuilder->tokeniser,
+					HUBBUB_TOKENISER_PROCESS_CDATA, &params);
+		}
+		return;
+	}
+
+	if ((flags & TB_NOSCRIPT) && textbuilder->scripting) {
+		textbuilder->raw_hidden = true;
+
+		params.content_model.model = HUBBUB_CONTENT_MODEL_CDATA;
+		hubbub_tokeniser_setopt(textbuilder->tokeniser,
+				HUBBUB_TOKENISER_CONTENT_MODEL, &params);
+		return;
+	}
+
+	if (flags & (TB_HIDDEN | TB_NOSCRIPT))
+		textbuilder->hidden++;
+
+	if (flags & TB_HIDDEN_RAW)
+		textbuilder->raw_hidden = true;
+
+	if (i >= 0 && name_flags_map[i].model != HUBBUB_CONTENT_MODEL_PCDATA) {
+		params.content_model.model = name_flags_map[i].model;
+		hubbub_tokeniser_setopt(textbuilder->tokeniser,
+				HUBBUB_TOKENISER_CONTENT_MODEL, &params);
+	}
+}
+
+/**
+ * Process an end tag
+ *
+ * \param textbuilder  The textbuilder instance
+ * \param tag          The end tag
+ */
+void textbuilder_end_tag(hubbub_textbuilder *textbuilder,
+		const hubbub_tag *tag)
+{
+	hubbub_tokeniser_optparams params;
+	int i = textbuilder_element(&tag->name);
+	uint32_t flags = (i >= 0) ? name_flags_map[i].flags : 0;
+
+	/* Raw text elements end at the first end tag seen */
+	textbuilder->raw_hidden = false;
+
+	if (textbuilder->foreign > 0) {
+		if ((flags & TB_FOREIGN) && --textbuilder->foreign == 0) {
+			params.process_cdata = false;
+			hubbub_tokeniser_setopt(textbuilder->tokeniser,
+					HUBBUB_TOKENISER_PROCESS_CDATA, &params);
+		}
+		return;
+	}
+
+	if (flags & TB_BLOCK)
+		textbuilder->need_break = true;
+
+	if ((flags & TB_HIDDEN) ||
+			((flags & TB_NOSCRIPT) && !textbuilder->scripting)) {
+		if (textbuilder->hidden > 0)
+			textbuilder->hidden--;
+	}
+}
+
+/**
+ * Process a run of characters
+ *
+ * \param textbuilder  The textbuilder instance
+ * \param chars        The characters
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error textbuilder_characters(hubbub_textbuilder *textbuilder,
+		const hubbub_string *chars)
+{
+	static const hubbub_string lf = { (const uint8_t *) "\n", 1 };
+	hubbub_string text = *chars;
+	hubbub_error error;
+	size_t ws;
+
+	if (textbuilder->raw_hidden || textbuilder->hidden > 0)
+		return HUBBUB_OK;
+
+	for (ws = 0; ws < text.len; ws++) {
+		uint8_t c = text.ptr[ws];
+
+		if (c != '\t' && c != '\n' && c != '\f' && c != '\r' &&
+				c != ' ')
+			break;
+	}
+
+	if (textbuilder->in_body == false) {
+		/* Whitespace before the body is never rendered */
+		text.ptr += ws;
+		text.len -= ws;
+
+		if (text.len == 0)
+			return HUBBUB_OK;
+
+		textbuilder->in_body = true;
+	} else if (ws == text.len && textbuilder->need_break) {
+		/* Nor is whitespace between blocks */
+		return HUBBUB_OK;
+	}
+
+	if (text.len == 0 || textbuilder->text_handler == NULL)
+		return HUBBUB_OK;
+
+	/* Separate blocks, but don't lead or trail with a break */
+	if (textbuilder->need_break && textbuilder->had_text) {
+		error = textbuilder->text_handler(&lf, textbuilder->text_pw);
+		if (error != HUBBUB_OK)
+			return error;
+	}
+
+	textbuilder->need_break = false;
+	textbuilder->had_text = true;
+
+	return textbuilder->text_handler(&text, textbuilder->text_pw);
+}
+
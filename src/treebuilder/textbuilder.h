@@ -0,0 +1,59 @@
+/*
+ * This file is part of Hubbub.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ */
+
+#ifndef hubbub_treebuilder_textbuilder_h_
+#define hubbub_treebuilder_textbuilder_h_
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include <hubbub/errors.h>
+#include <hubbub/functypes.h>
+#include <hubbub/types.h>
+
+#include "tokeniser/tokeniser.h"
+
+typedef struct hubbub_textbuilder hubbub_textbuilder;
+
+/**
+ * Hubbub textbuilder option types
+ */
+typedef enum hubbub_textbuilder_opttype {
+	HUBBUB_TEXTBUILDER_TEXT_HANDLER,
+	HUBBUB_TEXTBUILDER_ENABLE_SCRIPTING
+} hubbub_textbuilder_opttype;
+
+/**
+ * Hubbub textbuilder option parameters
+ */
+typedef union hubbub_textbuilder_optparams {
+	struct {
+		hubbub_text_handler handler;
+		void *pw;
+	} text_handler;			/**< Text handling callback */
+
+	bool enable_scripting;		/**< Enable scripting */
+} hubbub_textbuilder_optparams;
+
+/* Create a hubbub textbuilder */
+hubbub_error hubbub_textbuilder_create(hubbub_tokeniser *tokeniser,
+		hubbub_allocator_fn alloc, void *pw,
+		hubbub_textbuilder **textbuilder);
+
+/* Destroy a hubbub textbuilder */
+hubbub_error hubbub_textbuilder_destroy(hubbub_textbuilder *textbuilder);
+
+/* Clone a hubbub textbuilder */
+hubbub_error hubbub_textbuilder_clone(hubbub_textbuilder *textbuilder,
+		hubbub_tokeniser *tokeniser, hubbub_textbuilder **clone);
+
+/* Set an option in the textbuilder */
+hubbub_error hubbub_textbuilder_setopt(hubbub_textbuilder *textbuilder,
+		hubbub_textbuilder_opttype type,
+		hubbub_textbuilder_optparams *params);
+
+#endif
+
@@ -79,7 +79,140 @@ static const struct {
 	{ S("foreignobject"), FOREIGNOBJECT },
 };
 
-static bool is_form_associated(element_type type);
+const uint8_t element_properties[UNKNOWN + 1] = {
+	[ADDRESS]	= ELEMENT_SPECIAL,
+	[AREA]		= ELEMENT_SPECIAL,
+	[ARTICLE]	= ELEMENT_SPECIAL,
+	[ASIDE]		= ELEMENT_SPECIAL,
+	[BASE]		= ELEMENT_SPECIAL,
+	[BASEFONT]	= ELEMENT_SPECIAL,
+	[BGSOUND]	= ELEMENT_SPECIAL,
+	[BLOCKQUOTE]	= ELEMENT_SPECIAL,
+	[BODY]		= ELEMENT_SPECIAL | ELEMENT_MODE_ANCHOR,
+	[BR]		= ELEMENT_SPECIAL,
+	[CENTER]	= ELEMENT_SPECIAL,
+	[COL]		= ELEMENT_SPECIAL,
+	[COLGROUP]	= ELEMENT_SPECIAL,
+	[COMMAND]	= ELEMENT_SPECIAL,
+	[DATAGRID]	= ELEMENT_SPECIAL,
+	[DD]		= ELEMENT_SPECIAL | ELEMENT_IMPLIED_END,
+	[DETAILS]	= ELEMENT_SPECIAL,
+	[DIALOG]	= ELEMENT_SPECIAL,
+	[DIR]		= ELEMENT_SPECIAL,
+	[DIV]		= ELEMENT_SPECIAL,
+	[DL]		= ELEMENT_SPECIAL,
+	[DT]		= ELEMENT_SPECIAL | ELEMENT_IMPLIED_END,
+	[EMBED]		= ELEMENT_SPECIAL,
+	[FIELDSET]	= ELEMENT_SPECIAL | ELEMENT_FORM_ASSOCIATED,
+	[FIGURE]	= ELEMENT_SPECIAL,
+	[FOOTER]	= ELEMENT_SPECIAL,
+	[FORM]		= ELEMENT_SPECIAL,
+	[FRAME]		= ELEMENT_SPECIAL,
+	[FRAMESET]	= ELEMENT_SPECIAL,
+	[H1]		= ELEMENT_SPECIAL,
+	[H2]		= ELEMENT_SPECIAL,
+	[H3]		= ELEMENT_SPECIAL,
+	[H4]		= ELEMENT_SPECIAL,
+	[H5]		= ELEMENT_SPECIAL,
+	[H6]		= ELEMENT_SPECIAL,
+	[HEAD]		= ELEMENT_SPECIAL,
+	[HEADER]	= ELEMENT_SPECIAL,
+	[HR]		= ELEMENT_SPECIAL,
+	[IFRAME]	= ELEMENT_SPECIAL,
+	[IMAGE]		= ELEMENT_SPECIAL,
+	[IMG]		= ELEMENT_SPECIAL,
+	[INPUT]		= ELEMENT_SPECIAL | ELEMENT_FORM_ASSOCIATED,
+	[ISINDEX]	= ELEMENT_SPECIAL,
+	[LI]		= ELEMENT_SPECIAL | ELEMENT_IMPLIED_END,
+	[LINK]		= ELEMENT_SPECIAL,
+	[LISTING]	= ELEMENT_SPECIAL,
+	[MENU]		= ELEMENT_SPECIAL,
+	[META]		= ELEMENT_SPECIAL,
+	[NAV]		= ELEMENT_SPECIAL,
+	[NOEMBED]	= ELEMENT_SPECIAL,
+	[NOFRAMES]	= ELEMENT_SPECIAL,
+	[NOSCRIPT]	= ELEMENT_SPECIAL,
+	[OL]		= ELEMENT_SPECIAL,
+	[OPTGROUP]	= ELEMENT_SPECIAL | ELEMENT_IMPLIED_END,
+	[OPTION]	= ELEMENT_SPECIAL | ELEMENT_IMPLIED_END,
+	[P]		= ELEMENT_SPECIAL | ELEMENT_IMPLIED_END,
+	[PARAM]		= ELEMENT_SPECIAL,
+	[PLAINTEXT]	= ELEMENT_SPECIAL,
+	[PRE]		= ELEMENT_SPECIAL,
+	[SCRIPT]	= ELEMENT_SPECIAL,
+	[SECTION]	= ELEMENT_SPECIAL,
+	[SELECT]	= ELEMENT_SPECIAL | ELEMENT_FORM_ASSOCIATED,
+	[SPACER]	= ELEMENT_SPECIAL,
+	[STYLE]		= ELEMENT_SPECIAL,
+	[TBODY]		= ELEMENT_SPECIAL | ELEMENT_MODE_ANCHOR,
+	[TEXTAREA]	= ELEMENT_SPECIAL | ELEMENT_FORM_ASSOCIATED,
+	[TFOOT]		= ELEMENT_SPECIAL | ELEMENT_MODE_ANCHOR,
+	[THEAD]		= ELEMENT_SPECIAL | ELEMENT_MODE_ANCHOR,
+	[TITLE]		= ELEMENT_SPECIAL,
+	[TR]		= ELEMENT_SPECIAL | ELEMENT_MODE_ANCHOR,
+	[UL]		= ELEMENT_SPECIAL,
+	[WBR]		= ELEMENT_SPECIAL,
+	[APPLET]	= ELEMENT_SCOPING,
+	[BUTTON]	= ELEMENT_SCOPING | ELEMENT_FORM_ASSOCIATED,
+	[CAPTION]	= ELEMENT_SCOPING | ELEMENT_MODE_ANCHOR,
+	[HTML]		= ELEMENT_SCOPING | ELEMENT_TABLE_SCOPING,
+	[MARQUEE]	= ELEMENT_SCOPING,
+	[OBJECT]	= ELEMENT_SCOPING,
+	[TABLE]		= ELEMENT_SCOPING | ELEMENT_TABLE_SCOPING |
+			  ELEMENT_MODE_ANCHOR,
+	[TD]		= ELEMENT_SCOPING | ELEMENT_MODE_ANCHOR,
+	[TH]		= ELEMENT_SCOPING | ELEMENT_MODE_ANCHOR,
+	[A]		= ELEMENT_FORMATTING,
+	[B]		= ELEMENT_FORMATTING,
+	[BIG]		= ELEMENT_FORMATTING,
+	[CODE]		= ELEMENT_FORMATTING,
+	[EM]		= ELEMENT_FORMATTING,
+	[FONT]		= ELEMENT_FORMATTING,
+	[I]		= ELEMENT_FORMATTING,
+	[NOBR]		= ELEMENT_FORMATTING,
+	[S]		= ELEMENT_FORMATTING,
+	[SMALL]		= ELEMENT_FORMATTING,
+	[STRIKE]	= ELEMENT_FORMATTING,
+	[STRONG]	= ELEMENT_FORMATTING,
+	[TT]		= ELEMENT_FORMATTING,
+	[U]		= ELEMENT_FORMATTING,
+	[LABEL]		= ELEMENT_PHRASING | ELEMENT_FORM_ASSOCIATED,
+	[OUTPUT]	= ELEMENT_PHRASING | ELEMENT_FORM_ASSOCIATED,
+	[RP]		= ELEMENT_PHRASING | ELEMENT_IMPLIED_END,
+	[RT]		= ELEMENT_PHRASING | ELEMENT_IMPLIED_END,
+	[RUBY]		= ELEMENT_PHRASING,
+	[SPAN]		= ELEMENT_PHRASING,
+	[SUB]		= ELEMENT_PHRASING,
+	[SUP]		= ELEMENT_PHRASING,
+	[VAR]		= ELEMENT_PHRASING,
+	[XMP]		= ELEMENT_PHRASING,
+	[MATH]		= ELEMENT_PHRASING,
+	[MGLYPH]	= ELEMENT_PHRASING,
+	[MALIGNMARK]	= ELEMENT_PHRASING,
+	[MI]		= ELEMENT_PHRASING,
+	[MO]		= ELEMENT_PHRASING,
+	[MN]		= ELEMENT_PHRASING,
+	[MS]		= ELEMENT_PHRASING,
+	[MTEXT]		= ELEMENT_PHRASING,
+	[ANNOTATION_XML]	= ELEMENT_PHRASING,
+	[SVG]		= ELEMENT_PHRASING,
+	[FOREIGNOBJECT]	= ELEMENT_PHRASING,
+	[DESC]		= ELEMENT_PHRASING,
+	[UNKNOWN]	= ELEMENT_PHRASING,
+};
+
+static inline bool is_form_associated(element_type type);
+static inline bool is_mode_anchor(hubbub_ns ns, element_type type);
+static void note_block_boundary(hubbub_treebuilder *treebuilder,
+		hubbub_ns ns, element_type type);
+
+static void fragment_content_model(hubbub_treebuilder *treebuilder);
+static hubbub_error fragment_setup(hubbub_treebuilder *treebuilder);
+
+static hubbub_error element_stack_resize(hubbub_treebuilder_context *ctx,
+		uint32_t size, hubbub_allocator_fn alloc, void *pw);
+static void element_stack_free(hubbub_treebuilder_context *ctx,
+		hubbub_allocator_fn alloc, void *pw);
 
 /**
  * Create a hubbub treebuilder
@@ -114,18 +247,19 @@ hubbub_error hubbub_treebuilder_create(hubbub_tokeniser *tokeniser,
 	memset(&tb->context, 0, sizeof(hubbub_treebuilder_context));
 	tb->context.mode = INITIAL;
 
-	tb->context.element_stack = alloc(NULL,
-			ELEMENT_STACK_CHUNK * sizeof(element_context),
-			pw);
-	if (tb->context.element_stack == NULL) {
+	error = element_stack_resize(&tb->context, ELEMENT_STACK_INITIAL,
+			alloc, pw);
+	if (error != HUBBUB_OK) {
+		element_stack_free(&tb->context, alloc, pw);
 		alloc(tb, 0, pw);
-		return HUBBUB_NOMEM;
+		return error;
 	}
-	tb->context.stack_alloc = ELEMENT_STACK_CHUNK;
 	/* We rely on HTML not being equal to zero to determine
 	 * if the first item in the stack is in use. Assert this here. */
 	assert(HTML != 0);
-	tb->context.element_stack[0].type = (element_type) 0;
+	/* Element types and namespaces must fit in an element_kind */
+	assert(UNKNOWN <= UINT8_MAX && HUBBUB_NS_XMLNS <= UINT8_MAX);
+	tb->context.stack_kind[0].type = 0;
 
 	tb->context.strip_leading_lr = false;
 	tb->context.frameset_ok = true;
@@ -133,6 +267,9 @@ hubbub_error hubbub_treebuilder_create(hubbub_tokeniser *tokeniser,
 	tb->error_handler = NULL;
 	tb->error_pw = NULL;
 
+	tb->charset_handler = NULL;
+	tb->charset_pw = NULL;
+
 	tb->alloc = alloc;
 	tb->alloc_pw = pw;
 
@@ -142,7 +279,7 @@ hubbub_error hubbub_treebuilder_create(hubbub_tokeniser *tokeniser,
 	error = hubbub_tokeniser_setopt(tokeniser,
 			HUBBUB_TOKENISER_TOKEN_HANDLER, &tokparams);
 	if (error != HUBBUB_OK) {
-		alloc(tb->context.element_stack, 0, pw);
+		element_stack_free(&tb->context, alloc, pw);
 		alloc(tb, 0, pw);
 		return error;
 	}
@@ -198,17 +335,21 @@ hubbub_error hubbub_treebuilder_destroy(hubbub_treebuilder *treebuilder)
 				n > 0; n--) {
 			treebuilder->tree_handler->unref_node(
 				treebuilder->tree_handler->ctx,
-				treebuilder->context.element_stack[n].node);
+				treebuilder->context.stack_node[n]);
 		}
-		if (treebuilder->context.element_stack[0].type == HTML) {
+		if (treebuilder->context.stack_kind[0].type == HTML) {
 			treebuilder->tree_handler->unref_node(
 				treebuilder->tree_handler->ctx,
-				treebuilder->context.element_stack[0].node);
+				treebuilder->context.stack_node[0]);
 		}
 	}
-	treebuilder->alloc(treebuilder->context.element_stack, 0,
+	element_stack_free(&treebuilder->context, treebuilder->alloc,
 			treebuilder->alloc_pw);
-	treebuilder->context.element_stack = NULL;
+
+	if (treebuilder->context.pending_table_text.buf != NULL) {
+		treebuilder->alloc(treebuilder->context.pending_table_text.buf,
+				0, treebuilder->alloc_pw);
+	}
 
 	for (entry = treebuilder->context.formatting_list; entry != NULL;
 			entry = next) {
@@ -228,6 +369,188 @@ hubbub_error hubbub_treebuilder_destroy(hubbub_treebuilder *treebuilder)
 	return HUBBUB_OK;
 }
 
+/**
+ * Clone a hubbub treebuilder
+ *
+ * The clone shares the original's handlers, but refers to nodes in
+ * another tree: each node the original holds a reference to is passed
+ * to ::handler, which supplies its counterpart.
+ *
+ * \param treebuilder  The treebuilder instance to clone
+ * \param tokeniser    Tokeniser instance for the clone
+ * \param handler      Node mapping function
+ * \param pw           Pointer to client data for ::handler
+ * \param clone        Pointer to location to receive clone
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_BADPARM on bad parameters,
+ *         HUBBUB_NOMEM on memory exhaustion,
+ *         appropriate error from ::handler otherwise
+ */
+hubbub_error hubbub_treebuilder_clone(hubbub_treebuilder *treebuilder,
+		hubbub_tokeniser *tokeniser, hubbub_clone_handler handler,
+		void *pw, hubbub_treebuilder **clone)
+{
+	hubbub_error error = HUBBUB_OK;
+	hubbub_treebuilder_context *ctx;
+	hubbub_tokeniser_optparams tokparams;
+	formatting_list_entry *entry;
+	hubbub_treebuilder *tb;
+	uint32_t n;
+
+	if (treebuilder == NULL || tokeniser == NULL || handler == NULL ||
+			clone == NULL)
+		return HUBBUB_BADPARM;
+
+	tb = treebuilder->alloc(NULL, sizeof(hubbub_treebuilder),
+			treebuilder->alloc_pw);
+	if (tb == NULL)
+		return HUBBUB_NOMEM;
+
+	*tb = *treebuilder;
+
+	tb->tokeniser = tokeniser;
+
+	/* Empty the clone's context, so that it can be destroyed safely
+	 * at any point. It's repopulated as nodes are mapped. */
+	ctx = &tb->context;
+
+	ctx->stack_kind = NULL;
+	ctx->stack_node = NULL;
+	ctx->stack_links = NULL;
+	ctx->stack_alloc = 0;
+
+	error = element_stack_resize(ctx,
+			treebuilder->context.stack_alloc,
+			tb->alloc, tb->alloc_pw);
+	if (error != HUBBUB_OK) {
+		element_stack_free(ctx, tb->alloc, tb->alloc_pw);
+		tb->alloc(tb, 0, tb->alloc_pw);
+		return error;
+	}
+	ctx->stack_kind[0].type = 0;
+	ctx->current_node = 0;
+	ctx->current_table = 0;
+	ctx->current_anchor = 0;
+
+	ctx->pending_table_text.buf = NULL;
+	ctx->pending_table_text.len = 0;
+	ctx->pending_table_text.alloc = 0;
+
+	ctx->formatting_list = NULL;
+	ctx->formatting_list_end = NULL;
+	ctx->head_element = NULL;
+	ctx->form_element = NULL;
+	ctx->document = NULL;
+
+	/* Stack of open elements */
+	for (n = 0; n <= treebuilder->context.current_node; n++) {
+		element_kind kind = treebuilder->context.stack_kind[n];
+
+		if (n == 0 && kind.type != HTML)
+			break;
+
+		ctx->stack_kind[n] = kind;
+		ctx->stack_links[n] = treebuilder->context.stack_links[n];
+
+		error = handler(treebuilder->context.stack_node[n], pw,
+				&ctx->stack_node[n]);
+		if (error != HUBBUB_OK) {
+			if (n == 0)
+				ctx->stack_kind[0].type = 0;
+			break;
+		}
+
+		ctx->current_node = n;
+		if (kind.type == TABLE)
+			ctx->current_table = n;
+		if (n > 0 && is_mode_anchor(kind.ns, kind.type))
+			ctx->current_anchor = n;
+	}
+
+	/* List of active formatting elements */
+	for (entry = treebuilder->context.formatting_list;
+			entry != NULL && error == HUBBUB_OK;
+			entry = entry->next) {
+		formatting_list_entry *e;
+
+		e = tb->alloc(NULL, sizeof(formatting_list_entry),
+				tb->alloc_pw);
+		if (e == NULL) {
+			error = HUBBUB_NOMEM;
+			break;
+		}
+
+		*e = *entry;
+
+		error = handler(entry->details.node, pw, &e->details.node);
+		if (error != HUBBUB_OK) {
+			tb->alloc(e, 0, tb->alloc_pw);
+			break;
+		}
+
+		e->prev = ctx->formatting_list_end;
+		e->next = NULL;
+
+		if (ctx->formatting_list_end == NULL)
+			ctx->formatting_list = e;
+		else
+			ctx->formatting_list_end->next = e;
+
+		ctx->formatting_list_end = e;
+	}
+
+	if (error == HUBBUB_OK && treebuilder->context.head_element != NULL) {
+		error = handler(treebuilder->context.head_element, pw,
+				&ctx->head_element);
+	}
+
+	if (error == HUBBUB_OK && treebuilder->context.form_element != NULL) {
+		error = handler(treebuilder->context.form_element, pw,
+				&ctx->form_element);
+	}
+
+	if (error == HUBBUB_OK && treebuilder->context.document != NULL) {
+		error = handler(treebuilder->context.document, pw,
+				&ctx->document);
+	}
+
+	if (error == HUBBUB_OK &&
+			treebuilder->context.pending_table_text.len > 0) {
+		size_t len = treebuilder->context.pending_table_text.len;
+
+		ctx->pending_table_text.buf = tb->alloc(NULL, len,
+				tb->alloc_pw);
+		if (ctx->pending_table_text.buf == NULL) {
+			error = HUBBUB_NOMEM;
+		} else {
+			memcpy(ctx->pending_table_text.buf,
+				treebuilder->context.pending_table_text.buf,
+				len);
+			ctx->pending_table_text.len = len;
+			ctx->pending_table_text.alloc = len;
+		}
+	}
+
+	if (error != HUBBUB_OK) {
+		hubbub_treebuilder_destroy(tb);
+		return error;
+	}
+
+	tokparams.token_handler.handler = hubbub_treebuilder_token_handler;
+	tokparams.token_handler.pw = tb;
+
+	error = hubbub_tokeniser_setopt(tokeniser,
+			HUBBUB_TOKENISER_TOKEN_HANDLER, &tokparams);
+	if (error != HUBBUB_OK) {
+		hubbub_treebuilder_destroy(tb);
+		return error;
+	}
+
+	*clone = tb;
+
+	return HUBBUB_OK;
+}
+
 /**
  * Configure a hubbub treebuilder
  *
@@ -257,6 +580,77 @@ hubbub_error hubbub_treebuilder_setopt(hubbub_treebuilder *treebuilder,
 	case HUBBUB_TREEBUILDER_ENABLE_SCRIPTING:
 		treebuilder->context.enable_scripting =
 				params->enable_scripting;
+		/* The content model of a noscript context depends on this */
+		if (treebuilder->context.fragment &&
+				treebuilder->context.stack_kind[0].type == 0)
+			fragment_content_model(treebuilder);
+		break;
+	case HUBBUB_TREEBUILDER_IGNORE_WHITESPACE:
+		treebuilder->context.ignore_whitespace =
+				params->ignore_whitespace;
+		break;
+	case HUBBUB_TREEBUILDER_CHARSET_HANDLER:
+		treebuilder->charset_handler = params->charset_handler.handler;
+		treebuilder->charset_pw = params->charset_handler.pw;
+		break;
+	case HUBBUB_TREEBUILDER_FRAGMENT_CONTEXT:
+	{
+		hubbub_string name;
+
+		if (params->fragment_context.name == NULL)
+			return HUBBUB_BADPARM;
+
+		/* Too late once the tree has been started */
+		if (treebuilder->context.stack_kind[0].type != 0)
+			return HUBBUB_INVALID;
+
+		name.ptr = (const uint8_t *) params->fragment_context.name;
+		name.len = strlen(params->fragment_context.name);
+
+		treebuilder->context.fragment = true;
+		treebuilder->context.fragment_ns = params->fragment_context.ns;
+		treebuilder->context.fragment_type =
+				element_type_from_name(treebuilder, &name);
+
+		fragment_content_model(treebuilder);
+	}
+		break;
+	case HUBBUB_TREEBUILDER_STOP:
+		switch (params->stop.condition) {
+		case HUBBUB_STOP_NEVER:
+			break;
+		case HUBBUB_STOP_AFTER_HEAD:
+			treebuilder->context.stop_type = HEAD;
+			break;
+		case HUBBUB_STOP_AFTER_ELEMENT:
+		{
+			hubbub_string name;
+
+			if (params->stop.name == NULL)
+				return HUBBUB_BADPARM;
+
+			name.ptr = (const uint8_t *) params->stop.name;
+			name.len = strlen(params->stop.name);
+
+			/* We can only tell known elements apart */
+			treebuilder->context.stop_type =
+					element_type_from_name(treebuilder,
+							&name);
+			if (treebuilder->context.stop_type == UNKNOWN)
+				return HUBBUB_BADPARM;
+		}
+			break;
+		case HUBBUB_STOP_AFTER_START_TAGS:
+			if (params->stop.count == 0)
+				return HUBBUB_BADPARM;
+
+			treebuilder->context.stop_count = params->stop.count;
+			break;
+		default:
+			return HUBBUB_BADPARM;
+		}
+
+		treebuilder->context.stop = params->stop.condition;
 		break;
 	}
 
@@ -280,8 +674,33 @@ hubbub_error hubbub_treebuilder_token_handler(const hubbub_token *token,
 			treebuilder->tree_handler == NULL)
 		return HUBBUB_OK;
 
+	/* Nor once we've been told to stop */
+	if (treebuilder->context.stopped)
+		return HUBBUB_STOPPED;
+
 	assert((signed) treebuilder->context.current_node >= 0);
 
+	/* Anything other than more characters ends a run of table text */
+	if (treebuilder->context.pending_table_text.len > 0 &&
+			token->type != HUBBUB_TOKEN_CHARACTER) {
+		err = flush_pending_table_text(treebuilder);
+		if (err != HUBBUB_OK)
+			return err;
+
+		err = HUBBUB_REPROCESS;
+	}
+
+	/* Fragments skip the initial modes, starting with a bare html
+	 * element on the stack and the mode the context element implies */
+	if (treebuilder->context.fragment &&
+			treebuilder->context.stack_kind[0].type == 0) {
+		err = fragment_setup(treebuilder);
+		if (err != HUBBUB_OK)
+			return err;
+
+		err = HUBBUB_REPROCESS;
+	}
+
 /* A slightly nasty debugging hook, but very useful */
 #ifdef NDEBUG
 # define mode(x) \
@@ -292,7 +711,10 @@ hubbub_error hubbub_treebuilder_token_handler(const hubbub_token *token,
 			printf( #x "\n");
 #endif
 
-	while (err == HUBBUB_REPROCESS) {
+	/* Once stopped, a token which closed the element we were to stop
+	 * after, by implication, goes no further */
+	while (err == HUBBUB_REPROCESS &&
+			treebuilder->context.stopped == false) {
 		switch (treebuilder->context.mode) {
 		mode(INITIAL)
 			err = handle_initial(treebuilder, token);
@@ -363,6 +785,15 @@ hubbub_error hubbub_treebuilder_token_handler(const hubbub_token *token,
 		}
 	}
 
+	if (treebuilder->context.stop == HUBBUB_STOP_AFTER_START_TAGS &&
+			token->type == HUBBUB_TOKEN_START_TAG &&
+			--treebuilder->context.stop_count == 0)
+		treebuilder->context.stopped = true;
+
+	if ((err == HUBBUB_OK || err == HUBBUB_REPROCESS) &&
+			treebuilder->context.stopped)
+		err = HUBBUB_STOPPED;
+
 	return err;
 }
 
@@ -393,7 +824,11 @@ hubbub_error process_characters_expect_whitespace(
 			break;
 	}
 
-	if (c > 0 && insert_into_current_node) {
+	/* None of the callers' contexts render whitespace, unless a table
+	 * finds itself in preformatted text */
+	if (c > 0 && insert_into_current_node &&
+			(treebuilder->context.ignore_whitespace == false ||
+			in_preformatted(treebuilder))) {
 		hubbub_error error;
 		hubbub_string temp;
 
@@ -507,40 +942,63 @@ hubbub_error parse_generic_rcdata(hubbub_treebuilder *treebuilder,
 uint32_t element_in_scope(hubbub_treebuilder *treebuilder,
 		element_type type, bool in_table)
 {
+	uint8_t scope = in_table ? ELEMENT_TABLE_SCOPING : ELEMENT_SCOPING;
 	uint32_t node;
 
-	if (treebuilder->context.element_stack == NULL)
+	if (treebuilder->context.stack_kind == NULL)
 		return 0;
 
 	assert((signed) treebuilder->context.current_node >= 0);
 
 	for (node = treebuilder->context.current_node; node > 0; node--) {
 		hubbub_ns node_ns =
-				treebuilder->context.element_stack[node].ns;
+				treebuilder->context.stack_kind[node].ns;
 		element_type node_type =
-				treebuilder->context.element_stack[node].type;
+				treebuilder->context.stack_kind[node].type;
 
 		if (node_type == type)
 			return node;
 
-		if (node_type == TABLE)
+		/* HTML should only occur as the first node in the stack,
+		 * which is never processed in this loop. */
+		if (element_properties[node_type] & scope)
 			break;
 
-		/* The list of element types given in the spec here are the
-		 * scoping elements excluding TABLE and HTML. TABLE is handled
-		 * in the previous conditional and HTML should only occur
-		 * as the first node in the stack, which is never processed
-		 * in this loop. */
-		if (!in_table && (is_scoping_element(node_type) ||
-				(node_type == FOREIGNOBJECT &&
-						node_ns == HUBBUB_NS_SVG))) {
+		/* foreignObject is scoping, but only in the SVG namespace */
+		if (!in_table && node_type == FOREIGNOBJECT &&
+				node_ns == HUBBUB_NS_SVG)
 			break;
-		}
 	}
 
 	return 0;
 }
 
+/**
+ * Determine if text at the current node is preformatted
+ *
+ * \param treebuilder  The treebuilder instance
+ * \return True iff the current node or one of its ancestors keeps its
+ *         whitespace as written
+ */
+bool in_preformatted(hubbub_treebuilder *treebuilder)
+{
+	uint32_t node;
+
+	for (node = treebuilder->context.current_node; node > 0; node--) {
+		if (treebuilder->context.stack_kind[node].ns != HUBBUB_NS_HTML)
+			continue;
+
+		switch (treebuilder->context.stack_kind[node].type) {
+		case LISTING: case PLAINTEXT: case PRE: case TEXTAREA:
+			return true;
+		default:
+			break;
+		}
+	}
+
+	return false;
+}
+
 /**
  * Reconstruct the list of active formatting elements
  *
@@ -601,8 +1059,8 @@ hubbub_error reconstruct_active_formatting_list(hubbub_treebuilder *treebuilder)
 		} else {
 			error = treebuilder->tree_handler->append_child(
 					treebuilder->tree_handler->ctx,
-					treebuilder->context.element_stack[
-					treebuilder->context.current_node].node,
+					treebuilder->context.stack_node[
+					treebuilder->context.current_node],
 					clone,
 					&appended);
 		}
@@ -638,7 +1096,7 @@ hubbub_error reconstruct_active_formatting_list(hubbub_treebuilder *treebuilder)
 		void *prev_node;
 		uint32_t prev_stack_index;
 
-		node = treebuilder->context.element_stack[++sp].node;
+		node = treebuilder->context.stack_node[++sp];
 
 		treebuilder->tree_handler->ref_node(
 				treebuilder->tree_handler->ctx, node);
@@ -776,8 +1234,8 @@ hubbub_error insert_element(hubbub_treebuilder *treebuilder,
 	} else {
 		error = treebuilder->tree_handler->append_child(
 				treebuilder->tree_handler->ctx,
-				treebuilder->context.element_stack[
-					treebuilder->context.current_node].node,
+				treebuilder->context.stack_node[
+					treebuilder->context.current_node],
 				node, &appended);
 	}
 
@@ -807,6 +1265,8 @@ hubbub_error insert_element(hubbub_treebuilder *treebuilder,
 		}
 	}
 
+	note_block_boundary(treebuilder, tag->ns, type);
+
 	if (push) {
 		error = element_stack_push(treebuilder,
 				tag->ns, type, appended);
@@ -838,12 +1298,10 @@ void close_implied_end_tags(hubbub_treebuilder *treebuilder,
 {
 	element_type type;
 
-	type = treebuilder->context.element_stack[
+	type = treebuilder->context.stack_kind[
 			treebuilder->context.current_node].type;
 
-	while (type == DD || type == DT || type == LI || type == OPTION ||
-			type == OPTGROUP || type == P || type == RP ||
-			type == RT) {
+	while (element_properties[type] & ELEMENT_IMPLIED_END) {
 		hubbub_ns ns;
 		element_type otype;
 		void *node;
@@ -857,11 +1315,29 @@ void close_implied_end_tags(hubbub_treebuilder *treebuilder,
 				treebuilder->tree_handler->ctx,
 				node);
 
-		type = treebuilder->context.element_stack[
+		type = treebuilder->context.stack_kind[
 				treebuilder->context.current_node].type;
 	}
 }
 
+/**
+ * Determine if an element decides the insertion mode on reset
+ *
+ * When resetting the insertion mode, the stack of open elements is
+ * searched from the top for one of these (the root element aside). The
+ * topmost such element is tracked as elements are pushed and popped, so
+ * no search is needed.
+ *
+ * \param ns    Namespace of element
+ * \param type  Type of element
+ * \return True iff the element is an anchor for the insertion mode
+ */
+static inline bool is_mode_anchor(hubbub_ns ns, element_type type)
+{
+	return ns != HUBBUB_NS_HTML ||
+			(element_properties[type] & ELEMENT_MODE_ANCHOR) != 0;
+}
+
 /**
  * Reset the insertion mode
  *
@@ -869,59 +1345,189 @@ void close_implied_end_tags(hubbub_treebuilder *treebuilder,
  */
 void reset_insertion_mode(hubbub_treebuilder *treebuilder)
 {
-	uint32_t node;
-	element_context *stack = treebuilder->context.element_stack;
-
-	/** \todo fragment parsing algorithm */
+	element_kind *kind = treebuilder->context.stack_kind;
+	uint32_t node = treebuilder->context.current_anchor;
+	hubbub_ns ns;
+	element_type type;
 
-	for (node = treebuilder->context.current_node; node > 0; node--) {
-		if (stack[node].ns != HUBBUB_NS_HTML) {
+	if (node != 0) {
+		if (kind[node].ns != HUBBUB_NS_HTML) {
 			treebuilder->context.mode = IN_FOREIGN_CONTENT;
 			treebuilder->context.second_mode = IN_BODY;
-			break;
+			return;
 		}
 
-		switch (stack[node].type) {
-		case SELECT:
-			/* fragment case */
-			break;
+		switch (kind[node].type) {
 		case TD:
 		case TH:
 			treebuilder->context.mode = IN_CELL;
-			return;
+			break;
 		case TR:
 			treebuilder->context.mode = IN_ROW;
-			return;
+			break;
 		case TBODY:
 		case TFOOT:
 		case THEAD:
 			treebuilder->context.mode = IN_TABLE_BODY;
-			return;
+			break;
 		case CAPTION:
 			treebuilder->context.mode = IN_CAPTION;
-			return;
-		case COLGROUP:
-			/* fragment case */
 			break;
 		case TABLE:
 			treebuilder->context.mode = IN_TABLE;
-			return;
-		case HEAD:
-			/* fragment case */
 			break;
 		case BODY:
 			treebuilder->context.mode = IN_BODY;
-			return;
-		case FRAMESET:
-			/* fragment case */
 			break;
-		case HTML:
-			/* fragment case */
+		default:
+			assert(0 && "Unexpected insertion mode anchor");
+			break;
+		}
+
+		return;
+	}
+
+	/* Reached the root element */
+	if (treebuilder->context.fragment == false)
+		return;
+
+	/* fragment case: use the context element */
+	ns = treebuilder->context.fragment_ns;
+	type = treebuilder->context.fragment_type;
+
+	if (ns != HUBBUB_NS_HTML) {
+		treebuilder->context.mode = IN_FOREIGN_CONTENT;
+		treebuilder->context.second_mode = IN_BODY;
+		return;
+	}
+
+	switch (type) {
+	case SELECT:
+		treebuilder->context.mode = IN_SELECT;
+		break;
+	case TR:
+		treebuilder->context.mode = IN_ROW;
+		break;
+	case TBODY:
+	case TFOOT:
+	case THEAD:
+		treebuilder->context.mode = IN_TABLE_BODY;
+		break;
+	case CAPTION:
+		treebuilder->context.mode = IN_CAPTION;
+		break;
+	case COLGROUP:
+		treebuilder->context.mode = IN_COLUMN_GROUP;
+		break;
+	case TABLE:
+		treebuilder->context.mode = IN_TABLE;
+		break;
+	case FRAMESET:
+		treebuilder->context.mode = IN_FRAMESET;
+		break;
+	case HTML:
+		treebuilder->context.mode = BEFORE_HEAD;
+		break;
+	default:
+		treebuilder->context.mode = IN_BODY;
+		break;
+	}
+}
+
+/**
+ * Set the tokeniser content model for the fragment context element
+ *
+ * \param treebuilder  The treebuilder instance
+ */
+void fragment_content_model(hubbub_treebuilder *treebuilder)
+{
+	hubbub_tokeniser_optparams params;
+
+	params.content_model.model = HUBBUB_CONTENT_MODEL_PCDATA;
+
+	if (treebuilder->context.fragment_ns == HUBBUB_NS_HTML) {
+		switch (treebuilder->context.fragment_type) {
+		case TITLE:
+		case TEXTAREA:
+			params.content_model.model =
+					HUBBUB_CONTENT_MODEL_RCDATA;
+			break;
+		case STYLE:
+		case SCRIPT:
+		case XMP:
+		case IFRAME:
+		case NOEMBED:
+		case NOFRAMES:
+			params.content_model.model =
+					HUBBUB_CONTENT_MODEL_CDATA;
+			break;
+		case NOSCRIPT:
+			if (treebuilder->context.enable_scripting)
+				params.content_model.model =
+						HUBBUB_CONTENT_MODEL_CDATA;
+			break;
+		case PLAINTEXT:
+			params.content_model.model =
+					HUBBUB_CONTENT_MODEL_PLAINTEXT;
 			break;
 		default:
 			break;
 		}
 	}
+
+	hubbub_tokeniser_setopt(treebuilder->tokeniser,
+			HUBBUB_TOKENISER_CONTENT_MODEL, &params);
+}
+
+/**
+ * Prepare to parse a fragment: create the root html element, which
+ * stands in for the context element, and select the insertion mode
+ *
+ * \param treebuilder  The treebuilder instance
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error fragment_setup(hubbub_treebuilder *treebuilder)
+{
+	hubbub_error e;
+	hubbub_tag tag;
+	void *html, *appended;
+
+	tag.ns = HUBBUB_NS_HTML;
+	tag.name.ptr = (const uint8_t *) "html";
+	tag.name.len = SLEN("html");
+
+	tag.n_attributes = 0;
+	tag.attributes = NULL;
+
+	e = treebuilder->tree_handler->create_element(
+			treebuilder->tree_handler->ctx, &tag, &html);
+	if (e != HUBBUB_OK)
+		return e;
+
+	e = treebuilder->tree_handler->append_child(
+			treebuilder->tree_handler->ctx,
+			treebuilder->context.document,
+			html, &appended);
+
+	treebuilder->tree_handler->unref_node(
+			treebuilder->tree_handler->ctx, html);
+
+	if (e != HUBBUB_OK)
+		return e;
+
+	treebuilder->context.stack_kind[0].ns = HUBBUB_NS_HTML;
+	treebuilder->context.stack_kind[0].type = HTML;
+	treebuilder->context.stack_node[0] = appended;
+	treebuilder->context.current_node = 0;
+	treebuilder->context.current_table = 0;
+	treebuilder->context.current_anchor = 0;
+
+	/* The form element pointer is left unset: we have no knowledge
+	 * of the context element's ancestors */
+
+	reset_insertion_mode(treebuilder);
+
+	return HUBBUB_OK;
 }
 
 /**
@@ -935,8 +1541,8 @@ hubbub_error complete_script(hubbub_treebuilder *treebuilder)
 	hubbub_error error = HUBBUB_OK;
 	error = treebuilder->tree_handler->complete_script(
 		treebuilder->tree_handler->ctx,
-		treebuilder->context.element_stack[
-			treebuilder->context.current_node].node);
+		treebuilder->context.stack_node[
+			treebuilder->context.current_node]);
 	return error;
 }
 
@@ -960,6 +1566,8 @@ hubbub_error append_text(hubbub_treebuilder *treebuilder,
 	if (error != HUBBUB_OK)
 		return error;
 
+	treebuilder->context.after_block = false;
+
 	if (treebuilder->context.in_table_foster &&
 			(type == TABLE || type == TBODY || type == TFOOT ||
 			type == THEAD || type == TR)) {
@@ -968,8 +1576,8 @@ hubbub_error append_text(hubbub_treebuilder *treebuilder,
 	} else {
 		error = treebuilder->tree_handler->append_child(
 				treebuilder->tree_handler->ctx,
-				treebuilder->context.element_stack[
-					treebuilder->context.current_node].node,
+				treebuilder->context.stack_node[
+					treebuilder->context.current_node],
 						text, &appended);
 	}
 
@@ -1015,60 +1623,118 @@ element_type element_type_from_name(hubbub_treebuilder *treebuilder,
 }
 
 /**
- * Determine if a node is a special element
+ * Determine if a node is form associated
  *
  * \param type  Node type to consider
- * \return True iff node is a special element
+ * \return True iff node is form associated
  */
-bool is_special_element(element_type type)
+static inline bool is_form_associated(element_type type)
 {
-	return (type <= WBR);
+	return (element_properties[type] & ELEMENT_FORM_ASSOCIATED) != 0;
 }
 
 /**
- * Determine if a node is a scoping element
+ * Track whether an element's start or end leaves a block boundary behind
  *
- * \param type  Node type to consider
- * \return True iff node is a scoping element
- */
-bool is_scoping_element(element_type type)
-{
-	return (type >= APPLET && type <= TH);
-}
-
-/**
- * Determine if a node is a formatting element
+ * Whitespace that follows a block boundary starts a line, so is never
+ * rendered. Elements that are not rendered at all leave things as they are.
  *
- * \param type  Node type to consider
- * \return True iff node is a formatting element
+ * \param treebuilder  The treebuilder instance
+ * \param ns           Namespace of the element
+ * \param type         Type of the element
  */
-bool is_formatting_element(element_type type)
+void note_block_boundary(hubbub_treebuilder *treebuilder,
+		hubbub_ns ns, element_type type)
 {
-	return (type >= A && type <= U);
+	bool block;
+
+	if (treebuilder->context.ignore_whitespace == false)
+		return;
+
+	switch (type) {
+	case BASE: case BASEFONT: case BGSOUND: case LINK: case META:
+	case NOEMBED: case NOFRAMES: case NOSCRIPT: case PARAM:
+	case SCRIPT: case STYLE: case TITLE:
+		return;
+	case ADDRESS: case ARTICLE: case ASIDE: case BLOCKQUOTE: case BODY:
+	case BR: case CAPTION: case CENTER: case COLGROUP: case DD:
+	case DETAILS: case DIALOG: case DIR: case DIV: case DL: case DT:
+	case FIELDSET: case FIGURE: case FOOTER: case FORM: case FRAMESET:
+	case H1: case H2: case H3: case H4: case H5: case H6: case HEAD:
+	case HEADER: case HR: case HTML: case LI: case LISTING: case MENU:
+	case NAV: case OL: case P: case PLAINTEXT: case PRE: case SECTION:
+	case TABLE: case TBODY: case TD: case TFOOT: case TH: case THEAD:
+	case TR: case UL:
+		block = (ns == HUBBUB_NS_HTML);
+		break;
+	default:
+		block = false;
+		break;
+	}
+
+	treebuilder->context.after_block = block;
 }
 
 /**
- * Determine if a node is a phrasing element
+ * Resize the stack of open elements
  *
- * \param type  Node type to consider
- * \return True iff node is a phrasing element
+ * \param ctx    The treebuilder context containing the stack
+ * \param size   The number of entries to allocate
+ * \param alloc  Memory (de)allocation function
+ * \param pw     Pointer to client-specific private data
+ * \return HUBBUB_OK on success, HUBBUB_NOMEM on memory exhaustion
+ *
+ * On failure, the stack keeps its old size, though some of its arrays
+ * may already have been enlarged.
  */
-bool is_phrasing_element(element_type type)
+hubbub_error element_stack_resize(hubbub_treebuilder_context *ctx,
+		uint32_t size, hubbub_allocator_fn alloc, void *pw)
 {
-	return (type > U);
+	element_kind *kind;
+	void **node;
+	element_links *links;
+
+	kind = alloc(ctx->stack_kind, size * sizeof(element_kind), pw);
+	if (kind == NULL)
+		return HUBBUB_NOMEM;
+	ctx->stack_kind = kind;
+
+	node = alloc(ctx->stack_node, size * sizeof(void *), pw);
+	if (node == NULL)
+		return HUBBUB_NOMEM;
+	ctx->stack_node = node;
+
+	links = alloc(ctx->stack_links, size * sizeof(element_links), pw);
+	if (links == NULL)
+		return HUBBUB_NOMEM;
+	ctx->stack_links = links;
+
+	ctx->stack_alloc = size;
+
+	return HUBBUB_OK;
 }
 
 /**
- * Determine if a node is form associated
+ * Free the stack of open elements
  *
- * \param type  Node type to consider
- * \return True iff node is form associated
+ * \param ctx    The treebuilder context containing the stack
+ * \param alloc  Memory (de)allocation function
+ * \param pw     Pointer to client-specific private data
  */
-bool is_form_associated(element_type type)
+void element_stack_free(hubbub_treebuilder_context *ctx,
+		hubbub_allocator_fn alloc, void *pw)
 {
-	return type == FIELDSET || type == LABEL || type == INPUT ||
-			type == BUTTON || type == SELECT || type == TEXTAREA ||
-			type == OUTPUT;
+	if (ctx->stack_kind != NULL)
+		alloc(ctx->stack_kind, 0, pw);
+	if (ctx->stack_node != NULL)
+		alloc(ctx->stack_node, 0, pw);
+	if (ctx->stack_links != NULL)
+		alloc(ctx->stack_links, 0, pw);
+
+	ctx->stack_kind = NULL;
+	ctx->stack_node = NULL;
+	ctx->stack_links = NULL;
+	ctx->stack_alloc = 0;
 }
 
 /**
@@ -1086,23 +1752,29 @@ hubbub_error element_stack_push(hubbub_treebuilder *treebuilder,
 	uint32_t slot = treebuilder->context.current_node + 1;
 
 	if (slot >= treebuilder->context.stack_alloc) {
-		element_context *temp = treebuilder->alloc(
-				treebuilder->context.element_stack,
-				(treebuilder->context.stack_alloc +
-					ELEMENT_STACK_CHUNK) *
-					sizeof(element_context),
-				treebuilder->alloc_pw);
-
-		if (temp == NULL)
-			return HUBBUB_NOMEM;
-
-		treebuilder->context.element_stack = temp;
-		treebuilder->context.stack_alloc += ELEMENT_STACK_CHUNK;
+		hubbub_error error = element_stack_resize(
+				&treebuilder->context,
+				treebuilder->context.stack_alloc * 2,
+				treebuilder->alloc, treebuilder->alloc_pw);
+		if (error != HUBBUB_OK)
+			return error;
 	}
 
-	treebuilder->context.element_stack[slot].ns = ns;
-	treebuilder->context.element_stack[slot].type = type;
-	treebuilder->context.element_stack[slot].node = node;
+	treebuilder->context.stack_kind[slot].ns = ns;
+	treebuilder->context.stack_kind[slot].type = type;
+	treebuilder->context.stack_node[slot] = node;
+
+	if (type == TABLE) {
+		treebuilder->context.stack_links[slot].prev_table =
+				treebuilder->context.current_table;
+		treebuilder->context.current_table = slot;
+	}
+
+	if (is_mode_anchor(ns, type)) {
+		treebuilder->context.stack_links[slot].prev_anchor =
+				treebuilder->context.current_anchor;
+		treebuilder->context.current_anchor = slot;
+	}
 
 	treebuilder->context.current_node = slot;
 
@@ -1121,23 +1793,25 @@ hubbub_error element_stack_push(hubbub_treebuilder *treebuilder,
 hubbub_error element_stack_pop(hubbub_treebuilder *treebuilder,
 		hubbub_ns *ns, element_type *type, void **node)
 {
-	element_context *stack = treebuilder->context.element_stack;
+	element_kind *kind = treebuilder->context.stack_kind;
+	void **nodes = treebuilder->context.stack_node;
+	element_links *links = treebuilder->context.stack_links;
 	uint32_t slot = treebuilder->context.current_node;
 	formatting_list_entry *entry;
 
-	/* We're popping a table, find previous */
-	if (stack[slot].type == TABLE) {
-		uint32_t t;
-		for (t = slot - 1; t > 0; t--) {
-			if (stack[t].type == TABLE)
-				break;
-		}
+	/* We're popping a table, so the previous one becomes current */
+	if (kind[slot].type == TABLE) {
+		assert(treebuilder->context.current_table == slot);
+		treebuilder->context.current_table = links[slot].prev_table;
 	}
 
-	if (is_formatting_element(stack[slot].type) ||
-			(is_scoping_element(stack[slot].type) &&
-			stack[slot].type != HTML &&
-			stack[slot].type != TABLE)) {
+	if (treebuilder->context.current_anchor == slot)
+		treebuilder->context.current_anchor = links[slot].prev_anchor;
+
+	if (is_formatting_element(kind[slot].type) ||
+			(is_scoping_element(kind[slot].type) &&
+			kind[slot].type != HTML &&
+			kind[slot].type != TABLE)) {
 		/* Find occurrences of the node we're about to pop in the list
 		 * of active formatting elements. We need to invalidate their
 		 * stack index information. */
@@ -1150,9 +1824,18 @@ hubbub_error element_stack_pop(hubbub_treebuilder *treebuilder,
 		}
 	}
 
-	*ns = stack[slot].ns;
-	*type = stack[slot].type;
-	*node = stack[slot].node;
+	*ns = kind[slot].ns;
+	*type = kind[slot].type;
+	*node = nodes[slot];
+
+	note_block_boundary(treebuilder, *ns, *type);
+
+	if ((treebuilder->context.stop == HUBBUB_STOP_AFTER_HEAD ||
+			treebuilder->context.stop ==
+					HUBBUB_STOP_AFTER_ELEMENT) &&
+			treebuilder->context.stop_type == *type &&
+			*ns == HUBBUB_NS_HTML)
+		treebuilder->context.stopped = true;
 
 	/** \todo reduce allocated stack size once there's enough free */
 
@@ -1200,7 +1883,8 @@ hubbub_error element_stack_remove(hubbub_treebuilder *treebuilder,
 		uint32_t index, hubbub_ns *ns, element_type *type,
 		void **removed)
 {
-	element_context *stack = treebuilder->context.element_stack;
+	element_kind *kind = treebuilder->context.stack_kind;
+	void **nodes = treebuilder->context.stack_node;
 	uint32_t n;
 
 	assert(index <= treebuilder->context.current_node);
@@ -1211,10 +1895,10 @@ hubbub_error element_stack_remove(hubbub_treebuilder *treebuilder,
 	 * formatting list entry's stack index to match the
 	 * new stack location */
 	for (n = index + 1; n <= treebuilder->context.current_node; n++) {
-		if (is_formatting_element(stack[n].type) ||
-				(is_scoping_element(stack[n].type) &&
-				stack[n].type != HTML &&
-				stack[n].type != TABLE)) {
+		if (is_formatting_element(kind[n].type) ||
+				(is_scoping_element(kind[n].type) &&
+				kind[n].type != HTML &&
+				kind[n].type != TABLE)) {
 			formatting_list_entry *e;
 
 			for (e = treebuilder->context.formatting_list_end;
@@ -1225,15 +1909,24 @@ hubbub_error element_stack_remove(hubbub_treebuilder *treebuilder,
 		}
 	}
 
-	*ns = stack[index].ns;
-	*type = stack[index].type;
-	*removed = stack[index].node;
+	*ns = kind[index].ns;
+	*type = kind[index].type;
+	*removed = nodes[index];
+
+	if ((treebuilder->context.stop == HUBBUB_STOP_AFTER_HEAD ||
+			treebuilder->context.stop ==
+					HUBBUB_STOP_AFTER_ELEMENT) &&
+			treebuilder->context.stop_type == *type &&
+			*ns == HUBBUB_NS_HTML)
+		treebuilder->context.stopped = true;
+
+	element_stack_unlink(treebuilder, index,
+			treebuilder->context.current_node);
 
 	/* Now, shuffle the stack up one, removing node in the process */
 	if (index < treebuilder->context.current_node) {
-		memmove(&stack[index], &stack[index + 1],
-				(treebuilder->context.current_node - index) *
-				sizeof(element_context));
+		element_stack_shift(treebuilder, index,
+				treebuilder->context.current_node);
 	}
 
 	treebuilder->context.current_node--;
@@ -1242,20 +1935,77 @@ hubbub_error element_stack_remove(hubbub_treebuilder *treebuilder,
 }
 
 /**
- * Find the stack index of the current table.
+ * Update the chains of tables and insertion mode anchors before an entry
+ * is removed from the stack of open elements
+ *
+ * \param treebuilder  The treebuilder instance
+ * \param index        The index of the entry being removed
+ * \param limit        The index of the last entry to be moved down one
+ *
+ * Entries above ::limit keep their indices.
  */
-uint32_t current_table(hubbub_treebuilder *treebuilder)
+void element_stack_unlink(hubbub_treebuilder *treebuilder,
+		uint32_t index, uint32_t limit)
 {
-	element_context *stack = treebuilder->context.element_stack;
-	size_t t;
+	element_links *links = treebuilder->context.stack_links;
+	uint32_t *link;
 
-	for (t = treebuilder->context.current_node; t != 0; t--) {
-		if (stack[t].type == TABLE)
-			return t;
+	link = &treebuilder->context.current_table;
+	while (*link > limit)
+		link = &links[*link].prev_table;
+	while (*link > index) {
+		uint32_t *next = &links[*link].prev_table;
+
+		(*link)--;
+		link = next;
 	}
+	if (*link == index && index != 0)
+		*link = links[index].prev_table;
 
-	/* fragment case */
-	return 0;
+	link = &treebuilder->context.current_anchor;
+	while (*link > limit)
+		link = &links[*link].prev_anchor;
+	while (*link > index) {
+		uint32_t *next = &links[*link].prev_anchor;
+
+		(*link)--;
+		link = next;
+	}
+	if (*link == index && index != 0)
+		*link = links[index].prev_anchor;
+}
+
+/**
+ * Move entries of the stack of open elements down one, overwriting an entry
+ *
+ * \param treebuilder  The treebuilder instance
+ * \param index        The index of the entry to overwrite
+ * \param limit        The index of the last entry to move
+ *
+ * The chains of tables and anchors must already have been updated
+ * by element_stack_unlink().
+ */
+void element_stack_shift(hubbub_treebuilder *treebuilder,
+		uint32_t index, uint32_t limit)
+{
+	hubbub_treebuilder_context *ctx = &treebuilder->context;
+	uint32_t count = limit - index;
+
+	memmove(&ctx->stack_kind[index], &ctx->stack_kind[index + 1],
+			count * sizeof(element_kind));
+	memmove(&ctx->stack_node[index], &ctx->stack_node[index + 1],
+			count * sizeof(void *));
+	memmove(&ctx->stack_links[index], &ctx->stack_links[index + 1],
+			count * sizeof(element_links));
+}
+
+/**
+ * Find the stack index of the current table.
+ */
+uint32_t current_table(hubbub_treebuilder *treebuilder)
+{
+	/* This is 0 in the fragment case */
+	return treebuilder->context.current_table;
 }
 
 /**
@@ -1266,7 +2016,7 @@ uint32_t current_table(hubbub_treebuilder *treebuilder)
  */
 element_type current_node(hubbub_treebuilder *treebuilder)
 {
-	return treebuilder->context.element_stack
+	return treebuilder->context.stack_kind
 			[treebuilder->context.current_node].type;
 }
 
@@ -1281,7 +2031,7 @@ element_type prev_node(hubbub_treebuilder *treebuilder)
 	if (treebuilder->context.current_node == 0)
 		return UNKNOWN;
 
-	return treebuilder->context.element_stack
+	return treebuilder->context.stack_kind
 			[treebuilder->context.current_node - 1].type;
 }
 
@@ -1465,14 +2215,15 @@ hubbub_error formatting_list_replace(hubbub_treebuilder *treebuilder,
  */
 void element_stack_dump(hubbub_treebuilder *treebuilder, FILE *fp)
 {
-	element_context *stack = treebuilder->context.element_stack;
+	element_kind *kind = treebuilder->context.stack_kind;
+	void **nodes = treebuilder->context.stack_node;
 	uint32_t i;
 
 	for (i = 0; i <= treebuilder->context.current_node; i++) {
 		fprintf(fp, "%u: %s %p\n",
 				i,
-				element_type_to_name(stack[i].type),
-				stack[i].node);
+				element_type_to_name(kind[i].type),
+				nodes[i]);
 	}
 }
 
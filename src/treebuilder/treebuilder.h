@@ -20,6 +20,18 @@
 
 typedef struct hubbub_treebuilder hubbub_treebuilder;
 
+/**
+ * Type of function called to switch the document charset in place
+ *
+ * \param charset  Name of the new charset
+ * \param pw       Client data
+ * \return HUBBUB_OK if the charset was changed,
+ *         HUBBUB_INVALID if the document must be reprocessed instead,
+ *         appropriate error otherwise
+ */
+typedef hubbub_error (*hubbub_treebuilder_charset_handler)(
+		const char *charset, void *pw);
+
 /**
  * Hubbub treebuilder option types
  */
@@ -27,7 +39,11 @@ typedef enum hubbub_treebuilder_opttype {
 	HUBBUB_TREEBUILDER_ERROR_HANDLER,
 	HUBBUB_TREEBUILDER_TREE_HANDLER,
 	HUBBUB_TREEBUILDER_DOCUMENT_NODE,
-	HUBBUB_TREEBUILDER_ENABLE_SCRIPTING
+	HUBBUB_TREEBUILDER_ENABLE_SCRIPTING,
+	HUBBUB_TREEBUILDER_CHARSET_HANDLER,
+	HUBBUB_TREEBUILDER_FRAGMENT_CONTEXT,
+	HUBBUB_TREEBUILDER_STOP,
+	HUBBUB_TREEBUILDER_IGNORE_WHITESPACE
 } hubbub_treebuilder_opttype;
 
 /**
@@ -44,6 +60,25 @@ typedef union hubbub_treebuilder_optparams {
 	void *document_node;			/**< The document node */
 
 	bool enable_scripting;			/**< Enable scripting */
+
+	struct {
+		hubbub_treebuilder_charset_handler handler;
+		void *pw;
+	} charset_handler;			/**< Charset switching callback */
+
+	struct {
+		hubbub_ns ns;
+		const char *name;
+	} fragment_context;			/**< Fragment context element */
+
+	struct {
+		hubbub_stop_condition condition;
+		const char *name;
+		uint32_t count;
+	} stop;					/**< Early stop condition */
+
+	bool ignore_whitespace;			/**< Drop unrendered
+						 * whitespace */
 } hubbub_treebuilder_optparams;
 
 /* Create a hubbub treebuilder */
@@ -54,6 +89,11 @@ hubbub_error hubbub_treebuilder_create(hubbub_tokeniser *tokeniser,
 /* Destroy a hubbub treebuilder */
 hubbub_error hubbub_treebuilder_destroy(hubbub_treebuilder *treebuilder);
 
+/* Clone a hubbub treebuilder */
+hubbub_error hubbub_treebuilder_clone(hubbub_treebuilder *treebuilder,
+		hubbub_tokeniser *tokeniser, hubbub_clone_handler handler,
+		void *pw, hubbub_treebuilder **clone);
+
 /* Configure a hubbub treebuilder */
 hubbub_error hubbub_treebuilder_setopt(hubbub_treebuilder *treebuilder,
 		hubbub_treebuilder_opttype type,
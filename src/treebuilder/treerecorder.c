@@ -0,0 +1,1131 @@
+/*
+ * This file is part of Hubbub.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include <hubbub/errors.h>
+#include <hubbub/tree.h>
+
+#include "tokeniser/recorder.h"
+#include "utils/utils.h"
+
+/*
+ * A tree recording (HUBBUB_RECORDING_TREE) is a sequence of operations.
+ * Each starts with a byte holding the operation in its low four bits and
+ * a flag above them, followed by the operands.
+ *
+ * Nodes are identified by handle: an index into the table of nodes given
+ * to the treebuilder, where handle 0 is the document.  Handles are
+ * recorded as varints.  An operation creating a node implicitly has the
+ * next handle as its result.  Other results are recorded; a result equal
+ * to the number of handles so far introduces a new handle.
+ *
+ *   OP_CREATE		a DOCTYPE, START_TAG, COMMENT or CHARACTER token
+ *			describing the node to create
+ *   OP_REF, OP_UNREF	node
+ *   OP_APPEND		parent, child, result
+ *   OP_INSERT		parent, child, reference child, result
+ *   OP_REMOVE		parent, child; the result is the child
+ *   OP_CLONE		node; OP_FLAG is set for a deep clone
+ *   OP_REPARENT	node, new parent
+ *   OP_GET_PARENT	node, result; OP_FLAG is set if only an element
+ *			parent is wanted.  Not recorded if there's no parent
+ *   OP_FORM_ASSOCIATE	form, node
+ *   OP_ADD_ATTRIBUTES	node, attribute list
+ *   OP_QUIRKS_MODE	varint mode
+ *   OP_COMPLETE_SCRIPT	node
+ *
+ * A tree handler may merge a text node into an adjacent one when it is
+ * inserted, so the result of inserting a text node always has a handle
+ * of its own.
+ *
+ * The recorder builds no tree of its own beyond the links between nodes,
+ * which it needs to answer the treebuilder's questions.  has_children()
+ * has no effect, so isn't recorded.  Nor is encoding_change(), which is
+ * for the client alone.
+ */
+
+enum {
+	OP_CREATE,
+	OP_REF,
+	OP_UNREF,
+	OP_APPEND,
+	OP_INSERT,
+	OP_REMOVE,
+	OP_CLONE,
+	OP_REPARENT,
+	OP_GET_PARENT,
+	OP_FORM_ASSOCIATE,
+	OP_ADD_ATTRIBUTES,
+	OP_QUIRKS_MODE,
+	OP_COMPLETE_SCRIPT
+};
+
+#define OP_MASK			0x0f
+#define OP_FLAG			(1 << 4)
+
+/** No such node or handle */
+#define NONE			UINT32_MAX
+
+/** The node the treebuilder sees for a handle, and vice versa */
+#define HANDLE_NODE(h)		((void *) (uintptr_t) ((h) + 1))
+#define NODE_HANDLE(n)		((uint32_t) ((uintptr_t) (n) - 1))
+
+/**
+ * Type of a recorded node
+ */
+typedef enum recorder_node_type {
+	NODE_DOCUMENT,
+	NODE_ELEMENT,
+	NODE_TEXT,
+	NODE_OTHER
+} recorder_node_type;
+
+/**
+ * Recorded node
+ */
+typedef struct recorder_node {
+	uint32_t parent;		/**< Parent node, or NONE */
+	uint32_t first_child;		/**< First child node, or NONE */
+	uint32_t last_child;		/**< Last child node, or NONE */
+	uint32_t prev;			/**< Previous sibling node, or NONE */
+	uint32_t next;			/**< Next sibling node, or NONE */
+	uint32_t handle;		/**< First handle for node, or NONE */
+	recorder_node_type type;	/**< Type of node */
+} recorder_node;
+
+/**
+ * Tree recorder
+ */
+struct hubbub_tree_recorder {
+	hubbub_tree_handler handler;	/**< Tree handler for the parser */
+
+	hubbub_recorder *recording;	/**< Operations recorded */
+
+	recorder_node *nodes;		/**< Nodes, the document first */
+	uint32_t n_nodes;		/**< Number of nodes */
+	uint32_t nodes_alloc;		/**< Number of nodes allocated */
+
+	uint32_t *handles;		/**< Node for each handle */
+	uint32_t n_handles;		/**< Number of handles */
+	uint32_t handles_alloc;		/**< Number of handles allocated */
+
+	hubbub_tree_encoding_change encoding_change;	/**< Client's encoding
+							 * change handler */
+	void *ctx;			/**< Context for ::encoding_change */
+
+	hubbub_allocator_fn alloc;	/**< Memory (de)allocation function */
+	void *pw;			/**< Client data */
+};
+
+static hubbub_error recorder_create_comment(void *ctx,
+		const hubbub_string *data, void **result);
+static hubbub_error recorder_create_doctype(void *ctx,
+		const hubbub_doctype *doctype, void **result);
+static hubbub_error recorder_create_element(void *ctx,
+		const hubbub_tag *tag, void **result);
+static hubbub_error recorder_create_text(void *ctx,
+		const hubbub_string *data, void **result);
+static hubbub_error recorder_ref_node(void *ctx, void *node);
+static hubbub_error recorder_unref_node(void *ctx, void *node);
+static hubbub_error recorder_append_child(void *ctx, void *parent,
+		void *child, void **result);
+static hubbub_error recorder_insert_before(void *ctx, void *parent,
+		void *child, void *ref_child, void **result);
+static hubbub_error recorder_remove_child(void *ctx, void *parent,
+		void *child, void **result);
+static hubbub_error recorder_clone_node(void *ctx, void *node, bool deep,
+		void **result);
+static hubbub_error recorder_reparent_children(void *ctx, void *node,
+		void *new_parent);
+static hubbub_error recorder_get_parent(void *ctx, void *node,
+		bool element_only, void **result);
+static hubbub_error recorder_has_children(void *ctx, void *node,
+		bool *result);
+static hubbub_error recorder_form_associate(void *ctx, void *form,
+		void *node);
+static hubbub_error recorder_add_attributes(void *ctx, void *node,
+		const hubbub_attribute *attributes, uint32_t n_attributes);
+static hubbub_error recorder_set_quirks_mode(void *ctx,
+		hubbub_quirks_mode mode);
+static hubbub_error recorder_encoding_change(void *ctx,
+		const char *encname);
+static hubbub_error recorder_complete_script(void *ctx, void *script);
+
+static hubbub_error recorder_create(hubbub_tree_recorder *recorder,
+		const hubbub_token *token, recorder_node_type type,
+		void **result);
+static hubbub_error recorder_op(hubbub_tree_recorder *recorder, uint8_t op,
+		uint32_t n_handles, const uint32_t *handles);
+static hubbub_error recorder_new_node(hubbub_tree_recorder *recorder,
+		recorder_node_type type, uint32_t *node);
+static hubbub_error recorder_new_handle(hubbub_tree_recorder *recorder,
+		uint32_t node, uint32_t *handle);
+static hubbub_error recorder_insert(hubbub_tree_recorder *recorder,
+		uint8_t op, void *parent, void *child, void *ref_child,
+		void **result);
+static void recorder_link(hubbub_tree_recorder *recorder, uint32_t parent,
+		uint32_t node, uint32_t ref);
+static void recorder_unlink(hubbub_tree_recorder *recorder, uint32_t node);
+
+/**
+ * Create a tree recorder
+ *
+ * \param encoding_change  Client's encoding change handler, or NULL
+ * \param ctx              Context for ::encoding_change
+ * \param alloc            Memory (de)allocation function
+ * \param pw               Pointer to client-specific private data
+ * \param recorder         Pointer to location to receive recorder instance
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_BADPARM on bad parameters,
+ *         HUBBUB_NOMEM on memory exhaustion
+ *
+ * A change of encoding is not part of the tree, so isn't recorded; it's
+ * passed straight to ::encoding_change instead.
+ */
+hubbub_error hubbub_tree_recorder_create(
+		hubbub_tree_encoding_change encoding_change, void *ctx,
+		hubbub_allocator_fn alloc, void *pw,
+		hubbub_tree_recorder **recorder)
+{
+	hubbub_tree_recorder *rec;
+	hubbub_error error;
+	uint32_t document, handle;
+
+	if (alloc == NULL || recorder == NULL)
+		return HUBBUB_BADPARM;
+
+	rec = alloc(NULL, sizeof(hubbub_tree_recorder), pw);
+	if (rec == NULL)
+		return HUBBUB_NOMEM;
+
+	memset(rec, 0, sizeof(hubbub_tree_recorder));
+	rec->encoding_change = encoding_change;
+	rec->ctx = ctx;
+	rec->alloc = alloc;
+	rec->pw = pw;
+
+	error = hubbub_recorder_create(HUBBUB_RECORDING_TREE, alloc, pw,
+			&rec->recording);
+	if (error != HUBBUB_OK) {
+		alloc(rec, 0, pw);
+		return error;
+	}
+
+	/* The document is the first node, with the first handle */
+	error = recorder_new_node(rec, NODE_DOCUMENT, &document);
+	if (error == HUBBUB_OK)
+		error = recorder_new_handle(rec, document, &handle);
+	if (error != HUBBUB_OK) {
+		hubbub_tree_recorder_destroy(rec);
+		return error;
+	}
+
+	rec->handler.create_comment = recorder_create_comment;
+	rec->handler.create_doctype = recorder_create_doctype;
+	rec->handler.create_element = recorder_create_element;
+	rec->handler.create_text = recorder_create_text;
+	rec->handler.ref_node = recorder_ref_node;
+	rec->handler.unref_node = recorder_unref_node;
+	rec->handler.append_child = recorder_append_child;
+	rec->handler.insert_before = recorder_insert_before;
+	rec->handler.remove_child = recorder_remove_child;
+	rec->handler.clone_node = recorder_clone_node;
+	rec->handler.reparent_children = recorder_reparent_children;
+	rec->handler.get_parent = recorder_get_parent;
+	rec->handler.has_children = recorder_has_children;
+	rec->handler.form_associate = recorder_form_associate;
+	rec->handler.add_attributes = recorder_add_attributes;
+	rec->handler.set_quirks_mode = recorder_set_quirks_mode;
+	rec->handler.encoding_change = encoding_change != NULL ?
+			recorder_encoding_change : NULL;
+	rec->handler.complete_script = recorder_complete_script;
+	rec->handler.ctx = rec;
+
+	*recorder = rec;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Destroy a tree recorder
+ *
+ * \param recorder  The recorder instance to destroy
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error hubbub_tree_recorder_destroy(hubbub_tree_recorder *recorder)
+{
+	if (recorder == NULL)
+		return HUBBUB_BADPARM;
+
+	if (recorder->handles != NULL)
+		recorder->alloc(recorder->handles, 0, recorder->pw);
+	if (recorder->nodes != NULL)
+		recorder->alloc(recorder->nodes, 0, recorder->pw);
+
+	hubbub_recorder_destroy(recorder->recording);
+
+	recorder->alloc(recorder, 0, recorder->pw);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Retrieve the tree handler and document node to give to the parser
+ *
+ * \param recorder       The recorder instance
+ * \param handler        Pointer to location to receive tree handler
+ * \param document_node  Pointer to location to receive document node
+ * \return HUBBUB_OK on success, HUBBUB_BADPARM on bad parameters
+ *
+ * The handler is owned by the recorder.  It records the operations of a
+ * single parser, which must be given both it and the document node (see
+ * HUBBUB_PARSER_TREE_HANDLER and HUBBUB_PARSER_DOCUMENT_NODE).
+ */
+hubbub_error hubbub_tree_recorder_handler(hubbub_tree_recorder *recorder,
+		hubbub_tree_handler **handler, void **document_node)
+{
+	if (recorder == NULL || handler == NULL || document_node == NULL)
+		return HUBBUB_BADPARM;
+
+	*handler = &recorder->handler;
+	*document_node = HANDLE_NODE(0);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Read the operations recorded so far
+ *
+ * \param recorder  The recorder instance
+ * \param data      Pointer to location to receive recording
+ * \param len       Pointer to location to receive its length, in bytes
+ * \return HUBBUB_OK on success, HUBBUB_BADPARM on bad parameters,
+ *         appropriate error if a node could not be recorded
+ *
+ * The recording is owned by the recorder, and is valid until anything
+ * more is recorded, or the recorder is destroyed.  It is complete once
+ * the parser has been destroyed, as the parser's last act is to release
+ * the nodes it holds.
+ */
+hubbub_error hubbub_tree_recorder_read(const hubbub_tree_recorder *recorder,
+		const uint8_t **data, size_t *len)
+{
+	if (recorder == NULL || data == NULL || len == NULL)
+		return HUBBUB_BADPARM;
+
+	return hubbub_recorder_read(recorder->recording, data, len);
+}
+
+/*** Tree handler ***/
+
+hubbub_error recorder_create_comment(void *ctx, const hubbub_string *data,
+		void **result)
+{
+	hubbub_token token;
+
+	token.type = HUBBUB_TOKEN_COMMENT;
+	token.data.comment = *data;
+
+	return recorder_create(ctx, &token, NODE_OTHER, result);
+}
+
+hubbub_error recorder_create_doctype(void *ctx, const hubbub_doctype *doctype,
+		void **result)
+{
+	hubbub_token token;
+
+	token.type = HUBBUB_TOKEN_DOCTYPE;
+	token.data.doctype = *doctype;
+
+	return recorder_create(ctx, &token, NODE_OTHER, result);
+}
+
+hubbub_error recorder_create_element(void *ctx, const hubbub_tag *tag,
+		void **result)
+{
+	hubbub_token token;
+
+	token.type = HUBBUB_TOKEN_START_TAG;
+	token.data.tag = *tag;
+	/* Not part of the tree, and not always set by the treebuilder */
+	token.data.tag.self_closing = false;
+
+	return recorder_create(ctx, &token, NODE_ELEMENT, result);
+}
+
+hubbub_error recorder_create_text(void *ctx, const hubbub_string *data,
+		void **result)
+{
+	hubbub_token token;
+
+	token.type = HUBBUB_TOKEN_CHARACTER;
+	token.data.character = *data;
+
+	return recorder_create(ctx, &token, NODE_TEXT, result);
+}
+
+hubbub_error recorder_ref_node(void *ctx, void *node)
+{
+	uint32_t handle = NODE_HANDLE(node);
+
+	return recorder_op(ctx, OP_REF, 1, &handle);
+}
+
+hubbub_error recorder_unref_node(void *ctx, void *node)
+{
+	uint32_t handle = NODE_HANDLE(node);
+
+	return recorder_op(ctx, OP_UNREF, 1, &handle);
+}
+
+hubbub_error recorder_append_child(void *ctx, void *parent, void *child,
+		void **result)
+{
+	return recorder_insert(ctx, OP_APPEND, parent, child, NULL, result);
+}
+
+hubbub_error recorder_insert_before(void *ctx, void *parent, void *child,
+		void *ref_child, void **result)
+{
+	return recorder_insert(ctx, OP_INSERT, parent, child, ref_child,
+			result);
+}
+
+hubbub_error recorder_remove_child(void *ctx, void *parent, void *child,
+		void **result)
+{
+	hubbub_tree_recorder *recorder = ctx;
+	uint32_t handles[2];
+
+	handles[0] = NODE_HANDLE(parent);
+	handles[1] = NODE_HANDLE(child);
+
+	recorder_unlink(recorder, recorder->handles[handles[1]]);
+
+	*result = child;
+
+	return recorder_op(recorder, OP_REMOVE, 2, handles);
+}
+
+hubbub_error recorder_clone_node(void *ctx, void *node, bool deep,
+		void **result)
+{
+	hubbub_tree_recorder *recorder = ctx;
+	uint32_t handle = NODE_HANDLE(node);
+	uint32_t from = recorder->handles[handle];
+	uint32_t clone, to, copy;
+	hubbub_error error;
+
+	error = recorder_new_node(recorder, recorder->nodes[from].type,
+			&clone);
+	if (error != HUBBUB_OK)
+		return error;
+
+	/* Copy the subtree, walking it in document order */
+	to = clone;
+	while (deep) {
+		if (recorder->nodes[from].first_child != NONE) {
+			from = recorder->nodes[from].first_child;
+		} else {
+			while (recorder->nodes[from].next == NONE &&
+					to != clone) {
+				from = recorder->nodes[from].parent;
+				to = recorder->nodes[to].parent;
+			}
+
+			if (to == clone)
+				break;
+
+			from = recorder->nodes[from].next;
+			to = recorder->nodes[to].parent;
+		}
+
+		error = recorder_new_node(recorder,
+				recorder->nodes[from].type, &copy);
+		if (error != HUBBUB_OK)
+			return error;
+
+		recorder_link(recorder, to, copy, NONE);
+		to = copy;
+	}
+
+	error = recorder_op(recorder, OP_CLONE | (deep ? OP_FLAG : 0),
+			1, &handle);
+	if (error == HUBBUB_OK)
+		error = recorder_new_handle(recorder, clone, &handle);
+	if (error == HUBBUB_OK)
+		*result = HANDLE_NODE(handle);
+
+	return error;
+}
+
+hubbub_error recorder_reparent_children(void *ctx, void *node,
+		void *new_parent)
+{
+	hubbub_tree_recorder *recorder = ctx;
+	uint32_t handles[2];
+	uint32_t from, to;
+
+	handles[0] = NODE_HANDLE(node);
+	handles[1] = NODE_HANDLE(new_parent);
+
+	from = recorder->handles[handles[0]];
+	to = recorder->handles[handles[1]];
+
+	while (recorder->nodes[from].first_child != NONE) {
+		uint32_t child = recorder->nodes[from].first_child;
+
+		recorder_unlink(recorder, child);
+		recorder_link(recorder, to, child, NONE);
+	}
+
+	return recorder_op(recorder, OP_REPARENT, 2, handles);
+}
+
+hubbub_error recorder_get_parent(void *ctx, void *node, bool element_only,
+		void **result)
+{
+	hubbub_tree_recorder *recorder = ctx;
+	uint32_t handles[2];
+	uint32_t parent;
+	hubbub_error error;
+
+	handles[0] = NODE_HANDLE(node);
+	parent = recorder->nodes[recorder->handles[handles[0]]].parent;
+
+	if (parent == NONE || (element_only &&
+			recorder->nodes[parent].type != NODE_ELEMENT)) {
+		*result = NULL;
+		return HUBBUB_OK;
+	}
+
+	handles[1] = recorder->nodes[parent].handle;
+	if (handles[1] == NONE) {
+		error = recorder_new_handle(recorder, parent, &handles[1]);
+		if (error != HUBBUB_OK)
+			return error;
+	}
+
+	*result = HANDLE_NODE(handles[1]);
+
+	return recorder_op(recorder,
+			OP_GET_PARENT | (element_only ? OP_FLAG : 0),
+			2, handles);
+}
+
+hubbub_error recorder_has_children(void *ctx, void *node, bool *result)
+{
+	hubbub_tree_recorder *recorder = ctx;
+	uint32_t n = recorder->handles[NODE_HANDLE(node)];
+
+	*result = recorder->nodes[n].first_child != NONE;
+
+	return HUBBUB_OK;
+}
+
+hubbub_error recorder_form_associate(void *ctx, void *form, void *node)
+{
+	uint32_t handles[2];
+
+	handles[0] = NODE_HANDLE(form);
+	handles[1] = NODE_HANDLE(node);
+
+	return recorder_op(ctx, OP_FORM_ASSOCIATE, 2, handles);
+}
+
+hubbub_error recorder_add_attributes(void *ctx, void *node,
+		const hubbub_attribute *attributes, uint32_t n_attributes)
+{
+	hubbub_tree_recorder *recorder = ctx;
+	uint32_t handle = NODE_HANDLE(node);
+	hubbub_error error;
+
+	error = recorder_op(recorder, OP_ADD_ATTRIBUTES, 1, &handle);
+	if (error == HUBBUB_OK) {
+		error = hubbub_recorder_attributes(recorder->recording,
+				attributes, n_attributes);
+	}
+
+	return error;
+}
+
+hubbub_error recorder_set_quirks_mode(void *ctx, hubbub_quirks_mode mode)
+{
+	hubbub_tree_recorder *recorder = ctx;
+	hubbub_error error;
+
+	error = hubbub_recorder_byte(recorder->recording, OP_QUIRKS_MODE);
+	if (error == HUBBUB_OK)
+		error = hubbub_recorder_varint(recorder->recording, mode);
+
+	return error;
+}
+
+hubbub_error recorder_encoding_change(void *ctx, const char *encname)
+{
+	hubbub_tree_recorder *recorder = ctx;
+
+	return recorder->encoding_change(recorder->ctx, encname);
+}
+
+hubbub_error recorder_complete_script(void *ctx, void *script)
+{
+	uint32_t handle = NODE_HANDLE(script);
+
+	return recorder_op(ctx, OP_COMPLETE_SCRIPT, 1, &handle);
+}
+
+/*** Recording helpers ***/
+
+/**
+ * Create a node, and record its creation
+ *
+ * \param recorder  The recorder instance
+ * \param token     Token describing the node
+ * \param type      Type of node
+ * \param result    Pointer to location to receive node
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error recorder_create(hubbub_tree_recorder *recorder,
+		const hubbub_token *token, recorder_node_type type,
+		void **result)
+{
+	hubbub_error error;
+	uint32_t node, handle;
+
+	error = hubbub_recorder_byte(recorder->recording, OP_CREATE);
+	if (error == HUBBUB_OK)
+		error = hubbub_recorder_token(recorder->recording, token);
+	if (error == HUBBUB_OK)
+		error = recorder_new_node(recorder, type, &node);
+	if (error == HUBBUB_OK)
+		error = recorder_new_handle(recorder, node, &handle);
+	if (error == HUBBUB_OK)
+		*result = HANDLE_NODE(handle);
+
+	return error;
+}
+
+/**
+ * Record an operation whose operands are handles
+ *
+ * \param recorder   The recorder instance
+ * \param op         Operation, and flag
+ * \param n_handles  Number of handles
+ * \param handles    Handles
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error recorder_op(hubbub_tree_recorder *recorder, uint8_t op,
+		uint32_t n_handles, const uint32_t *handles)
+{
+	hubbub_error error;
+	uint32_t i;
+
+	error = hubbub_recorder_byte(recorder->recording, op);
+
+	for (i = 0; i < n_handles && error == HUBBUB_OK; i++) {
+		assert(handles[i] < recorder->n_handles);
+
+		error = hubbub_recorder_varint(recorder->recording,
+				handles[i]);
+	}
+
+	return error;
+}
+
+/**
+ * Create a detached node
+ *
+ * \param recorder  The recorder instance
+ * \param type      Type of node
+ * \param node      Pointer to location to receive node
+ * \return HUBBUB_OK on success, HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error recorder_new_node(hubbub_tree_recorder *recorder,
+		recorder_node_type type, uint32_t *node)
+{
+	recorder_node *n;
+
+	if (recorder->n_nodes == recorder->nodes_alloc) {
+		uint32_t alloc = recorder->nodes_alloc ?
+				recorder->nodes_alloc * 2 : 256;
+		recorder_node *nodes = recorder->alloc(recorder->nodes,
+				alloc * sizeof(recorder_node), recorder->pw);
+		if (nodes == NULL)
+			return HUBBUB_NOMEM;
+
+		recorder->nodes = nodes;
+		recorder->nodes_alloc = alloc;
+	}
+
+	n = &recorder->nodes[recorder->n_nodes];
+	n->parent = n->first_child = n->last_child = NONE;
+	n->prev = n->next = NONE;
+	n->handle = NONE;
+	n->type = type;
+
+	*node = recorder->n_nodes++;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Give a node a new handle
+ *
+ * \param recorder  The recorder instance
+ * \param node      The node
+ * \param handle    Pointer to location to receive handle
+ * \return HUBBUB_OK on success, HUBBUB_NOMEM on memory exhaustion
+ */
+hubbub_error recorder_new_handle(hubbub_tree_recorder *recorder,
+		uint32_t node, uint32_t *handle)
+{
+	if (recorder->n_handles == recorder->handles_alloc) {
+		uint32_t alloc = recorder->handles_alloc ?
+				recorder->handles_alloc * 2 : 256;
+		uint32_t *handles = recorder->alloc(recorder->handles,
+				alloc * sizeof(uint32_t), recorder->pw);
+		if (handles == NULL)
+			return HUBBUB_NOMEM;
+
+		recorder->handles = handles;
+		recorder->handles_alloc = alloc;
+	}
+
+	if (recorder->nodes[node].handle == NONE)
+		recorder->nodes[node].handle = recorder->n_handles;
+
+	recorder->handles[recorder->n_handles] = node;
+	*handle = recorder->n_handles++;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Insert a node into the tree, and record its insertion
+ *
+ * \param recorder   The recorder instance
+ * \param op         OP_APPEND or OP_INSERT
+ * \param parent     Parent node
+ * \param child      Node to insert
+ * \param ref_child  Node to insert before, for OP_INSERT
+ * \param result     Pointer to location to receive inserted node
+ * \return HUBBUB_OK on success, appropriate error otherwise
+ */
+hubbub_error recorder_insert(hubbub_tree_recorder *recorder,
+		uint8_t op, void *parent, void *child, void *ref_child,
+		void **result)
+{
+	uint32_t handles[4];
+	uint32_t n_handles = 0;
+	uint32_t node, ref = NONE;
+	hubbub_error error;
+
+	handles[n_handles++] = NODE_HANDLE(parent);
+	handles[n_handles++] = NODE_HANDLE(child);
+	if (op == OP_INSERT) {
+		handles[n_handles++] = NODE_HANDLE(ref_child);
+		ref = recorder->handles[NODE_HANDLE(ref_child)];
+	}
+
+	node = recorder->handles[NODE_HANDLE(child)];
+
+	recorder_unlink(recorder, node);
+	recorder_link(recorder, recorder->handles[NODE_HANDLE(parent)],
+			node, ref);
+
+	/* The tree handler may merge text with its neighbours */
+	if (recorder->nodes[node].type == NODE_TEXT) {
+		error = recorder_new_handle(recorder, node,
+				&handles[n_handles]);
+		if (error != HUBBUB_OK)
+			return error;
+	} else {
+		handles[n_handles] = NODE_HANDLE(child);
+	}
+
+	*result = HANDLE_NODE(handles[n_handles]);
+
+	return recorder_op(recorder, op, n_handles + 1, handles);
+}
+
+/**
+ * Insert a detached node into the tree
+ *
+ * \param recorder  The recorder instance
+ * \param parent    Parent node
+ * \param node      Node to insert
+ * \param ref       Node to insert before, or NONE to append
+ */
+void recorder_link(hubbub_tree_recorder *recorder, uint32_t parent,
+		uint32_t node, uint32_t ref)
+{
+	recorder_node *p = &recorder->nodes[parent];
+	recorder_node *n = &recorder->nodes[node];
+
+	n->parent = parent;
+	n->next = ref;
+
+	if (ref == NONE) {
+		n->prev = p->last_child;
+		p->last_child = node;
+	} else {
+		n->prev = recorder->nodes[ref].prev;
+		recorder->nodes[ref].prev = node;
+	}
+
+	if (n->prev == NONE)
+		p->first_child = node;
+	else
+		recorder->nodes[n->prev].next = node;
+}
+
+/**
+ * Detach a node from the tree, if it's attached
+ *
+ * \param recorder  The recorder instance
+ * \param node      Node to detach
+ */
+void recorder_unlink(hubbub_tree_recorder *recorder, uint32_t node)
+{
+	recorder_node *n = &recorder->nodes[node];
+	recorder_node *p;
+
+	if (n->parent == NONE)
+		return;
+
+	p = &recorder->nodes[n->parent];
+
+	if (n->prev == NONE)
+		p->first_child = n->next;
+	else
+		recorder->nodes[n->prev].next = n->next;
+
+	if (n->next == NONE)
+		p->last_child = n->prev;
+	else
+		recorder->nodes[n->next].prev = n->prev;
+
+	n->parent = n->prev = n->next = NONE;
+}
+
+/*** Replay ***/
+
+/**
+ * Replay state
+ */
+typedef struct tree_replay {
+	hubbub_replay replay;		/**< Reader of recording */
+
+	const hubbub_tree_target *targets;	/**< Tree handlers */
+	size_t n_targets;			/**< Number of tree handlers */
+
+	void **nodes;			/**< Each target's node for each
+					 * handle, by handle */
+	size_t n_handles;		/**< Number of handles */
+	size_t handles_alloc;		/**< Number of handles allocated */
+} tree_replay;
+
+/**
+ * Read a handle from a tree recording
+ *
+ * \param ctx     Replay state
+ * \param handle  Pointer to location to receive handle
+ * \return true on success, false if the recording is malformed
+ */
+static inline bool replay_handle(tree_replay *ctx, size_t *handle)
+{
+	return hubbub_replay_varint(&ctx->replay, handle) &&
+			*handle < ctx->n_handles;
+}
+
+/**
+ * Introduce a new handle
+ *
+ * \param ctx     Replay state
+ * \param handle  Pointer to location to receive handle
+ * \return HUBBUB_OK on success, HUBBUB_NOMEM on memory exhaustion
+ */
+static hubbub_error replay_new_handle(tree_replay *ctx, size_t *handle)
+{
+	if (ctx->n_handles == ctx->handles_alloc) {
+		size_t alloc = ctx->handles_alloc * 2;
+		void **nodes = ctx->replay.alloc(ctx->nodes,
+				alloc * ctx->n_targets * sizeof(void *),
+				ctx->replay.pw);
+		if (nodes == NULL)
+			return HUBBUB_NOMEM;
+
+		ctx->nodes = nodes;
+		ctx->handles_alloc = alloc;
+	}
+
+	*handle = ctx->n_handles++;
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Read the result of an operation from a tree recording
+ *
+ * \param ctx     Replay state
+ * \param handle  Pointer to location to receive handle
+ * \param fresh   Pointer to location to receive whether the result is a
+ *                new handle
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_INVALID if the recording is malformed,
+ *         HUBBUB_NOMEM on memory exhaustion
+ */
+static hubbub_error replay_result(tree_replay *ctx, size_t *handle,
+		bool *fresh)
+{
+	if (hubbub_replay_varint(&ctx->replay, handle) == false ||
+			*handle > ctx->n_handles)
+		return HUBBUB_INVALID;
+
+	*fresh = *handle == ctx->n_handles;
+	if (*fresh)
+		return replay_new_handle(ctx, handle);
+
+	return HUBBUB_OK;
+}
+
+/**
+ * Replay one operation from a tree recording
+ *
+ * \param ctx  Replay state
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_INVALID if the recording is malformed,
+ *         HUBBUB_NOMEM on memory exhaustion,
+ *         a tree handler's error if it fails
+ */
+static hubbub_error replay_op(tree_replay *ctx)
+{
+	const hubbub_tree_target *targets = ctx->targets;
+	size_t n = ctx->n_targets;
+	hubbub_error error = HUBBUB_OK;
+	size_t a = 0, b = 0, c = 0, r = 0, t;
+	bool fresh = false;
+	uint8_t op = *ctx->replay.ptr++;
+	bool flag = (op & OP_FLAG) != 0;
+
+/* Node for handle h in target t */
+#define NODE(h) ctx->nodes[(h) * n + t]
+/* Call a tree handler function in each target, until one fails */
+#define EACH(call)							\
+	for (t = 0; t < n && error == HUBBUB_OK; t++) {			\
+		const hubbub_tree_handler *h = targets[t].handler;	\
+									\
+		error = h->call;					\
+	}
+
+	switch (op & OP_MASK) {
+	case OP_CREATE:
+	{
+		hubbub_token token;
+
+		error = hubbub_replay_token(&ctx->replay, &token);
+		if (error == HUBBUB_OK)
+			error = replay_new_handle(ctx, &r);
+		if (error != HUBBUB_OK)
+			return error;
+
+		switch (token.type) {
+		case HUBBUB_TOKEN_DOCTYPE:
+			EACH(create_doctype(h->ctx, &token.data.doctype,
+					&NODE(r)));
+			break;
+		case HUBBUB_TOKEN_START_TAG:
+			EACH(create_element(h->ctx, &token.data.tag,
+					&NODE(r)));
+			break;
+		case HUBBUB_TOKEN_COMMENT:
+			EACH(create_comment(h->ctx, &token.data.comment,
+					&NODE(r)));
+			break;
+		case HUBBUB_TOKEN_CHARACTER:
+			EACH(create_text(h->ctx, &token.data.character,
+					&NODE(r)));
+			break;
+		default:
+			error = HUBBUB_INVALID;
+		}
+	}
+		break;
+	case OP_REF:
+		if (!replay_handle(ctx, &a))
+			return HUBBUB_INVALID;
+		EACH(ref_node(h->ctx, NODE(a)));
+		break;
+	case OP_UNREF:
+		if (!replay_handle(ctx, &a))
+			return HUBBUB_INVALID;
+		EACH(unref_node(h->ctx, NODE(a)));
+		break;
+	case OP_APPEND:
+		if (!replay_handle(ctx, &a) || !replay_handle(ctx, &b))
+			return HUBBUB_INVALID;
+		error = replay_result(ctx, &r, &fresh);
+		for (t = 0; t < n && error == HUBBUB_OK; t++) {
+			void *result;
+
+			error = targets[t].handler->append_child(
+					targets[t].handler->ctx,
+					NODE(a), NODE(b), &result);
+			if (fresh)
+				NODE(r) = result;
+		}
+		break;
+	case OP_INSERT:
+		if (!replay_handle(ctx, &a) || !replay_handle(ctx, &b) ||
+				!replay_handle(ctx, &c))
+			return HUBBUB_INVALID;
+		error = replay_result(ctx, &r, &fresh);
+		for (t = 0; t < n && error == HUBBUB_OK; t++) {
+			void *result;
+
+			error = targets[t].handler->insert_before(
+					targets[t].handler->ctx,
+					NODE(a), NODE(b), NODE(c), &result);
+			if (fresh)
+				NODE(r) = result;
+		}
+		break;
+	case OP_REMOVE:
+		if (!replay_handle(ctx, &a) || !replay_handle(ctx, &b))
+			return HUBBUB_INVALID;
+		for (t = 0; t < n && error == HUBBUB_OK; t++) {
+			void *result;
+
+			error = targets[t].handler->remove_child(
+					targets[t].handler->ctx,
+					NODE(a), NODE(b), &result);
+		}
+		break;
+	case OP_CLONE:
+		if (!replay_handle(ctx, &a))
+			return HUBBUB_INVALID;
+		error = replay_new_handle(ctx, &r);
+		EACH(clone_node(h->ctx, NODE(a), flag, &NODE(r)));
+		break;
+	case OP_REPARENT:
+		if (!replay_handle(ctx, &a) || !replay_handle(ctx, &b))
+			return HUBBUB_INVALID;
+		EACH(reparent_children(h->ctx, NODE(a), NODE(b)));
+		break;
+	case OP_GET_PARENT:
+		if (!replay_handle(ctx, &a))
+			return HUBBUB_INVALID;
+		error = replay_result(ctx, &r, &fresh);
+		for (t = 0; t < n && error == HUBBUB_OK; t++) {
+			void *result;
+
+			error = targets[t].handler->get_parent(
+					targets[t].handler->ctx,
+					NODE(a), flag, &result);
+			if (fresh)
+				NODE(r) = result;
+		}
+		break;
+	case OP_FORM_ASSOCIATE:
+		if (!replay_handle(ctx, &a) || !replay_handle(ctx, &b))
+			return HUBBUB_INVALID;
+		EACH(form_associate(h->ctx, NODE(a), NODE(b)));
+		break;
+	case OP_ADD_ATTRIBUTES:
+	{
+		hubbub_attribute *attributes;
+		uint32_t n_attributes;
+
+		if (!replay_handle(ctx, &a))
+			return HUBBUB_INVALID;
+		error = hubbub_replay_attributes(&ctx->replay,
+				&attributes, &n_attributes);
+		EACH(add_attributes(h->ctx, NODE(a),
+				attributes, n_attributes));
+	}
+		break;
+	case OP_QUIRKS_MODE:
+		if (!hubbub_replay_varint(&ctx->replay, &a))
+			return HUBBUB_INVALID;
+		EACH(set_quirks_mode(h->ctx, (hubbub_quirks_mode) a));
+		break;
+	case OP_COMPLETE_SCRIPT:
+		if (!replay_handle(ctx, &a))
+			return HUBBUB_INVALID;
+		EACH(complete_script(h->ctx, NODE(a)));
+		break;
+	default:
+		error = HUBBUB_INVALID;
+	}
+
+#undef EACH
+#undef NODE
+
+	return error;
+}
+
+/**
+ * Replay recorded tree operations into one or more tree handlers
+ *
+ * \param data       Recording, as read by hubbub_tree_recorder_read()
+ * \param len        Length of recording, in bytes
+ * \param targets    Tree handlers, and their document nodes
+ * \param n_targets  Number of tree handlers
+ * \param alloc      Memory (de)allocation function
+ * \param pw         Pointer to client-specific private data (may be NULL)
+ * \return HUBBUB_OK on success,
+ *         HUBBUB_BADPARM on bad parameters,
+ *         HUBBUB_INVALID if the recording is malformed,
+ *         HUBBUB_NOMEM on memory exhaustion,
+ *         a tree handler's error if it fails
+ *
+ * The tree handlers are called in turn for each operation, as if each was
+ * attached to a parser of its own.  Replay ends at the first operation a
+ * tree handler fails.
+ */
+hubbub_error hubbub_tree_replay(const uint8_t *data, size_t len,
+		const hubbub_tree_target *targets, size_t n_targets,
+		hubbub_allocator_fn alloc, void *pw)
+{
+	hubbub_error error;
+	tree_replay ctx;
+	size_t t;
+
+	if (targets == NULL || n_targets == 0)
+		return HUBBUB_BADPARM;
+
+	error = hubbub_replay_init(&ctx.replay, HUBBUB_RECORDING_TREE,
+			data, len, alloc, pw);
+	if (error != HUBBUB_OK)
+		return error;
+
+	ctx.targets = targets;
+	ctx.n_targets = n_targets;
+	ctx.handles_alloc = 256;
+	ctx.nodes = alloc(NULL, ctx.handles_alloc * n_targets *
+			sizeof(void *), pw);
+	if (ctx.nodes == NULL) {
+		hubbub_replay_finalise(&ctx.replay);
+		return HUBBUB_NOMEM;
+	}
+
+	/* Handle 0 is the document */
+	for (t = 0; t < n_targets; t++)
+		ctx.nodes[t] = targets[t].document_node;
+	ctx.n_handles = 1;
+
+	while (ctx.replay.ptr < ctx.replay.end && error == HUBBUB_OK)
+		error = replay_op(&ctx);
+
+	alloc(ctx.nodes, 0, pw);
+	hubbub_replay_finalise(&ctx.replay);
+
+	return error;
+}
+
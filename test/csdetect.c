@@ -24,6 +24,7 @@ typedef struct line_ctx {
 
 static bool handle_line(const char *data, size_t datalen, void *pw);
 static void run_test(const uint8_t *data, size_t len, char *expected);
+static void run_impossible_test(void);
 
 int main(int argc, char **argv)
 {
@@ -61,6 +62,8 @@ int main(int argc, char **argv)
 
 	free(ctx.buf);
 
+	run_impossible_test();
+
 	printf("PASS\n");
 
 	return 0;
@@ -121,3 +124,42 @@ void run_test(const uint8_t *data, size_t len, char *expected)
 	assert(mibenum == parserutils_charset_mibenum_from_name(
 			expected, strlen(expected)));
 }
+
+/**
+ * Check that a charset which can't encode a byte isn't chosen, however
+ * well it scores elsewhere. A budget far beyond the default is used, so
+ * that the rest of the data could outweigh any penalty.
+ */
+void run_impossible_test(void)
+{
+	/* Windows-1252 French; 0x81 is undefined in Windows-1252 */
+	static const char text[] = "Le caf\xe9 \xe9tait tr\xe8s anim\xe9, "
+			"pr\xe8s de la for\xeat o\xf9 l'\xe9t\xe9 dure. ";
+	size_t len = 1 << 20, pos;
+	uint16_t windows1252 = parserutils_charset_mibenum_from_name(
+			"Windows-1252", SLEN("Windows-1252"));
+	uint8_t *data;
+
+	data = malloc(len);
+	assert(data != NULL);
+
+	for (pos = 0; pos < len; pos += SLEN(text))
+		memcpy(data + pos, text, min(SLEN(text), len - pos));
+
+	/* Without the undefined byte, the text scores strongly */
+	assert(hubbub_charset_autodetect(data, len) == windows1252);
+	assert(hubbub_charset_autodetect(data, 4096) == windows1252);
+
+	/* With it, near the start or at the end, it's out */
+	data[SLEN(text) * 4] = 0x81;
+	assert(hubbub_charset_autodetect(data, len) != windows1252);
+	assert(hubbub_charset_autodetect(data, 4096) != windows1252);
+
+	data[SLEN(text) * 4] = ' ';
+	data[len - 1] = 0x81;
+	assert(hubbub_charset_autodetect(data, len) != windows1252);
+
+	free(data);
+
+	printf("Excluded impossible charset\n");
+}
@@ -0,0 +1,239 @@
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <hubbub/coroutine.hpp>
+
+#include "testutils.h"
+
+/* Coroutines waiting to run, standing in for an event loop */
+static std::deque<std::coroutine_handle<>> ready;
+
+static void run_loop()
+{
+	while (!ready.empty()) {
+		std::coroutine_handle<> h = ready.front();
+
+		ready.pop_front();
+		h.resume();
+	}
+}
+
+/* Awaitable which lets everything else waiting run first */
+struct yield {
+	bool await_ready() { return false; }
+	void await_suspend(std::coroutine_handle<> h) { ready.push_back(h); }
+	void await_resume() {}
+};
+
+/* Source delivering a document in chunks, from the event loop */
+struct chunked_source {
+	const std::string *doc;
+	size_t pos;
+	size_t chunk;
+	int reads;		/* Number of reads so far */
+	int fail_at;		/* Read which throws, or -1 */
+
+	auto read()
+	{
+		struct awaiter {
+			chunked_source *source;
+
+			bool await_ready() { return false; }
+			void await_suspend(std::coroutine_handle<> h)
+			{
+				ready.push_back(h);
+			}
+			std::span<const uint8_t> await_resume()
+			{
+				return source->take();
+			}
+		};
+
+		return awaiter{this};
+	}
+
+	std::span<const uint8_t> take()
+	{
+		size_t n = std::min(chunk, doc->size() - pos);
+
+		if (reads++ == fail_at)
+			throw std::runtime_error("read failed");
+
+		pos += n;
+
+		return std::span<const uint8_t>(
+				(const uint8_t *) doc->data() + pos - n, n);
+	}
+};
+
+/* Describe a token, for comparison */
+static std::string describe(const hubbub::token_view &token)
+{
+	std::string s = std::to_string(token.type()) + ":";
+
+	switch (token.type()) {
+	case HUBBUB_TOKEN_DOCTYPE:
+		s += token.doctype().name();
+		break;
+	case HUBBUB_TOKEN_START_TAG:
+	case HUBBUB_TOKEN_END_TAG:
+		s += token.tag().name();
+		for (hubbub::attribute_view attr : token.tag().attributes()) {
+			s += " " + std::string(attr.name()) + "=" +
+					std::string(attr.value());
+		}
+		break;
+	case HUBBUB_TOKEN_COMMENT:
+		s += token.comment();
+		break;
+	case HUBBUB_TOKEN_CHARACTER:
+		s += token.characters();
+		break;
+	case HUBBUB_TOKEN_EOF:
+		break;
+	}
+
+	return s;
+}
+
+/* Add a token, joining up characters, which depend on chunking */
+static void add(std::vector<std::string> &tokens, const std::string &token)
+{
+	static const std::string chars =
+			std::to_string(HUBBUB_TOKEN_CHARACTER) + ":";
+
+	if (!tokens.empty() && token.compare(0, chars.size(), chars) == 0 &&
+			tokens.back().compare(0, chars.size(), chars) == 0)
+		tokens.back() += token.substr(chars.size());
+	else
+		tokens.push_back(token);
+}
+
+/* Reference token sequence, from the synchronous parser */
+struct reference {
+	std::vector<std::string> tokens;
+
+	hubbub_error token(const hubbub::token_view &token)
+	{
+		add(tokens, describe(token));
+		return HUBBUB_OK;
+	}
+};
+
+/* Consumer coroutine, started eagerly and left to finish by itself */
+struct task {
+	struct promise_type {
+		task get_return_object() { return task(); }
+		std::suspend_never initial_suspend() { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+struct outcome {
+	std::vector<std::string> tokens;
+	bool threw;
+	bool done;
+	hubbub_error error;
+};
+
+/* Read every token, doing other work after every busy'th one */
+static task consume(hubbub::token_stream<chunked_source> &stream,
+		outcome &out, unsigned busy)
+{
+	unsigned n = 0;
+
+	try {
+		while (const hubbub::token_view *token =
+				co_await stream.next()) {
+			add(out.tokens, describe(*token));
+
+			/* Suspending while the tokeniser runs pauses it */
+			if (busy != 0 && ++n % busy == 0)
+				co_await yield();
+		}
+	} catch (const std::runtime_error &) {
+		out.threw = true;
+	}
+
+	out.error = stream.error();
+	out.done = true;
+}
+
+static outcome stream(const std::string &doc, size_t chunk, unsigned busy,
+		int fail_at)
+{
+	chunked_source source = { &doc, 0, chunk, 0, fail_at };
+	hubbub::token_stream<chunked_source> tokens;
+	outcome out;
+
+	out.threw = false;
+	out.done = false;
+	out.error = HUBBUB_OK;
+
+	assert(tokens.create(source, "UTF-8") == HUBBUB_OK);
+
+	consume(tokens, out, busy);
+	run_loop();
+
+	assert(out.done);
+
+	return out;
+}
+
+int main(int argc, char **argv)
+{
+	/* Carriage returns and NULs make the tokeniser emit several
+	 * character tokens before it can pause */
+	std::string doc = "<!DOCTYPE html><title>T</title>";
+	static const size_t chunks[] = { 1, 5, 64, 100000 };
+	static const unsigned busy[] = { 0, 1, 3 };
+	reference ref;
+	hubbub::token_parser<reference> parser;
+
+	UNUSED(argc);
+	UNUSED(argv);
+
+	for (int i = 0; i < 20; i++) {
+		doc += "<p class=c" + std::to_string(i) + ">a\rb\r\nc";
+		doc += '\0';
+		doc += "d\re&amp;f<!--x--></p>\r";
+	}
+	doc += "tail\r\r";
+
+	assert(parser.create(ref, "UTF-8") == HUBBUB_OK);
+	assert(parser.parse_chunk((const uint8_t *) doc.data(),
+			doc.size()) == HUBBUB_OK);
+	assert(parser.completed() == HUBBUB_OK);
+
+	for (size_t c : chunks) {
+		for (unsigned b : busy) {
+			outcome out = stream(doc, c, b, -1);
+
+			assert(out.threw == false);
+			assert(out.error == HUBBUB_OK);
+			assert(out.tokens == ref.tokens);
+		}
+	}
+
+	/* A source which fails ends the stream with its exception, after
+	 * the tokens which came before */
+	for (unsigned b : busy) {
+		outcome out = stream(doc, 64, b, 2);
+
+		assert(out.threw);
+		assert(out.tokens.size() < ref.tokens.size());
+		for (size_t i = 0; i + 1 < out.tokens.size(); i++)
+			assert(out.tokens[i] == ref.tokens[i]);
+		assert(ref.tokens[out.tokens.size() - 1].compare(0,
+				out.tokens.back().size(),
+				out.tokens.back()) == 0);
+	}
+
+	printf("PASS\n");
+
+	return 0;
+}
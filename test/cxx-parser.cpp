@@ -0,0 +1,370 @@
+#include <string>
+#include <vector>
+
+#include <hubbub/hubbub.hpp>
+
+#include "testutils.h"
+
+/* Document tree built through hubbub::parser */
+struct node {
+	enum kind { DOCUMENT, DOCTYPE, COMMENT, ELEMENT, TEXT } type;
+	std::string name;		/* Element or doctype name */
+	std::string data;		/* Text or comment content */
+	std::vector<std::string> attrs;	/* Attributes, as name="value" */
+
+	node *parent;
+	node *child;
+	node *next;
+
+	unsigned refcnt;
+};
+
+class dom : public hubbub::tree_base<node *> {
+public:
+	dom() : quirks(HUBBUB_QUIRKS_MODE_NONE)
+	{
+		document = make(node::DOCUMENT);
+	}
+
+	~dom()
+	{
+		for (size_t i = 0; i < nodes.size(); i++)
+			delete nodes[i];
+	}
+
+	hubbub_error create_comment(const hubbub_string &data, node *&result)
+	{
+		result = make(node::COMMENT);
+		result->data.assign((const char *) data.ptr, data.len);
+		return HUBBUB_OK;
+	}
+
+	hubbub_error create_doctype(const hubbub_doctype &doctype,
+			node *&result)
+	{
+		result = make(node::DOCTYPE);
+		result->name.assign((const char *) doctype.name.ptr,
+				doctype.name.len);
+		return HUBBUB_OK;
+	}
+
+	hubbub_error create_element(const hubbub_tag &tag, node *&result)
+	{
+		result = make(node::ELEMENT);
+		result->name.assign((const char *) tag.name.ptr, tag.name.len);
+		return add_attributes(result, tag.attributes,
+				tag.n_attributes);
+	}
+
+	hubbub_error create_text(const hubbub_string &data, node *&result)
+	{
+		result = make(node::TEXT);
+		result->data.assign((const char *) data.ptr, data.len);
+		return HUBBUB_OK;
+	}
+
+	hubbub_error ref_node(node *n)
+	{
+		n->refcnt++;
+		return HUBBUB_OK;
+	}
+
+	hubbub_error unref_node(node *n)
+	{
+		assert(n->refcnt > 0);
+		n->refcnt--;
+		return HUBBUB_OK;
+	}
+
+	hubbub_error append_child(node *parent, node *child, node *&result)
+	{
+		node *last = parent->child;
+
+		while (last != NULL && last->next != NULL)
+			last = last->next;
+
+		result = insert(parent, child, last);
+		return ref_node(result);
+	}
+
+	hubbub_error insert_before(node *parent, node *child, node *ref_child,
+			node *&result)
+	{
+		node *prev = NULL;
+
+		if (parent->child != ref_child) {
+			for (prev = parent->child; prev->next != ref_child; )
+				prev = prev->next;
+		}
+
+		result = insert(parent, child, prev);
+		return ref_node(result);
+	}
+
+	hubbub_error remove_child(node *parent, node *child, node *&result)
+	{
+		node **link = &parent->child;
+
+		while (*link != child)
+			link = &(*link)->next;
+
+		*link = child->next;
+		child->parent = child->next = NULL;
+
+		result = child;
+		return ref_node(result);
+	}
+
+	hubbub_error clone_node(node *n, bool deep, node *&result)
+	{
+		node *last = NULL;
+
+		result = make(n->type);
+		result->name = n->name;
+		result->data = n->data;
+		result->attrs = n->attrs;
+
+		for (node *c = n->child; deep && c != NULL; c = c->next) {
+			node *copy;
+
+			clone_node(c, true, copy);
+			copy->refcnt = 0;
+			last = insert(result, copy, last);
+		}
+
+		return HUBBUB_OK;
+	}
+
+	hubbub_error reparent_children(node *n, node *new_parent)
+	{
+		node *last = new_parent->child;
+
+		while (last != NULL && last->next != NULL)
+			last = last->next;
+
+		while (n->child != NULL) {
+			node *c = n->child;
+
+			n->child = c->next;
+			c->next = NULL;
+			last = insert(new_parent, c, last);
+		}
+
+		return HUBBUB_OK;
+	}
+
+	hubbub_error get_parent(node *n, bool element_only, node *&result)
+	{
+		result = n->parent;
+		if (result != NULL && element_only &&
+				result->type != node::ELEMENT)
+			result = NULL;
+		if (result != NULL)
+			ref_node(result);
+		return HUBBUB_OK;
+	}
+
+	hubbub_error has_children(node *n, bool &result)
+	{
+		result = n->child != NULL;
+		return HUBBUB_OK;
+	}
+
+	hubbub_error add_attributes(node *n,
+			const hubbub_attribute *attributes,
+			uint32_t n_attributes)
+	{
+		for (uint32_t i = 0; i < n_attributes; i++) {
+			const hubbub_attribute &a = attributes[i];
+
+			n->attrs.push_back(
+				std::string((const char *) a.name.ptr,
+						a.name.len) + "=\"" +
+				std::string((const char *) a.value.ptr,
+						a.value.len) + "\"");
+		}
+
+		return HUBBUB_OK;
+	}
+
+	hubbub_error set_quirks_mode(hubbub_quirks_mode mode)
+	{
+		quirks = mode;
+		return HUBBUB_OK;
+	}
+
+	/* Print the document in the tree construction tests' format */
+	std::string print() const
+	{
+		std::string out;
+
+		for (node *c = document->child; c != NULL; c = c->next)
+			print(out, c, 0);
+
+		return out;
+	}
+
+	/* Check that the tree builder released all its references */
+	bool released() const
+	{
+		for (size_t i = 0; i < nodes.size(); i++) {
+			if (nodes[i] != document && nodes[i]->refcnt != 0)
+				return false;
+		}
+
+		return true;
+	}
+
+	node *document;
+	hubbub_quirks_mode quirks;
+
+private:
+	node *make(node::kind type)
+	{
+		node *n = new node();
+
+		n->type = type;
+		n->parent = n->child = n->next = NULL;
+		n->refcnt = 1;
+		nodes.push_back(n);
+
+		return n;
+	}
+
+	/* Insert child after prev, merging adjacent text */
+	node *insert(node *parent, node *child, node *prev)
+	{
+		node *next = prev != NULL ? prev->next : parent->child;
+
+		if (child->type == node::TEXT && prev != NULL &&
+				prev->type == node::TEXT) {
+			prev->data += child->data;
+			return prev;
+		}
+
+		child->parent = parent;
+		child->next = next;
+		if (prev != NULL)
+			prev->next = child;
+		else
+			parent->child = child;
+
+		return child;
+	}
+
+	static void print(std::string &out, const node *n, unsigned depth)
+	{
+		std::string indent = "| " + std::string(depth * 2, ' ');
+
+		switch (n->type) {
+		case node::DOCUMENT:
+			break;
+		case node::DOCTYPE:
+			out += indent + "<!DOCTYPE " + n->name + ">\n";
+			break;
+		case node::COMMENT:
+			out += indent + "<!-- " + n->data + " -->\n";
+			break;
+		case node::ELEMENT:
+			out += indent + "<" + n->name + ">\n";
+			for (size_t i = 0; i < n->attrs.size(); i++)
+				out += indent + "  " + n->attrs[i] + "\n";
+			break;
+		case node::TEXT:
+			out += indent + "\"" + n->data + "\"\n";
+			break;
+		}
+
+		for (const node *c = n->child; c != NULL; c = c->next)
+			print(out, c, depth + 1);
+	}
+
+	std::vector<node *> nodes;
+};
+
+/* Parse a document in chunks of the given size, and check the tree built */
+static void run_test(const char *data, const char *expected,
+		hubbub_quirks_mode quirks, size_t chunk)
+{
+	dom tree;
+	hubbub::parser<dom> parser;
+	size_t len = strlen(data);
+
+	assert(parser.create(tree, tree.document, "UTF-8") == HUBBUB_OK);
+
+	for (size_t off = 0; off < len; off += chunk) {
+		size_t n = len - off < chunk ? len - off : chunk;
+
+		assert(parser.parse_chunk((const uint8_t *) data + off, n) ==
+				HUBBUB_OK);
+	}
+
+	assert(parser.completed() == HUBBUB_OK);
+	parser.destroy();
+
+	printf("%s", tree.print().c_str());
+
+	assert(tree.print() == expected);
+	assert(tree.quirks == quirks);
+	assert(tree.released());
+}
+
+int main(int argc, char **argv)
+{
+	static const struct {
+		const char *data;
+		const char *expected;
+		hubbub_quirks_mode quirks;
+	} tests[] = {
+		{ "<!DOCTYPE html><p class=x>Hello <b>world</b><!--c-->",
+		  "| <!DOCTYPE html>\n"
+		  "| <html>\n"
+		  "|   <head>\n"
+		  "|   <body>\n"
+		  "|     <p>\n"
+		  "|       class=\"x\"\n"
+		  "|       \"Hello \"\n"
+		  "|       <b>\n"
+		  "|         \"world\"\n"
+		  "|       <!-- c -->\n",
+		  HUBBUB_QUIRKS_MODE_NONE },
+		/* Adoption agency: clone_node, reparent_children and
+		 * remove_child */
+		{ "<a>1<p>2</a>3</p>",
+		  "| <html>\n"
+		  "|   <head>\n"
+		  "|   <body>\n"
+		  "|     <a>\n"
+		  "|       \"1\"\n"
+		  "|     <p>\n"
+		  "|       <a>\n"
+		  "|         \"2\"\n"
+		  "|       \"3\"\n",
+		  HUBBUB_QUIRKS_MODE_FULL },
+		/* Foster parenting: insert_before */
+		{ "<table>x<tr><td>y</table>",
+		  "| <html>\n"
+		  "|   <head>\n"
+		  "|   <body>\n"
+		  "|     \"x\"\n"
+		  "|     <table>\n"
+		  "|       <tbody>\n"
+		  "|         <tr>\n"
+		  "|           <td>\n"
+		  "|             \"y\"\n",
+		  HUBBUB_QUIRKS_MODE_FULL }
+	};
+
+	UNUSED(argc);
+	UNUSED(argv);
+
+	for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+		run_test(tests[i].data, tests[i].expected, tests[i].quirks,
+				strlen(tests[i].data));
+		run_test(tests[i].data, tests[i].expected, tests[i].quirks, 1);
+	}
+
+	printf("PASS\n");
+
+	return 0;
+}
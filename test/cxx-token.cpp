@@ -0,0 +1,321 @@
+#include <string>
+#include <vector>
+
+#include <hubbub/token.hpp>
+
+#include "testutils.h"
+
+/* Token contents, copied out of a view */
+struct token_copy {
+	hubbub_token_type type;
+	std::string name;
+	std::string public_id;
+	std::string system_id;
+	std::vector<std::string> attrs;	/* Names and values, alternately */
+	bool flag;			/* Self-closing, or force quirks */
+
+	bool operator==(const token_copy &o) const
+	{
+		return type == o.type && name == o.name &&
+				public_id == o.public_id &&
+				system_id == o.system_id &&
+				attrs == o.attrs && flag == o.flag;
+	}
+};
+
+static token_copy copy_view(const hubbub::token_view &token)
+{
+	token_copy c;
+
+	c.type = token.type();
+	c.flag = false;
+
+	switch (token.type()) {
+	case HUBBUB_TOKEN_DOCTYPE:
+		c.name = token.doctype().name();
+		c.public_id = token.doctype().public_id();
+		c.system_id = token.doctype().system_id();
+		c.flag = token.doctype().force_quirks();
+		break;
+	case HUBBUB_TOKEN_START_TAG:
+	case HUBBUB_TOKEN_END_TAG:
+		c.name = token.tag().name();
+		c.flag = token.tag().self_closing();
+		for (hubbub::attribute_view attr : token.tag().attributes()) {
+			c.attrs.push_back(std::string(attr.name()));
+			c.attrs.push_back(std::string(attr.value()));
+		}
+		break;
+	case HUBBUB_TOKEN_COMMENT:
+		c.name = token.comment();
+		break;
+	case HUBBUB_TOKEN_CHARACTER:
+		c.name = token.characters();
+		break;
+	case HUBBUB_TOKEN_EOF:
+		break;
+	}
+
+	return c;
+}
+
+static bool same(std::string_view view, const hubbub_string &str)
+{
+	return view.data() == (const char *) str.ptr && view.size() == str.len;
+}
+
+/* Check that a view refers to exactly what its token does */
+static void check_view(const hubbub::token_view &token)
+{
+	const hubbub_token &raw = token.raw();
+
+	assert(token.type() == raw.type);
+
+	switch (raw.type) {
+	case HUBBUB_TOKEN_DOCTYPE:
+	{
+		hubbub::doctype_view d = token.doctype();
+
+		assert(same(d.name(), raw.data.doctype.name));
+		assert(d.public_missing() == raw.data.doctype.public_missing);
+		assert(same(d.public_id(), raw.data.doctype.public_id));
+		assert(d.system_missing() == raw.data.doctype.system_missing);
+		assert(same(d.system_id(), raw.data.doctype.system_id));
+		assert(d.force_quirks() == raw.data.doctype.force_quirks);
+	}
+		break;
+	case HUBBUB_TOKEN_START_TAG:
+	case HUBBUB_TOKEN_END_TAG:
+	{
+		hubbub::tag_view t = token.tag();
+		hubbub::attributes_view a = t.attributes();
+		uint32_t i = 0;
+
+		assert(t.ns() == raw.data.tag.ns);
+		assert(same(t.name(), raw.data.tag.name));
+		assert(t.self_closing() == raw.data.tag.self_closing);
+		assert(a.size() == raw.data.tag.n_attributes);
+		assert(a.empty() == (raw.data.tag.n_attributes == 0));
+		assert((size_t) (a.end() - a.begin()) == a.size());
+
+		for (hubbub::attributes_view::iterator it = a.begin();
+				it != a.end(); ++it, ++i) {
+			const hubbub_attribute &attr =
+					raw.data.tag.attributes[i];
+
+			assert(&(*it).raw() == &attr);
+			assert(&a[i].raw() == &attr);
+			assert(&a.begin()[i].raw() == &attr);
+			assert((*it).ns() == attr.ns);
+			assert(same((*it).name(), attr.name));
+			assert(same((*it).value(), attr.value));
+			assert((*it).value_id() == attr.value_id);
+		}
+		assert(i == raw.data.tag.n_attributes);
+#if __cplusplus >= 202002L
+		assert(a.span().data() == raw.data.tag.attributes);
+		assert(a.span().size() == raw.data.tag.n_attributes);
+#endif
+	}
+		break;
+	case HUBBUB_TOKEN_COMMENT:
+		assert(same(token.comment(), raw.data.comment));
+		break;
+	case HUBBUB_TOKEN_CHARACTER:
+		assert(same(token.characters(), raw.data.character));
+		break;
+	case HUBBUB_TOKEN_EOF:
+		break;
+	}
+}
+
+/* Handler checking each view against its token, and keeping them all */
+struct collector {
+	std::vector<hubbub::token_view> views;
+	std::vector<token_copy> copies;
+	size_t kept;		/* Views kept during the current chunk */
+
+	hubbub_error token(const hubbub::token_view &token)
+	{
+		check_view(token);
+
+		views.push_back(token);
+		copies.push_back(copy_view(token));
+		kept++;
+
+		return HUBBUB_OK;
+	}
+
+	/* Check the views kept during the current chunk still hold */
+	void check_kept()
+	{
+		for (size_t i = views.size() - kept; i < views.size(); i++)
+			assert(copy_view(views[i]) == copies[i]);
+
+		kept = 0;
+	}
+};
+
+/*
+ * Allocator which always moves blocks it resizes, and scribbles over
+ * memory before releasing it, so that data left behind by the tokeniser
+ * doesn't survive by accident.
+ */
+static size_t allocations;
+
+static void *moving_realloc(void *ptr, size_t len, void *pw)
+{
+	size_t *old = ptr != NULL ? (size_t *) ptr - 2 : NULL;
+	size_t *block = NULL;
+
+	UNUSED(pw);
+
+	if (len > 0) {
+		block = (size_t *) malloc(len + 2 * sizeof(size_t));
+		if (block == NULL)
+			return NULL;
+		block[0] = len;
+		allocations++;
+
+		if (old != NULL)
+			memcpy(block + 2, ptr, old[0] < len ? old[0] : len);
+	}
+
+	if (old != NULL) {
+		memset(old, 0xdf, old[0] + 2 * sizeof(size_t));
+		free(old);
+		allocations--;
+	}
+
+	return block != NULL ? block + 2 : NULL;
+}
+
+/* A document with a token of each type, and values that outgrow buffers */
+static std::string make_document()
+{
+	std::string doc = "<!DOCTYPE html PUBLIC "
+			"\"-//W3C//DTD HTML 4.01//EN\" "
+			"\"http://www.w3.org/TR/html4/strict.dtd\">";
+
+	for (int i = 0; i < 50; i++) {
+		std::string n = std::to_string(i);
+
+		doc += "<p id=p" + n + " class='a b' title=\"" +
+				std::string(i * 97, 'x') + "\">Text " + n +
+				"<br/><!-- comment " + n + " --></p>\n";
+	}
+
+	return doc;
+}
+
+/* Join up character tokens, which depend on where chunks are split */
+static std::vector<token_copy> merged(const std::vector<token_copy> &tokens)
+{
+	std::vector<token_copy> out;
+
+	for (size_t i = 0; i < tokens.size(); i++) {
+		if (tokens[i].type == HUBBUB_TOKEN_CHARACTER && !out.empty() &&
+				out.back().type == HUBBUB_TOKEN_CHARACTER)
+			out.back().name += tokens[i].name;
+		else
+			out.push_back(tokens[i]);
+	}
+
+	return out;
+}
+
+/* Parse doc in chunks of the given size, checking views as they come */
+static std::vector<token_copy> parse(const std::string &doc, size_t chunk,
+		bool stable)
+{
+	collector c;
+	hubbub::token_parser<collector> parser;
+
+	c.kept = 0;
+
+	assert(parser.create(c, "UTF-8", false, stable, moving_realloc) ==
+			HUBBUB_OK);
+
+	for (size_t off = 0; off < doc.size(); off += chunk) {
+		size_t n = doc.size() - off < chunk ? doc.size() - off : chunk;
+
+		assert(parser.parse_chunk(
+				(const uint8_t *) doc.data() + off, n) ==
+				HUBBUB_OK);
+
+		/* In stable mode, what the views refer to outlives the
+		 * callbacks which received them */
+		if (stable)
+			c.check_kept();
+		else
+			c.kept = 0;
+	}
+
+	assert(parser.completed() == HUBBUB_OK);
+	if (stable)
+		c.check_kept();
+
+	return merged(c.copies);
+}
+
+/* Check that a reset arena hands out the same blocks again */
+static void test_arena()
+{
+	static const size_t sizes[] = { 10, 4000, 70000, 1, 65536, 300 };
+	hubbub::token_arena *arena;
+	std::vector<uint8_t *> first;
+	size_t blocks;
+
+	assert(hubbub::token_arena::create(moving_realloc, NULL, &arena) ==
+			HUBBUB_OK);
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		uint8_t *ptr = arena->allocate(sizes[i]);
+
+		assert(ptr != NULL);
+		assert((uintptr_t) ptr % alignof(std::max_align_t) == 0);
+		memset(ptr, i, sizes[i]);
+		first.push_back(ptr);
+	}
+
+	blocks = allocations;
+
+	for (int pass = 0; pass < 3; pass++) {
+		arena->reset();
+
+		for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+			assert(arena->allocate(sizes[i]) == first[i]);
+
+		assert(allocations == blocks);
+	}
+
+	hubbub::token_arena::destroy(arena);
+}
+
+int main(int argc, char **argv)
+{
+	std::string doc = make_document();
+	std::vector<token_copy> expected;
+	static const size_t chunks[] = { 1, 7, 64, 4096 };
+
+	UNUSED(argc);
+	UNUSED(argv);
+
+	/* Parsed whole, as a reference */
+	expected = parse(doc, doc.size(), false);
+	assert(expected.size() > 200);
+
+	for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+		assert(parse(doc, chunks[i], false) == expected);
+		assert(parse(doc, chunks[i], true) == expected);
+	}
+	assert(parse(doc, doc.size(), true) == expected);
+
+	test_arena();
+
+	assert(allocations == 0);
+
+	printf("PASS\n");
+
+	return 0;
+}
@@ -1,16 +1,61 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include <sys/uio.h>
 
 #include <hubbub/hubbub.h>
 
 #include <hubbub/parser.h>
 
+#include "tokeniser/intern.h"
+#include "tokeniser/recorder.h"
 #include "utils/utils.h"
 
 #include "testutils.h"
 
 static hubbub_error token_handler(const hubbub_token *token, void *pw);
+static hubbub_error text_handler(const hubbub_string *text, void *pw);
+static hubbub_error pause_handler(const hubbub_token *token, void *pw);
+static hubbub_error record_handler(const hubbub_token *token, void *pw);
+
+/* Attribute filter, used for alternate runs */
+static const char *filter_names[] = { "href", "src", "id", "class", NULL };
+static const char *filter_tags[] = { "a", "img", "link", "div", NULL };
+
+/* Interned values seen so far, by ID - 1, for runs which intern them */
+static bool interning;
+static struct {
+	const uint8_t *ptr;
+	size_t len;
+	uint8_t data[HUBBUB_INTERN_MAX_LENGTH];
+} interned[HUBBUB_INTERN_MAX_VALUES];
+
+/* Amount of input consumed by the first streaming run */
+static uint64_t streamed_offset;
+
+/* Tokens recorded by the last run without streaming, which a streaming
+ * run with the same chunk size must reproduce exactly */
+static uint8_t *recorded;
+static size_t recorded_len;
+
+/* Tokens seen by pause_handler(), and whether it's waiting to resume */
+static struct {
+	bool pause;		/* Whether to pause after character tokens */
+	bool held;		/* Whether a pause has been requested */
+	uint32_t tags;		/* Tokens other than characters seen */
+	uint32_t chars;		/* Bytes of character data seen */
+} pausing;
+
+/* Blocks allocated while recording is set up, which starving_realloc()
+ * refuses to resize, so that the recording can't grow */
+static struct {
+	bool catching;		/* Whether to note blocks allocated */
+	void *blocks[4];	/* Blocks noted */
+	size_t n_blocks;	/* Number of blocks noted */
+	bool refused;		/* Whether a resize has been refused */
+} starving;
 
 static void *myrealloc(void *ptr, size_t len, void *pw)
 {
@@ -19,7 +64,38 @@ static void *myrealloc(void *ptr, size_t len, void *pw)
 	return realloc(ptr, len);
 }
 
-static int run_test(int argc, char **argv, unsigned int CHUNK_SIZE)
+static void *starving_realloc(void *ptr, size_t len, void *pw)
+{
+	size_t i;
+
+	UNUSED(pw);
+
+	for (i = 0; ptr != NULL && i < starving.n_blocks; i++) {
+		if (starving.blocks[i] != ptr)
+			continue;
+
+		if (len > 0) {
+			starving.refused = true;
+			return NULL;
+		}
+
+		/* Once freed, the block may be handed out for anything */
+		starving.blocks[i] = starving.blocks[--starving.n_blocks];
+		break;
+	}
+
+	ptr = realloc(ptr, len);
+
+	if (starving.catching && ptr != NULL && len > 0) {
+		assert(starving.n_blocks < N_ELEMENTS(starving.blocks));
+		starving.blocks[starving.n_blocks++] = ptr;
+	}
+
+	return ptr;
+}
+
+static int run_test(int argc, char **argv, unsigned int CHUNK_SIZE,
+		bool filter, bool intern, bool stream)
 {
 	hubbub_parser *parser;
 	hubbub_parser_optparams params;
@@ -28,17 +104,55 @@ static int run_test(int argc, char **argv, unsigned int CHUNK_SIZE)
 	uint8_t *buf = alloca(CHUNK_SIZE);
 	const char *charset;
 	hubbub_charset_source cssource;
+	uint64_t offset = 0, prev_offset = 0;
+	const uint8_t *rec;
+	size_t rec_len;
 
 	UNUSED(argc);
 
 	assert(hubbub_parser_create("UTF-8", false, myrealloc, NULL, &parser) ==
 			HUBBUB_OK);
 
+	if (filter) {
+		/* Set the filter while a text handler is in place, which
+		 * must keep it for the token handler that replaces it */
+		params.text_handler.handler = text_handler;
+		params.text_handler.pw = NULL;
+		assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_TEXT_HANDLER,
+				&params) == HUBBUB_OK);
+
+		params.attribute_filter.names = filter_names;
+		params.attribute_filter.tags = filter_tags;
+		assert(hubbub_parser_setopt(parser,
+				HUBBUB_PARSER_ATTRIBUTE_FILTER,
+				&params) == HUBBUB_OK);
+	}
+
 	params.token_handler.handler = token_handler;
-	params.token_handler.pw = NULL;
+	params.token_handler.pw = filter ? filter_names : NULL;
 	assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_TOKEN_HANDLER,
 			&params) == HUBBUB_OK);
 
+	interning = intern;
+	if (intern) {
+		memset(interned, 0, sizeof(interned));
+
+		params.intern_values = true;
+		assert(hubbub_parser_setopt(parser,
+				HUBBUB_PARSER_INTERN_VALUES,
+				&params) == HUBBUB_OK);
+	}
+
+	if (stream) {
+		params.streaming = true;
+		assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_STREAMING,
+				&params) == HUBBUB_OK);
+	}
+
+	params.record_tokens = true;
+	assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_RECORD_TOKENS,
+			&params) == HUBBUB_OK);
+
 	fp = fopen(argv[1], "rb");
 	if (fp == NULL) {
 		printf("Failed opening %s\n", argv[1]);
@@ -58,6 +172,11 @@ static int run_test(int argc, char **argv, unsigned int CHUNK_SIZE)
 		assert(hubbub_parser_parse_chunk(parser,
 				buf, bytes_read) == HUBBUB_OK);
 
+		assert(hubbub_parser_read_offset(parser, &offset) ==
+				HUBBUB_OK);
+		assert(offset >= prev_offset);
+		prev_offset = offset;
+
 		len -= bytes_read;
 	}
         
@@ -65,6 +184,33 @@ static int run_test(int argc, char **argv, unsigned int CHUNK_SIZE)
 
 	fclose(fp);
 
+	assert(hubbub_parser_completed(parser) == HUBBUB_OK);
+
+	if (stream) {
+		/* However the input was split, all of it is consumed */
+		assert(hubbub_parser_read_offset(parser, &offset) ==
+				HUBBUB_OK);
+		assert(offset >= prev_offset);
+
+		if (streamed_offset == 0)
+			streamed_offset = offset;
+		assert(offset == streamed_offset);
+	}
+
+	/* Discarding consumed input mustn't change the tokens emitted */
+	assert(hubbub_parser_read_recording(parser, &rec, &rec_len) ==
+			HUBBUB_OK);
+	if (stream) {
+		assert(rec_len == recorded_len);
+		assert(memcmp(rec, recorded, rec_len) == 0);
+	} else if (!filter && !intern) {
+		free(recorded);
+		recorded = malloc(rec_len);
+		assert(recorded != NULL);
+		memcpy(recorded, rec, rec_len);
+		recorded_len = rec_len;
+	}
+
 	charset = hubbub_parser_read_charset(parser, &cssource);
 
 	printf("Charset: %s (from %d)\n", charset, cssource);
@@ -76,6 +222,334 @@ static int run_test(int argc, char **argv, unsigned int CHUNK_SIZE)
 	return 0;
 }
 
+static const char *detect_charset(const struct iovec *iov, int cnt,
+		hubbub_charset_source *source)
+{
+	hubbub_parser *parser;
+	const char *charset;
+
+	static const struct iovec empty[] = {
+		{ NULL, 0 }, { (void *) "", 0 }
+	};
+
+	assert(hubbub_parser_create(NULL, false, myrealloc, NULL, &parser) ==
+			HUBBUB_OK);
+
+	/* Chains with no data in them mustn't settle the charset */
+	assert(hubbub_parser_parse_iov(parser, iov, 0) == HUBBUB_OK);
+	assert(hubbub_parser_parse_iov(parser, empty, N_ELEMENTS(empty)) ==
+			HUBBUB_OK);
+
+	assert(hubbub_parser_parse_iov(parser, iov, cnt) == HUBBUB_OK);
+
+	charset = hubbub_parser_read_charset(parser, source);
+
+	hubbub_parser_destroy(parser);
+
+	return charset;
+}
+
+static int run_iov_test(int argc, char **argv, unsigned int CHUNK_SIZE)
+{
+	hubbub_parser *parser;
+	hubbub_parser_optparams params;
+	FILE *fp;
+	size_t len, pos;
+	uint8_t *data;
+	struct iovec *iov;
+	int cnt, i;
+	const char *charset, *whole_charset;
+	hubbub_charset_source cssource, whole_cssource;
+	uint64_t offset;
+
+	UNUSED(argc);
+
+	fp = fopen(argv[1], "rb");
+	if (fp == NULL) {
+		printf("Failed opening %s\n", argv[1]);
+		return 1;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	data = malloc(len + 1);
+	assert(data != NULL);
+	assert(fread(data, 1, len, fp) == len);
+
+	fclose(fp);
+
+	/* Split the document into a chain of buffers, with an empty one
+	 * ahead of each, which a client may leave without a base */
+	iov = malloc((len / CHUNK_SIZE + 1) * 2 * sizeof(struct iovec));
+	assert(iov != NULL);
+
+	for (pos = 0, cnt = 0; pos < len; pos += CHUNK_SIZE, cnt += 2) {
+		iov[cnt].iov_base = NULL;
+		iov[cnt].iov_len = 0;
+		iov[cnt + 1].iov_base = data + pos;
+		iov[cnt + 1].iov_len = min(CHUNK_SIZE, len - pos);
+	}
+
+	assert(hubbub_parser_create("UTF-8", false, myrealloc, NULL, &parser) ==
+			HUBBUB_OK);
+
+	params.token_handler.handler = token_handler;
+	params.token_handler.pw = NULL;
+	assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_TOKEN_HANDLER,
+			&params) == HUBBUB_OK);
+
+	/* Pass the chain a few buffers at a time */
+	for (i = 0; i < cnt; i += 16) {
+		assert(hubbub_parser_parse_iov(parser, iov + i,
+				min(16, cnt - i)) == HUBBUB_OK);
+	}
+
+	/* All of the input is consumed, as if it had been parsed in chunks */
+	assert(hubbub_parser_completed(parser) == HUBBUB_OK);
+	assert(hubbub_parser_read_offset(parser, &offset) == HUBBUB_OK);
+	assert(offset == streamed_offset);
+
+	hubbub_parser_destroy(parser);
+
+	/* The chain yields the same charset as the document in one piece */
+	charset = detect_charset(iov, cnt, &cssource);
+
+	iov[0].iov_base = data;
+	iov[0].iov_len = len;
+	whole_charset = detect_charset(iov, 1, &whole_cssource);
+
+	assert(strcmp(charset, whole_charset) == 0);
+	assert(cssource == whole_cssource);
+
+	printf("Charset: %s (from %d)\n", charset, cssource);
+
+	free(iov);
+	free(data);
+
+	printf("PASS\n");
+
+	return 0;
+}
+
+/* Resume the parser for as long as pause_handler() pauses it */
+static void resume(hubbub_parser *parser, hubbub_error error)
+{
+	hubbub_parser_optparams params;
+
+	while (error == HUBBUB_PAUSED) {
+		assert(pausing.held);
+		pausing.held = false;
+
+		params.pause_parse = false;
+		error = hubbub_parser_setopt(parser, HUBBUB_PARSER_PAUSE,
+				&params);
+	}
+
+	assert(error == HUBBUB_OK);
+	assert(pausing.held == false);
+}
+
+/* Parse a document, pausing after every character token if asked to */
+static void run_pause(const uint8_t *data, size_t len,
+		unsigned int CHUNK_SIZE, bool pause)
+{
+	hubbub_parser *parser;
+	hubbub_parser_optparams params;
+	size_t pos;
+
+	assert(hubbub_parser_create("UTF-8", false, myrealloc, NULL, &parser) ==
+			HUBBUB_OK);
+
+	params.token_handler.handler = pause_handler;
+	params.token_handler.pw = parser;
+	assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_TOKEN_HANDLER,
+			&params) == HUBBUB_OK);
+
+	memset(&pausing, 0, sizeof(pausing));
+	pausing.pause = pause;
+
+	for (pos = 0; pos < len; pos += CHUNK_SIZE) {
+		resume(parser, hubbub_parser_parse_chunk(parser, data + pos,
+				min(CHUNK_SIZE, len - pos)));
+	}
+
+	resume(parser, hubbub_parser_completed(parser));
+
+	hubbub_parser_destroy(parser);
+}
+
+static int run_pause_test(int argc, char **argv, unsigned int CHUNK_SIZE)
+{
+	FILE *fp;
+	size_t len;
+	uint8_t *data;
+	uint32_t tags, chars;
+
+	UNUSED(argc);
+
+	fp = fopen(argv[1], "rb");
+	if (fp == NULL) {
+		printf("Failed opening %s\n", argv[1]);
+		return 1;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	data = malloc(len + 1);
+	assert(data != NULL);
+	assert(fread(data, 1, len, fp) == len);
+
+	fclose(fp);
+
+	run_pause(data, len, CHUNK_SIZE, false);
+	tags = pausing.tags;
+	chars = pausing.chars;
+
+	/* Pausing holds back the rest of the document, and loses none */
+	run_pause(data, len, CHUNK_SIZE, true);
+	assert(pausing.tags == tags);
+	assert(pausing.chars == chars);
+
+	free(data);
+
+	printf("PASS\n");
+
+	return 0;
+}
+
+/**
+ * Parse a document, recording the tokens it yields, while recording them
+ * with the parser too
+ *
+ * \param data        Document
+ * \param len         Length of document, in bytes
+ * \param CHUNK_SIZE  Size of chunks to parse it in
+ * \param alloc       Allocator for the parser
+ * \param seen        Recorder to receive the tokens the parser yields
+ * \param rec         Pointer to location to receive parser's recording
+ * \param rec_len     Pointer to location to receive its length
+ * \return Result of reading the parser's recording
+ */
+static hubbub_error run_record(const uint8_t *data, size_t len,
+		unsigned int CHUNK_SIZE, hubbub_allocator_fn alloc,
+		hubbub_recorder *seen, uint8_t **rec, size_t *rec_len)
+{
+	hubbub_parser *parser;
+	hubbub_parser_optparams params;
+	const uint8_t *recording;
+	hubbub_error error;
+	size_t pos;
+
+	assert(hubbub_parser_create("UTF-8", false, alloc, NULL, &parser) ==
+			HUBBUB_OK);
+
+	params.token_handler.handler = record_handler;
+	params.token_handler.pw = seen;
+	assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_TOKEN_HANDLER,
+			&params) == HUBBUB_OK);
+
+	starving.catching = true;
+	params.record_tokens = true;
+	assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_RECORD_TOKENS,
+			&params) == HUBBUB_OK);
+	starving.catching = false;
+
+	for (pos = 0; pos < len; pos += CHUNK_SIZE) {
+		assert(hubbub_parser_parse_chunk(parser, data + pos,
+				min(CHUNK_SIZE, len - pos)) == HUBBUB_OK);
+	}
+
+	assert(hubbub_parser_completed(parser) == HUBBUB_OK);
+
+	error = hubbub_parser_read_recording(parser, &recording, rec_len);
+
+	*rec = malloc(*rec_len);
+	assert(*rec != NULL);
+	memcpy(*rec, recording, *rec_len);
+
+	hubbub_parser_destroy(parser);
+
+	return error;
+}
+
+static int run_starved_test(int argc, char **argv, unsigned int CHUNK_SIZE)
+{
+	hubbub_recorder *seen, *starved_seen;
+	const uint8_t *tokens, *starved_tokens;
+	size_t tokens_len, starved_tokens_len;
+	uint8_t *rec, *starved_rec;
+	size_t rec_len, starved_rec_len;
+	hubbub_error error;
+	FILE *fp;
+	size_t len;
+	uint8_t *data;
+
+	UNUSED(argc);
+
+	fp = fopen(argv[1], "rb");
+	if (fp == NULL) {
+		printf("Failed opening %s\n", argv[1]);
+		return 1;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	data = malloc(len + 1);
+	assert(data != NULL);
+	assert(fread(data, 1, len, fp) == len);
+
+	fclose(fp);
+
+	assert(hubbub_recorder_create(HUBBUB_RECORDING_TOKENS, myrealloc,
+			NULL, &seen) == HUBBUB_OK);
+	assert(hubbub_recorder_create(HUBBUB_RECORDING_TOKENS, myrealloc,
+			NULL, &starved_seen) == HUBBUB_OK);
+
+	assert(run_record(data, len, CHUNK_SIZE, myrealloc, seen,
+			&rec, &rec_len) == HUBBUB_OK);
+
+	memset(&starving, 0, sizeof(starving));
+	error = run_record(data, len, CHUNK_SIZE, starving_realloc,
+			starved_seen, &starved_rec, &starved_rec_len);
+
+	/* The parse is the same, whether or not it could be recorded */
+	assert(hubbub_recorder_read(seen, &tokens, &tokens_len) ==
+			HUBBUB_OK);
+	assert(hubbub_recorder_read(starved_seen, &starved_tokens,
+			&starved_tokens_len) == HUBBUB_OK);
+	assert(starved_tokens_len == tokens_len);
+	assert(memcmp(starved_tokens, tokens, tokens_len) == 0);
+
+	/* A recording which failed says so, and holds whole tokens up to
+	 * the first it couldn't record */
+	if (starving.refused) {
+		assert(error == HUBBUB_NOMEM);
+		assert(starved_rec_len < rec_len);
+	} else {
+		assert(error == HUBBUB_OK);
+		assert(starved_rec_len == rec_len);
+	}
+	assert(memcmp(starved_rec, rec, starved_rec_len) == 0);
+
+	hubbub_recorder_destroy(starved_seen);
+	hubbub_recorder_destroy(seen);
+
+	free(starved_rec);
+	free(rec);
+	free(data);
+
+	printf("%s recording\n", starving.refused ? "Starved" : "Fed");
+	printf("PASS\n");
+
+	return 0;
+}
+
 int main(int argc, char **argv)
 {
 	int ret;
@@ -85,14 +559,141 @@ int main(int argc, char **argv)
 		printf("Usage: %s <filename>\n", argv[0]);
 		return 1;
 	}
-#define DO_TEST(n) if ((ret = run_test(argc, argv, (n))) != 0) return ret
+#define DO_TEST(n, f, i, s) \
+		if ((ret = run_test(argc, argv, (n), (f), (i), (s))) != 0) \
+			return ret
         for (shift = 0; (1 << shift) != 16384; shift++)
-        	for (offset = 0; offset < 10; offset += 3)
-	                DO_TEST((1 << shift) + offset);
+        	for (offset = 0; offset < 10; offset += 3) {
+	                DO_TEST((1 << shift) + offset, false, false, false);
+	                DO_TEST((1 << shift) + offset, false, false, true);
+		}
+
+	for (shift = 0; shift < 14; shift += 4) {
+		DO_TEST(1 << shift, false, true, false);
+		DO_TEST(1 << shift, true, false, false);
+	}
+
+	for (shift = 0; shift < 14; shift += 4) {
+		if ((ret = run_iov_test(argc, argv, 1 << shift)) != 0)
+			return ret;
+	}
+
+	for (shift = 0; shift < 14; shift += 4) {
+		if ((ret = run_pause_test(argc, argv, 1 << shift)) != 0)
+			return ret;
+	}
+
+	for (shift = 0; shift < 14; shift += 4) {
+		if ((ret = run_starved_test(argc, argv, 1 << shift)) != 0)
+			return ret;
+	}
+
+	free(recorded);
+
         return 0;
 #undef DO_TEST
 }
 
+static bool listed(const char **list, const hubbub_string *name)
+{
+	for (; *list != NULL; list++) {
+		if (strlen(*list) == name->len &&
+				strncmp(*list, (const char *) name->ptr,
+					name->len) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+static void check_filtered(const hubbub_tag *tag)
+{
+	uint32_t i;
+
+	if (tag->n_attributes > 0)
+		assert(listed(filter_tags, &tag->name));
+
+	for (i = 0; i < tag->n_attributes; i++)
+		assert(listed(filter_names, &tag->attributes[i].name));
+}
+
+static void check_interned(const hubbub_tag *tag)
+{
+	uint32_t i;
+
+	for (i = 0; i < tag->n_attributes; i++) {
+		const hubbub_attribute *attr = &tag->attributes[i];
+		uint32_t id = attr->value_id;
+
+		if (attr->value.len > HUBBUB_INTERN_MAX_LENGTH) {
+			assert(id == 0);
+			continue;
+		}
+
+		if (id == 0) {
+			/* Only once the cache is full */
+			assert(interned[HUBBUB_INTERN_MAX_VALUES - 1].ptr !=
+					NULL);
+			continue;
+		}
+
+		assert(id <= HUBBUB_INTERN_MAX_VALUES);
+
+		/* Each ID always has the same, unchanged, copy */
+		if (interned[id - 1].ptr == NULL) {
+			interned[id - 1].ptr = attr->value.ptr;
+			interned[id - 1].len = attr->value.len;
+			memcpy(interned[id - 1].data, attr->value.ptr,
+					attr->value.len);
+		} else {
+			assert(interned[id - 1].ptr == attr->value.ptr);
+			assert(interned[id - 1].len == attr->value.len);
+			assert(memcmp(interned[id - 1].data, attr->value.ptr,
+					attr->value.len) == 0);
+		}
+	}
+}
+
+hubbub_error pause_handler(const hubbub_token *token, void *pw)
+{
+	hubbub_parser_optparams params;
+
+	if (token->type != HUBBUB_TOKEN_CHARACTER) {
+		/* Once paused, the tokeniser must not move on to the next
+		 * state until resumed */
+		assert(pausing.held == false);
+		pausing.tags++;
+		return HUBBUB_OK;
+	}
+
+	pausing.chars += token->data.character.len;
+
+	if (pausing.pause == false)
+		return HUBBUB_OK;
+
+	/* Ask for a pause both ways the API allows */
+	pausing.held = true;
+	if (pausing.chars % 2 == 0)
+		return HUBBUB_PAUSED;
+
+	params.pause_parse = true;
+	assert(hubbub_parser_setopt((hubbub_parser *) pw,
+			HUBBUB_PARSER_PAUSE, &params) == HUBBUB_OK);
+
+	return HUBBUB_OK;
+}
+
+hubbub_error text_handler(const hubbub_string *text, void *pw)
+{
+	UNUSED(text);
+	UNUSED(pw);
+
+	/* Never called: the token handler replaces it before parsing */
+	assert(0);
+
+	return HUBBUB_OK;
+}
+
 hubbub_error token_handler(const hubbub_token *token, void *pw)
 {
 	static const char *token_names[] = {
@@ -101,7 +702,13 @@ hubbub_error token_handler(const hubbub_token *token, void *pw)
 	};
 	size_t i;
 
-	UNUSED(pw);
+	if (pw != NULL && (token->type == HUBBUB_TOKEN_START_TAG ||
+			token->type == HUBBUB_TOKEN_END_TAG))
+		check_filtered(&token->data.tag);
+
+	if (interning && (token->type == HUBBUB_TOKEN_START_TAG ||
+			token->type == HUBBUB_TOKEN_END_TAG))
+		check_interned(&token->data.tag);
 
 	printf("%s: ", token_names[token->type]);
 
@@ -175,3 +782,10 @@ hubbub_error token_handler(const hubbub_token *token, void *pw)
 
 	return HUBBUB_OK;
 }
+
+hubbub_error record_handler(const hubbub_token *token, void *pw)
+{
+	assert(hubbub_recorder_token(pw, token) == HUBBUB_OK);
+
+	return HUBBUB_OK;
+}
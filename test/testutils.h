@@ -159,7 +159,7 @@ char *my_strndup(const char *s, size_t n)
 	for (len = 0; len != n && s[len]; len++)
 		;
 
-	s2 = malloc(len + 1);
+	s2 = (char *) malloc(len + 1);
 	if (!s2)
 		return NULL;
 
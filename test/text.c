@@ -0,0 +1,202 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <hubbub/hubbub.h>
+
+#include <hubbub/parser.h>
+
+#include "utils/utils.h"
+
+#include "testutils.h"
+
+typedef struct line_ctx {
+	size_t buflen;
+	size_t bufused;
+	uint8_t *buf;
+	size_t textused;
+	uint8_t *text;
+	bool indata;
+	bool intext;
+} line_ctx;
+
+typedef struct text_ctx {
+	size_t len;
+	uint8_t *buf;
+	size_t alloc;
+} text_ctx;
+
+static bool handle_line(const char *data, size_t datalen, void *pw);
+static void run_test(const uint8_t *data, size_t len,
+		const uint8_t *expected, size_t explen);
+static hubbub_error text_handler(const hubbub_string *text, void *pw);
+
+static void *myrealloc(void *ptr, size_t len, void *pw)
+{
+	UNUSED(pw);
+
+	return realloc(ptr, len);
+}
+
+int main(int argc, char **argv)
+{
+	line_ctx ctx;
+
+	if (argc != 2) {
+		printf("Usage: %s <filename>\n", argv[0]);
+		return 1;
+	}
+
+	ctx.buflen = parse_filesize(argv[1]);
+	if (ctx.buflen == 0)
+		return 1;
+
+	ctx.buf = malloc(ctx.buflen);
+	if (ctx.buf == NULL) {
+		printf("Failed allocating %u bytes\n",
+				(unsigned int) ctx.buflen);
+		return 1;
+	}
+
+	ctx.text = malloc(ctx.buflen);
+	if (ctx.text == NULL) {
+		printf("Failed allocating %u bytes\n",
+				(unsigned int) ctx.buflen);
+		free(ctx.buf);
+		return 1;
+	}
+
+	ctx.bufused = 0;
+	ctx.textused = 0;
+	ctx.indata = false;
+	ctx.intext = false;
+
+	assert(parse_testfile(argv[1], handle_line, &ctx) == true);
+
+	/* and run final test */
+	if (ctx.intext) {
+		while (ctx.textused > 0 && ctx.text[ctx.textused - 1] == '\n')
+			ctx.textused -= 1;
+
+		run_test(ctx.buf, ctx.bufused, ctx.text, ctx.textused);
+	}
+
+	free(ctx.text);
+	free(ctx.buf);
+
+	printf("PASS\n");
+
+	return 0;
+}
+
+bool handle_line(const char *data, size_t datalen, void *pw)
+{
+	line_ctx *ctx = (line_ctx *) pw;
+
+	if (data[0] == '#') {
+		if (ctx->intext) {
+			/* This marks end of testcase, so run it */
+			if (ctx->bufused > 0 &&
+					ctx->buf[ctx->bufused - 1] == '\n')
+				ctx->bufused -= 1;
+
+			/* Test cases are separated by blank lines */
+			while (ctx->textused > 0 &&
+					ctx->text[ctx->textused - 1] == '\n')
+				ctx->textused -= 1;
+
+			run_test(ctx->buf, ctx->bufused,
+					ctx->text, ctx->textused);
+
+			ctx->bufused = 0;
+			ctx->textused = 0;
+		}
+
+		ctx->indata = (strncasecmp(data+1, "data", 4) == 0);
+		ctx->intext = (strncasecmp(data+1, "text", 4) == 0);
+	} else {
+		if (ctx->indata) {
+			memcpy(ctx->buf + ctx->bufused, data, datalen);
+			ctx->bufused += datalen;
+		}
+		if (ctx->intext) {
+			memcpy(ctx->text + ctx->textused, data, datalen);
+			ctx->textused += datalen;
+		}
+	}
+
+	return true;
+}
+
+static void parse_text(const uint8_t *data, size_t len, size_t chunk,
+		text_ctx *text)
+{
+	hubbub_parser *parser;
+	hubbub_parser_optparams params;
+	size_t done;
+
+	assert(hubbub_parser_create("UTF-8", false, myrealloc, NULL,
+			&parser) == HUBBUB_OK);
+
+	params.text_handler.handler = text_handler;
+	params.text_handler.pw = text;
+	assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_TEXT_HANDLER,
+			&params) == HUBBUB_OK);
+
+	text->len = 0;
+
+	for (done = 0; done < len; done += chunk) {
+		assert(hubbub_parser_parse_chunk(parser, data + done,
+				min(chunk, len - done)) == HUBBUB_OK);
+	}
+
+	assert(hubbub_parser_completed(parser) == HUBBUB_OK);
+
+	hubbub_parser_destroy(parser);
+}
+
+void run_test(const uint8_t *data, size_t len,
+		const uint8_t *expected, size_t explen)
+{
+	static int testnum;
+	text_ctx text = { 0, NULL, 0 };
+
+	printf("%d: Extracting text from '%.*s'\n", ++testnum,
+			(int) len, data);
+
+	parse_text(data, len, len > 0 ? len : 1, &text);
+
+	printf("Got '%.*s'\nExpected '%.*s'\n", (int) text.len, text.buf,
+			(int) explen, expected);
+
+	assert(text.len == explen && memcmp(text.buf, expected, explen) == 0);
+
+	/* Same again, a byte at a time */
+	parse_text(data, len, 1, &text);
+
+	assert(text.len == explen && memcmp(text.buf, expected, explen) == 0);
+
+	free(text.buf);
+}
+
+hubbub_error text_handler(const hubbub_string *text, void *pw)
+{
+	text_ctx *ctx = (text_ctx *) pw;
+
+	if (ctx->len + text->len > ctx->alloc) {
+		uint8_t *temp = realloc(ctx->buf, ctx->len + text->len);
+		if (temp == NULL)
+			return HUBBUB_NOMEM;
+
+		ctx->buf = temp;
+		ctx->alloc = ctx->len + text->len;
+	}
+
+	memcpy(ctx->buf + ctx->len, text->ptr, text->len);
+	ctx->len += text->len;
+
+	return HUBBUB_OK;
+}
+
@@ -12,6 +12,8 @@
 #include "testutils.h"
 
 static hubbub_error token_handler(const hubbub_token *token, void *pw);
+static hubbub_error count_handler(const hubbub_token *token, void *pw);
+static int run_stream_test(const char *filename);
 
 static void *myrealloc(void *ptr, size_t len, void *pw)
 {
@@ -78,11 +80,107 @@ int main(int argc, char **argv)
 
 	parserutils_inputstream_destroy(stream);
 
+	if (run_stream_test(argv[1]) != 0)
+		return 1;
+
 	printf("PASS\n");
 
 	return 0;
 }
 
+/**
+ * Feed a document repeatedly to a streaming tokeniser, checking that the
+ * input it keeps stays bounded however much has been fed
+ */
+int run_stream_test(const char *filename)
+{
+	parserutils_inputstream *stream;
+	hubbub_tokeniser *tok;
+	hubbub_tokeniser_optparams params;
+	FILE *fp;
+	uint8_t *data;
+	size_t len, pos, fed, target, kept, most = 0;
+	uint32_t count = 0;
+
+	fp = fopen(filename, "rb");
+	if (fp == NULL) {
+		printf("Failed opening %s\n", filename);
+		return 1;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	data = malloc(len + 1);
+	assert(data != NULL);
+	assert(fread(data, 1, len, fp) == len);
+
+	fclose(fp);
+
+	assert(parserutils_inputstream_create("UTF-8", 0, NULL,
+			myrealloc, NULL, &stream) == PARSERUTILS_OK);
+
+	assert(hubbub_tokeniser_create(stream, myrealloc, NULL, &tok) ==
+			HUBBUB_OK);
+
+	params.token_handler.handler = count_handler;
+	params.token_handler.pw = &count;
+	assert(hubbub_tokeniser_setopt(tok, HUBBUB_TOKENISER_TOKEN_HANDLER,
+			&params) == HUBBUB_OK);
+
+	params.streaming = true;
+	assert(hubbub_tokeniser_setopt(tok, HUBBUB_TOKENISER_STREAMING,
+			&params) == HUBBUB_OK);
+
+	/* At least a megabyte, and at least two copies of the document */
+	target = max(2 * len, 1 << 20);
+
+	for (fed = 0; len > 0 && fed < target; ) {
+		for (pos = 0; pos < len; pos += CHUNK_SIZE) {
+			size_t n = min(CHUNK_SIZE, len - pos);
+
+			assert(parserutils_inputstream_append(stream,
+					data + pos, n) == PARSERUTILS_OK);
+			fed += n;
+
+			assert(hubbub_tokeniser_run(tok) == HUBBUB_OK);
+
+			/* Consumed input is discarded once it outweighs
+			 * what remains, and there's enough of it */
+			kept = stream->utf8->length - stream->cursor;
+			assert(stream->utf8->length < 2 * kept +
+					HUBBUB_TOKENISER_DISCARD_MIN);
+
+			most = max(most, stream->utf8->length);
+		}
+	}
+
+	/* So the buffer never holds much more than one copy */
+	assert(most < 2 * (len + CHUNK_SIZE) +
+			HUBBUB_TOKENISER_DISCARD_MIN);
+	assert(count > 0);
+
+	hubbub_tokeniser_destroy(tok);
+
+	parserutils_inputstream_destroy(stream);
+
+	free(data);
+
+	printf("Streamed %zu bytes, buffered at most %zu\n", fed, most);
+
+	return 0;
+}
+
+hubbub_error count_handler(const hubbub_token *token, void *pw)
+{
+	UNUSED(token);
+
+	(*((uint32_t *) pw))++;
+
+	return HUBBUB_OK;
+}
+
 hubbub_error token_handler(const hubbub_token *token, void *pw)
 {
 	static const char *token_names[] = {
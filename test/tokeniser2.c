@@ -10,6 +10,7 @@
 
 #include "utils/utils.h"
 
+#include "tokeniser/intern.h"
 #include "tokeniser/tokeniser.h"
 
 #include "testutils.h"
@@ -27,6 +28,7 @@ typedef struct context {
 	const char *last_start_tag;
 	struct array_list *content_model;
 	bool process_cdata;
+	bool intern_values;
 } context;
 
 static void run_test(context *ctx);
@@ -102,7 +104,11 @@ int main(int argc, char **argv)
 			}
 		}
 
-		/* And run the test */
+		/* And run the test, with and without interning values */
+		ctx.intern_values = false;
+		run_test(&ctx);
+
+		ctx.intern_values = true;
 		run_test(&ctx);
 	}
 
@@ -161,6 +167,11 @@ void run_test(context *ctx)
 					&params) == HUBBUB_OK);
 		}
 
+		params.intern_values = ctx->intern_values;
+		assert(hubbub_tokeniser_setopt(tok,
+				HUBBUB_TOKENISER_INTERN_VALUES,
+				&params) == HUBBUB_OK);
+
 		params.token_handler.handler = token_handler;
 		params.token_handler.pw = ctx;
 		assert(hubbub_tokeniser_setopt(tok,
@@ -385,6 +396,10 @@ hubbub_error token_handler(const hubbub_token *token, void *pw)
 			assert(vallen == strlen(expval));
 			assert(strncmp(gotval, expval, strlen(expval)) == 0);
 
+			assert((token->data.tag.attributes[i].value_id != 0) ==
+					(ctx->intern_values && vallen <=
+					HUBBUB_INTERN_MAX_LENGTH));
+
 			expattrs = expattrs->next;
 		}
 
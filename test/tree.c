@@ -78,6 +78,20 @@ static hubbub_tree_handler tree_handler = {
 	NULL
 };
 
+/* Start tags to stop after, for HUBBUB_STOP_AFTER_START_TAGS */
+#define STOP_COUNT 5
+
+/* Elements created so far which show where parsing stopped */
+static struct {
+	uint32_t head;
+	uint32_t body;			/**< Body or frameset elements */
+	uint32_t title;			/**< HTML title elements */
+} created;
+
+/* Parsed in full, the document has this many start tags and titles */
+static uint32_t full_start_tags;
+static uint32_t full_titles;
+
 static void *myrealloc(void *ptr, size_t len, void *pw)
 {
 	UNUSED(pw);
@@ -85,7 +99,86 @@ static void *myrealloc(void *ptr, size_t len, void *pw)
 	return realloc(ptr, len);
 }
 
-static int run_test(int argc, char **argv, unsigned int CHUNK_SIZE)
+static hubbub_error count_token(const hubbub_token *token, void *pw)
+{
+	uint32_t *start_tags = pw;
+
+	if (token->type == HUBBUB_TOKEN_START_TAG)
+		(*start_tags)++;
+
+	return HUBBUB_OK;
+}
+
+/* Count the start tags a parser has passed to the treebuilder */
+static uint32_t count_start_tags(hubbub_parser *parser)
+{
+	hubbub_parser *replay;
+	hubbub_parser_optparams params;
+	const uint8_t *rec;
+	size_t rec_len;
+	uint32_t start_tags = 0;
+
+	assert(hubbub_parser_read_recording(parser, &rec, &rec_len) ==
+			HUBBUB_OK);
+
+	assert(hubbub_parser_create("UTF-8", false, myrealloc, NULL,
+			&replay) == HUBBUB_OK);
+
+	params.token_handler.handler = count_token;
+	params.token_handler.pw = &start_tags;
+	assert(hubbub_parser_setopt(replay, HUBBUB_PARSER_TOKEN_HANDLER,
+			&params) == HUBBUB_OK);
+
+	assert(hubbub_parser_replay(replay, rec, rec_len) == HUBBUB_OK);
+
+	hubbub_parser_destroy(replay);
+
+	return start_tags;
+}
+
+/* Check that parsing stopped when, and only when, the condition was met */
+static void check_stopped(hubbub_parser *parser, hubbub_stop_condition stop,
+		bool stopped, bool at_end)
+{
+	uint32_t start_tags = count_start_tags(parser);
+
+	switch (stop) {
+	case HUBBUB_STOP_NEVER:
+		assert(stopped == false);
+
+		full_start_tags = start_tags;
+		full_titles = created.title;
+		break;
+	case HUBBUB_STOP_AFTER_HEAD:
+		/* Nothing after the head, even the body it implies */
+		assert(stopped);
+		assert(created.head == 1 && created.body == 0);
+		break;
+	case HUBBUB_STOP_AFTER_ELEMENT:
+		/* Foreign titles don't count, and there may be no title */
+		assert(stopped == (full_titles > 0));
+		assert(created.title == (stopped ? 1 : 0));
+		break;
+	case HUBBUB_STOP_AFTER_START_TAGS:
+		/* Short documents may have too few start tags */
+		assert(stopped == (full_start_tags >= STOP_COUNT));
+		assert(start_tags == min(full_start_tags, STOP_COUNT));
+		break;
+	}
+
+	if (stop == HUBBUB_STOP_AFTER_START_TAGS || stopped == false)
+		return;
+
+	/* Unless the end of input met the condition, some start tags
+	 * weren't reached */
+	if (at_end)
+		assert(start_tags == full_start_tags);
+	else
+		assert(start_tags < full_start_tags);
+}
+
+static int run_test(int argc, char **argv, unsigned int CHUNK_SIZE,
+		hubbub_stop_condition stop, bool ignore_whitespace)
 {
 	hubbub_parser *parser;
 	hubbub_parser_optparams params;
@@ -94,7 +187,9 @@ static int run_test(int argc, char **argv, unsigned int CHUNK_SIZE)
 	uint8_t *buf = alloca(CHUNK_SIZE);
 	const char *charset;
 	hubbub_charset_source cssource;
+	hubbub_error error;
 	bool passed = true;
+	bool stopped = false, at_end = false;
 	uintptr_t n;
 
 	UNUSED(argc);
@@ -106,6 +201,8 @@ static int run_test(int argc, char **argv, unsigned int CHUNK_SIZE)
 	}
 	node_ref_alloc = NODE_REF_CHUNK;
 
+	memset(&created, 0, sizeof(created));
+
 	assert(hubbub_parser_create("UTF-8", false, myrealloc, NULL, &parser) ==
 			HUBBUB_OK);
 
@@ -118,6 +215,20 @@ static int run_test(int argc, char **argv, unsigned int CHUNK_SIZE)
 	assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_DOCUMENT_NODE,
 			&params) == HUBBUB_OK);
 
+	params.stop.condition = stop;
+	params.stop.name = "title";
+	params.stop.count = STOP_COUNT;
+	assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_STOP,
+			&params) == HUBBUB_OK);
+
+	params.record_tokens = true;
+	assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_RECORD_TOKENS,
+			&params) == HUBBUB_OK);
+
+	params.ignore_whitespace = ignore_whitespace;
+	assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_IGNORE_WHITESPACE,
+			&params) == HUBBUB_OK);
+
 	fp = fopen(argv[1], "rb");
 	if (fp == NULL) {
 		printf("Failed opening %s\n", argv[1]);
@@ -134,13 +245,33 @@ static int run_test(int argc, char **argv, unsigned int CHUNK_SIZE)
                 if (bytes_read < 1)
                         break;
                 
-		assert(hubbub_parser_parse_chunk(parser,
-				buf, bytes_read) == HUBBUB_OK);
+		error = hubbub_parser_parse_chunk(parser, buf, bytes_read);
+		if (error == HUBBUB_STOPPED && stop != HUBBUB_STOP_NEVER) {
+			stopped = true;
+			break;
+		}
+		assert(error == HUBBUB_OK);
 
 		len -= bytes_read;
 	}
         
-        assert(len == 0);
+	if (stopped) {
+		/* Nothing more is parsed once stopped */
+		assert(hubbub_parser_parse_chunk(parser, buf, 1) ==
+				HUBBUB_STOPPED);
+		assert(hubbub_parser_completed(parser) == HUBBUB_STOPPED);
+	} else {
+		assert(len == 0);
+
+		/* The end of the document may yet meet the condition */
+		error = hubbub_parser_completed(parser);
+		if (error == HUBBUB_STOPPED && stop != HUBBUB_STOP_NEVER)
+			stopped = at_end = true;
+		else
+			assert(error == HUBBUB_OK);
+	}
+
+	check_stopped(parser, stop, stopped, at_end);
         
 	fclose(fp);
 
@@ -176,10 +307,24 @@ int main(int argc, char **argv)
 		return 1;
 	}
 
-#define DO_TEST(n) if ((ret = run_test(argc, argv, (n))) != 0) return ret
+#define DO_TEST(n, s, w) \
+		if ((ret = run_test(argc, argv, (n), (s), (w))) != 0) \
+			return ret
         for (shift = 0; (1 << shift) != 16384; shift++)
         	for (offset = 0; offset < 10; offset += 3)
-	                DO_TEST((1 << shift) + offset);
+	                DO_TEST((1 << shift) + offset, HUBBUB_STOP_NEVER,
+					false);
+
+	/* Stopping early must still release every node */
+	for (shift = 0; shift < 14; shift += 4) {
+		DO_TEST(1 << shift, HUBBUB_STOP_AFTER_HEAD, false);
+		DO_TEST(1 << shift, HUBBUB_STOP_AFTER_ELEMENT, false);
+		DO_TEST(1 << shift, HUBBUB_STOP_AFTER_START_TAGS, false);
+	}
+
+	/* As must dropping whitespace */
+	for (shift = 0; shift < 14; shift += 4)
+		DO_TEST(1 << shift, HUBBUB_STOP_NEVER, true);
 
         return 0;
 #undef DO_TEST
@@ -228,6 +373,13 @@ hubbub_error create_doctype(void *ctx, const hubbub_doctype *doctype,
 	return HUBBUB_OK;
 }
 
+static bool is_named(const hubbub_tag *tag, const char *name)
+{
+	return tag->name.len == strlen(name) &&
+			strncmp((const char *) tag->name.ptr, name,
+				tag->name.len) == 0;
+}
+
 hubbub_error create_element(void *ctx, const hubbub_tag *tag, void **result)
 {
 	uint32_t i;
@@ -243,6 +395,15 @@ hubbub_error create_element(void *ctx, const hubbub_tag *tag, void **result)
 		assert(memchr(attr->value.ptr, 0xff, attr->value.len) == NULL);
 	}
 
+	if (tag->ns == HUBBUB_NS_HTML) {
+		if (is_named(tag, "head"))
+			created.head++;
+		else if (is_named(tag, "body") || is_named(tag, "frameset"))
+			created.body++;
+		else if (is_named(tag, "title"))
+			created.title++;
+	}
+
 	GROW_REF
 	node_ref[node_counter] = 0;
 
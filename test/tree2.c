@@ -9,6 +9,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <parserutils/charset/mibenum.h>
+
 #include <hubbub/hubbub.h>
 #include <hubbub/parser.h>
 #include <hubbub/tree.h>
@@ -93,6 +95,7 @@ static hubbub_error form_associate(void *ctx, void *form, void *node);
 static hubbub_error add_attributes(void *ctx, void *node,
 		const hubbub_attribute *attributes, uint32_t n_attributes);
 static hubbub_error set_quirks_mode(void *ctx, hubbub_quirks_mode mode);
+static hubbub_error encoding_change(void *ctx, const char *encname);
 static hubbub_error complete_script(void *ctx, void *script);
 
 static void delete_node(node_t *node);
@@ -115,11 +118,28 @@ static hubbub_tree_handler tree_handler = {
 	form_associate,
 	add_attributes,
 	set_quirks_mode,
-	NULL,
+	encoding_change,
         complete_script,
 	NULL
 };
 
+/* Charset to parse documents in, or NULL to detect it */
+static const char *encoding = "UTF-8";
+
+/* Whether to drop whitespace that cannot be rendered */
+static bool ignore_whitespace;
+
+/* Whether to ask for attributes to be filtered, which the tree builder
+ * must refuse, as it reads attributes to build the tree */
+static bool filter_attributes;
+static const char *filter_names[] = { "href", NULL };
+
+/* Parser being fed the document */
+static hubbub_parser *current;
+
+/* Charset to reprocess the document in, as asked by encoding_change() */
+static char reparse_charset[64];
+
 static void *myrealloc(void *ptr, size_t len, void *pw)
 {
 	void *ret;
@@ -141,14 +161,26 @@ static void *myrealloc(void *ptr, size_t len, void *pw)
 
 /*
  * Create, initialise, and return, a parser instance.
+ *
+ * If context is non-NULL, the parser is set up to parse a fragment, with
+ * context as the name of the context element.  The input is in charset
+ * enc, or is to be detected if enc is NULL.
  */
-static hubbub_parser *setup_parser(void)
+static hubbub_parser *setup_parser(const char *context, const char *enc)
 {
 	hubbub_parser *parser;
 	hubbub_parser_optparams params;
 
-	assert(hubbub_parser_create("UTF-8", false, myrealloc, NULL, &parser) ==
-			HUBBUB_OK);
+	if (context != NULL) {
+		assert(hubbub_parser_create_fragment(HUBBUB_NS_HTML, context,
+				enc, false, myrealloc, NULL, &parser) ==
+				HUBBUB_OK);
+	} else {
+		assert(hubbub_parser_create(enc, false, myrealloc, NULL,
+				&parser) == HUBBUB_OK);
+	}
+
+	current = parser;
 
 	params.tree_handler = &tree_handler;
 	assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_TREE_HANDLER,
@@ -162,6 +194,18 @@ static hubbub_parser *setup_parser(void)
 	assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_ENABLE_SCRIPTING,
 			&params) == HUBBUB_OK);
 
+	params.ignore_whitespace = ignore_whitespace;
+	assert(hubbub_parser_setopt(parser, HUBBUB_PARSER_IGNORE_WHITESPACE,
+			&params) == HUBBUB_OK);
+
+	if (filter_attributes) {
+		params.attribute_filter.names = filter_names;
+		params.attribute_filter.tags = NULL;
+		assert(hubbub_parser_setopt(parser,
+				HUBBUB_PARSER_ATTRIBUTE_FILTER,
+				&params) == HUBBUB_INVALID);
+	}
+
 	return parser;
 }
 
@@ -208,22 +252,445 @@ enum reading_state {
 	READING_DATA,
 	READING_DATA_AFTER_FIRST,
 	READING_ERRORS,
+	READING_CONTEXT,
+	READING_ENCODING,
 	READING_TREE
 };
 
+/*** Parser cloning ***/
+
+/* Map from nodes in the original tree to their copies */
+static struct {
+	node_t *orig;
+	node_t *copy;
+} *node_map;
+static size_t node_map_len;
+static size_t node_map_alloc;
+
+static void node_map_add(node_t *orig, node_t *copy)
+{
+	if (node_map_len == node_map_alloc) {
+		node_map_alloc = node_map_alloc ? node_map_alloc * 2 : 64;
+		node_map = realloc(node_map,
+				node_map_alloc * sizeof *node_map);
+	}
+
+	node_map[node_map_len].orig = orig;
+	node_map[node_map_len].copy = copy;
+	node_map_len++;
+}
+
+/*
+ * Copy a node, its following siblings and all their descendants.
+ */
+static node_t *copy_nodes(node_t *node, node_t *parent)
+{
+	node_t *first = NULL, *prev = NULL;
+
+	for (; node != NULL; node = node->next) {
+		node_t *copy;
+
+		clone_node(NULL, node, false, (void **) (void *) &copy);
+		copy->refcnt = 0;
+
+		node_map_add(node, copy);
+
+		copy->parent = parent;
+		copy->prev = prev;
+		if (prev == NULL)
+			first = copy;
+		else
+			prev->next = copy;
+
+		copy->child = copy_nodes(node->child, copy);
+
+		prev = copy;
+	}
+
+	return first;
+}
+
+static hubbub_error map_node(void *node, void *pw, void **clone)
+{
+	node_t *copy;
+	size_t i;
+
+	UNUSED(pw);
+
+	if (node == (void *) 1) {
+		*clone = node;
+		return HUBBUB_OK;
+	}
+
+	for (i = 0; i < node_map_len; i++) {
+		if (node_map[i].orig == node) {
+			node_map[i].copy->refcnt++;
+			*clone = node_map[i].copy;
+			return HUBBUB_OK;
+		}
+	}
+
+	/* Not in the tree: copy it now */
+	clone_node(NULL, node, true, (void **) (void *) &copy);
+	node_map_add(node, copy);
+
+	*clone = copy;
+
+	return HUBBUB_OK;
+}
+
+/* Tokens recorded by the last straightforward parse */
+static uint8_t *recording;
+static size_t recording_len;
+
+static void delete_document(void)
+{
+	while (Document) {
+		node_t *victim = Document;
+		Document = victim->next;
+		delete_node(victim);
+	}
+}
+
+/* Charset expected of a document whose charset is detected */
+static char expected_charset[64];
+static bool expect_reparse;
+
+/*
+ * Check that the parser arrived at the expected charset, having had the
+ * document reprocessed only if that was expected.
+ */
+static bool check_charset(hubbub_parser *parser, bool reparsed)
+{
+	hubbub_charset_source source;
+	const char *name;
+
+	if (encoding != NULL)
+		return true;
+
+	name = hubbub_parser_read_charset(parser, &source);
+
+	if (source == HUBBUB_CHARSET_CONFIDENT && reparsed == expect_reparse &&
+			parserutils_charset_mibenum_from_name(name,
+				strlen(name)) ==
+			parserutils_charset_mibenum_from_name(expected_charset,
+				strlen(expected_charset)))
+		return true;
+
+	printf("expected charset %s%s\n", expected_charset,
+			expect_reparse ? ", after reprocessing" : "");
+	printf("got charset %s (source %d)%s\n", name, source,
+			reparsed ? ", after reprocessing" : "");
+
+	return false;
+}
+
+/*
+ * Pass data to a parser.  Returns false if the document must be
+ * reprocessed in another charset.
+ */
+static bool feed_data(hubbub_parser *parser, const char *data, size_t len)
+{
+	hubbub_error error = hubbub_parser_parse_chunk(parser,
+			(const uint8_t *) data, len);
+
+	assert(error == HUBBUB_OK || error == HUBBUB_ENCODINGCHANGE);
+
+	return error == HUBBUB_OK;
+}
+
+/*
+ * Pass data to a parser a line at a time, as the test file is read, with
+ * each newline in a chunk of its own.  Returns false if the document must
+ * be reprocessed in another charset.
+ */
+static bool feed_lines(hubbub_parser *parser, const char *data, size_t len)
+{
+	while (len > 0) {
+		const char *nl = memchr(data, '\n', len);
+		size_t line = nl != NULL ? (size_t) (nl - data) : len;
+
+		if (feed_data(parser, data, line) == false)
+			return false;
+
+		if (nl == NULL)
+			break;
+
+		if (feed_data(parser, "\n", 1) == false)
+			return false;
+
+		data += line + 1;
+		len -= line + 1;
+	}
+
+	return true;
+}
+
+/*
+ * Tell a parser that it has all the data.  Returns false if the document
+ * must be reprocessed in another charset.
+ */
+static bool complete_data(hubbub_parser *parser)
+{
+	hubbub_error error = hubbub_parser_completed(parser);
+
+	assert(error == HUBBUB_OK || error == HUBBUB_ENCODINGCHANGE);
+
+	return error == HUBBUB_OK;
+}
+
+/*
+ * Parse the test data, in charset enc.  Returns the parser, or NULL if the
+ * document must be reprocessed in another charset.
+ *
+ * The data is passed line by line.  If clone is true, the parser and the
+ * tree are cloned halfway through the data, which may be mid-line, and
+ * the originals discarded.  Otherwise, the tokens are
+ * recorded, for replay_data().
+ */
+static hubbub_parser *parse_document(buf_t *data, const char *context,
+		bool clone, const char *enc)
+{
+	hubbub_parser *parser = setup_parser(context, enc);
+	const char *buf = data->buf != NULL ? data->buf : "";
+	size_t len = strlen(buf);
+	size_t split = 0;
+	bool ok;
+
+	/* An empty first chunk mustn't settle the charset */
+	ok = feed_data(parser, buf, 0);
+
+	if (clone) {
+		hubbub_parser *copy;
+		node_t *doc;
+
+		/* Split at a character boundary */
+		split = len / 2;
+		while (split > 0 && (buf[split] & 0xc0) == 0x80)
+			split--;
+
+		ok = ok && feed_lines(parser, buf, split);
+
+		if (ok) {
+			node_map_len = 0;
+			doc = copy_nodes(Document, (node_t *) 1);
+
+			assert(hubbub_parser_clone(parser, map_node, NULL,
+					&copy) == HUBBUB_OK);
+
+			hubbub_parser_destroy(parser);
+			delete_document();
+
+			Document = doc;
+			parser = current = copy;
+		}
+	} else {
+		hubbub_parser_optparams params;
+
+		params.record_tokens = true;
+		assert(hubbub_parser_setopt(parser,
+				HUBBUB_PARSER_RECORD_TOKENS, &params) ==
+				HUBBUB_OK);
+	}
+
+	ok = ok && feed_lines(parser, buf + split, len - split);
+	ok = ok && complete_data(parser);
+
+	if (!ok) {
+		hubbub_parser_destroy(parser);
+		delete_document();
+		return NULL;
+	}
+
+	return parser;
+}
+
+/*
+ * Parse the test data and print the resulting tree.
+ *
+ * Fragments are parsed into a lone html element; it's that element's
+ * children which make up the tree.
+ *
+ * Returns false if the document's charset isn't as expected.
+ */
+static bool parse_data(buf_t *data, const char *context, bool clone,
+		buf_t *got)
+{
+	hubbub_parser *parser;
+	const char *enc = encoding;
+	bool reparsed = false;
+	bool passed;
+
+	/* Reprocess the document when asked to, as a client would */
+	while ((parser = parse_document(data, context, clone, enc)) == NULL) {
+		assert(reparsed == false);
+		reparsed = true;
+		enc = reparse_charset;
+	}
+
+	passed = check_charset(parser, reparsed);
+
+	if (!clone) {
+		const uint8_t *rec;
+
+		assert(hubbub_parser_read_recording(parser, &rec,
+				&recording_len) == HUBBUB_OK);
+
+		free(recording);
+		recording = malloc(recording_len);
+		assert(recording != NULL);
+		memcpy(recording, rec, recording_len);
+	}
+
+	if (context == NULL) {
+		node_print(got, Document, 0);
+	} else if (Document != NULL && Document->child != NULL) {
+		node_print(got, Document->child, 0);
+	}
+
+	hubbub_parser_destroy(parser);
+	delete_document();
+
+	return passed;
+}
+
+/*
+ * Build a tree from the tokens recorded by parse_data(), and print it.
+ */
+static void replay_data(const char *context, buf_t *got)
+{
+	hubbub_parser *parser = setup_parser(context, "UTF-8");
+
+	assert(hubbub_parser_replay(parser, recording, recording_len) ==
+			HUBBUB_OK);
+
+	if (context == NULL) {
+		node_print(got, Document, 0);
+	} else if (Document != NULL && Document->child != NULL) {
+		node_print(got, Document->child, 0);
+	}
+
+	hubbub_parser_destroy(parser);
+	delete_document();
+}
+
+/*
+ * Parse the test data through a tree recorder, then replay the recording
+ * into the tree handler, and print the resulting tree.
+ *
+ * Returns false if the document's charset isn't as expected.
+ */
+static bool record_data(buf_t *data, const char *context, buf_t *got)
+{
+	hubbub_parser *parser;
+	const char *enc = encoding;
+	bool reparsed = false;
+	bool passed;
+	const char *buf = data->buf != NULL ? data->buf : "";
+	size_t len = strlen(buf);
+	hubbub_parser_optparams params;
+	hubbub_tree_recorder *recorder;
+	hubbub_tree_handler *handler;
+	hubbub_tree_target target;
+	const uint8_t *rec;
+	size_t rec_len;
+	void *document;
+
+	while (true) {
+		parser = setup_parser(context, enc);
+
+		assert(hubbub_tree_recorder_create(encoding_change, NULL,
+				myrealloc, NULL, &recorder) == HUBBUB_OK);
+		assert(hubbub_tree_recorder_handler(recorder, &handler,
+				&document) == HUBBUB_OK);
+
+		params.tree_handler = handler;
+		assert(hubbub_parser_setopt(parser,
+				HUBBUB_PARSER_TREE_HANDLER, &params) ==
+				HUBBUB_OK);
+
+		params.document_node = document;
+		assert(hubbub_parser_setopt(parser,
+				HUBBUB_PARSER_DOCUMENT_NODE, &params) ==
+				HUBBUB_OK);
+
+		/* Unlike parse_data(), pass the whole document in one chunk */
+		if (feed_data(parser, buf, len) && complete_data(parser))
+			break;
+
+		hubbub_parser_destroy(parser);
+		hubbub_tree_recorder_destroy(recorder);
+
+		assert(reparsed == false);
+		reparsed = true;
+		enc = reparse_charset;
+	}
+
+	passed = check_charset(parser, reparsed);
+
+	/* The parser releases its nodes as it's destroyed */
+	hubbub_parser_destroy(parser);
+
+	assert(Document == NULL);
+
+	assert(hubbub_tree_recorder_read(recorder, &rec, &rec_len) ==
+			HUBBUB_OK);
+
+	target.handler = &tree_handler;
+	target.document_node = (void *) 1;
+	assert(hubbub_tree_replay(rec, rec_len, &target, 1, myrealloc,
+			NULL) == HUBBUB_OK);
+
+	if (context == NULL) {
+		node_print(got, Document, 0);
+	} else if (Document != NULL && Document->child != NULL) {
+		node_print(got, Document->child, 0);
+	}
+
+	hubbub_tree_recorder_destroy(recorder);
+	delete_document();
+
+	return passed;
+}
+
+static bool compare_trees(buf_t *expected, buf_t *got)
+{
+	bool passed;
+
+	if (expected->buf == NULL)
+		buf_add(expected, "");
+	if (got->buf == NULL)
+		buf_add(got, "");
+
+	passed = !strcmp(got->buf, expected->buf);
+	if (!passed) {
+		printf("expected:\n");
+		printf("%s", expected->buf);
+		printf("got:\n");
+		printf("%s", got->buf);
+	}
+
+	return passed;
+}
+
 int main(int argc, char **argv)
 {
 	FILE *fp;
 	char line[2048];
+	char context[64];
 
 	bool reprocess = false;
 	bool passed = true;
+	bool pending = false;
 
-	hubbub_parser *parser = NULL;
 	enum reading_state state = EXPECT_DATA;
 
+	buf_t data = { NULL, 0, 0 };
 	buf_t expected = { NULL, 0, 0 };
 	buf_t got = { NULL, 0, 0 };
+	buf_t cloned = { NULL, 0, 0 };
+	buf_t replayed = { NULL, 0, 0 };
+	buf_t recorded = { NULL, 0, 0 };
 
 
 	if (argc != 2) {
@@ -237,6 +704,8 @@ int main(int argc, char **argv)
 		return 1;
 	}
 
+	context[0] = '\0';
+
 	/* We rely on lines not being anywhere near 2048 characters... */
 	while (reprocess || (passed && fgets(line, sizeof line, fp) == line)) {
 		reprocess = false;
@@ -244,75 +713,109 @@ int main(int argc, char **argv)
 		switch (state)
 		{
 		case ERASE_DATA:
+			buf_clear(&data);
 			buf_clear(&got);
+			buf_clear(&cloned);
+			buf_clear(&replayed);
+			buf_clear(&recorded);
 			buf_clear(&expected);
-
-			hubbub_parser_destroy(parser);
-			while (Document) {
-				node_t *victim = Document;
-				Document = victim->next;
-				delete_node(victim);
-			}
-			Document = NULL;
+			context[0] = '\0';
+			encoding = "UTF-8";
+			ignore_whitespace = false;
+			filter_attributes = false;
+			pending = false;
 
 			state = EXPECT_DATA;
 
  		case EXPECT_DATA:
-			if (strcmp(line, "#data\n") == 0) {
-				parser = setup_parser();
+			if (strcmp(line, "#data\n") == 0)
 				state = READING_DATA;
-			}
 			break;
 
 		case READING_DATA:
 		case READING_DATA_AFTER_FIRST:
 			if (strcmp(line, "#errors\n") == 0) {
-				assert(hubbub_parser_completed(parser) == HUBBUB_OK);
 				state = READING_ERRORS;
 			} else {
 				size_t len = strlen(line);
 
 				if (state == READING_DATA_AFTER_FIRST) {
-					assert(hubbub_parser_parse_chunk(parser,
-						(uint8_t *)"\n",
-						1) == HUBBUB_OK);
+					buf_add(&data, "\n");
 				} else {
 					state = READING_DATA_AFTER_FIRST;
 				}
 
 				printf(": %s", line);
-				assert(hubbub_parser_parse_chunk(parser, (uint8_t *)line,
-						len - 1) == HUBBUB_OK);
+
+				line[len - 1] = '\0';
+				buf_add(&data, line);
 			}
 			break;
 
 
 		case READING_ERRORS:
 			if (strcmp(line, "#document-fragment\n") == 0) {
-				state = ERASE_DATA;
-				reprocess = true;
-			}
-
-			if (strcmp(line, "#document\n") == 0)
+				state = READING_CONTEXT;
+			} else if (strcmp(line, "#encoding\n") == 0 ||
+					strcmp(line,
+					"#encoding-change\n") == 0) {
+				/* The charset is to be detected, and either
+				 * switched in place or the document
+				 * reprocessed, when a meta element is met */
+				expect_reparse = (line[9] == '-');
+				state = READING_ENCODING;
+			} else if (strcmp(line, "#ignore-whitespace\n") == 0) {
+				/* The expected tree lacks unrendered
+				 * whitespace */
+				ignore_whitespace = true;
+			} else if (strcmp(line, "#attribute-filter\n") == 0) {
+				/* The tree is as it would be unfiltered */
+				filter_attributes = true;
+			} else if (strcmp(line, "#document\n") == 0) {
+				const char *ctx = context[0] != '\0' ?
+						context : NULL;
+
+				passed = parse_data(&data, ctx, false, &got);
+
+				/* Cloning mid-parse mustn't change the result */
+				passed = parse_data(&data, ctx, true, &cloned) &&
+					passed && compare_trees(&got, &cloned);
+
+				/* As must replaying the tokens */
+				replay_data(ctx, &replayed);
+				passed = passed &&
+					compare_trees(&got, &replayed);
+
+				/* Or recording the tree operations */
+				passed = record_data(&data, ctx, &recorded) &&
+					passed &&
+					compare_trees(&got, &recorded);
+
+				pending = true;
 				state = READING_TREE;
-			else {
 			}
 			break;
 
+		case READING_CONTEXT:
+			line[strlen(line) - 1] = '\0';
+			snprintf(context, sizeof context, "%s", line);
+			state = READING_ERRORS;
+			break;
+
+		case READING_ENCODING:
+			line[strlen(line) - 1] = '\0';
+			snprintf(expected_charset, sizeof expected_charset,
+					"%s", line);
+			encoding = NULL;
+			state = READING_ERRORS;
+			break;
+
 		case READING_TREE:
 			if (strcmp(line, "#data\n") == 0) {
-				node_print(&got, Document, 0);
-
 				/* Trim off the last newline */
 				expected.buf[strlen(expected.buf) - 1] = '\0';
 
-				passed = !strcmp(got.buf, expected.buf);
-				if (!passed) {
-					printf("expected:\n");
-					printf("%s", expected.buf);
-					printf("got:\n");
-					printf("%s", got.buf);
-				}
+				passed = compare_trees(&expected, &got);
 
 				state = ERASE_DATA;
 				reprocess = true;
@@ -323,31 +826,21 @@ int main(int argc, char **argv)
 		}
 	}
 
-	if (Document != NULL) {
-		node_print(&got, Document, 0);
-
-		passed = !strcmp(got.buf, expected.buf);
-		if (!passed) {
-			printf("expected:\n");
-			printf("%s", expected.buf);
-			printf("got:\n");
-			printf("%s", got.buf);
-		}
-
-		hubbub_parser_destroy(parser);
-		while (Document) {
-			node_t *victim = Document;
-			Document = victim->next;
-			delete_node(victim);
-		}
-	}
+	if (pending && passed)
+		passed = compare_trees(&expected, &got);
 
 	printf("%s\n", passed ? "PASS" : "FAIL");
 
 	fclose(fp);
 
+	free(node_map);
+	free(data.buf);
 	free(got.buf);
+	free(cloned.buf);
+	free(replayed.buf);
+	free(recorded.buf);
 	free(expected.buf);
+	free(recording);
 
 	return 0;
 }
@@ -816,6 +1309,23 @@ hubbub_error set_quirks_mode(void *ctx, hubbub_quirks_mode mode)
 	return HUBBUB_OK;
 }
 
+hubbub_error encoding_change(void *ctx, const char *encname)
+{
+	hubbub_charset_source source;
+
+	UNUSED(ctx);
+
+	/* Either the parser has switched charset already, or the charset
+	 * was known from the start */
+	hubbub_parser_read_charset(current, &source);
+	if (source == HUBBUB_CHARSET_CONFIDENT)
+		return HUBBUB_OK;
+
+	snprintf(reparse_charset, sizeof reparse_charset, "%s", encname);
+
+	return HUBBUB_ENCODINGCHANGE;
+}
+
 hubbub_error complete_script(void *ctx, void *script)
 {
 	UNUSED(ctx);